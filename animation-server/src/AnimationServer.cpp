@@ -809,23 +809,22 @@ AnimationServer::AnimationServer(int &argc, char **argv) :
 void AnimationServer::readPendingDatagrams() {
     NodeList* nodeList = NodeList::getInstance();
   
-    static QByteArray receivedPacket;
-    static HifiSockAddr nodeSockAddr;
+    PacketBuffer receivedDatagram;
+    QByteArray receivedPacket;
+    HifiSockAddr nodeSockAddr;
     
     // Nodes sending messages to us...
-    while (nodeList->getNodeSocket().hasPendingDatagrams()) {
-        receivedPacket.resize(nodeList->getNodeSocket().pendingDatagramSize());
-        nodeList->getNodeSocket().readDatagram(receivedPacket.data(), receivedPacket.size(),
-                                               nodeSockAddr.getAddressPointer(), nodeSockAddr.getPortPointer());
+    while (nodeList->readDatagram(receivedDatagram, nodeSockAddr)) {
+        receivedDatagram.asByteArray(receivedPacket);
         if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
             if (packetTypeForPacket(receivedPacket) == PacketTypeJurisdiction) {
                 int headerBytes = numBytesForPacketHeader(receivedPacket);
                 // PacketType_JURISDICTION, first byte is the node type...
-                if (receivedPacket.data()[headerBytes] == NodeType::VoxelServer && ::jurisdictionListener) {
+                if (receivedPacket.constData()[headerBytes] == NodeType::VoxelServer && ::jurisdictionListener) {
                     
                     SharedNodePointer matchedNode = NodeList::getInstance()->sendingNodeForPacket(receivedPacket);
                     if (matchedNode) {
-                        ::jurisdictionListener->queueReceivedPacket(matchedNode, receivedPacket);
+                        ::jurisdictionListener->queueReceivedPacket(matchedNode, receivedDatagram);
                     }
                 }
             }
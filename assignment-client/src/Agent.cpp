@@ -37,11 +37,13 @@ Agent::Agent(const QByteArray& packet) :
 }
 
 void Agent::readPendingDatagrams() {
+    PacketBuffer receivedDatagram;
     QByteArray receivedPacket;
     HifiSockAddr senderSockAddr;
     NodeList* nodeList = NodeList::getInstance();
     
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
+    while (readAvailableDatagram(receivedDatagram, senderSockAddr)) {
+        receivedDatagram.asByteArray(receivedPacket);
         if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
             PacketType datagramPacketType = packetTypeForPacket(receivedPacket);
             
@@ -55,11 +57,11 @@ void Agent::readPendingDatagrams() {
                     switch (receivedPacket[headerBytes]) {
                         case NodeType::VoxelServer:
                             _scriptEngine.getVoxelsScriptingInterface()->getJurisdictionListener()->
-                                                                queueReceivedPacket(matchedNode,receivedPacket);
+                                                                queueReceivedPacket(matchedNode, receivedDatagram);
                             break;
                         case NodeType::ParticleServer:
                             _scriptEngine.getParticlesScriptingInterface()->getJurisdictionListener()->
-                                                                queueReceivedPacket(matchedNode, receivedPacket);
+                                                                queueReceivedPacket(matchedNode, receivedDatagram);
                             break;
                     }
                 }
@@ -6,7 +6,6 @@
 //  Copyright (c) 2013 HighFidelity, Inc. All rights reserved.
 //
 
-#include <mmintrin.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <fstream>
@@ -28,17 +27,15 @@
 #include <sys/socket.h>
 #endif //_WIN32
 
-#include <glm/glm.hpp>
-#include <glm/gtx/norm.hpp>
-#include <glm/gtx/vector_angle.hpp>
-
 #include <QtCore/QCoreApplication>
 #include <QtCore/QJsonObject>
+#include <QtCore/QStringList>
 #include <QtCore/QTimer>
 
 #include <Logging.h>
 #include <NodeList.h>
 #include <Node.h>
+#include <PacketBuffer.h>
 #include <PacketHeaders.h>
 #include <SharedUtil.h>
 #include <StdDev.h>
@@ -46,8 +43,8 @@
 
 #include "AudioRingBuffer.h"
 #include "AudioMixerClientData.h"
+#include "AudioMixerWorker.h"
 #include "AvatarAudioRingBuffer.h"
-#include "InjectedAudioRingBuffer.h"
 
 #include "AudioMixer.h"
 
@@ -66,279 +63,245 @@ void attachNewBufferToNode(Node *newNode) {
 
 AudioMixer::AudioMixer(const QByteArray& packet) :
     ThreadedAssignment(packet),
+    _isPremixingClusters(false),
+    _listenerClusterSize(0.0f),
     _trailingSleepRatio(1.0f),
     _minAudibilityThreshold(LOUDNESS_TO_DISTANCE_RATIO / 2.0f),
     _performanceThrottlingRatio(0.0f),
     _numStatFrames(0),
     _sumListeners(0),
-    _sumMixes(0)
+    _sumMixes(0),
+    _sumSourcesVisited(0),
+    _sumMixPayloadBytes(0),
+    _sumListenerClusters(0),
+    _sumClusteredListeners(0),
+    _sumPremixedSources(0)
 {
     
 }
 
-void AudioMixer::addBufferToMixForListeningNodeWithBuffer(PositionalAudioRingBuffer* bufferToAdd,
-                                                          AvatarAudioRingBuffer* listeningNodeBuffer) {
-    float bearingRelativeAngleToSource = 0.0f;
-    float attenuationCoefficient = 1.0f;
-    int numSamplesDelay = 0;
-    float weakChannelAmplitudeRatio = 1.0f;
-    
-    if (bufferToAdd != listeningNodeBuffer) {
-        // if the two buffer pointers do not match then these are different buffers
-        glm::vec3 relativePosition = bufferToAdd->getPosition() - listeningNodeBuffer->getPosition();
-        
-        float distanceBetween = glm::length(relativePosition);
-       
-        if (distanceBetween < EPSILON) {
-            distanceBetween = EPSILON;
-        }
-        
-        if (bufferToAdd->getNextOutputTrailingLoudness() / distanceBetween <= _minAudibilityThreshold) {
-            // according to mixer performance we have decided this does not get to be mixed in
-            // bail out
-            return;
-        }
-        
-        ++_sumMixes;
-        
-        glm::quat inverseOrientation = glm::inverse(listeningNodeBuffer->getOrientation());
-        
-        float distanceSquareToSource = glm::dot(relativePosition, relativePosition);
-        float radius = 0.0f;
+AudioMixer::~AudioMixer() {
+    foreach (AudioMixerWorker* worker, _workers) {
+        delete worker;
+    }
+}
 
-        if (bufferToAdd->getType() == PositionalAudioRingBuffer::Injector) {
-            InjectedAudioRingBuffer* injectedBuffer = (InjectedAudioRingBuffer*) bufferToAdd;
-            radius = injectedBuffer->getRadius();
-            attenuationCoefficient *= injectedBuffer->getAttenuationRatio();
+void AudioMixer::parsePayload() {
+    QStringList payloadList = QString(getPayload()).split(" ", QString::SkipEmptyParts);
+
+    int numMixThreads = 1;
+
+    const QString MIX_THREADS_OPTION = "--mixThreads";
+    int mixThreadsIndex = payloadList.indexOf(MIX_THREADS_OPTION);
+    if (mixThreadsIndex != -1 && mixThreadsIndex + 1 < payloadList.size()) {
+        numMixThreads = std::max(1, payloadList[mixThreadsIndex + 1].toInt());
+    }
+
+    qDebug() << "Audio mixer will mix with" << numMixThreads << "thread(s)";
+
+    const QString SOURCE_GRID_CELL_SIZE_OPTION = "--sourceGridCellSize";
+    int cellSizeIndex = payloadList.indexOf(SOURCE_GRID_CELL_SIZE_OPTION);
+    if (cellSizeIndex != -1 && cellSizeIndex + 1 < payloadList.size()) {
+        float cellSize = payloadList[cellSizeIndex + 1].toFloat();
+        if (cellSize > 0.0f) {
+            _sourceGrid.setCellSize(cellSize);
         }
+    }
 
-        if (radius == 0 || (distanceSquareToSource > radius * radius)) {
-            // this is either not a spherical source, or the listener is outside the sphere
+    qDebug() << "Audio source grid cell size is" << _sourceGrid.getCellSize();
 
-            if (radius > 0) {
-                // this is a spherical source - the distance used for the coefficient
-                // needs to be the closest point on the boundary to the source
+    const QString LISTENER_CLUSTER_SIZE_OPTION = "--listenerClusterSize";
+    int clusterSizeIndex = payloadList.indexOf(LISTENER_CLUSTER_SIZE_OPTION);
+    if (clusterSizeIndex != -1 && clusterSizeIndex + 1 < payloadList.size()) {
+        _listenerClusterSize = std::max(0.0f, payloadList[clusterSizeIndex + 1].toFloat());
+    }
 
-                // ovveride the distance to the node with the distance to the point on the
-                // boundary of the sphere
-                distanceSquareToSource -= (radius * radius);
+    if (_listenerClusterSize > 0.0f) {
+        qDebug() << "Listeners within" << _listenerClusterSize << "of each other will share pre-mixes of sources over"
+            << _listenerClusterSize * PREMIXED_SOURCE_CLUSTER_SIZE_RATIO << "away";
+    }
 
-            } else {
-                // calculate the angle delivery for off-axis attenuation
-                glm::vec3 rotatedListenerPosition = glm::inverse(bufferToAdd->getOrientation()) * relativePosition;
+    // the first worker always runs on the mixer's own thread, the rest are handed to the pool each frame
+    for (int i = 0; i < numMixThreads; i++) {
+        _workers.append(new AudioMixerWorker(this));
+    }
+    _workerThreadPool.setMaxThreadCount(std::max(1, numMixThreads - 1));
+}
 
-                float angleOfDelivery = glm::angle(glm::vec3(0.0f, 0.0f, -1.0f),
-                                                   glm::normalize(rotatedListenerPosition));
+void AudioMixer::buildSourceGrid() {
+    _sourceGrid.clear();
 
-                const float MAX_OFF_AXIS_ATTENUATION = 0.2f;
-                const float OFF_AXIS_ATTENUATION_FORMULA_STEP = (1 - MAX_OFF_AXIS_ATTENUATION) / 2.0f;
+    foreach (const SharedNodePointer& node, _frameNodes) {
+        if (node->getLinkedData()) {
+            AudioMixerClientData* nodeClientData = (AudioMixerClientData*) node->getLinkedData();
 
-                float offAxisCoefficient = MAX_OFF_AXIS_ATTENUATION +
-                    (OFF_AXIS_ATTENUATION_FORMULA_STEP * (angleOfDelivery / PI_OVER_TWO));
+            for (unsigned int i = 0; i < nodeClientData->getRingBuffers().size(); i++) {
+                PositionalAudioRingBuffer* nodeBuffer = nodeClientData->getRingBuffers()[i];
 
-                // multiply the current attenuation coefficient by the calculated off axis coefficient
-                attenuationCoefficient *= offAxisCoefficient;
+                if (nodeBuffer->willBeAddedToMix() && nodeBuffer->getNextOutputTrailingLoudness() > 0) {
+                    _sourceGrid.addSource(nodeBuffer, node.data());
+                }
             }
+        }
+    }
 
-            glm::vec3 rotatedSourcePosition = inverseOrientation * relativePosition;
+    _sourceGrid.finalize();
+}
 
-            const float DISTANCE_SCALE = 2.5f;
-            const float GEOMETRIC_AMPLITUDE_SCALAR = 0.3f;
-            const float DISTANCE_LOG_BASE = 2.5f;
-            const float DISTANCE_SCALE_LOG = logf(DISTANCE_SCALE) / logf(DISTANCE_LOG_BASE);
+const int NUM_LISTENER_CLUSTER_ORIENTATIONS = 8;
 
-            // calculate the distance coefficient using the distance to this node
-            float distanceCoefficient = powf(GEOMETRIC_AMPLITUDE_SCALAR,
-                                             DISTANCE_SCALE_LOG +
-                                             (0.5f * logf(distanceSquareToSource) / logf(DISTANCE_LOG_BASE)) - 1);
-            distanceCoefficient = std::min(1.0f, distanceCoefficient);
+// packs the cluster cell a listener stands in (20 bits per axis) and the direction it faces into one key
+static quint64 clusterKeyForListener(const glm::vec3& position, const glm::quat& orientation, float clusterSize) {
+    glm::ivec3 coordinates(floorf(position.x / clusterSize), floorf(position.y / clusterSize),
+                           floorf(position.z / clusterSize));
 
-            // multiply the current attenuation coefficient by the distance coefficient
-            attenuationCoefficient *= distanceCoefficient;
+    glm::vec3 front = orientation * glm::vec3(0.0f, 0.0f, -1.0f);
+    int orientationBucket = floorf((atan2f(front.x, front.z) + PI) / (TWO_PI / NUM_LISTENER_CLUSTER_ORIENTATIONS));
+    orientationBucket = glm::clamp(orientationBucket, 0, NUM_LISTENER_CLUSTER_ORIENTATIONS - 1);
 
-            // project the rotated source position vector onto the XZ plane
-            rotatedSourcePosition.y = 0.0f;
+    const quint64 COORDINATE_MASK = (1 << 20) - 1;
+    return (((quint64) coordinates.x & COORDINATE_MASK) << 43) | (((quint64) coordinates.y & COORDINATE_MASK) << 23)
+        | (((quint64) coordinates.z & COORDINATE_MASK) << 3) | (quint64) orientationBucket;
+}
 
-            // produce an oriented angle about the y-axis
-            bearingRelativeAngleToSource = glm::orientedAngle(glm::vec3(0.0f, 0.0f, -1.0f),
-                                                              glm::normalize(rotatedSourcePosition),
-                                                              glm::vec3(0.0f, 1.0f, 0.0f));
+void AudioMixer::buildListenerClusters() {
+    _listenerClusters.clear();
+    _listenerClusterIndices.fill(-1, _frameListeners.size());
+    _nodeClusterIndices.clear();
 
-            const float PHASE_AMPLITUDE_RATIO_AT_90 = 0.5;
+    if (_listenerClusterSize <= 0.0f) {
+        return;
+    }
+
+    // bucket every listener by the cell it stands in and the way it faces
+    _clusterIndicesForKeys.clear();
+
+    for (int i = 0; i < _frameListeners.size(); i++) {
+        AvatarAudioRingBuffer* listenerBuffer =
+            ((AudioMixerClientData*) _frameListeners[i]->getLinkedData())->getAvatarAudioRingBuffer();
+
+        quint64 clusterKey = clusterKeyForListener(listenerBuffer->getPosition(), listenerBuffer->getOrientation(),
+                                                   _listenerClusterSize);
 
-            // figure out the number of samples of delay and the ratio of the amplitude
-            // in the weak channel for audio spatialization
-            float sinRatio = fabsf(sinf(bearingRelativeAngleToSource));
-            numSamplesDelay = SAMPLE_PHASE_DELAY_AT_90 * sinRatio;
-            weakChannelAmplitudeRatio = 1 - (PHASE_AMPLITUDE_RATIO_AT_90 * sinRatio);
+        QHash<quint64, int>::const_iterator matchingCluster = _clusterIndicesForKeys.constFind(clusterKey);
+        int clusterIndex = 0;
+
+        if (matchingCluster == _clusterIndicesForKeys.constEnd()) {
+            // the first listener in a cluster decides the way it faces, the others are within one bucket of it
+            ListenerCluster newCluster = { glm::vec3(0.0f, 0.0f, 0.0f), listenerBuffer->getOrientation(), 0 };
+
+            clusterIndex = _listenerClusters.size();
+            _listenerClusters.append(newCluster);
+            _clusterIndicesForKeys.insert(clusterKey, clusterIndex);
+        } else {
+            clusterIndex = matchingCluster.value();
         }
-    }
 
-    // if the bearing relative angle to source is > 0 then the delayed channel is the right one
-    int delayedChannelOffset = (bearingRelativeAngleToSource > 0.0f) ? 1 : 0;
-    int goodChannelOffset = delayedChannelOffset == 0 ? 1 : 0;
-    
-    const int16_t* nextOutputStart = bufferToAdd->getNextOutput();
-   
-    const int16_t* bufferStart = bufferToAdd->getBuffer();
-    int ringBufferSampleCapacity = bufferToAdd->getSampleCapacity();
+        _listenerClusters[clusterIndex].position += listenerBuffer->getPosition();
+        ++_listenerClusters[clusterIndex].numListeners;
 
-    int16_t correctBufferSample[2], delayBufferSample[2];
-    int delayedChannelIndex = 0;
-    
-    const int SINGLE_STEREO_OFFSET = 2;
-    
-    for (int s = 0; s < NETWORK_BUFFER_LENGTH_SAMPLES_STEREO; s += 4) {
-        
-        // setup the int16_t variables for the two sample sets
-        correctBufferSample[0] = nextOutputStart[s / 2] * attenuationCoefficient;
-        correctBufferSample[1] = nextOutputStart[(s / 2) + 1] * attenuationCoefficient;
-        
-        delayedChannelIndex = s + (numSamplesDelay * 2) + delayedChannelOffset;
-        
-        delayBufferSample[0] = correctBufferSample[0] * weakChannelAmplitudeRatio;
-        delayBufferSample[1] = correctBufferSample[1] * weakChannelAmplitudeRatio;
-        
-        __m64 bufferSamples = _mm_set_pi16(_clientSamples[s + goodChannelOffset],
-                                           _clientSamples[s + goodChannelOffset + SINGLE_STEREO_OFFSET],
-                                           _clientSamples[delayedChannelIndex],
-                                           _clientSamples[delayedChannelIndex + SINGLE_STEREO_OFFSET]);
-        __m64 addedSamples = _mm_set_pi16(correctBufferSample[0], correctBufferSample[1],
-                                         delayBufferSample[0], delayBufferSample[1]);
-        
-        // perform the MMX add (with saturation) of two correct and delayed samples
-        __m64 mmxResult = _mm_adds_pi16(bufferSamples, addedSamples);
-        int16_t* shortResults = reinterpret_cast<int16_t*>(&mmxResult);
-        
-        // assign the results from the result of the mmx arithmetic
-        _clientSamples[s + goodChannelOffset] = shortResults[3];
-        _clientSamples[s + goodChannelOffset + SINGLE_STEREO_OFFSET] = shortResults[2];
-        _clientSamples[delayedChannelIndex] = shortResults[1];
-        _clientSamples[delayedChannelIndex + SINGLE_STEREO_OFFSET] = shortResults[0];
+        _listenerClusterIndices[i] = clusterIndex;
     }
-    
-    // The following code is pretty gross and redundant, but AFAIK it's the best way to avoid
-    // too many conditionals in handling the delay samples at the beginning of _clientSamples.
-    // Basically we try to take the samples in batches of four, and then handle the remainder
-    // conditionally to get rid of the rest.
-    
-    const int DOUBLE_STEREO_OFFSET = 4;
-    const int TRIPLE_STEREO_OFFSET = 6;
-    
-    if (numSamplesDelay > 0) {
-        // if there was a sample delay for this buffer, we need to pull samples prior to the nextOutput
-        // to stick at the beginning
-        float attenuationAndWeakChannelRatio = attenuationCoefficient * weakChannelAmplitudeRatio;
-        const int16_t* delayNextOutputStart = nextOutputStart - numSamplesDelay;
-        if (delayNextOutputStart < bufferStart) {
-            delayNextOutputStart = bufferStart + ringBufferSampleCapacity - numSamplesDelay;
-        }
-        
-        int i = 0;
-        
-        while (i + 3 < numSamplesDelay) {
-            // handle the first cases where we can MMX add four samples at once
-            int parentIndex = i * 2;
-            __m64 bufferSamples = _mm_set_pi16(_clientSamples[parentIndex + delayedChannelOffset],
-                                               _clientSamples[parentIndex + SINGLE_STEREO_OFFSET + delayedChannelOffset],
-                                               _clientSamples[parentIndex + DOUBLE_STEREO_OFFSET + delayedChannelOffset],
-                                               _clientSamples[parentIndex + TRIPLE_STEREO_OFFSET + delayedChannelOffset]);
-            __m64 addSamples = _mm_set_pi16(delayNextOutputStart[i] * attenuationAndWeakChannelRatio,
-                                            delayNextOutputStart[i + 1] * attenuationAndWeakChannelRatio,
-                                            delayNextOutputStart[i + 2] * attenuationAndWeakChannelRatio,
-                                            delayNextOutputStart[i + 3] * attenuationAndWeakChannelRatio);
-            __m64 mmxResult = _mm_adds_pi16(bufferSamples, addSamples);
-            int16_t* shortResults = reinterpret_cast<int16_t*>(&mmxResult);
-            
-            _clientSamples[parentIndex + delayedChannelOffset] = shortResults[3];
-            _clientSamples[parentIndex + SINGLE_STEREO_OFFSET + delayedChannelOffset] = shortResults[2];
-            _clientSamples[parentIndex + DOUBLE_STEREO_OFFSET + delayedChannelOffset] = shortResults[1];
-            _clientSamples[parentIndex + TRIPLE_STEREO_OFFSET + delayedChannelOffset] = shortResults[0];
-            
-            // push the index
-            i += 4;
+
+    // a listener on its own gains nothing from a pre-mix, so only clusters of two or more are kept
+    QVector<int> keptClusterIndices(_listenerClusters.size(), -1);
+    int numKeptClusters = 0;
+
+    for (int i = 0; i < _listenerClusters.size(); i++) {
+        if (_listenerClusters[i].numListeners > 1) {
+            ListenerCluster& cluster = _listenerClusters[i];
+            cluster.position /= (float) cluster.numListeners;
+
+            keptClusterIndices[i] = numKeptClusters;
+            _listenerClusters[numKeptClusters++] = cluster;
         }
-        
-        int parentIndex = i * 2;
-        
-        if (i + 2 < numSamplesDelay) {
-            // MMX add only three delayed samples
-            
-            __m64 bufferSamples = _mm_set_pi16(_clientSamples[parentIndex + delayedChannelOffset],
-                                               _clientSamples[parentIndex + SINGLE_STEREO_OFFSET + delayedChannelOffset],
-                                               _clientSamples[parentIndex + DOUBLE_STEREO_OFFSET + delayedChannelOffset],
-                                               0);
-            __m64 addSamples = _mm_set_pi16(delayNextOutputStart[i] * attenuationAndWeakChannelRatio,
-                                            delayNextOutputStart[i + 1] * attenuationAndWeakChannelRatio,
-                                            delayNextOutputStart[i + 2] * attenuationAndWeakChannelRatio,
-                                            0);
-            __m64 mmxResult = _mm_adds_pi16(bufferSamples, addSamples);
-            int16_t* shortResults = reinterpret_cast<int16_t*>(&mmxResult);
-            
-            _clientSamples[parentIndex + delayedChannelOffset] = shortResults[3];
-            _clientSamples[parentIndex + SINGLE_STEREO_OFFSET + delayedChannelOffset] = shortResults[2];
-            _clientSamples[parentIndex + DOUBLE_STEREO_OFFSET + delayedChannelOffset] = shortResults[1];
-            
-        } else if (i + 1 < numSamplesDelay) {
-            // MMX add two delayed samples
-            __m64 bufferSamples = _mm_set_pi16(_clientSamples[parentIndex + delayedChannelOffset],
-                                               _clientSamples[parentIndex + SINGLE_STEREO_OFFSET + delayedChannelOffset], 0, 0);
-            __m64 addSamples = _mm_set_pi16(delayNextOutputStart[i] * attenuationAndWeakChannelRatio,
-                                            delayNextOutputStart[i + 1] * attenuationAndWeakChannelRatio, 0, 0);
-            
-            __m64 mmxResult = _mm_adds_pi16(bufferSamples, addSamples);
-            int16_t* shortResults = reinterpret_cast<int16_t*>(&mmxResult);
-            
-            _clientSamples[parentIndex + delayedChannelOffset] = shortResults[3];
-            _clientSamples[parentIndex + SINGLE_STEREO_OFFSET + delayedChannelOffset] = shortResults[2];
-            
-        } else if (i < numSamplesDelay) {
-            // MMX add a single delayed sample
-            __m64 bufferSamples = _mm_set_pi16(_clientSamples[parentIndex + delayedChannelOffset], 0, 0, 0);
-            __m64 addSamples = _mm_set_pi16(delayNextOutputStart[i] * attenuationAndWeakChannelRatio, 0, 0, 0);
-            
-            __m64 mmxResult = _mm_adds_pi16(bufferSamples, addSamples);
-            int16_t* shortResults = reinterpret_cast<int16_t*>(&mmxResult);
-            
-            _clientSamples[parentIndex + delayedChannelOffset] = shortResults[3];
+    }
+
+    _listenerClusters.resize(numKeptClusters);
+
+    for (int i = 0; i < _frameListeners.size(); i++) {
+        _listenerClusterIndices[i] = keptClusterIndices[_listenerClusterIndices[i]];
+
+        if (_listenerClusterIndices[i] != -1) {
+            _nodeClusterIndices.insert(_frameListeners[i].data(), _listenerClusterIndices[i]);
+            ++_sumClusteredListeners;
         }
     }
+
+    _sumListenerClusters += numKeptClusters;
+
+    if (_clusterPremixes.size() < (size_t) (numKeptClusters * NETWORK_BUFFER_LENGTH_SAMPLES_STEREO)) {
+        _clusterPremixes.resize(numKeptClusters * NETWORK_BUFFER_LENGTH_SAMPLES_STEREO);
+    }
 }
 
-void AudioMixer::prepareMixForListeningNode(Node* node) {
-    AvatarAudioRingBuffer* nodeRingBuffer = ((AudioMixerClientData*) node->getLinkedData())->getAvatarAudioRingBuffer();
+bool AudioMixer::isSourcePremixedForCluster(const AudioSourceGrid::Source& source, int clusterIndex) const {
+    float premixDistance = PREMIXED_SOURCE_CLUSTER_SIZE_RATIO * _listenerClusterSize;
+    float distanceToCluster = std::max(glm::distance(source.buffer->getPosition(), _listenerClusters[clusterIndex].position),
+                                       EPSILON);
+    if (distanceToCluster < premixDistance) {
+        return false;
+    }
 
-    // zero out the client mix for this node
-    memset(_clientSamples, 0, NETWORK_BUFFER_LENGTH_BYTES_STEREO);
+    // the pre-mix culls the same way a listener at the centre would, and a source too quiet to be heard there may still
+    // be heard at the edge of the cluster, so it is left to each listener's own mix instead of being dropped from both
+    if (source.buffer->getNextOutputTrailingLoudness() / distanceToCluster <= _minAudibilityThreshold) {
+        return false;
+    }
 
-    // loop through all other nodes that have sufficient audio to mix
-    foreach (const SharedNodePointer& otherNode, NodeList::getInstance()->getNodeHash()) {
-        if (otherNode->getLinkedData()) {
+    // the cluster's own members are always mixed per listener so that loopback is decided for each of them
+    return _nodeClusterIndices.value(source.node, -1) != clusterIndex;
+}
 
-            AudioMixerClientData* otherNodeClientData = (AudioMixerClientData*) otherNode->getLinkedData();
+int AudioMixer::claimNextListenerIndex() {
+    int listenerIndex = _nextWorkIndex.fetchAndAddOrdered(1);
+    return listenerIndex < _frameListeners.size() ? listenerIndex : -1;
+}
 
-            // enumerate the ARBs attached to the otherNode and add all that should be added to mix
-            for (unsigned int i = 0; i < otherNodeClientData->getRingBuffers().size(); i++) {
-                PositionalAudioRingBuffer* otherNodeBuffer = otherNodeClientData->getRingBuffers()[i];
+int AudioMixer::claimNextClusterIndex() {
+    int clusterIndex = _nextWorkIndex.fetchAndAddOrdered(1);
+    return clusterIndex < _listenerClusters.size() ? clusterIndex : -1;
+}
 
-                if ((*otherNode != *node
-                     || otherNodeBuffer->shouldLoopbackForNode())
-                    && otherNodeBuffer->willBeAddedToMix()
-                    && otherNodeBuffer->getNextOutputTrailingLoudness() > 0) {
-                    addBufferToMixForListeningNodeWithBuffer(otherNodeBuffer, nodeRingBuffer);
-                }
-            }
-        }
+void AudioMixer::mixFrameListeners() {
+    // make sure every listener has a slot for its mix, this only re-allocates when the number of listeners grows
+    if (_listenerMixPayloadSizes.size() < (size_t) _frameListeners.size()) {
+        _listenerMixPayloads.resize(_frameListeners.size() * MAX_MIX_PAYLOAD_BYTES);
+        _listenerMixPayloadSizes.resize(_frameListeners.size());
     }
+
+    // the listener mixes add in their cluster's pre-mix, so those all have to be done first
+    if (!_listenerClusters.isEmpty()) {
+        _isPremixingClusters = true;
+        runWorkers();
+        _isPremixingClusters = false;
+    }
+
+    runWorkers();
 }
 
+void AudioMixer::runWorkers() {
+    _nextWorkIndex.fetchAndStoreOrdered(0);
+
+    for (int i = 1; i < _workers.size(); i++) {
+        _workerThreadPool.start(_workers[i]);
+    }
+
+    // the mixer thread does its share of the work instead of sitting idle
+    _workers[0]->run();
+
+    // wait for all of the workers to report that they are done
+    _finishedWorkers.acquire(_workers.size());
+}
 
 void AudioMixer::readPendingDatagrams() {
+    PacketBuffer receivedDatagram;
     QByteArray receivedPacket;
     HifiSockAddr senderSockAddr;
     NodeList* nodeList = NodeList::getInstance();
     
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
+    while (readAvailableDatagram(receivedDatagram, senderSockAddr)) {
+        receivedDatagram.asByteArray(receivedPacket);
         if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
             // pull any new audio data from nodes off of the network stack
             PacketType mixerPacketType = packetTypeForPacket(receivedPacket);
@@ -361,18 +324,52 @@ void AudioMixer::sendStatsPacket() {
     statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100.0f;
     statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
 
+    for (int i = 0; i < _workers.size(); i++) {
+        AudioMixerWorker* worker = _workers[i];
+
+        _sumListeners += worker->getSumListeners();
+        _sumMixes += worker->getSumMixes();
+        _sumSourcesVisited += worker->getSumSourcesVisited();
+        _sumPremixedSources += worker->getSumPremixedSources();
+
+        QString workerPrefix = QString("mix_worker_%1_").arg(i);
+        if (_numStatFrames > 0) {
+            statsObject[workerPrefix + "usecs_per_frame"] = (float) worker->getSumMixUsecs() / (float) _numStatFrames;
+            statsObject[workerPrefix + "listeners_per_frame"] = (float) worker->getSumListeners() / (float) _numStatFrames;
+        } else {
+            statsObject[workerPrefix + "usecs_per_frame"] = 0.0;
+            statsObject[workerPrefix + "listeners_per_frame"] = 0.0;
+        }
+
+        worker->resetStats();
+    }
+
     statsObject["average_listeners_per_frame"] = (float) _sumListeners / (float) _numStatFrames;
+    statsObject["average_listener_clusters_per_frame"] = (float) _sumListenerClusters / (float) _numStatFrames;
     
     if (_sumListeners > 0) {
         statsObject["average_mixes_per_listener"] = (float) _sumMixes / (float) _sumListeners;
+        statsObject["average_sources_visited_per_listener"] = (float) _sumSourcesVisited / (float) _sumListeners;
+        statsObject["average_mix_bytes_per_listener"] = (float) _sumMixPayloadBytes / (float) _sumListeners;
+        statsObject["average_premixed_sources_per_listener"] = (float) _sumPremixedSources / (float) _sumListeners;
+        statsObject["clustered_listener_percentage"] = 100.0f * _sumClusteredListeners / (float) _sumListeners;
     } else {
         statsObject["average_mixes_per_listener"] = 0.0;
+        statsObject["average_sources_visited_per_listener"] = 0.0;
+        statsObject["average_mix_bytes_per_listener"] = 0.0;
+        statsObject["average_premixed_sources_per_listener"] = 0.0;
+        statsObject["clustered_listener_percentage"] = 0.0;
     }
     
     ThreadedAssignment::addPacketStatsAndSendStatsPacket(statsObject);
     
     _sumListeners = 0;
     _sumMixes = 0;
+    _sumSourcesVisited = 0;
+    _sumMixPayloadBytes = 0;
+    _sumListenerClusters = 0;
+    _sumClusteredListeners = 0;
+    _sumPremixedSources = 0;
     _numStatFrames = 0;
 }
 
@@ -386,13 +383,14 @@ void AudioMixer::run() {
 
     nodeList->linkedDataCreateCallback = attachNewBufferToNode;
 
+    parsePayload();
+
     int nextFrame = 0;
     timeval startTime;
 
     gettimeofday(&startTime, NULL);
     
-    char* clientMixBuffer = new char[NETWORK_BUFFER_LENGTH_BYTES_STEREO
-                                     + numBytesForPacketHeaderGivenPacketType(PacketTypeMixedAudio)];
+    char* clientMixBuffer = new char[numBytesForPacketHeaderGivenPacketType(PacketTypeMixedAudio)];
     
     int usecToSleep = BUFFER_SEND_INTERVAL_USECS;
     
@@ -401,7 +399,10 @@ void AudioMixer::run() {
 
     while (!_isFinished) {
         
-        foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
+        // grab the nodes once for the frame, the workers all look at this same set
+        _frameNodes = nodeList->getNodeHash();
+
+        foreach (const SharedNodePointer& node, _frameNodes) {
             if (node->getLinkedData()) {
                 ((AudioMixerClientData*) node->getLinkedData())->checkBuffersBeforeFrameSend(JITTER_BUFFER_SAMPLES);
             }
@@ -459,22 +460,39 @@ void AudioMixer::run() {
             ++framesSinceCutoffEvent;
         }
         
-        foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
+        _frameListeners.clear();
+
+        foreach (const SharedNodePointer& node, _frameNodes) {
             if (node->getType() == NodeType::Agent && node->getActiveSocket() && node->getLinkedData()
                 && ((AudioMixerClientData*) node->getLinkedData())->getAvatarAudioRingBuffer()) {
-                prepareMixForListeningNode(node.data());
-                
-                int numBytesPacketHeader = populatePacketHeader(clientMixBuffer, PacketTypeMixedAudio);
-
-                memcpy(clientMixBuffer + numBytesPacketHeader, _clientSamples, NETWORK_BUFFER_LENGTH_BYTES_STEREO);
-                nodeList->writeDatagram(clientMixBuffer, NETWORK_BUFFER_LENGTH_BYTES_STEREO + numBytesPacketHeader, node);
-                
-                ++_sumListeners;
+                _frameListeners.append(node);
             }
         }
 
+        buildSourceGrid();
+        buildListenerClusters();
+
+        mixFrameListeners();
+
+        // the socket belongs to this thread, so all of the mixes are sent from here once the workers are done
+        int numBytesPacketHeader = populatePacketHeader(clientMixBuffer, PacketTypeMixedAudio);
+        
+        // and they go out in as few system calls as possible, which at this rate is most of the cost of sending
+        DatagramSendBatch sendBatch(nodeList->getNodeSocket());
+
+        for (int i = 0; i < _frameListeners.size(); i++) {
+            // the workers already encoded each mix in the codec its listener asked for, which is copied once into a
+            // pooled buffer with the header in front of it, and sent from there
+            PacketBuffer mixPacket(getMixPayloadForListener(i), _listenerMixPayloadSizes[i]);
+            memcpy(mixPacket.prepend(numBytesPacketHeader), clientMixBuffer, numBytesPacketHeader);
+            nodeList->writeDatagram(mixPacket, _frameListeners[i]);
+
+            _sumMixPayloadBytes += _listenerMixPayloadSizes[i];
+        }
+        sendBatch.flush();
+
         // push forward the next output pointers for any audio buffers we used
-        foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
+        foreach (const SharedNodePointer& node, _frameNodes) {
             if (node->getLinkedData()) {
                 ((AudioMixerClientData*) node->getLinkedData())->pushBuffersAfterFrameSend();
             }
@@ -495,5 +513,9 @@ void AudioMixer::run() {
         }
     }
     
+    // don't hold on to the nodes from the last frame
+    _frameNodes.clear();
+    _frameListeners.clear();
+
     delete[] clientMixBuffer;
 }
@@ -9,20 +9,77 @@
 #ifndef __hifi__AudioMixer__
 #define __hifi__AudioMixer__
 
+#include <vector>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+#include <glm/gtc/quaternion.hpp>
+
 #include <AudioRingBuffer.h>
+#include <NodeList.h>
 
 #include <ThreadedAssignment.h>
 
-class PositionalAudioRingBuffer;
-class AvatarAudioRingBuffer;
+#include "AudioSourceGrid.h"
+
+class AudioMixerWorker;
 
-const int SAMPLE_PHASE_DELAY_AT_90 = 20;
+/// a listener's mix is its codec byte followed by the encoded stereo frame, PCM being the largest
+const int MAX_MIX_PAYLOAD_BYTES = sizeof(AudioCodecType_t) + NETWORK_BUFFER_LENGTH_BYTES_STEREO;
+
+/// sources at least this many cluster sizes away from a listener cluster are pre-mixed once for the whole cluster
+const float PREMIXED_SOURCE_CLUSTER_SIZE_RATIO = 4.0f;
+
+/// Listeners that stand close together and face roughly the same way. Sources that are far from all of them sound
+/// nearly the same to each of them, so those are mixed once from the cluster's centre and shared.
+struct ListenerCluster {
+    glm::vec3 position;
+    glm::quat orientation;
+    int numListeners;
+};
 
 /// Handles assignments of type AudioMixer - mixing streams of audio and re-distributing to various clients.
 class AudioMixer : public ThreadedAssignment {
     Q_OBJECT
 public:
     AudioMixer(const QByteArray& packet);
+    ~AudioMixer();
+
+    float getMinAudibilityThreshold() const { return _minAudibilityThreshold; }
+
+    /// the sources that will be mixed in the current frame, bucketed by position
+    const AudioSourceGrid& getSourceGrid() const { return _sourceGrid; }
+
+    /// claims the next listener of the current frame for a worker, returns -1 once all listeners are claimed
+    int claimNextListenerIndex();
+    const SharedNodePointer& getFrameListener(int listenerIndex) const { return _frameListeners[listenerIndex]; }
+
+    /// true while the workers are pre-mixing clusters, before any listener is mixed
+    bool isPremixingClusters() const { return _isPremixingClusters; }
+
+    /// claims the next cluster to pre-mix for a worker, returns -1 once all clusters are claimed
+    int claimNextClusterIndex();
+    const ListenerCluster& getListenerCluster(int clusterIndex) const { return _listenerClusters[clusterIndex]; }
+
+    /// \return the cluster the listener belongs to, or -1 if it is mixed on its own
+    int getClusterIndexForListener(int listenerIndex) const { return _listenerClusterIndices[listenerIndex]; }
+
+    /// the cluster's pre-mix, the left channel followed by the right channel
+    int32_t* getPremixForCluster(int clusterIndex)
+        { return &_clusterPremixes[clusterIndex * NETWORK_BUFFER_LENGTH_SAMPLES_STEREO]; }
+
+    /// \return true if this source is mixed into the cluster's shared pre-mix instead of each of its listeners' mixes,
+    /// which takes it being far from the cluster and audible from the cluster's centre
+    bool isSourcePremixedForCluster(const AudioSourceGrid::Source& source, int clusterIndex) const;
+    char* getMixPayloadForListener(int listenerIndex) { return &_listenerMixPayloads[listenerIndex * MAX_MIX_PAYLOAD_BYTES]; }
+    void setMixPayloadSizeForListener(int listenerIndex, int numBytes) { _listenerMixPayloadSizes[listenerIndex] = numBytes; }
+
+    /// called by each worker when it runs out of listeners to mix for this frame
+    void workerFinished() { _finishedWorkers.release(); }
 public slots:
     /// threaded run of assignment
     void run();
@@ -31,23 +88,51 @@ public slots:
     
     void sendStatsPacket();
 private:
-    /// adds one buffer to the mix for a listening node
-    void addBufferToMixForListeningNodeWithBuffer(PositionalAudioRingBuffer* bufferToAdd,
-                                                  AvatarAudioRingBuffer* listeningNodeBuffer);
-    
-    /// prepares and sends a mix to one Node
-    void prepareMixForListeningNode(Node* node);
-    
-    // client samples capacity is larger than what will be sent to optimize mixing
-    // we are MMX adding 4 samples at a time so we need client samples to have an extra 4
-    int16_t _clientSamples[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO + (SAMPLE_PHASE_DELAY_AT_90 * 2)];
-    
+    /// reads mixer options (like --mixThreads) from the assignment payload
+    void parsePayload();
+
+    /// rebuilds _sourceGrid from the buffers in _frameNodes that are ready to be mixed
+    void buildSourceGrid();
+
+    /// groups the listeners in _frameListeners that are close enough to share a pre-mix, when clustering is enabled
+    void buildListenerClusters();
+
+    /// fans the cluster pre-mixes and then the mixes for every listener in _frameListeners out across the workers
+    void mixFrameListeners();
+
+    /// runs every worker once for the current phase of the frame and waits for them to finish
+    void runWorkers();
+
+    QVector<AudioMixerWorker*> _workers;
+    QThreadPool _workerThreadPool;
+    QSemaphore _finishedWorkers;
+
+    NodeHash _frameNodes;
+    QVector<SharedNodePointer> _frameListeners;
+    AudioSourceGrid _sourceGrid;
+    QAtomicInt _nextWorkIndex;
+    bool _isPremixingClusters;
+    std::vector<char> _listenerMixPayloads;
+    std::vector<int> _listenerMixPayloadSizes;
+
+    float _listenerClusterSize;
+    QVector<ListenerCluster> _listenerClusters;
+    QVector<int> _listenerClusterIndices;
+    QHash<const Node*, int> _nodeClusterIndices;
+    QHash<quint64, int> _clusterIndicesForKeys;
+    std::vector<int32_t> _clusterPremixes;
+
     float _trailingSleepRatio;
     float _minAudibilityThreshold;
     float _performanceThrottlingRatio;
     int _numStatFrames;
     int _sumListeners;
     int _sumMixes;
+    int _sumSourcesVisited;
+    qint64 _sumMixPayloadBytes;
+    int _sumListenerClusters;
+    int _sumClusteredListeners;
+    int _sumPremixedSources;
 };
 
 #endif /* defined(__hifi__AudioMixer__) */
@@ -6,6 +6,8 @@
 //  Copyright (c) 2013 HighFidelity, Inc. All rights reserved.
 //
 
+#include <cstring>
+
 #include <QDebug>
 
 #include <PacketHeaders.h>
@@ -16,7 +18,9 @@
 #include "AudioMixerClientData.h"
 
 AudioMixerClientData::AudioMixerClientData() :
-    _ringBuffers()
+    _ringBuffers(),
+    _mixEncoder(NULL),
+    _mixEncoderRequestedType(AudioCodecType::PCM)
 {
     
 }
@@ -26,6 +30,8 @@ AudioMixerClientData::~AudioMixerClientData() {
         // delete this attached PositionalAudioRingBuffer
         delete _ringBuffers[i];
     }
+    
+    delete _mixEncoder;
 }
 
 AvatarAudioRingBuffer* AudioMixerClientData::getAvatarAudioRingBuffer() const {
@@ -114,3 +120,26 @@ void AudioMixerClientData::pushBuffersAfterFrameSend() {
         }
     }
 }
+
+int AudioMixerClientData::encodeMixedAudio(const int16_t* mixSamples, char* destination) {
+    AvatarAudioRingBuffer* avatarRingBuffer = getAvatarAudioRingBuffer();
+    AudioCodecType_t codecType = avatarRingBuffer ? avatarRingBuffer->getCodecType() : AudioCodecType::PCM;
+    
+    // compared against what was asked for, since a fallback encoder is of another type than that
+    if (!_mixEncoder || _mixEncoderRequestedType != codecType) {
+        delete _mixEncoder;
+        _mixEncoder = AudioCodec::create(codecType);
+        _mixEncoderRequestedType = codecType;
+        
+        if (!_mixEncoder) {
+            // we can't speak what this client asked for, fall back to raw samples which every client can decode
+            _mixEncoder = new PCMAudioCodec();
+        }
+    }
+    
+    AudioCodecType_t mixCodecType = _mixEncoder->getType();
+    memcpy(destination, &mixCodecType, sizeof(AudioCodecType_t));
+    
+    return sizeof(AudioCodecType_t) + _mixEncoder->encode(mixSamples, NETWORK_BUFFER_LENGTH_SAMPLES_STEREO, 2,
+                                                          destination + sizeof(AudioCodecType_t));
+}
@@ -11,6 +11,7 @@
 
 #include <vector>
 
+#include <AudioCodec.h>
 #include <NodeData.h>
 #include <PositionalAudioRingBuffer.h>
 
@@ -27,8 +28,14 @@ public:
     int parseData(const QByteArray& packet);
     void checkBuffersBeforeFrameSend(int jitterBufferLengthSamples);
     void pushBuffersAfterFrameSend();
+    
+    /// writes the codec byte and the encoded stereo mix, in the codec this client sends its microphone audio with
+    /// \return the number of bytes written to destination, at most MAX_MIX_PAYLOAD_BYTES
+    int encodeMixedAudio(const int16_t* mixSamples, char* destination);
 private:
     std::vector<PositionalAudioRingBuffer*> _ringBuffers;
+    AudioCodec* _mixEncoder;
+    AudioCodecType_t _mixEncoderRequestedType;
 };
 
 #endif /* defined(__hifi__AudioMixerClientData__) */
@@ -0,0 +1,250 @@
+//
+//  AudioMixerWorker.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <string.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <glm/gtx/vector_angle.hpp>
+
+#include <AudioMixKernel.h>
+#include <NodeList.h>
+#include <SharedUtil.h>
+
+#include "AudioMixer.h"
+#include "AudioMixerClientData.h"
+#include "AvatarAudioRingBuffer.h"
+#include "InjectedAudioRingBuffer.h"
+
+#include "AudioMixerWorker.h"
+
+AudioMixerWorker::AudioMixerWorker(AudioMixer* mixer) :
+    _mixer(mixer),
+    _sumListeners(0),
+    _sumMixes(0),
+    _sumSourcesVisited(0),
+    _sumPremixedSources(0),
+    _sumMixUsecs(0)
+{
+    // the AudioMixer owns its workers and re-queues them every frame
+    setAutoDelete(false);
+}
+
+void AudioMixerWorker::run() {
+    quint64 startTime = usecTimestampNow();
+
+    if (_mixer->isPremixingClusters()) {
+        int clusterIndex = 0;
+        while ((clusterIndex = _mixer->claimNextClusterIndex()) != -1) {
+            prepareMixForCluster(clusterIndex);
+        }
+    } else {
+        int listenerIndex = 0;
+        while ((listenerIndex = _mixer->claimNextListenerIndex()) != -1) {
+            prepareMixForListeningNode(_mixer->getFrameListener(listenerIndex).data(),
+                                       _mixer->getClusterIndexForListener(listenerIndex));
+
+            // saturate the mix once, encode it for this listener and hand it back to the mixer,
+            // which sends it once the frame is complete
+            AudioMixKernel::saturateAndInterleave(_channelAccumulators[0], _channelAccumulators[1],
+                                                  _mixSamples, NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL);
+
+            AudioMixerClientData* listenerClientData =
+                (AudioMixerClientData*) _mixer->getFrameListener(listenerIndex)->getLinkedData();
+            int numPayloadBytes = listenerClientData->encodeMixedAudio(_mixSamples,
+                                                                       _mixer->getMixPayloadForListener(listenerIndex));
+            _mixer->setMixPayloadSizeForListener(listenerIndex, numPayloadBytes);
+
+            ++_sumListeners;
+        }
+    }
+
+    _sumMixUsecs += usecTimestampNow() - startTime;
+
+    _mixer->workerFinished();
+}
+
+void AudioMixerWorker::resetStats() {
+    _sumListeners = 0;
+    _sumMixes = 0;
+    _sumSourcesVisited = 0;
+    _sumPremixedSources = 0;
+    _sumMixUsecs = 0;
+}
+
+void AudioMixerWorker::addBufferToMixForListener(PositionalAudioRingBuffer* bufferToAdd, const glm::vec3& listenerPosition,
+                                                 const glm::quat& listenerOrientation, bool isListenersOwnBuffer) {
+    float bearingRelativeAngleToSource = 0.0f;
+    float attenuationCoefficient = 1.0f;
+    int numSamplesDelay = 0;
+    float weakChannelAmplitudeRatio = 1.0f;
+    
+    if (!isListenersOwnBuffer) {
+        glm::vec3 relativePosition = bufferToAdd->getPosition() - listenerPosition;
+        
+        float distanceBetween = glm::length(relativePosition);
+       
+        if (distanceBetween < EPSILON) {
+            distanceBetween = EPSILON;
+        }
+        
+        if (bufferToAdd->getNextOutputTrailingLoudness() / distanceBetween <= _mixer->getMinAudibilityThreshold()) {
+            // according to mixer performance we have decided this does not get to be mixed in
+            // bail out
+            return;
+        }
+        
+        ++_sumMixes;
+        
+        glm::quat inverseOrientation = glm::inverse(listenerOrientation);
+        
+        float distanceSquareToSource = glm::dot(relativePosition, relativePosition);
+        float radius = 0.0f;
+
+        if (bufferToAdd->getType() == PositionalAudioRingBuffer::Injector) {
+            InjectedAudioRingBuffer* injectedBuffer = (InjectedAudioRingBuffer*) bufferToAdd;
+            radius = injectedBuffer->getRadius();
+            attenuationCoefficient *= injectedBuffer->getAttenuationRatio();
+        }
+
+        if (radius == 0 || (distanceSquareToSource > radius * radius)) {
+            // this is either not a spherical source, or the listener is outside the sphere
+
+            if (radius > 0) {
+                // this is a spherical source - the distance used for the coefficient
+                // needs to be the closest point on the boundary to the source
+
+                // ovveride the distance to the node with the distance to the point on the
+                // boundary of the sphere
+                distanceSquareToSource -= (radius * radius);
+
+            } else {
+                // calculate the angle delivery for off-axis attenuation
+                glm::vec3 rotatedListenerPosition = glm::inverse(bufferToAdd->getOrientation()) * relativePosition;
+
+                float angleOfDelivery = glm::angle(glm::vec3(0.0f, 0.0f, -1.0f),
+                                                   glm::normalize(rotatedListenerPosition));
+
+                const float MAX_OFF_AXIS_ATTENUATION = 0.2f;
+                const float OFF_AXIS_ATTENUATION_FORMULA_STEP = (1 - MAX_OFF_AXIS_ATTENUATION) / 2.0f;
+
+                float offAxisCoefficient = MAX_OFF_AXIS_ATTENUATION +
+                    (OFF_AXIS_ATTENUATION_FORMULA_STEP * (angleOfDelivery / PI_OVER_TWO));
+
+                // multiply the current attenuation coefficient by the calculated off axis coefficient
+                attenuationCoefficient *= offAxisCoefficient;
+            }
+
+            glm::vec3 rotatedSourcePosition = inverseOrientation * relativePosition;
+
+            const float DISTANCE_SCALE = 2.5f;
+            const float GEOMETRIC_AMPLITUDE_SCALAR = 0.3f;
+            const float DISTANCE_LOG_BASE = 2.5f;
+            const float DISTANCE_SCALE_LOG = logf(DISTANCE_SCALE) / logf(DISTANCE_LOG_BASE);
+
+            // calculate the distance coefficient using the distance to this node
+            float distanceCoefficient = powf(GEOMETRIC_AMPLITUDE_SCALAR,
+                                             DISTANCE_SCALE_LOG +
+                                             (0.5f * logf(distanceSquareToSource) / logf(DISTANCE_LOG_BASE)) - 1);
+            distanceCoefficient = std::min(1.0f, distanceCoefficient);
+
+            // multiply the current attenuation coefficient by the distance coefficient
+            attenuationCoefficient *= distanceCoefficient;
+
+            // project the rotated source position vector onto the XZ plane
+            rotatedSourcePosition.y = 0.0f;
+
+            // produce an oriented angle about the y-axis
+            bearingRelativeAngleToSource = glm::orientedAngle(glm::vec3(0.0f, 0.0f, -1.0f),
+                                                              glm::normalize(rotatedSourcePosition),
+                                                              glm::vec3(0.0f, 1.0f, 0.0f));
+
+            const float PHASE_AMPLITUDE_RATIO_AT_90 = 0.5;
+
+            // figure out the number of samples of delay and the ratio of the amplitude
+            // in the weak channel for audio spatialization
+            float sinRatio = fabsf(sinf(bearingRelativeAngleToSource));
+            numSamplesDelay = SAMPLE_PHASE_DELAY_AT_90 * sinRatio;
+            weakChannelAmplitudeRatio = 1 - (PHASE_AMPLITUDE_RATIO_AT_90 * sinRatio);
+        }
+    }
+
+    // if the bearing relative angle to source is > 0 then the delayed channel is the right one
+    int delayedChannelOffset = (bearingRelativeAngleToSource > 0.0f) ? 1 : 0;
+    int goodChannelOffset = delayedChannelOffset == 0 ? 1 : 0;
+    
+    const int16_t* nextOutputStart = bufferToAdd->getNextOutput();
+    
+    AudioMixKernel::addSpatialized(_channelAccumulators[goodChannelOffset], _channelAccumulators[delayedChannelOffset],
+                                   nextOutputStart, attenuationCoefficient, weakChannelAmplitudeRatio, numSamplesDelay,
+                                   NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL);
+    
+    if (numSamplesDelay > 0) {
+        // if there was a sample delay for this buffer, we need to pull samples prior to the nextOutput
+        // to stick at the beginning of the delayed channel
+        const int16_t* bufferStart = bufferToAdd->getBuffer();
+        const int16_t* delayNextOutputStart = nextOutputStart - numSamplesDelay;
+        if (delayNextOutputStart < bufferStart) {
+            delayNextOutputStart = bufferStart + bufferToAdd->getSampleCapacity() - numSamplesDelay;
+        }
+        
+        AudioMixKernel::addScaled(_channelAccumulators[delayedChannelOffset], delayNextOutputStart,
+                                  attenuationCoefficient * weakChannelAmplitudeRatio, numSamplesDelay);
+    }
+}
+
+void AudioMixerWorker::prepareMixForListeningNode(Node* node, int clusterIndex) {
+    AvatarAudioRingBuffer* nodeRingBuffer = ((AudioMixerClientData*) node->getLinkedData())->getAvatarAudioRingBuffer();
+
+    // zero out the client mix for this node
+    memset(_channelAccumulators, 0, sizeof(_channelAccumulators));
+
+    // only look at the sources in grid cells that could be loud enough to be heard from here
+    _audibleSources.clear();
+    _mixer->getSourceGrid().findAudibleSources(nodeRingBuffer->getPosition(), _mixer->getMinAudibilityThreshold(),
+                                               node, _audibleSources);
+
+    _sumSourcesVisited += _audibleSources.size();
+
+    foreach (const AudioSourceGrid::Source* source, _audibleSources) {
+        if (clusterIndex != -1 && _mixer->isSourcePremixedForCluster(*source, clusterIndex)) {
+            // this source is already in the pre-mix we add below
+            ++_sumPremixedSources;
+            continue;
+        }
+
+        addBufferToMixForListener(source->buffer, nodeRingBuffer->getPosition(), nodeRingBuffer->getOrientation(),
+                                  source->buffer == nodeRingBuffer);
+    }
+
+    if (clusterIndex != -1) {
+        const int32_t* clusterPremix = _mixer->getPremixForCluster(clusterIndex);
+        AudioMixKernel::addAccumulated(_channelAccumulators[0], clusterPremix, NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL);
+        AudioMixKernel::addAccumulated(_channelAccumulators[1], clusterPremix + NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL,
+                                       NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL);
+    }
+}
+
+void AudioMixerWorker::prepareMixForCluster(int clusterIndex) {
+    const ListenerCluster& cluster = _mixer->getListenerCluster(clusterIndex);
+
+    memset(_channelAccumulators, 0, sizeof(_channelAccumulators));
+
+    // there is no single listening node here, isSourcePremixedForCluster leaves out the members' own buffers
+    _audibleSources.clear();
+    _mixer->getSourceGrid().findAudibleSources(cluster.position, _mixer->getMinAudibilityThreshold(),
+                                               NULL, _audibleSources);
+
+    foreach (const AudioSourceGrid::Source* source, _audibleSources) {
+        if (_mixer->isSourcePremixedForCluster(*source, clusterIndex)) {
+            addBufferToMixForListener(source->buffer, cluster.position, cluster.orientation, false);
+        }
+    }
+
+    memcpy(_mixer->getPremixForCluster(clusterIndex), _channelAccumulators, sizeof(_channelAccumulators));
+}
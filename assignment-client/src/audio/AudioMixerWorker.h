@@ -0,0 +1,72 @@
+//
+//  AudioMixerWorker.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#ifndef __hifi__AudioMixerWorker__
+#define __hifi__AudioMixerWorker__
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <QtCore/QRunnable>
+#include <QtCore/QVector>
+
+#include <AudioRingBuffer.h>
+#include <Node.h>
+
+#include "AudioSourceGrid.h"
+
+class AudioMixer;
+class AvatarAudioRingBuffer;
+class PositionalAudioRingBuffer;
+
+const int SAMPLE_PHASE_DELAY_AT_90 = 20;
+
+/// Computes mixes for the listeners of one AudioMixer frame. Each worker owns its own scratch buffer so that
+/// several of them can pull listeners from the same frame concurrently.
+class AudioMixerWorker : public QRunnable {
+public:
+    AudioMixerWorker(AudioMixer* mixer);
+
+    /// pre-mixes clusters or mixes listeners claimed from the mixer's current frame until there are none left
+    void run();
+
+    int getSumListeners() const { return _sumListeners; }
+    int getSumMixes() const { return _sumMixes; }
+    int getSumSourcesVisited() const { return _sumSourcesVisited; }
+    int getSumPremixedSources() const { return _sumPremixedSources; }
+    quint64 getSumMixUsecs() const { return _sumMixUsecs; }
+    void resetStats();
+
+private:
+    /// adds one buffer to _channelAccumulators as heard from the listener's position and orientation
+    /// \param isListenersOwnBuffer the listener's own microphone, which is mixed in without spatialization
+    void addBufferToMixForListener(PositionalAudioRingBuffer* bufferToAdd, const glm::vec3& listenerPosition,
+                                   const glm::quat& listenerOrientation, bool isListenersOwnBuffer);
+
+    /// prepares the mix for one Node in _channelAccumulators, adding in its cluster's pre-mix if it has one
+    void prepareMixForListeningNode(Node* node, int clusterIndex);
+
+    /// mixes the sources that are far from a listener cluster into the cluster's pre-mix
+    void prepareMixForCluster(int clusterIndex);
+
+    AudioMixer* _mixer;
+
+    // the mix is accumulated per channel (0 is left, 1 is right) in int32 and only saturated to int16 once at the end
+    int32_t _channelAccumulators[2][NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL];
+    int16_t _mixSamples[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+
+    QVector<const AudioSourceGrid::Source*> _audibleSources;
+
+    int _sumListeners;
+    int _sumMixes;
+    int _sumSourcesVisited;
+    int _sumPremixedSources;
+    quint64 _sumMixUsecs;
+};
+
+#endif /* defined(__hifi__AudioMixerWorker__) */
@@ -0,0 +1,155 @@
+//
+//  AudioSourceGrid.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+
+#include <PositionalAudioRingBuffer.h>
+#include <SharedUtil.h>
+
+#include "AudioSourceGrid.h"
+
+// each cell coordinate is packed into 21 bits of the cell key
+const int CELL_COORDINATE_BITS = 21;
+const int CELL_COORDINATE_OFFSET = 1 << (CELL_COORDINATE_BITS - 1);
+const int MIN_CELL_COORDINATE = -CELL_COORDINATE_OFFSET;
+const int MAX_CELL_COORDINATE = CELL_COORDINATE_OFFSET - 1;
+
+AudioSourceGrid::AudioSourceGrid(float cellSize) :
+    _cellSize(cellSize),
+    _maxLoudness(0.0f),
+    _sources(),
+    _cells()
+{
+
+}
+
+void AudioSourceGrid::clear() {
+    _sources.clear();
+    _cells.clear();
+    _maxLoudness = 0.0f;
+}
+
+void AudioSourceGrid::addSource(PositionalAudioRingBuffer* buffer, const Node* node) {
+    Source newSource;
+    newSource.buffer = buffer;
+    newSource.node = node;
+    newSource.cellKey = keyForCellCoordinates(cellCoordinatesForPosition(buffer->getPosition()));
+
+    _sources.push_back(newSource);
+
+    _maxLoudness = std::max(_maxLoudness, buffer->getNextOutputTrailingLoudness());
+}
+
+void AudioSourceGrid::finalize() {
+    std::sort(_sources.begin(), _sources.end(), sourceCellKeyLessThan);
+
+    // the sources are now grouped by cell, so each run of matching keys becomes one cell
+    for (int i = 0; i < (int) _sources.size(); i++) {
+        const Source& source = _sources[i];
+
+        if (_cells.empty() || _cells.back().key != source.cellKey) {
+            Cell newCell;
+            newCell.key = source.cellKey;
+            newCell.coordinates = cellCoordinatesForPosition(source.buffer->getPosition());
+            newCell.firstSource = i;
+            newCell.numSources = 0;
+            newCell.maxLoudness = 0.0f;
+
+            _cells.push_back(newCell);
+        }
+
+        Cell& currentCell = _cells.back();
+        ++currentCell.numSources;
+        currentCell.maxLoudness = std::max(currentCell.maxLoudness, source.buffer->getNextOutputTrailingLoudness());
+    }
+}
+
+void AudioSourceGrid::findAudibleSources(const glm::vec3& listenerPosition, float minAudibilityThreshold,
+                                         const Node* listeningNode, QVector<const Source*>& audibleSources) const {
+    if (_cells.empty()) {
+        return;
+    }
+
+    // no source can be heard from further away than the loudest one in the grid
+    float maxAudibleDistance = _maxLoudness / minAudibilityThreshold;
+
+    glm::ivec3 minCell = cellCoordinatesForPosition(listenerPosition - glm::vec3(maxAudibleDistance));
+    glm::ivec3 maxCell = cellCoordinatesForPosition(listenerPosition + glm::vec3(maxAudibleDistance));
+
+    // use a double here so that a very loud source can't overflow the count
+    double numCellsInRange = (double) (maxCell.x - minCell.x + 1) * (maxCell.y - minCell.y + 1)
+        * (maxCell.z - minCell.z + 1);
+
+    if (numCellsInRange >= _cells.size()) {
+        // the listener could hear more cells than are occupied, just walk the occupied ones
+        for (std::vector<Cell>::const_iterator cell = _cells.begin(); cell != _cells.end(); cell++) {
+            appendAudibleSourcesInCell(*cell, listenerPosition, minAudibilityThreshold, listeningNode, audibleSources);
+        }
+    } else {
+        for (int x = minCell.x; x <= maxCell.x; x++) {
+            for (int y = minCell.y; y <= maxCell.y; y++) {
+                for (int z = minCell.z; z <= maxCell.z; z++) {
+                    quint64 key = keyForCellCoordinates(glm::ivec3(x, y, z));
+                    std::vector<Cell>::const_iterator cell = std::lower_bound(_cells.begin(), _cells.end(),
+                                                                              key, cellKeyLessThan);
+                    if (cell != _cells.end() && cell->key == key) {
+                        appendAudibleSourcesInCell(*cell, listenerPosition, minAudibilityThreshold,
+                                                   listeningNode, audibleSources);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void AudioSourceGrid::appendAudibleSourcesInCell(const Cell& cell, const glm::vec3& listenerPosition,
+                                                 float minAudibilityThreshold, const Node* listeningNode,
+                                                 QVector<const Source*>& audibleSources) const {
+    // the closest point of the cell is never further than any source inside of it, so if the loudest source
+    // would not be audible there then nothing in the cell would pass the mixer's own audibility test
+    glm::vec3 cellMinimum = glm::vec3(cell.coordinates) * _cellSize;
+    glm::vec3 closestPoint = glm::clamp(listenerPosition, cellMinimum, cellMinimum + glm::vec3(_cellSize));
+
+    float distanceToCell = std::max(glm::distance(listenerPosition, closestPoint), EPSILON);
+
+    if (cell.maxLoudness / distanceToCell <= minAudibilityThreshold) {
+        return;
+    }
+
+    for (int i = cell.firstSource; i < cell.firstSource + cell.numSources; i++) {
+        const Source& source = _sources[i];
+
+        // a listener only hears its own buffers if they ask to be looped back
+        if (source.node != listeningNode || source.buffer->shouldLoopbackForNode()) {
+            audibleSources.append(&source);
+        }
+    }
+}
+
+glm::ivec3 AudioSourceGrid::cellCoordinatesForPosition(const glm::vec3& position) const {
+    glm::vec3 cellPosition = glm::floor(position / _cellSize);
+    cellPosition = glm::clamp(cellPosition, glm::vec3((float) MIN_CELL_COORDINATE), glm::vec3((float) MAX_CELL_COORDINATE));
+
+    return glm::ivec3(cellPosition);
+}
+
+quint64 AudioSourceGrid::keyForCellCoordinates(const glm::ivec3& coordinates) {
+    const quint64 CELL_COORDINATE_MASK = (1 << CELL_COORDINATE_BITS) - 1;
+
+    return (((quint64) (coordinates.x + CELL_COORDINATE_OFFSET) & CELL_COORDINATE_MASK) << (CELL_COORDINATE_BITS * 2))
+        | (((quint64) (coordinates.y + CELL_COORDINATE_OFFSET) & CELL_COORDINATE_MASK) << CELL_COORDINATE_BITS)
+        | ((quint64) (coordinates.z + CELL_COORDINATE_OFFSET) & CELL_COORDINATE_MASK);
+}
+
+bool AudioSourceGrid::sourceCellKeyLessThan(const Source& firstSource, const Source& secondSource) {
+    return firstSource.cellKey < secondSource.cellKey;
+}
+
+bool AudioSourceGrid::cellKeyLessThan(const Cell& cell, quint64 key) {
+    return cell.key < key;
+}
@@ -0,0 +1,79 @@
+//
+//  AudioSourceGrid.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#ifndef __hifi__AudioSourceGrid__
+#define __hifi__AudioSourceGrid__
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <QtCore/QVector>
+
+class Node;
+class PositionalAudioRingBuffer;
+
+const float DEFAULT_AUDIO_SOURCE_GRID_CELL_SIZE = 10.0f;
+
+/// A uniform grid of the audio sources that will be mixed this frame, rebuilt by the AudioMixer every frame. Each cell
+/// remembers the loudest source in it, so a listener can skip whole cells that could not be audible from where it is.
+/// Once finalized the grid is only read, so any number of AudioMixerWorkers can query it at the same time.
+class AudioSourceGrid {
+public:
+    struct Source {
+        PositionalAudioRingBuffer* buffer;
+        const Node* node;
+        quint64 cellKey;
+    };
+
+    AudioSourceGrid(float cellSize = DEFAULT_AUDIO_SOURCE_GRID_CELL_SIZE);
+
+    float getCellSize() const { return _cellSize; }
+    void setCellSize(float cellSize) { _cellSize = cellSize; }
+
+    /// removes all sources and cells, keeps the allocated capacity for the next frame
+    void clear();
+
+    /// adds a buffer that will be mixed this frame, call finalize() once all sources are added
+    void addSource(PositionalAudioRingBuffer* buffer, const Node* node);
+
+    /// sorts the sources into their cells, must be called before findAudibleSources
+    void finalize();
+
+    int getNumSources() const { return _sources.size(); }
+    int getNumCells() const { return _cells.size(); }
+
+    /// appends every source in a cell that might pass the audibility test for this listener
+    void findAudibleSources(const glm::vec3& listenerPosition, float minAudibilityThreshold, const Node* listeningNode,
+                            QVector<const Source*>& audibleSources) const;
+
+private:
+    struct Cell {
+        quint64 key;
+        glm::ivec3 coordinates;
+        int firstSource;
+        int numSources;
+        float maxLoudness;
+    };
+
+    glm::ivec3 cellCoordinatesForPosition(const glm::vec3& position) const;
+    static quint64 keyForCellCoordinates(const glm::ivec3& coordinates);
+
+    static bool sourceCellKeyLessThan(const Source& firstSource, const Source& secondSource);
+    static bool cellKeyLessThan(const Cell& cell, quint64 key);
+
+    void appendAudibleSourcesInCell(const Cell& cell, const glm::vec3& listenerPosition, float minAudibilityThreshold,
+                                    const Node* listeningNode, QVector<const Source*>& audibleSources) const;
+
+    float _cellSize;
+    float _maxLoudness;
+    std::vector<Source> _sources;
+    std::vector<Cell> _cells;
+};
+
+#endif /* defined(__hifi__AudioSourceGrid__) */
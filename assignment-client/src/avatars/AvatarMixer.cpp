@@ -10,19 +10,24 @@
 //  The avatar mixer receives head, hand and positional data from all connected
 //  nodes, and broadcasts that data back to them, every BROADCAST_INTERVAL ms.
 
+#include <algorithm>
+
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDateTime>
 #include <QtCore/QJsonObject>
+#include <QtCore/QStringList>
 #include <QtCore/QTimer>
 #include <QtCore/QThread>
 
 #include <Logging.h>
 #include <NodeList.h>
+#include <OctreeConstants.h>
 #include <PacketHeaders.h>
 #include <SharedUtil.h>
 #include <UUID.h>
 
 #include "AvatarMixerClientData.h"
+#include "AvatarMixerWorker.h"
 
 #include "AvatarMixer.h"
 
@@ -30,16 +35,30 @@ const QString AVATAR_MIXER_LOGGING_NAME = "avatar-mixer";
 
 const unsigned int AVATAR_DATA_SEND_INTERVAL_MSECS = (1.0f / 60.0f) * 1000;
 
+const int DEFAULT_LISTENER_BYTES_PER_SECOND = 125000;
+
 AvatarMixer::AvatarMixer(const QByteArray& packet) :
     ThreadedAssignment(packet),
     _broadcastThread(),
     _lastFrameTimestamp(QDateTime::currentMSecsSinceEpoch()),
+    _listenerBytesPerSecond(DEFAULT_LISTENER_BYTES_PER_SECOND),
+    _listenerBudgetBytes(0),
+    _lastStatsTimestamp(usecTimestampNow()),
     _trailingSleepRatio(1.0f),
     _performanceThrottlingRatio(0.0f),
     _sumListeners(0),
     _numStatFrames(0),
     _sumBillboardPackets(0),
-    _sumIdentityPackets(0)
+    _sumIdentityPackets(0),
+    _sumAvatarsSent(0),
+    _sumDeltaAvatarsSent(0),
+    _sumAvatarsUpToDate(0),
+    _sumAvatarStateBytes(0),
+    _sumAvatarPacks(0),
+    _sumAvatarPackUsecs(0),
+    _sumAllocations(0),
+    _frameAvatarPacks(0),
+    _frameAvatarPackUsecs(0)
 {
     // make sure we hear about node kills so we can tell the other nodes
     connect(NodeList::getInstance(), &NodeList::nodeKilled, this, &AvatarMixer::nodeKilled);
@@ -48,6 +67,10 @@ AvatarMixer::AvatarMixer(const QByteArray& packet) :
 AvatarMixer::~AvatarMixer() {
     _broadcastThread.quit();
     _broadcastThread.wait();
+    
+    foreach (AvatarMixerWorker* worker, _workers) {
+        delete worker;
+    }
 }
 
 void attachAvatarDataToNode(Node* newNode) {
@@ -56,16 +79,94 @@ void attachAvatarDataToNode(Node* newNode) {
     }
 }
 
-const float BILLBOARD_AND_IDENTITY_SEND_PROBABILITY = 1.0f / 300.0f;
+void AvatarMixer::parsePayload() {
+    QStringList payloadList = QString(getPayload()).split(" ", QString::SkipEmptyParts);
+    
+    int numBroadcastThreads = 1;
+    
+    const QString BROADCAST_THREADS_OPTION = "--broadcastThreads";
+    int broadcastThreadsIndex = payloadList.indexOf(BROADCAST_THREADS_OPTION);
+    if (broadcastThreadsIndex != -1 && broadcastThreadsIndex + 1 < payloadList.size()) {
+        numBroadcastThreads = std::max(1, payloadList[broadcastThreadsIndex + 1].toInt());
+    }
+    
+    qDebug() << "Avatar mixer will assemble packets with" << numBroadcastThreads << "thread(s)";
+    
+    // the first worker always runs on the broadcast thread, the rest are handed to the pool each frame
+    for (int i = 0; i < numBroadcastThreads; i++) {
+        _workers.append(new AvatarMixerWorker(this));
+    }
+    _sumWorkerAssemblyUsecs.fill(0, numBroadcastThreads);
+    _workerThreadPool.setMaxThreadCount(std::max(1, numBroadcastThreads - 1));
+    
+    const QString LISTENER_BYTES_PER_SECOND_OPTION = "--listenerBytesPerSecond";
+    int listenerBytesPerSecondIndex = payloadList.indexOf(LISTENER_BYTES_PER_SECOND_OPTION);
+    if (listenerBytesPerSecondIndex != -1 && listenerBytesPerSecondIndex + 1 < payloadList.size()) {
+        _listenerBytesPerSecond = std::max(MAX_PACKET_SIZE, payloadList[listenerBytesPerSecondIndex + 1].toInt());
+    }
+    
+    qDebug() << "Avatar mixer will send each listener up to" << _listenerBytesPerSecond << "bytes per second";
+}
+
+int AvatarMixer::claimNextListenerIndex() {
+    int listenerIndex = _nextListenerIndex.fetchAndAddOrdered(1);
+    return listenerIndex < _frameListenerIndices.size() ? listenerIndex : -1;
+}
+
+void AvatarMixer::snapshotFrameAvatars(const NodeHash& nodeHash) {
+    _frameAvatars.resize(0);
+    _frameListenerIndices.resize(0);
+    _frameAvatarPacks = 0;
+    _frameAvatarPackUsecs = 0;
+    
+    foreach (const SharedNodePointer& node, nodeHash) {
+        if (!node->getLinkedData()) {
+            continue;
+        }
+        
+        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData());
+        
+        // this waits for at most one packet to be parsed, and is the only time this frame that we lock the avatar
+        QMutexLocker nodeDataLocker(&nodeData->getMutex());
+        
+        quint64 packStartTime = usecTimestampNow();
+        if (nodeData->packAvatarStateIfChanged()) {
+            _frameAvatarPackUsecs += usecTimestampNow() - packStartTime;
+            ++_frameAvatarPacks;
+        }
+        
+        // the workers read packed states straight from the history, which only this thread writes to and only here
+        AvatarSnapshot snapshot;
+        snapshot.node = node;
+        snapshot.nodeData = nodeData;
+        snapshot.uuidBytes = node->getUUID().toRfc4122();
+        snapshot.position = nodeData->getAvatar().getPosition();
+        snapshot.viewDirection = nodeData->getAvatar().getHeadOrientation() * IDENTITY_FRONT;
+        snapshot.avatarSequence = nodeData->getAvatarSequence();
+        snapshot.billboardChangeTimestamp = nodeData->getBillboardChangeTimestamp();
+        snapshot.identityChangeTimestamp = nodeData->getIdentityChangeTimestamp();
+        
+        if (snapshot.billboardChangeTimestamp > 0) {
+            snapshot.billboardPacket = nodeData->getBillboardPacket(node->getUUID());
+        }
+        
+        if (snapshot.identityChangeTimestamp > 0) {
+            snapshot.identityPacket = nodeData->getIdentityPacket(node->getUUID());
+        }
+        
+        if (node->getType() == NodeType::Agent && node->getActiveSocket()) {
+            _frameListenerIndices.append(_frameAvatars.size());
+        }
+        
+        _frameAvatars.append(snapshot);
+    }
+}
 
-// NOTE: some additional optimizations to consider.
-//    1) use the view frustum to cull those avatars that are out of view. Since avatar data doesn't need to be present
-//       if the avatar is not in view or in the keyhole.
 void AvatarMixer::broadcastAvatarData() {
     
-    int idleTime = QDateTime::currentMSecsSinceEpoch() - _lastFrameTimestamp;
+    quint64 frameStartTime = usecTimestampNow();
     
-    ++_numStatFrames;
+    int idleTime = QDateTime::currentMSecsSinceEpoch() - _lastFrameTimestamp;
     
     const float STRUGGLE_TRIGGER_SLEEP_PERCENTAGE_THRESHOLD = 0.10f;
     const float BACK_OFF_TRIGGER_SLEEP_PERCENTAGE_THRESHOLD = 0.20f;
@@ -114,105 +215,75 @@ void AvatarMixer::broadcastAvatarData() {
         ++framesSinceCutoffEvent;
     }
     
-    static QByteArray mixedAvatarByteArray;
-    
-    int numPacketHeaderBytes = populatePacketHeader(mixedAvatarByteArray, PacketTypeBulkAvatarData);
+    // when we are struggling every listener gets a smaller share of the frame, but always at least a packet's worth
+    _listenerBudgetBytes = std::max(MAX_PACKET_SIZE, (int) (_listenerBytesPerSecond * (1.0f - _performanceThrottlingRatio)
+                                                             * AVATAR_DATA_SEND_INTERVAL_MSECS / MSECS_PER_SECOND));
     
     NodeList* nodeList = NodeList::getInstance();
     
-    AvatarMixerClientData* nodeData = NULL;
-    AvatarMixerClientData* otherNodeData = NULL;
+    snapshotFrameAvatars(nodeList->getNodeHash());
     
-    foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
-        if (node->getLinkedData() && node->getType() == NodeType::Agent && node->getActiveSocket()
-            && (nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData()))->getMutex().tryLock()) {
-            ++_sumListeners;
-            
-            // reset packet pointers for this node
-            mixedAvatarByteArray.resize(numPacketHeaderBytes);
-            
-            AvatarData& avatar = nodeData->getAvatar();
-            glm::vec3 myPosition = avatar.getPosition();
-            
-            // this is an AGENT we have received head data from
-            // send back a packet with other active node data to this node
-            foreach (const SharedNodePointer& otherNode, nodeList->getNodeHash()) {
-                if (otherNode->getLinkedData() && otherNode->getUUID() != node->getUUID()
-                    && (otherNodeData = reinterpret_cast<AvatarMixerClientData*>(otherNode->getLinkedData()))->getMutex().tryLock()) {
-                    
-                    AvatarMixerClientData* otherNodeData = reinterpret_cast<AvatarMixerClientData*>(otherNode->getLinkedData());
-                    AvatarData& otherAvatar = otherNodeData->getAvatar();
-                    glm::vec3 otherPosition = otherAvatar.getPosition();
-            
-                    float distanceToAvatar = glm::length(myPosition - otherPosition);
-                    //  The full rate distance is the distance at which EVERY update will be sent for this avatar
-                    //  at a distance of twice the full rate distance, there will be a 50% chance of sending this avatar's update
-                    const float FULL_RATE_DISTANCE = 2.f;
-                    
-                    //  Decide whether to send this avatar's data based on it's distance from us
-                    if ((_performanceThrottlingRatio == 0 || randFloat() < (1.0f - _performanceThrottlingRatio))
-                        && (distanceToAvatar == 0.f || randFloat() < FULL_RATE_DISTANCE / distanceToAvatar)) {
-                        QByteArray avatarByteArray;
-                        avatarByteArray.append(otherNode->getUUID().toRfc4122());
-                        avatarByteArray.append(otherAvatar.toByteArray());
-                        
-                        if (avatarByteArray.size() + mixedAvatarByteArray.size() > MAX_PACKET_SIZE) {
-                            nodeList->writeDatagram(mixedAvatarByteArray, node);
-                            
-                            // reset the packet
-                            mixedAvatarByteArray.resize(numPacketHeaderBytes);
-                        }
-                        
-                        // copy the avatar into the mixedAvatarByteArray packet
-                        mixedAvatarByteArray.append(avatarByteArray);
-                        
-                        // if the receiving avatar has just connected make sure we send out the mesh and billboard
-                        // for this avatar (assuming they exist)
-                        bool forceSend = !nodeData->checkAndSetHasReceivedFirstPackets();
-                        
-                        // we will also force a send of billboard or identity packet
-                        // if either has changed in the last frame
-                        
-                        if (otherNodeData->getBillboardChangeTimestamp() > 0
-                            && (forceSend
-                                || otherNodeData->getBillboardChangeTimestamp() > _lastFrameTimestamp
-                                || randFloat() < BILLBOARD_AND_IDENTITY_SEND_PROBABILITY)) {
-                            QByteArray billboardPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarBillboard);
-                            billboardPacket.append(otherNode->getUUID().toRfc4122());
-                            billboardPacket.append(otherNodeData->getAvatar().getBillboard());
-                            nodeList->writeDatagram(billboardPacket, node);
-                            
-                            ++_sumBillboardPackets;
-                        }
-                        
-                        if (otherNodeData->getIdentityChangeTimestamp() > 0
-                            && (forceSend
-                                || otherNodeData->getIdentityChangeTimestamp() > _lastFrameTimestamp
-                                || randFloat() < BILLBOARD_AND_IDENTITY_SEND_PROBABILITY)) {
-                                
-                            QByteArray identityPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarIdentity);
-                            
-                            QByteArray individualData = otherNodeData->getAvatar().identityByteArray();
-                            individualData.replace(0, NUM_BYTES_RFC4122_UUID, otherNode->getUUID().toRfc4122());
-                            identityPacket.append(individualData);
-                            
-                            nodeList->writeDatagram(identityPacket, node);
-                                
-                            ++_sumIdentityPackets;
-                        }
-                    }
-                
-                    otherNodeData->getMutex().unlock();
-                }
-            }
-            
-            nodeList->writeDatagram(mixedAvatarByteArray, node);
-            
-            nodeData->getMutex().unlock();
+    if (_listenerPackets.size() < _frameListenerIndices.size()) {
+        _listenerPackets.resize(_frameListenerIndices.size());
+    }
+    
+    _nextListenerIndex.fetchAndStoreOrdered(0);
+    
+    for (int i = 1; i < _workers.size(); i++) {
+        _workerThreadPool.start(_workers[i]);
+    }
+    
+    // the broadcast thread does its share of the work instead of sitting idle
+    _workers[0]->run();
+    
+    // wait for all of the workers to report that the frame is assembled
+    _finishedWorkers.acquire(_workers.size());
+    
+    // the sends all go out from this thread, in the order the workers queued them for each listener. Nothing else holds
+    // the buffers, so the hashes are written where they are and the batch shares them rather than copying.
+    DatagramSendBatch sendBatch(nodeList->getNodeSocket());
+    for (int i = 0; i < _frameListenerIndices.size(); i++) {
+        const SharedNodePointer& listenerNode = getFrameListener(i).node;
+        
+        QVector<PacketBuffer>& packets = _listenerPackets[i];
+        for (int j = 0; j < packets.size(); j++) {
+            nodeList->writeDatagram(packets[j], listenerNode);
         }
+        
+        packets.resize(0);
     }
+    sendBatch.flush();
+    
+    // let go of the snapshot so that nodes killed during the frame can be deleted
+    _frameAvatars.resize(0);
     
     _lastFrameTimestamp = QDateTime::currentMSecsSinceEpoch();
+    
+    // the workers are idle until the next frame, so this is where their stats are taken and reset - sendStatsPacket
+    // runs on the main thread and only ever reads what is folded in here
+    QMutexLocker statsLocker(&_statsMutex);
+    
+    for (int i = 0; i < _workers.size(); i++) {
+        AvatarMixerWorker* worker = _workers[i];
+        
+        _sumListeners += worker->getSumListeners();
+        _sumAvatarsSent += worker->getSumAvatarsSent();
+        _sumDeltaAvatarsSent += worker->getSumDeltaAvatarsSent();
+        _sumAvatarsUpToDate += worker->getSumAvatarsUpToDate();
+        _sumAvatarStateBytes += worker->getSumAvatarStateBytes();
+        _sumBillboardPackets += worker->getSumBillboardPackets();
+        _sumIdentityPackets += worker->getSumIdentityPackets();
+        _sumAllocations += worker->getSumAllocations();
+        _sumWorkerAssemblyUsecs[i] += worker->getSumAssemblyUsecs();
+        
+        worker->resetStats();
+    }
+    
+    _sumAvatarPacks += _frameAvatarPacks;
+    _sumAvatarPackUsecs += _frameAvatarPackUsecs;
+    
+    ++_numStatFrames;
+    _frameUsecs.append(usecTimestampNow() - frameStartTime);
 }
 
 void AvatarMixer::nodeKilled(SharedNodePointer killedNode) {
@@ -225,16 +296,28 @@ void AvatarMixer::nodeKilled(SharedNodePointer killedNode) {
         
         NodeList::getInstance()->broadcastToNodes(killPacket,
                                                   NodeSet() << NodeType::Agent);
+        
+        // nobody will be sent this avatar again, and a reconnect comes back with a fresh sequence
+        foreach (const SharedNodePointer& node, NodeList::getInstance()->getNodeHash()) {
+            if (node->getLinkedData()) {
+                AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData());
+                
+                QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                nodeData->forgetAvatar(killedNode->getUUID());
+            }
+        }
     }
 }
 
 void AvatarMixer::readPendingDatagrams() {
+    PacketBuffer receivedDatagram;
     QByteArray receivedPacket;
     HifiSockAddr senderSockAddr;
     
     NodeList* nodeList = NodeList::getInstance();
     
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
+    while (readAvailableDatagram(receivedDatagram, senderSockAddr)) {
+        receivedDatagram.asByteArray(receivedPacket);
         if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
             switch (packetTypeForPacket(receivedPacket)) {
                 case PacketTypeAvatarData: {
@@ -251,8 +334,8 @@ void AvatarMixer::readPendingDatagrams() {
                         AvatarData& avatar = nodeData->getAvatar();
                         
                         // parse the identity packet and update the change timestamp if appropriate
+                        QMutexLocker nodeDataLocker(&nodeData->getMutex());
                         if (avatar.hasIdentityChangedAfterParsing(receivedPacket)) {
-                            QMutexLocker nodeDataLocker(&nodeData->getMutex());
                             nodeData->setIdentityChangeTimestamp(QDateTime::currentMSecsSinceEpoch());
                         }
                     }
@@ -268,14 +351,25 @@ void AvatarMixer::readPendingDatagrams() {
                         AvatarData& avatar = nodeData->getAvatar();
                         
                         // parse the billboard packet and update the change timestamp if appropriate
+                        QMutexLocker nodeDataLocker(&nodeData->getMutex());
                         if (avatar.hasBillboardChangedAfterParsing(receivedPacket)) {
-                            QMutexLocker nodeDataLocker(&nodeData->getMutex());
                             nodeData->setBillboardChangeTimestamp(QDateTime::currentMSecsSinceEpoch());
                         }
                         
                     }
                     break;
                 }
+                case PacketTypeBulkAvatarDataAck: {
+                    SharedNodePointer listenerNode = nodeList->sendingNodeForPacket(receivedPacket);
+                    
+                    if (listenerNode && listenerNode->getLinkedData()) {
+                        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(listenerNode->getLinkedData());
+                        
+                        QMutexLocker nodeDataLocker(&nodeData->getMutex());
+                        nodeData->processBulkAvatarDataAck(receivedPacket);
+                    }
+                    break;
+                }
                 case PacketTypeKillAvatar: {
                     nodeList->processKillNode(receivedPacket);
                     break;
@@ -291,25 +385,128 @@ void AvatarMixer::readPendingDatagrams() {
 
 void AvatarMixer::sendStatsPacket() {
     QJsonObject statsObject;
+    
+    quint64 now = usecTimestampNow();
+    float statsSeconds = (now - _lastStatsTimestamp) / (float) USECS_PER_SECOND;
+    _lastStatsTimestamp = now;
+    
+    qint64 sumBudgetBytes = 0;
+    qint64 sumBytesSent = 0;
+    qint64 sumAvatarUpdates = 0;
+    
+    // how much of its budget each listener used, so that a listener starved by its budget stands out, but summed up
+    // in a fixed number of values, since the stats packet has to fit in one datagram however many listeners there are
+    QVector<QPair<float, QUuid> > listenerBudgetUsages;
+    
+    foreach (const SharedNodePointer& node, NodeList::getInstance()->getNodeHash()) {
+        if (node->getType() != NodeType::Agent || !node->getLinkedData()) {
+            continue;
+        }
+        
+        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData());
+        QMutexLocker nodeDataLocker(&nodeData->getMutex());
+        
+        if (nodeData->getSumBudgetBytes() > 0) {
+            float budgetUsage = 100.0f * nodeData->getSumBytesSent() / (float) nodeData->getSumBudgetBytes();
+            listenerBudgetUsages.append(qMakePair(budgetUsage, node->getUUID()));
+            
+            sumBudgetBytes += nodeData->getSumBudgetBytes();
+            sumBytesSent += nodeData->getSumBytesSent();
+            sumAvatarUpdates += nodeData->getSumAvatarUpdates();
+        }
+        
+        nodeData->resetBroadcastStats();
+    }
+    
+    statsObject["listener_budget_usage_percentage"] = (sumBudgetBytes > 0)
+        ? 100.0f * sumBytesSent / (float) sumBudgetBytes : 0.0f;
+    statsObject["listener_budget_bytes_per_frame"] = _listenerBudgetBytes;
+    
+    if (!listenerBudgetUsages.isEmpty() && statsSeconds > 0.0f) {
+        std::sort(listenerBudgetUsages.begin(), listenerBudgetUsages.end());
+        
+        statsObject["average_listener_bytes_per_second"] =
+            (float) sumBytesSent / listenerBudgetUsages.size() / statsSeconds;
+        statsObject["average_listener_avatar_updates_per_second"] =
+            (float) sumAvatarUpdates / listenerBudgetUsages.size() / statsSeconds;
+        
+        statsObject["listener_budget_usage_min"] = listenerBudgetUsages.first().first;
+        statsObject["listener_budget_usage_50th_percentile"] =
+            listenerBudgetUsages[listenerBudgetUsages.size() / 2].first;
+        statsObject["listener_budget_usage_95th_percentile"] =
+            listenerBudgetUsages[(listenerBudgetUsages.size() * 95) / 100].first;
+        statsObject["listener_budget_usage_max"] = listenerBudgetUsages.last().first;
+        
+        // name the listeners that came closest to their budgets
+        const int MAX_LISTED_LISTENERS = 3;
+        for (int i = 0; i < MAX_LISTED_LISTENERS && i < listenerBudgetUsages.size(); i++) {
+            const QPair<float, QUuid>& usage = listenerBudgetUsages.at(listenerBudgetUsages.size() - 1 - i);
+            statsObject[QString("listener_budget_usage_top_%1").arg(i + 1)] =
+                uuidStringWithoutCurlyBraces(usage.second) + QString(" %1%").arg(usage.first, 0, 'f', 1);
+        }
+    }
+    
+    // take everything the broadcast thread has folded in since the last stats packet, and start it counting again
+    QMutexLocker statsLocker(&_statsMutex);
+    
+    for (int i = 0; i < _sumWorkerAssemblyUsecs.size(); i++) {
+        statsObject[QString("broadcast_worker_%1_usecs_per_frame").arg(i)] =
+            (float) _sumWorkerAssemblyUsecs[i] / (float) _numStatFrames;
+    }
+    
+    QVector<quint64> frameUsecs;
+    frameUsecs.swap(_frameUsecs);
+    
+    if (!frameUsecs.isEmpty()) {
+        std::sort(frameUsecs.begin(), frameUsecs.end());
+        
+        statsObject["frame_usecs_50th_percentile"] = (double) frameUsecs[frameUsecs.size() / 2];
+        statsObject["frame_usecs_95th_percentile"] = (double) frameUsecs[(frameUsecs.size() * 95) / 100];
+        statsObject["frame_usecs_99th_percentile"] = (double) frameUsecs[(frameUsecs.size() * 99) / 100];
+        statsObject["frame_usecs_max"] = (double) frameUsecs.last();
+    }
+    
     statsObject["average_listeners_last_second"] = (float) _sumListeners / (float) _numStatFrames;
     
     statsObject["average_billboard_packets_per_frame"] = (float) _sumBillboardPackets / (float) _numStatFrames;
     statsObject["average_identity_packets_per_frame"] = (float) _sumIdentityPackets / (float) _numStatFrames;
     
-    statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100;
-    statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
-    
-    ThreadedAssignment::addPacketStatsAndSendStatsPacket(statsObject);
+    statsObject["average_avatars_sent_per_frame"] = (float) _sumAvatarsSent / (float) _numStatFrames;
+    statsObject["average_avatars_up_to_date_per_frame"] = (float) _sumAvatarsUpToDate / (float) _numStatFrames;
+    statsObject["delta_avatar_percentage"] = (_sumAvatarsSent > 0)
+        ? 100.0f * _sumDeltaAvatarsSent / (float) _sumAvatarsSent : 0.0f;
+    statsObject["average_bytes_per_avatar_sent"] = (_sumAvatarsSent > 0)
+        ? (float) _sumAvatarStateBytes / (float) _sumAvatarsSent : 0.0f;
+    statsObject["average_avatar_packs_per_frame"] = (float) _sumAvatarPacks / (float) _numStatFrames;
+    statsObject["average_avatar_pack_usecs_per_frame"] = (float) _sumAvatarPackUsecs / (float) _numStatFrames;
+    statsObject["average_allocations_per_frame"] = (float) _sumAllocations / (float) _numStatFrames;
     
     _sumListeners = 0;
     _sumBillboardPackets = 0;
     _sumIdentityPackets = 0;
+    _sumAvatarsSent = 0;
+    _sumDeltaAvatarsSent = 0;
+    _sumAvatarsUpToDate = 0;
+    _sumAvatarStateBytes = 0;
+    _sumAvatarPacks = 0;
+    _sumAvatarPackUsecs = 0;
+    _sumAllocations = 0;
+    _sumWorkerAssemblyUsecs.fill(0);
     _numStatFrames = 0;
+    
+    statsLocker.unlock();
+    
+    statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100;
+    statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
+    
+    ThreadedAssignment::addPacketStatsAndSendStatsPacket(statsObject);
 }
 
 void AvatarMixer::run() {
     ThreadedAssignment::commonInit(AVATAR_MIXER_LOGGING_NAME, NodeType::AvatarMixer);
     
+    parsePayload();
+    
     NodeList* nodeList = NodeList::getInstance();
     nodeList->addNodeTypeToInterestSet(NodeType::Agent);
     
@@ -9,38 +9,118 @@
 #ifndef __hifi__AvatarMixer__
 #define __hifi__AvatarMixer__
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+#include <glm/glm.hpp>
+
+#include <NodeList.h>
 #include <ThreadedAssignment.h>
 
+class AvatarMixerClientData;
+class AvatarMixerWorker;
+
+/// Everything the workers need to know about one avatar, copied once at the start of a broadcast frame so that they
+/// never have to lock the AvatarMixerClientData of an avatar they send, only that of the listener they send it to.
+struct AvatarSnapshot {
+    SharedNodePointer node;
+    AvatarMixerClientData* nodeData;
+    QByteArray uuidBytes;
+    glm::vec3 position;
+    glm::vec3 viewDirection;
+    quint16 avatarSequence;
+    quint64 billboardChangeTimestamp;
+    QByteArray billboardPacket;
+    quint64 identityChangeTimestamp;
+    QByteArray identityPacket;
+};
+
 /// Handles assignments of type AvatarMixer - distribution of avatar data to various clients
 class AvatarMixer : public ThreadedAssignment {
 public:
     AvatarMixer(const QByteArray& packet);
     ~AvatarMixer();
+
+    float getPerformanceThrottlingRatio() const { return _performanceThrottlingRatio; }
+    
+    /// the bytes each listener may be sent this frame, after throttling
+    int getListenerBudgetBytes() const { return _listenerBudgetBytes; }
+
+    const QVector<AvatarSnapshot>& getFrameAvatars() const { return _frameAvatars; }
+
+    /// claims the next listener of the current frame for a worker, returns -1 once all listeners are claimed
+    int claimNextListenerIndex();
+    const AvatarSnapshot& getFrameListener(int listenerIndex) const
+        { return _frameAvatars[_frameListenerIndices[listenerIndex]]; }
+
+    /// the packets a worker assembled for a listener, sent from the broadcast thread once the frame is assembled
+    QVector<PacketBuffer>& getPacketsForListener(int listenerIndex) { return _listenerPackets[listenerIndex]; }
+
+    /// called by each worker when it runs out of listeners to assemble packets for
+    void workerFinished() { _finishedWorkers.release(); }
 public slots:
     /// runs the avatar mixer
     void run();
 
     void nodeAdded(SharedNodePointer nodeAdded);
     void nodeKilled(SharedNodePointer killedNode);
-    
+
     void readPendingDatagrams();
-    
+
     void sendStatsPacket();
-    
+
 private:
+    /// reads mixer options (like --broadcastThreads) from the assignment payload
+    void parsePayload();
+
     void broadcastAvatarData();
-    
+
+    /// copies the state of every avatar into _frameAvatars, packing any avatar that was updated since the last frame
+    void snapshotFrameAvatars(const NodeHash& nodeHash);
+
     QThread _broadcastThread;
-    
+
+    QVector<AvatarMixerWorker*> _workers;
+    QThreadPool _workerThreadPool;
+    QSemaphore _finishedWorkers;
+
+    QVector<AvatarSnapshot> _frameAvatars;
+    QVector<int> _frameListenerIndices;
+    QVector<QVector<PacketBuffer> > _listenerPackets;
+    QAtomicInt _nextListenerIndex;
+
     quint64 _lastFrameTimestamp;
     
+    int _listenerBytesPerSecond;
+    int _listenerBudgetBytes;
+    quint64 _lastStatsTimestamp;
+
     float _trailingSleepRatio;
     float _performanceThrottlingRatio;
-    
+
     int _sumListeners;
     int _numStatFrames;
     int _sumBillboardPackets;
     int _sumIdentityPackets;
+    int _sumAvatarsSent;
+    int _sumDeltaAvatarsSent;
+    int _sumAvatarsUpToDate;
+    qint64 _sumAvatarStateBytes;
+    int _sumAvatarPacks;
+    quint64 _sumAvatarPackUsecs;
+    int _sumAllocations;
+    QVector<quint64> _sumWorkerAssemblyUsecs;
+    QVector<quint64> _frameUsecs;
+
+    /// guards the stat sums above, which the broadcast thread adds to after each frame and sendStatsPacket takes
+    QMutex _statsMutex;
+
+    /// only touched by the broadcast thread, folded into the sums at the end of the frame
+    int _frameAvatarPacks;
+    quint64 _frameAvatarPackUsecs;
 };
 
 #endif /* defined(__hifi__AvatarMixer__) */
@@ -6,23 +6,198 @@
 //  Copyright (c) 2014 HighFidelity, Inc. All rights reserved.
 //
 
+#include <cstring>
+
+#include <PacketHeaders.h>
+#include <UUID.h>
+
 #include "AvatarMixerClientData.h"
 
 AvatarMixerClientData::AvatarMixerClientData() :
     NodeData(),
+    _packedAvatarState(),
+    _avatarStates(),
+    _avatarSequence(0),
+    _hasAvatarChanged(true),
     _hasReceivedFirstPackets(false),
     _billboardChangeTimestamp(0),
-    _identityChangeTimestamp(0)
+    _identityChangeTimestamp(0),
+    _billboardPacket(),
+    _billboardPacketTimestamp(0),
+    _identityPacket(),
+    _identityPacketTimestamp(0),
+    _nextBulkAvatarPacketSequence(0),
+    _sentBulkAvatarPackets(),
+    _acknowledgedAvatarSequences(),
+    _avatarPriorities(),
+    _sumBudgetBytes(0),
+    _sumBytesSent(0),
+    _sumAvatarUpdates(0)
 {
-    
+    // packing never has to allocate once this is reserved
+    _packedAvatarState.reserve(MAX_PACKET_SIZE);
 }
 
 int AvatarMixerClientData::parseData(const QByteArray& packet) {
     // compute the offset to the data payload
     int offset = numBytesForPacketHeader(packet);
+    
+    // the packed copy of the avatar is now out of date
+    _hasAvatarChanged = true;
+    
     return _avatar.parseDataAtOffset(packet, offset);
 }
 
+bool AvatarMixerClientData::packAvatarStateIfChanged() {
+    if (!_hasAvatarChanged) {
+        return false;
+    }
+    
+    _packedAvatarState.resize(MAX_PACKET_SIZE);
+    _packedAvatarState.resize(_avatar.packAvatarData(reinterpret_cast<unsigned char*>(_packedAvatarState.data())));
+    _hasAvatarChanged = false;
+    
+    // the sequence number only moves on when the state does, listeners that have the current state need nothing more
+    const QByteArray* currentState = _avatarStates.getState(_avatarSequence);
+    if (currentState && *currentState == _packedAvatarState) {
+        return true;
+    }
+    
+    // each buffer in the history allocates the first time it is used, after that states are copied in place
+    QByteArray* stateBuffer = _avatarStates.getBufferForState(++_avatarSequence);
+    stateBuffer->reserve(MAX_PACKET_SIZE);
+    stateBuffer->resize(_packedAvatarState.size());
+    memcpy(stateBuffer->data(), _packedAvatarState.constData(), _packedAvatarState.size());
+    
+    return true;
+}
+
+quint16 AvatarMixerClientData::startSentBulkAvatarPacket() {
+    if (_sentBulkAvatarPackets.isEmpty()) {
+        _sentBulkAvatarPackets.resize(SENT_BULK_AVATAR_PACKET_HISTORY_SIZE);
+    }
+    
+    quint16 packetSequence = _nextBulkAvatarPacketSequence++;
+    
+    SentBulkAvatarPacket& sentPacket = _sentBulkAvatarPackets[packetSequence % SENT_BULK_AVATAR_PACKET_HISTORY_SIZE];
+    sentPacket.sequence = packetSequence;
+    sentPacket.isAcknowledged = false;
+    sentPacket.avatarSequences.resize(0);
+    
+    return packetSequence;
+}
+
+void AvatarMixerClientData::addAvatarToSentBulkAvatarPacket(const QUuid& avatarUUID, quint16 avatarSequence) {
+    quint16 packetSequence = _nextBulkAvatarPacketSequence - 1;
+    _sentBulkAvatarPackets[packetSequence % SENT_BULK_AVATAR_PACKET_HISTORY_SIZE].avatarSequences.append(
+        QPair<QUuid, quint16>(avatarUUID, avatarSequence));
+}
+
+void AvatarMixerClientData::processBulkAvatarDataAck(const QByteArray& packet) {
+    int offset = numBytesForPacketHeader(packet);
+    
+    quint16 latestPacketSequence;
+    quint32 previousPacketBits;
+    if (packet.size() < offset + (int) (sizeof(latestPacketSequence) + sizeof(previousPacketBits))) {
+        return;
+    }
+    
+    memcpy(&latestPacketSequence, packet.constData() + offset, sizeof(latestPacketSequence));
+    offset += sizeof(latestPacketSequence);
+    memcpy(&previousPacketBits, packet.constData() + offset, sizeof(previousPacketBits));
+    
+    // every ack repeats the packets before the latest one as bits, so that a lost ack costs us nothing
+    acknowledgeSentBulkAvatarPacket(latestPacketSequence);
+    for (int i = 0; i < (int) sizeof(previousPacketBits) * BITS_IN_BYTE; i++) {
+        if (previousPacketBits & (1u << i)) {
+            acknowledgeSentBulkAvatarPacket(latestPacketSequence - 1 - i);
+        }
+    }
+}
+
+void AvatarMixerClientData::acknowledgeSentBulkAvatarPacket(quint16 packetSequence) {
+    if (_sentBulkAvatarPackets.isEmpty()) {
+        return;
+    }
+    
+    SentBulkAvatarPacket& sentPacket = _sentBulkAvatarPackets[packetSequence % SENT_BULK_AVATAR_PACKET_HISTORY_SIZE];
+    if (sentPacket.isAcknowledged || sentPacket.sequence != packetSequence) {
+        return;
+    }
+    sentPacket.isAcknowledged = true;
+    
+    for (int i = 0; i < sentPacket.avatarSequences.size(); i++) {
+        const QPair<QUuid, quint16>& avatarSequence = sentPacket.avatarSequences[i];
+        
+        QHash<QUuid, quint16>::iterator acknowledged = _acknowledgedAvatarSequences.find(avatarSequence.first);
+        if (acknowledged == _acknowledgedAvatarSequences.end()) {
+            _acknowledgedAvatarSequences.insert(avatarSequence.first, avatarSequence.second);
+        } else if (isAvatarSequenceNewer(avatarSequence.second, acknowledged.value())) {
+            acknowledged.value() = avatarSequence.second;
+        }
+    }
+}
+
+bool AvatarMixerClientData::getAcknowledgedAvatarSequence(const QUuid& avatarUUID, quint16& sequence) const {
+    QHash<QUuid, quint16>::const_iterator acknowledged = _acknowledgedAvatarSequences.find(avatarUUID);
+    if (acknowledged == _acknowledgedAvatarSequences.constEnd()) {
+        return false;
+    }
+    
+    sequence = acknowledged.value();
+    return true;
+}
+
+const QByteArray& AvatarMixerClientData::getBillboardPacket(const QUuid& nodeUUID) {
+    if (_billboardPacketTimestamp != _billboardChangeTimestamp) {
+        _billboardPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarBillboard);
+        _billboardPacket.append(nodeUUID.toRfc4122());
+        _billboardPacket.append(_avatar.getBillboard());
+        
+        _billboardPacketTimestamp = _billboardChangeTimestamp;
+    } else {
+        // our session UUID in the header can change while the billboard doesn't
+        populatePacketHeader(_billboardPacket, PacketTypeAvatarBillboard);
+    }
+    
+    return _billboardPacket;
+}
+
+const QByteArray& AvatarMixerClientData::getIdentityPacket(const QUuid& nodeUUID) {
+    if (_identityPacketTimestamp != _identityChangeTimestamp) {
+        _identityPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarIdentity);
+        
+        QByteArray individualData = _avatar.identityByteArray();
+        individualData.replace(0, NUM_BYTES_RFC4122_UUID, nodeUUID.toRfc4122());
+        _identityPacket.append(individualData);
+        
+        _identityPacketTimestamp = _identityChangeTimestamp;
+    } else {
+        populatePacketHeader(_identityPacket, PacketTypeAvatarIdentity);
+    }
+    
+    return _identityPacket;
+}
+
+void AvatarMixerClientData::forgetAvatar(const QUuid& avatarUUID) {
+    _acknowledgedAvatarSequences.remove(avatarUUID);
+    _avatarPriorities.remove(avatarUUID);
+    _sentBillboardTimestamps.remove(avatarUUID);
+    _sentIdentityTimestamps.remove(avatarUUID);
+}
+
+void AvatarMixerClientData::recordBroadcastFrame(int budgetBytes, int bytesSent, int avatarUpdates) {
+    _sumBudgetBytes += budgetBytes;
+    _sumBytesSent += bytesSent;
+    _sumAvatarUpdates += avatarUpdates;
+}
+
+void AvatarMixerClientData::resetBroadcastStats() {
+    _sumBudgetBytes = 0;
+    _sumBytesSent = 0;
+    _sumAvatarUpdates = 0;
+}
+
 bool AvatarMixerClientData::checkAndSetHasReceivedFirstPackets() {
     bool oldValue = _hasReceivedFirstPackets;
     _hasReceivedFirstPackets = true;
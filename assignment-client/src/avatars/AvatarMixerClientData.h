@@ -9,11 +9,26 @@
 #ifndef __hifi__AvatarMixerClientData__
 #define __hifi__AvatarMixerClientData__
 
+#include <QtCore/QHash>
+#include <QtCore/QPair>
 #include <QtCore/QUrl>
+#include <QtCore/QUuid>
+#include <QtCore/QVector>
 
 #include <AvatarData.h>
+#include <AvatarStateDelta.h>
 #include <NodeData.h>
 
+/// how many of the bulk avatar packets sent to a listener we remember, to match them up with its acknowledgements
+const int SENT_BULK_AVATAR_PACKET_HISTORY_SIZE = 1024;
+
+/// the avatar states that went out in one bulk avatar packet to a listener
+struct SentBulkAvatarPacket {
+    quint16 sequence;
+    bool isAcknowledged;
+    QVector<QPair<QUuid, quint16> > avatarSequences;
+};
+
 class AvatarMixerClientData : public NodeData {
     Q_OBJECT
 public:
@@ -22,6 +37,48 @@ public:
     int parseData(const QByteArray& packet);
     AvatarData& getAvatar() { return _avatar; }
     
+    /// packs the avatar unless it has not been updated since it was last packed, and gives it a new sequence number
+    /// if the packed state differs from the last one
+    /// \return true if the avatar had to be packed
+    bool packAvatarStateIfChanged();
+    
+    /// the sequence number of the state the avatar was in as of the last packAvatarStateIfChanged
+    quint16 getAvatarSequence() const { return _avatarSequence; }
+    
+    /// \return one of the last few packed states of the avatar, or NULL if that state is too old
+    const QByteArray* getAvatarState(quint16 sequence) const { return _avatarStates.getState(sequence); }
+    
+    /// starts recording the avatar states that go out in a new bulk avatar packet to this node
+    /// \return the sequence number for the packet
+    quint16 startSentBulkAvatarPacket();
+    
+    /// records that the state with this sequence number of another avatar went out in the current bulk avatar packet
+    void addAvatarToSentBulkAvatarPacket(const QUuid& avatarUUID, quint16 avatarSequence);
+    
+    /// reads a PacketTypeBulkAvatarDataAck from this node and records the avatar states it now has
+    void processBulkAvatarDataAck(const QByteArray& packet);
+    
+    /// \return true if this node has acknowledged a state of the other avatar, which is put in sequence
+    bool getAcknowledgedAvatarSequence(const QUuid& avatarUUID, quint16& sequence) const;
+    
+    /// the priority another avatar has built up with this node since it was last sent, which is added to every frame
+    float& getAvatarPriority(const QUuid& avatarUUID) { return _avatarPriorities[avatarUUID]; }
+    
+    /// the change timestamps of the billboard and identity of another avatar that were last sent to this node
+    quint64& getSentBillboardTimestamp(const QUuid& avatarUUID) { return _sentBillboardTimestamps[avatarUUID]; }
+    quint64& getSentIdentityTimestamp(const QUuid& avatarUUID) { return _sentIdentityTimestamps[avatarUUID]; }
+    
+    /// forgets what this node knows about an avatar that has gone away
+    void forgetAvatar(const QUuid& avatarUUID);
+    
+    /// records what one broadcast frame sent to this node against what it was allowed
+    void recordBroadcastFrame(int budgetBytes, int bytesSent, int avatarUpdates);
+    
+    qint64 getSumBudgetBytes() const { return _sumBudgetBytes; }
+    qint64 getSumBytesSent() const { return _sumBytesSent; }
+    int getSumAvatarUpdates() const { return _sumAvatarUpdates; }
+    void resetBroadcastStats();
+    
     bool checkAndSetHasReceivedFirstPackets();
     
     quint64 getBillboardChangeTimestamp() const { return _billboardChangeTimestamp; }
@@ -30,11 +87,36 @@ public:
     quint64 getIdentityChangeTimestamp() const { return _identityChangeTimestamp; }
     void setIdentityChangeTimestamp(quint64 identityChangeTimestamp) { _identityChangeTimestamp = identityChangeTimestamp; }
     
+    /// \return a PacketTypeAvatarBillboard packet for this node, built again only when the billboard has changed
+    const QByteArray& getBillboardPacket(const QUuid& nodeUUID);
+    
+    /// \return a PacketTypeAvatarIdentity packet for this node, built again only when the identity has changed
+    const QByteArray& getIdentityPacket(const QUuid& nodeUUID);
+    
 private:
+    void acknowledgeSentBulkAvatarPacket(quint16 packetSequence);
+    
     AvatarData _avatar;
+    QByteArray _packedAvatarState;
+    AvatarStateHistory _avatarStates;
+    quint16 _avatarSequence;
+    bool _hasAvatarChanged;
     bool _hasReceivedFirstPackets;
     quint64 _billboardChangeTimestamp;
     quint64 _identityChangeTimestamp;
+    QByteArray _billboardPacket;
+    quint64 _billboardPacketTimestamp;
+    QByteArray _identityPacket;
+    quint64 _identityPacketTimestamp;
+    quint16 _nextBulkAvatarPacketSequence;
+    QVector<SentBulkAvatarPacket> _sentBulkAvatarPackets;
+    QHash<QUuid, quint16> _acknowledgedAvatarSequences;
+    QHash<QUuid, float> _avatarPriorities;
+    QHash<QUuid, quint64> _sentBillboardTimestamps;
+    QHash<QUuid, quint64> _sentIdentityTimestamps;
+    qint64 _sumBudgetBytes;
+    qint64 _sumBytesSent;
+    int _sumAvatarUpdates;
 };
 
 #endif /* defined(__hifi__AvatarMixerClientData__) */
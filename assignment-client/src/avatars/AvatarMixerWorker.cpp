@@ -0,0 +1,256 @@
+//
+//  AvatarMixerWorker.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include <AvatarStateDelta.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "AvatarMixer.h"
+#include "AvatarMixerClientData.h"
+
+#include "AvatarMixerWorker.h"
+
+const float BILLBOARD_AND_IDENTITY_SEND_PROBABILITY = 1.0f / 300.0f;
+
+AvatarMixerWorker::AvatarMixerWorker(AvatarMixer* mixer) :
+    _mixer(mixer),
+    _bulkAvatarPacket(),
+    _sumListeners(0),
+    _sumAvatarsSent(0),
+    _sumDeltaAvatarsSent(0),
+    _sumAvatarsUpToDate(0),
+    _sumAvatarStateBytes(0),
+    _sumBillboardPackets(0),
+    _sumIdentityPackets(0),
+    _sumAllocations(0),
+    _sumAssemblyUsecs(0)
+{
+    // the AvatarMixer owns its workers and re-queues them every frame
+    setAutoDelete(false);
+}
+
+void AvatarMixerWorker::run() {
+    quint64 startTime = usecTimestampNow();
+
+    int listenerIndex = 0;
+    while ((listenerIndex = _mixer->claimNextListenerIndex()) != -1) {
+        assemblePacketsForListener(listenerIndex);
+        ++_sumListeners;
+    }
+
+    _sumAssemblyUsecs += usecTimestampNow() - startTime;
+
+    _mixer->workerFinished();
+}
+
+void AvatarMixerWorker::resetStats() {
+    _sumListeners = 0;
+    _sumAvatarsSent = 0;
+    _sumDeltaAvatarsSent = 0;
+    _sumAvatarsUpToDate = 0;
+    _sumAvatarStateBytes = 0;
+    _sumBillboardPackets = 0;
+    _sumIdentityPackets = 0;
+    _sumAllocations = 0;
+    _sumAssemblyUsecs = 0;
+}
+
+void AvatarMixerWorker::startBulkAvatarPacket(AvatarMixerClientData* listenerData) {
+    // packets are queued until the whole frame is assembled, so every bulk packet gets a pooled buffer of its own, which
+    // is sent as it is
+    _bulkAvatarPacket = PacketBuffer(MAX_PACKET_SIZE);
+    ++_sumAllocations;
+    
+    int numHeaderBytes = populatePacketHeader(_bulkAvatarPacket.data(), PacketTypeBulkAvatarData);
+    
+    quint16 packetSequence = listenerData->startSentBulkAvatarPacket();
+    memcpy(_bulkAvatarPacket.data() + numHeaderBytes, &packetSequence, sizeof(packetSequence));
+    _bulkAvatarPacket.resize(numHeaderBytes + sizeof(packetSequence));
+}
+
+int AvatarMixerWorker::appendAvatarState(const AvatarSnapshot& avatar, AvatarMixerClientData* listenerData,
+                                          QVector<PacketBuffer>& listenerPackets) {
+    const QByteArray* state = avatar.nodeData->getAvatarState(avatar.avatarSequence);
+    
+    // the listener can rebuild the state from any state it acknowledged that we still have
+    quint16 baseSequence = avatar.avatarSequence;
+    const QByteArray* baseState = NULL;
+    if (listenerData->getAcknowledgedAvatarSequence(avatar.node->getUUID(), baseSequence)) {
+        baseState = avatar.nodeData->getAvatarState(baseSequence);
+    }
+    if (!baseState) {
+        baseSequence = avatar.avatarSequence;
+    }
+    
+    int maxEntryBytes = BULK_AVATAR_DATA_ENTRY_HEADER_BYTES + maxPackedAvatarStateBytes(state->size());
+    if (_bulkAvatarPacket.size() + maxEntryBytes > MAX_PACKET_SIZE) {
+        listenerPackets.append(_bulkAvatarPacket);
+        startBulkAvatarPacket(listenerData);
+    }
+    
+    // this stays inside the buffer's block, so nothing is allocated or copied
+    int entryOffset = _bulkAvatarPacket.size();
+    _bulkAvatarPacket.resize(entryOffset + maxEntryBytes);
+    unsigned char* entry = reinterpret_cast<unsigned char*>(_bulkAvatarPacket.data()) + entryOffset;
+    unsigned char* packedState = entry + BULK_AVATAR_DATA_ENTRY_HEADER_BYTES;
+    
+    int numPackedBytes = packAvatarState(*state, baseState, packedState);
+    if (baseState && numPackedBytes > (int) sizeof(quint16) + state->size()) {
+        // so much has changed that the whole state is smaller
+        baseSequence = avatar.avatarSequence;
+        numPackedBytes = packAvatarState(*state, NULL, packedState);
+    }
+    
+    memcpy(entry, avatar.uuidBytes.constData(), NUM_BYTES_RFC4122_UUID);
+    entry += NUM_BYTES_RFC4122_UUID;
+    memcpy(entry, &avatar.avatarSequence, sizeof(avatar.avatarSequence));
+    entry += sizeof(avatar.avatarSequence);
+    memcpy(entry, &baseSequence, sizeof(baseSequence));
+    
+    _bulkAvatarPacket.resize(entryOffset + BULK_AVATAR_DATA_ENTRY_HEADER_BYTES + numPackedBytes);
+    listenerData->addAvatarToSentBulkAvatarPacket(avatar.node->getUUID(), avatar.avatarSequence);
+    
+    ++_sumAvatarsSent;
+    _sumAvatarStateBytes += BULK_AVATAR_DATA_ENTRY_HEADER_BYTES + numPackedBytes;
+    if (baseSequence != avatar.avatarSequence) {
+        ++_sumDeltaAvatarsSent;
+    }
+    
+    return BULK_AVATAR_DATA_ENTRY_HEADER_BYTES + numPackedBytes;
+}
+
+static bool hasHigherPriority(const PrioritizedAvatar& a, const PrioritizedAvatar& b) {
+    return a.priority > b.priority;
+}
+
+/// \return the priority an avatar gains with a listener each frame it is not sent
+static float priorityGainForListener(const AvatarSnapshot& listener, const AvatarSnapshot& avatar) {
+    //  an avatar within the full rate distance and in front of the listener gains a whole update's worth every frame,
+    //  one at twice the distance half that, so it is sent about every other frame
+    const float FULL_RATE_DISTANCE = 2.f;
+    
+    //  an avatar right behind the listener still gains this much of what it would in front
+    const float BEHIND_LISTENER_GAIN_RATIO = 0.25f;
+    
+    glm::vec3 offset = avatar.position - listener.position;
+    float distanceToAvatar = glm::length(offset);
+    
+    float viewRatio = 1.0f;
+    if (distanceToAvatar > EPSILON) {
+        float facing = glm::dot(listener.viewDirection, offset / distanceToAvatar);
+        viewRatio = glm::mix(BEHIND_LISTENER_GAIN_RATIO, 1.0f, (facing + 1.0f) * 0.5f);
+    }
+    
+    return viewRatio * FULL_RATE_DISTANCE / glm::max(distanceToAvatar, FULL_RATE_DISTANCE);
+}
+
+int AvatarMixerWorker::appendBillboardAndIdentity(const AvatarSnapshot& avatar, AvatarMixerClientData* listenerData,
+                                                  bool forceSend, bool allowResend,
+                                                  QVector<PacketBuffer>& listenerPackets) {
+    int numBytes = 0;
+    
+    // we will also force a send of billboard or identity packet if either has changed since the listener was last
+    // sent it, which may be some frames after the change if the avatar didn't make the listener's budget until then
+    
+    // every listener's copy is hashed for it as it is sent, so it's copied here rather than on the broadcast thread
+    
+    quint64& sentBillboardTimestamp = listenerData->getSentBillboardTimestamp(avatar.node->getUUID());
+    if (avatar.billboardChangeTimestamp > 0
+        && (forceSend
+            || avatar.billboardChangeTimestamp > sentBillboardTimestamp
+            || (allowResend && randFloat() < BILLBOARD_AND_IDENTITY_SEND_PROBABILITY))) {
+        listenerPackets.append(PacketBuffer(avatar.billboardPacket));
+        numBytes += avatar.billboardPacket.size();
+        ++_sumBillboardPackets;
+        sentBillboardTimestamp = avatar.billboardChangeTimestamp;
+    }
+    
+    quint64& sentIdentityTimestamp = listenerData->getSentIdentityTimestamp(avatar.node->getUUID());
+    if (avatar.identityChangeTimestamp > 0
+        && (forceSend
+            || avatar.identityChangeTimestamp > sentIdentityTimestamp
+            || (allowResend && randFloat() < BILLBOARD_AND_IDENTITY_SEND_PROBABILITY))) {
+        listenerPackets.append(PacketBuffer(avatar.identityPacket));
+        numBytes += avatar.identityPacket.size();
+        ++_sumIdentityPackets;
+        sentIdentityTimestamp = avatar.identityChangeTimestamp;
+    }
+    
+    return numBytes;
+}
+
+// NOTE: some additional optimizations to consider.
+//    1) use the view frustum to cull those avatars that are out of view. Since avatar data doesn't need to be present
+//       if the avatar is not in view or in the keyhole.
+void AvatarMixerWorker::assemblePacketsForListener(int listenerIndex) {
+    const AvatarSnapshot& listener = _mixer->getFrameListener(listenerIndex);
+    QVector<PacketBuffer>& listenerPackets = _mixer->getPacketsForListener(listenerIndex);
+    const QVector<AvatarSnapshot>& frameAvatars = _mixer->getFrameAvatars();
+    
+    // this keeps the listener's acknowledgements from being processed while we pick base states and record what we
+    // send, it is the only lock we take per listener
+    QMutexLocker listenerLocker(&listener.nodeData->getMutex());
+    
+    startBulkAvatarPacket(listener.nodeData);
+    
+    int budgetBytes = _mixer->getListenerBudgetBytes();
+    int bytesSent = 0;
+    int avatarUpdates = 0;
+    
+    // if the receiving avatar has just connected make sure we send out the mesh and billboard
+    // for every avatar (assuming they exist)
+    bool forceSend = !listener.nodeData->checkAndSetHasReceivedFirstPackets();
+    
+    // every avatar the listener does not have as it is now gains priority until it is sent
+    _prioritizedAvatars.resize(0);
+    for (int i = 0; i < frameAvatars.size(); i++) {
+        const AvatarSnapshot& otherAvatar = frameAvatars[i];
+        if (otherAvatar.node == listener.node) {
+            continue;
+        }
+        
+        float& priority = listener.nodeData->getAvatarPriority(otherAvatar.node->getUUID());
+        
+        quint16 acknowledgedSequence;
+        if (listener.nodeData->getAcknowledgedAvatarSequence(otherAvatar.node->getUUID(), acknowledgedSequence)
+            && acknowledgedSequence == otherAvatar.avatarSequence) {
+            // the listener already has the avatar as it is now, only a billboard or identity change is news
+            priority = 0.0f;
+            ++_sumAvatarsUpToDate;
+            bytesSent += appendBillboardAndIdentity(otherAvatar, listener.nodeData, forceSend, false, listenerPackets);
+            continue;
+        }
+        
+        priority += priorityGainForListener(listener, otherAvatar);
+        
+        PrioritizedAvatar prioritizedAvatar = { priority, i, &priority };
+        _prioritizedAvatars.append(prioritizedAvatar);
+    }
+    
+    // QHash keeps each entry where it was allocated as others are added, so the pointers into it are still good
+    std::sort(_prioritizedAvatars.begin(), _prioritizedAvatars.end(), hasHigherPriority);
+    
+    // the highest priorities fill the budget, the rest carry what they have built up over to the next frame
+    for (int i = 0; i < _prioritizedAvatars.size() && bytesSent < budgetBytes; i++) {
+        const AvatarSnapshot& otherAvatar = frameAvatars[_prioritizedAvatars[i].avatarIndex];
+        
+        bytesSent += appendAvatarState(otherAvatar, listener.nodeData, listenerPackets);
+        bytesSent += appendBillboardAndIdentity(otherAvatar, listener.nodeData, forceSend, true, listenerPackets);
+        
+        *_prioritizedAvatars[i].accumulatedPriority = 0.0f;
+        ++avatarUpdates;
+    }
+    
+    listener.nodeData->recordBroadcastFrame(budgetBytes, bytesSent, avatarUpdates);
+    
+    listenerPackets.append(_bulkAvatarPacket);
+    _bulkAvatarPacket = PacketBuffer();
+}
@@ -0,0 +1,85 @@
+//
+//  AvatarMixerWorker.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#ifndef __hifi__AvatarMixerWorker__
+#define __hifi__AvatarMixerWorker__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QRunnable>
+#include <QtCore/QVector>
+
+#include <PacketBuffer.h>
+
+class AvatarMixer;
+class AvatarMixerClientData;
+struct AvatarSnapshot;
+
+/// an avatar a listener is owed an update for, with the priority it has built up with that listener
+struct PrioritizedAvatar {
+    float priority;
+    int avatarIndex;
+    float* accumulatedPriority;
+};
+
+/// Assembles the bulk avatar packets for the listeners of one AvatarMixer frame. Several workers pull listeners from
+/// the same frame concurrently and only ever read the frame's AvatarSnapshots.
+class AvatarMixerWorker : public QRunnable {
+public:
+    AvatarMixerWorker(AvatarMixer* mixer);
+
+    /// assembles packets for listeners claimed from the mixer's current frame until there are none left
+    void run();
+
+    int getSumListeners() const { return _sumListeners; }
+    int getSumAvatarsSent() const { return _sumAvatarsSent; }
+    int getSumDeltaAvatarsSent() const { return _sumDeltaAvatarsSent; }
+    int getSumAvatarsUpToDate() const { return _sumAvatarsUpToDate; }
+    qint64 getSumAvatarStateBytes() const { return _sumAvatarStateBytes; }
+    int getSumBillboardPackets() const { return _sumBillboardPackets; }
+    int getSumIdentityPackets() const { return _sumIdentityPackets; }
+    int getSumAllocations() const { return _sumAllocations; }
+    quint64 getSumAssemblyUsecs() const { return _sumAssemblyUsecs; }
+    void resetStats();
+
+private:
+    /// appends every packet this listener should get this frame to the mixer's packets for the listener
+    void assemblePacketsForListener(int listenerIndex);
+
+    /// starts _bulkAvatarPacket over with a new header and the listener's next bulk packet sequence number
+    void startBulkAvatarPacket(AvatarMixerClientData* listenerData);
+
+    /// adds the avatar's current state to _bulkAvatarPacket, as changes against the last state the listener
+    /// acknowledged when it still has that one, starting a new packet first if this one is too full
+    /// \return the number of bytes the state took up
+    int appendAvatarState(const AvatarSnapshot& avatar, AvatarMixerClientData* listenerData,
+                          QVector<PacketBuffer>& listenerPackets);
+    
+    /// queues the avatar's billboard and identity packets for the listener if it should get them this frame, which it
+    /// should if either changed since it was last sent to the listener
+    /// \param allowResend whether a packet that has not changed may be sent again in case the listener lost it
+    /// \return the number of bytes queued
+    int appendBillboardAndIdentity(const AvatarSnapshot& avatar, AvatarMixerClientData* listenerData, bool forceSend,
+                                   bool allowResend, QVector<PacketBuffer>& listenerPackets);
+
+    AvatarMixer* _mixer;
+
+    PacketBuffer _bulkAvatarPacket;
+    QVector<PrioritizedAvatar> _prioritizedAvatars;
+
+    int _sumListeners;
+    int _sumAvatarsSent;
+    int _sumDeltaAvatarsSent;
+    int _sumAvatarsUpToDate;
+    qint64 _sumAvatarStateBytes;
+    int _sumBillboardPackets;
+    int _sumIdentityPackets;
+    int _sumAllocations;
+    quint64 _sumAssemblyUsecs;
+};
+
+#endif /* defined(__hifi__AvatarMixerWorker__) */
@@ -43,12 +43,14 @@ void MetavoxelServer::run() {
 }
 
 void MetavoxelServer::readPendingDatagrams() {
+    PacketBuffer receivedDatagram;
     QByteArray receivedPacket;
     HifiSockAddr senderSockAddr;
     
     NodeList* nodeList = NodeList::getInstance();
     
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
+    while (readAvailableDatagram(receivedDatagram, senderSockAddr)) {
+        receivedDatagram.asByteArray(receivedPacket);
         if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
             switch (packetTypeForPacket(receivedPacket)) {
                 case PacketTypeMetavoxelData:
@@ -8,6 +8,9 @@
 //  Threaded or non-threaded network packet processor for the voxel-server
 //
 
+#include <algorithm>
+
+#include <OctalCode.h>
 #include <PacketHeaders.h>
 #include <PerfStat.h>
 
@@ -15,7 +18,25 @@
 #include "OctreeServerConsts.h"
 #include "OctreeInboundPacketProcessor.h"
 
-static QUuid DEFAULT_NODE_ID_REF;
+// how long edits wait between checks for the snapshots or the journal to be loaded
+const quint64 WAIT_FOR_LOAD_USECS = 10 * USECS_PER_MSEC;
+
+// orders the edits of a run by the octal code they start with, keeping edits of the same element in the order they came in
+class EditOctalCodeLessThan {
+public:
+    EditOctalCodeLessThan(const QVector<BatchedEditPacket>& packets) : _packets(packets) { }
+
+    bool operator()(const BatchedEdit& a, const BatchedEdit& b) const {
+        return compareOctalCodes(codeOf(a), codeOf(b)) == LESS_THAN;
+    }
+
+private:
+    const unsigned char* codeOf(const BatchedEdit& edit) const {
+        return reinterpret_cast<const unsigned char*>(_packets[edit.packetIndex].packet.constData()) + edit.offset;
+    }
+
+    const QVector<BatchedEditPacket>& _packets;
+};
 
 OctreeInboundPacketProcessor::OctreeInboundPacketProcessor(OctreeServer* myServer) :
     _myServer(myServer),
@@ -24,7 +45,20 @@ OctreeInboundPacketProcessor::OctreeInboundPacketProcessor(OctreeServer* myServe
     _totalProcessTime(0),
     _totalLockWaitTime(0),
     _totalElementsInPacket(0),
-    _totalPackets(0)
+    _totalPackets(0),
+    _batchPackets(),
+    _batchEdits(),
+    _batchStarted(0),
+    _editRunStart(0),
+    _editRunMaxOctets(0),
+    _pendingPackets(),
+    _pendingEdits(),
+    _lastWrittenTree(NULL),
+    _totalBatches(0),
+    _totalBatchEdits(0),
+    _totalBatchLatency(0),
+    _totalBatchLockHoldTime(0),
+    _maxBatchLockHoldTime(0)
 {
 }
 
@@ -35,11 +69,21 @@ void OctreeInboundPacketProcessor::resetStats() {
     _totalElementsInPacket = 0;
     _totalPackets = 0;
 
+    _totalBatches = 0;
+    _totalBatchEdits = 0;
+    _totalBatchLatency = 0;
+    _totalBatchLockHoldTime = 0;
+    _maxBatchLockHoldTime = 0;
+
+    resetQueueHistograms();
+
     _singleSenderStats.clear();
 }
 
 
-void OctreeInboundPacketProcessor::processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+void OctreeInboundPacketProcessor::processPacketBuffer(const SharedNodePointer& sendingNode, const PacketBuffer& buffer) {
+    // the packet is batched along with its buffer, which keeps its bytes where they are until the batch is applied
+    QByteArray packet = buffer.asByteArray();
 
     bool debugProcessPacket = _myServer->wantsVerboseDebug();
 
@@ -56,78 +100,214 @@ void OctreeInboundPacketProcessor::processPacket(const SharedNodePointer& sendin
         PerformanceWarning warn(debugProcessPacket, "processPacket KNOWN TYPE",debugProcessPacket);
         _receivedPacketCount++;
         
-        const unsigned char* packetData = reinterpret_cast<const unsigned char*>(packet.data());
+        const unsigned char* packetData = reinterpret_cast<const unsigned char*>(packet.constData());
 
         unsigned short int sequence = (*((unsigned short int*)(packetData + numBytesPacketHeader)));
         quint64 sentAt = (*((quint64*)(packetData + numBytesPacketHeader + sizeof(sequence))));
         quint64 arrivedAt = usecTimestampNow();
         quint64 transitTime = arrivedAt - sentAt;
-        int editsInPacket = 0;
-        quint64 processTime = 0;
-        quint64 lockWaitTime = 0;
 
         if (_myServer->wantsDebugReceiving()) {
             qDebug() << "PROCESSING THREAD: got '" << packetType << "' packet - " << _receivedPacketCount
                     << " command from client receivedBytes=" << packet.size()
                     << " sequence=" << sequence << " transitTime=" << transitTime << " usecs";
         }
+
+        if (_batchPackets.isEmpty()) {
+            _batchStarted = arrivedAt;
+        }
+        BatchedEditPacket batchedPacket = { sendingNode, buffer, packet, packetType, sequence, transitTime, 0 };
+        _batchPackets.append(batchedPacket);
+        int packetIndex = _batchPackets.size() - 1;
+
+        // split the packet into its edit records without locking the tree, as far as the tree can size them
         int atByte = numBytesPacketHeader + sizeof(sequence) + sizeof(sentAt);
-        unsigned char* editData = (unsigned char*)&packetData[atByte];
         while (atByte < packet.size()) {
             int maxSize = packet.size() - atByte;
-
-            if (debugProcessPacket) {
-                printf("OctreeInboundPacketProcessor::processPacket() %c "
-                       "packetData=%p packetLength=%d voxelData=%p atByte=%d maxSize=%d\n",
-                        packetType, packetData, packet.size(), editData, atByte, maxSize);
+            int editLength = _myServer->getOctree()->getEditRecordLength(packetType, packetData + atByte, maxSize);
+            if (editLength <= 0) {
+                batchUnsortableEdit(packetIndex, atByte);
+                break;
             }
-
-            quint64 startLock = usecTimestampNow();
-            _myServer->getOctree()->lockForWrite();
-            quint64 startProcess = usecTimestampNow();
-            int editDataBytesRead = _myServer->getOctree()->processEditPacketData(packetType,
-                                                                                  reinterpret_cast<const unsigned char*>(packet.data()),
-                                                                                  packet.size(),
-                                                                                  editData, maxSize, sendingNode);
-            _myServer->getOctree()->unlock();
-            quint64 endProcess = usecTimestampNow();
-
-            editsInPacket++;
-            quint64 thisProcessTime = endProcess - startProcess;
-            quint64 thisLockWaitTime = startProcess - startLock;
-            processTime += thisProcessTime;
-            lockWaitTime += thisLockWaitTime;
-
-            // skip to next voxel edit record in the packet
-            editData += editDataBytesRead;
-            atByte += editDataBytesRead;
-        }
-
-        if (debugProcessPacket) {
-            printf("OctreeInboundPacketProcessor::processPacket() DONE LOOPING FOR %c "
-                   "packetData=%p packetLength=%d voxelData=%p atByte=%d\n",
-                    packetType, packetData, packet.size(), editData, atByte);
+            batchSortableEdit(packetIndex, atByte, editLength);
+            atByte += editLength;
         }
 
         // Make sure our Node and NodeList knows we've heard from this node.
-        QUuid& nodeUUID = DEFAULT_NODE_ID_REF;
         if (sendingNode) {
             sendingNode->setLastHeardMicrostamp(usecTimestampNow());
-            nodeUUID = sendingNode->getUUID();
-            if (debugProcessPacket) {
-                qDebug() << "sender has uuid=" << nodeUUID;
-            }
-        } else {
-            if (debugProcessPacket) {
-                qDebug() << "sender has no known nodeUUID.";
-            }
         }
-        trackInboundPackets(nodeUUID, sequence, transitTime, editsInPacket, processTime, lockWaitTime);
+
+        // keep decoding while a burst of packets is waiting, and apply all of their edits at once
+        if (!hasPacketsToProcess() || _batchPackets.size() >= MAX_PACKETS_PER_EDIT_BATCH) {
+            applyEditBatch();
+        }
     } else {
         qDebug("unknown packet ignored... packetType=%d", packetType);
     }
 }
 
+void OctreeInboundPacketProcessor::batchSortableEdit(int packetIndex, int offset, int length) {
+    const unsigned char* octalCode = reinterpret_cast<const unsigned char*>(_batchPackets[packetIndex].packet.constData())
+        + offset;
+    int octets = numberOfThreeBitSectionsInCode(octalCode);
+
+    // sorting puts shallower codes first, so an edit that came in after a deeper one has to start a new run, or
+    // it could be moved ahead of an edit of one of its descendants
+    if (octets < _editRunMaxOctets) {
+        sortEditRun();
+    }
+    _editRunMaxOctets = std::max(_editRunMaxOctets, octets);
+
+    BatchedEdit edit = { packetIndex, offset, length };
+    _batchEdits.append(edit);
+}
+
+void OctreeInboundPacketProcessor::batchUnsortableEdit(int packetIndex, int offset) {
+    sortEditRun();
+
+    BatchedEdit edit = { packetIndex, offset, 0 };
+    _batchEdits.append(edit);
+
+    // nothing may be sorted ahead of it either
+    _editRunStart = _batchEdits.size();
+}
+
+void OctreeInboundPacketProcessor::sortEditRun() {
+    std::stable_sort(_batchEdits.begin() + _editRunStart, _batchEdits.end(), EditOctalCodeLessThan(_batchPackets));
+    _editRunStart = _batchEdits.size();
+    _editRunMaxOctets = 0;
+}
+
+void OctreeInboundPacketProcessor::applyEditBatch() {
+    sortEditRun();
+
+    Octree* tree = _myServer->getOctree();
+    OctreeSnapshots* snapshots = _myServer->getSnapshots();
+    OctreeEditJournal* journal = _myServer->getEditJournal();
+
+    // both snapshots have to be loaded before either gets an edit, or they could end up different, and the journal has
+    // to be replayed before it is added to
+    if (snapshots || journal) {
+        while (!_myServer->isInitialLoadComplete()) {
+            usleep(WAIT_FOR_LOAD_USECS);
+        }
+    }
+
+    // the edits are in the journal before they are in the tree
+    if (journal) {
+        journal->beginBatch();
+        foreach (const BatchedEditPacket& batchedPacket, _batchPackets) {
+            journal->append(batchedPacket.packet);
+        }
+        journal->flush();
+    }
+
+    quint64 startLock = usecTimestampNow();
+    if (snapshots) {
+        tree = snapshots->beginWrite();
+    }
+
+    // readers of a snapshot never take this lock, but it still keeps out anyone who reads the tree the old way
+    tree->lockForWrite();
+    quint64 startProcess = usecTimestampNow();
+
+    if (snapshots && tree != _lastWrittenTree) {
+        // catch this copy up with the edits the other copy was published with
+        applyEdits(tree, _pendingPackets, _pendingEdits);
+        _pendingPackets.resize(0);
+        _pendingEdits.resize(0);
+        _lastWrittenTree = tree;
+    }
+    int editsInBatch = applyEdits(tree, _batchPackets, _batchEdits);
+
+    tree->unlock();
+    if (snapshots) {
+        snapshots->publish();
+    }
+    if (journal) {
+        journal->endBatch();
+    }
+    quint64 endProcess = usecTimestampNow();
+
+    quint64 lockWaitTime = startProcess - startLock;
+    quint64 lockHoldTime = endProcess - startProcess;
+
+    _totalBatches++;
+    _totalBatchEdits += editsInBatch;
+    _totalBatchLatency += endProcess - _batchStarted;
+    _totalBatchLockHoldTime += lockHoldTime;
+    _maxBatchLockHoldTime = std::max(_maxBatchLockHoldTime, lockHoldTime);
+
+    // the packets of the batch share its lock wait and process time by the number of edits in them
+    foreach (const BatchedEditPacket& batchedPacket, _batchPackets) {
+        QUuid nodeUUID;
+        if (batchedPacket.sendingNode) {
+            nodeUUID = batchedPacket.sendingNode->getUUID();
+        }
+
+        quint64 processTime = editsInBatch == 0 ? 0 : lockHoldTime * batchedPacket.editsInPacket / editsInBatch;
+        quint64 packetLockWaitTime = editsInBatch == 0 ? 0 : lockWaitTime * batchedPacket.editsInPacket / editsInBatch;
+        trackInboundPackets(nodeUUID, batchedPacket.sequence, batchedPacket.transitTime, batchedPacket.editsInPacket,
+                            processTime, packetLockWaitTime);
+    }
+
+    if (snapshots) {
+        if (_pendingPackets.isEmpty()) {
+            _pendingPackets.swap(_batchPackets);
+            _pendingEdits.swap(_batchEdits);
+        } else {
+            int packetIndexOffset = _pendingPackets.size();
+            _pendingPackets += _batchPackets;
+            foreach (BatchedEdit edit, _batchEdits) {
+                edit.packetIndex += packetIndexOffset;
+                _pendingEdits.append(edit);
+            }
+        }
+    }
+    _batchPackets.resize(0);
+    _batchEdits.resize(0);
+    _editRunStart = 0;
+    _editRunMaxOctets = 0;
+}
+
+int OctreeInboundPacketProcessor::applyEdits(Octree* tree, QVector<BatchedEditPacket>& packets,
+                                             const QVector<BatchedEdit>& edits) {
+    int editsApplied = 0;
+
+    foreach (const BatchedEdit& edit, edits) {
+        BatchedEditPacket& batchedPacket = packets[edit.packetIndex];
+        const unsigned char* packetData = reinterpret_cast<const unsigned char*>(batchedPacket.packet.constData());
+        int packetLength = batchedPacket.packet.size();
+
+        if (edit.length > 0) {
+            tree->processEditPacketData(batchedPacket.packetType, packetData, packetLength, packetData + edit.offset,
+                                        edit.length, batchedPacket.sendingNode);
+            batchedPacket.editsInPacket++;
+            editsApplied++;
+            continue;
+        }
+
+        // the tree can only tell how long these records are by reading them
+        int atByte = edit.offset;
+        while (atByte < packetLength) {
+            int editDataBytesRead = tree->processEditPacketData(batchedPacket.packetType, packetData, packetLength,
+                                                                packetData + atByte, packetLength - atByte,
+                                                                batchedPacket.sendingNode);
+            batchedPacket.editsInPacket++;
+            editsApplied++;
+
+            // a record the tree can't read would otherwise have us loop forever
+            if (editDataBytesRead <= 0) {
+                break;
+            }
+            atByte += editDataBytesRead;
+        }
+    }
+
+    return editsApplied;
+}
+
 void OctreeInboundPacketProcessor::trackInboundPackets(const QUuid& nodeUUID, int sequence, quint64 transitTime,
             int editsInPacket, quint64 processTime, quint64 lockWaitTime) {
 
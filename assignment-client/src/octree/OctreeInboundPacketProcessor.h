@@ -13,9 +13,35 @@
 
 #include <map>
 
+#include <QtCore/QVector>
+
+#include <PacketHeaders.h>
 #include <ReceivedPacketProcessor.h>
 class OctreeServer;
 
+/// the most packets decoded into one batch of edits before it is applied, even if more are waiting
+const int MAX_PACKETS_PER_EDIT_BATCH = 64;
+
+/// An edit packet whose edits are in the current batch
+struct BatchedEditPacket {
+    SharedNodePointer sendingNode;
+    PacketBuffer buffer; // keeps the bytes that packet reads
+    QByteArray packet;
+    PacketType packetType;
+    unsigned short int sequence;
+    quint64 transitTime;
+    int editsInPacket;
+};
+
+/// One edit record of a packet in the current batch
+struct BatchedEdit {
+    int packetIndex;
+    int offset;
+    
+    /// 0 if the record, and the rest of the packet after it, can only be read as it is applied
+    int length;
+};
+
 class SingleSenderStats {
 public:
     SingleSenderStats();
@@ -58,14 +84,37 @@ public:
     quint64 getAverageLockWaitTimePerElement() const 
                 { return _totalElementsInPacket == 0 ? 0 : _totalLockWaitTime / _totalElementsInPacket; }
 
+    quint64 getTotalEditBatches() const { return _totalBatches; }
+    float getAverageEditsPerBatch() const { return _totalBatches == 0 ? 0 : (float)_totalBatchEdits / _totalBatches; }
+    quint64 getAverageBatchLatency() const { return _totalBatches == 0 ? 0 : _totalBatchLatency / _totalBatches; }
+    quint64 getAverageBatchLockHoldTime() const { return _totalBatches == 0 ? 0 : _totalBatchLockHoldTime / _totalBatches; }
+    quint64 getMaxBatchLockHoldTime() const { return _maxBatchLockHoldTime; }
+
     void resetStats();
 
     NodeToSenderStatsMap& getSingleSenderStats() { return _singleSenderStats; }
 
 protected:
-    virtual void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet);
+    virtual void processPacketBuffer(const SharedNodePointer& sendingNode, const PacketBuffer& buffer);
 
 private:
+    /// adds an edit with a known length to the batch, sorted with the other edits of its run when the batch is applied
+    void batchSortableEdit(int packetIndex, int offset, int length);
+
+    /// adds the rest of a packet that can only be read as it is applied, in the order it came in
+    void batchUnsortableEdit(int packetIndex, int offset);
+
+    /// sorts the current run of sortable edits by octal code and starts a new one
+    void sortEditRun();
+
+    /// applies every edit of the batch with the tree locked for writing once, with snapshots it applies them to the
+    /// unpublished copy, after the edits of the batch before, and publishes it. With a journal, the batch is written to
+    /// it first.
+    void applyEditBatch();
+
+    /// \return the number of edits applied, which are also counted in each packet's editsInPacket
+    int applyEdits(Octree* tree, QVector<BatchedEditPacket>& packets, const QVector<BatchedEdit>& edits);
+
     void trackInboundPackets(const QUuid& nodeUUID, int sequence, quint64 transitTime, 
             int voxelsInPacket, quint64 processTime, quint64 lockWaitTime);
 
@@ -79,5 +128,25 @@ private:
     quint64 _totalPackets;
     
     NodeToSenderStatsMap _singleSenderStats;
+
+    QVector<BatchedEditPacket> _batchPackets;
+    QVector<BatchedEdit> _batchEdits;
+    quint64 _batchStarted;
+
+    // the edits from _editRunStart on can be sorted amongst themselves, none is deeper than _editRunMaxOctets
+    int _editRunStart;
+    int _editRunMaxOctets;
+
+    // with snapshots, the batches applied to the copy we wrote to last that the other copy has yet to get. While the
+    // persist thread holds the published copy we keep writing to the same one, and these add up.
+    QVector<BatchedEditPacket> _pendingPackets;
+    QVector<BatchedEdit> _pendingEdits;
+    Octree* _lastWrittenTree;
+
+    quint64 _totalBatches;
+    quint64 _totalBatchEdits;
+    quint64 _totalBatchLatency;
+    quint64 _totalBatchLockHoldTime;
+    quint64 _maxBatchLockHoldTime;
 };
 #endif // __octree_server__OctreeInboundPacketProcessor__
@@ -50,9 +50,9 @@ OctreeQueryNode::~OctreeQueryNode() {
     }
     if (_octreeSendThread) {
         if (extraDebugging) {
-            qDebug() << "OctreeQueryNode::~OctreeQueryNode()... calling _octreeSendThread->terminate()";
+            qDebug() << "OctreeQueryNode::~OctreeQueryNode()... calling _octreeSendThread->setIsShuttingDown()";
         }
-        _octreeSendThread->terminate();
+        _octreeSendThread->setIsShuttingDown();
         if (extraDebugging) {
             qDebug() << "OctreeQueryNode::~OctreeQueryNode()... calling delete _octreeSendThread";
         }
@@ -77,9 +77,8 @@ void OctreeQueryNode::deleteLater() {
 
 
 void OctreeQueryNode::initializeOctreeSendThread(OctreeServer* octreeServer, SharedNodePointer node) {
-    // Create octree sending thread...
+    // Create our octree sender, which schedules itself with the server's send workers...
     _octreeSendThread = new OctreeSendThread(octreeServer, node);
-    _octreeSendThread->initialize(true);
 }
 
 bool OctreeQueryNode::packetIsDuplicate() const {
@@ -329,7 +328,9 @@ void OctreeQueryNode::dumpOutOfView() {
     
     int stillInView = 0;
     int outOfView = 0;
-    OctreeElementBag tempBag;
+    // the tree we send from can't change while we're in here, whether it is locked or a pinned snapshot
+    bool wantDeleteHook = false;
+    OctreeElementBag tempBag(wantDeleteHook);
     while (!nodeBag.isEmpty()) {
         OctreeElement* node = nodeBag.extract();
         if (node->isInView(_currentViewFrustum)) {
@@ -0,0 +1,206 @@
+//
+//  OctreeSendScheduler.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+
+#include <QMutexLocker>
+
+#include <SharedUtil.h>
+
+#include "OctreeSendScheduler.h"
+#include "OctreeSendThread.h"
+#include "OctreeServer.h"
+#include "OctreeServerConsts.h"
+
+// how long an idle worker sleeps before it checks whether it should exit, when no client is scheduled at all
+const unsigned long IDLE_WORKER_WAIT_MSECS = 100;
+
+// the heap keeps the client with the earliest deadline at the front
+static bool isDueLater(const ScheduledOctreeClient& a, const ScheduledOctreeClient& b) {
+    return a.deadline > b.deadline;
+}
+
+OctreeSendWorker::OctreeSendWorker(OctreeServer* server, OctreeSendScheduler* scheduler) :
+    _server(server),
+    _scheduler(scheduler),
+    _batch()
+{
+}
+
+bool OctreeSendWorker::process() {
+    if (!_scheduler->claimDueClients(_batch)) {
+        return false;
+    }
+
+    // don't do any send processing until the initial load of the octree is complete...
+    if (_server->isInitialLoadComplete()) {
+        // with snapshots each client pins the one it sends from instead
+        bool wantTreeLock = !_server->getSnapshots();
+        if (wantTreeLock) {
+            quint64 lockWaitStart = usecTimestampNow();
+            _server->getOctree()->lockForRead();
+            OctreeServer::trackTreeWaitTime((float)(usecTimestampNow() - lockWaitStart));
+        }
+
+        for (int i = 0; i < _batch.size(); i++) {
+            _batch[i].isStillSending = _batch[i].client->process();
+        }
+
+        if (wantTreeLock) {
+            _server->getOctree()->unlock();
+        }
+    }
+
+    _scheduler->finishClients(_batch);
+
+    return isStillRunning();
+}
+
+OctreeSendScheduler::OctreeSendScheduler(OctreeServer* server) :
+    _server(server),
+    _workers(),
+    _mutex(),
+    _clientDue(),
+    _clientFinished(),
+    _isStopping(false),
+    _scheduledClients(),
+    _claimedClients(),
+    _sumTreeLocks(0),
+    _sumClientsSent(0),
+    _sumLateClients(0)
+{
+}
+
+OctreeSendScheduler::~OctreeSendScheduler() {
+    stop();
+}
+
+void OctreeSendScheduler::start(int numWorkers) {
+    for (int i = 0; i < numWorkers; i++) {
+        OctreeSendWorker* worker = new OctreeSendWorker(_server, this);
+        worker->initialize(true);
+        _workers.append(worker);
+    }
+}
+
+void OctreeSendScheduler::stop() {
+    _mutex.lock();
+    _isStopping = true;
+    _clientDue.wakeAll();
+    _mutex.unlock();
+
+    foreach (OctreeSendWorker* worker, _workers) {
+        worker->terminate();
+        delete worker;
+    }
+    _workers.clear();
+}
+
+void OctreeSendScheduler::addClient(OctreeSendThread* client) {
+    QMutexLocker locker(&_mutex);
+
+    ScheduledOctreeClient scheduledClient = { usecTimestampNow(), client, true };
+    _scheduledClients.append(scheduledClient);
+    std::push_heap(_scheduledClients.begin(), _scheduledClients.end(), isDueLater);
+
+    _clientDue.wakeOne();
+}
+
+void OctreeSendScheduler::removeClient(OctreeSendThread* client) {
+    QMutexLocker locker(&_mutex);
+
+    // a claimed client goes back in line when its worker is done with it, so wait for that before taking it out
+    while (_claimedClients.contains(client)) {
+        _clientFinished.wait(&_mutex);
+    }
+
+    for (int i = 0; i < _scheduledClients.size(); i++) {
+        if (_scheduledClients[i].client == client) {
+            _scheduledClients.remove(i);
+            std::make_heap(_scheduledClients.begin(), _scheduledClients.end(), isDueLater);
+            break;
+        }
+    }
+}
+
+bool OctreeSendScheduler::claimDueClients(QVector<ScheduledOctreeClient>& batch) {
+    QMutexLocker locker(&_mutex);
+
+    batch.resize(0);
+
+    while (!_isStopping) {
+        if (_scheduledClients.isEmpty()) {
+            _clientDue.wait(&_mutex, IDLE_WORKER_WAIT_MSECS);
+            continue;
+        }
+
+        quint64 now = usecTimestampNow();
+        quint64 firstDeadline = _scheduledClients.first().deadline;
+        if (firstDeadline > now) {
+            // sleep until the first client is due, a client added or finished in the meantime wakes us up early
+            unsigned long msecsToWait = (firstDeadline - now + USECS_PER_MSEC - 1) / USECS_PER_MSEC;
+            _clientDue.wait(&_mutex, msecsToWait);
+            continue;
+        }
+
+        while (!_scheduledClients.isEmpty() && _scheduledClients.first().deadline <= now
+               && batch.size() < MAX_CLIENTS_PER_TREE_LOCK) {
+            std::pop_heap(_scheduledClients.begin(), _scheduledClients.end(), isDueLater);
+            batch.append(_scheduledClients.last());
+            _scheduledClients.removeLast();
+            _claimedClients.insert(batch.last().client);
+        }
+
+        ++_sumTreeLocks;
+        _sumClientsSent += batch.size();
+
+        // if there are more clients due than fit in this batch, another worker can take them
+        if (!_scheduledClients.isEmpty() && _scheduledClients.first().deadline <= now) {
+            _clientDue.wakeOne();
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void OctreeSendScheduler::finishClients(const QVector<ScheduledOctreeClient>& batch) {
+    QMutexLocker locker(&_mutex);
+
+    quint64 now = usecTimestampNow();
+
+    foreach (const ScheduledOctreeClient& finishedClient, batch) {
+        _claimedClients.remove(finishedClient.client);
+
+        if (!finishedClient.isStillSending) {
+            continue;
+        }
+
+        // keep to the client's cadence, unless we fell a whole interval behind, in which case we start over from now
+        ScheduledOctreeClient scheduledClient = finishedClient;
+        scheduledClient.deadline += OCTREE_SEND_INTERVAL_USECS;
+        if (scheduledClient.deadline < now) {
+            scheduledClient.deadline = now;
+            ++_sumLateClients;
+        }
+
+        _scheduledClients.append(scheduledClient);
+        std::push_heap(_scheduledClients.begin(), _scheduledClients.end(), isDueLater);
+    }
+
+    _clientFinished.wakeAll();
+    _clientDue.wakeOne();
+}
+
+void OctreeSendScheduler::resetStats() {
+    QMutexLocker locker(&_mutex);
+
+    _sumTreeLocks = 0;
+    _sumClientsSent = 0;
+    _sumLateClients = 0;
+}
@@ -0,0 +1,103 @@
+//
+//  OctreeSendScheduler.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Fixed pool of threads that send octree packets to every client of an OctreeServer
+//
+
+#ifndef __octree_server__OctreeSendScheduler__
+#define __octree_server__OctreeSendScheduler__
+
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+
+#include <GenericThread.h>
+
+class OctreeSendScheduler;
+class OctreeSendThread;
+class OctreeServer;
+
+/// the most clients a worker sends to under one read lock of the tree, so that edits never wait on more than this many
+const int MAX_CLIENTS_PER_TREE_LOCK = 8;
+
+/// A client that is due to be sent to at its deadline, which moves on by one interval every time it is sent to.
+struct ScheduledOctreeClient {
+    quint64 deadline;
+    OctreeSendThread* client;
+    bool isStillSending;
+};
+
+/// One thread of the OctreeSendScheduler's pool.
+class OctreeSendWorker : public GenericThread {
+    Q_OBJECT
+public:
+    OctreeSendWorker(OctreeServer* server, OctreeSendScheduler* scheduler);
+
+protected:
+    /// sends to the next clients that are due, with the tree locked for reading once for all of them, unless the server
+    /// has snapshots
+    virtual bool process();
+
+private:
+    OctreeServer* _server;
+    OctreeSendScheduler* _scheduler;
+    QVector<ScheduledOctreeClient> _batch;
+};
+
+/// Hands the clients of an OctreeServer to a fixed number of worker threads, earliest deadline first, instead of giving
+/// each client a thread of its own that sleeps between intervals.
+class OctreeSendScheduler {
+public:
+    OctreeSendScheduler(OctreeServer* server);
+    ~OctreeSendScheduler();
+
+    void start(int numWorkers);
+
+    /// wakes any waiting workers and waits for all of them to exit
+    void stop();
+
+    int getNumWorkers() const { return _workers.size(); }
+
+    /// schedules a new client to be sent to right away and then once every interval
+    void addClient(OctreeSendThread* client);
+
+    /// stops scheduling a client, waiting for a worker that is sending to it to finish first
+    void removeClient(OctreeSendThread* client);
+
+    /// waits until at least one client is due and claims up to MAX_CLIENTS_PER_TREE_LOCK of the ones that are
+    /// \return false if the scheduler is stopping and the worker should exit
+    bool claimDueClients(QVector<ScheduledOctreeClient>& batch);
+
+    /// puts the claimed clients that are still sending back in line for their next interval
+    void finishClients(const QVector<ScheduledOctreeClient>& batch);
+
+    int getSumTreeLocks() const { return _sumTreeLocks; }
+    int getSumClientsSent() const { return _sumClientsSent; }
+    int getSumLateClients() const { return _sumLateClients; }
+    void resetStats();
+
+private:
+    OctreeServer* _server;
+
+    QVector<OctreeSendWorker*> _workers;
+
+    QMutex _mutex;
+    QWaitCondition _clientDue;
+    QWaitCondition _clientFinished;
+    bool _isStopping;
+
+    // a heap, with the client that is due first at the front
+    QVector<ScheduledOctreeClient> _scheduledClients;
+    QSet<OctreeSendThread*> _claimedClients;
+
+    int _sumTreeLocks;
+    int _sumClientsSent;
+    int _sumLateClients;
+};
+
+#endif // __octree_server__OctreeSendScheduler__
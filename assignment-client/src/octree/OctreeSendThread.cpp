@@ -9,9 +9,9 @@
 
 #include <NodeList.h>
 #include <PacketHeaders.h>
-#include <PerfStat.h>
 #include <SharedUtil.h>
 
+#include "OctreeSendScheduler.h"
 #include "OctreeSendThread.h"
 #include "OctreeServer.h"
 #include "OctreeServerConsts.h"
@@ -24,17 +24,18 @@ OctreeSendThread::OctreeSendThread(OctreeServer* myServer, SharedNodePointer nod
     _nodeUUID(node->getUUID()),
     _packetData(),
     _nodeMissingCount(0),
-    _processLock(),
-    _isShuttingDown(false)
+    _isShuttingDown(false),
+    _snapshotIndex(-1)
 {
     QString safeServerName("Octree");
     if (_myServer) {
         safeServerName = _myServer->getMyServerName();
     }
     qDebug() << qPrintable(safeServerName)  << "server [" << _myServer << "]: client connected "
-                                            "- starting sending thread [" << this << "]";
+                                            "- scheduling sender [" << this << "]";
 
     OctreeServer::clientConnected();
+    _myServer->getSendScheduler()->addClient(this);
 }
 
 OctreeSendThread::~OctreeSendThread() { 
@@ -43,16 +44,23 @@ OctreeSendThread::~OctreeSendThread() {
         safeServerName = _myServer->getMyServerName();
     }
     qDebug() << qPrintable(safeServerName)  << "server [" << _myServer << "]: client disconnected "
-                                            "- ending sending thread [" << this << "]";
+                                            "- ending sender [" << this << "]";
     OctreeServer::clientDisconnected();
 }
 
 void OctreeSendThread::setIsShuttingDown() {
+    if (_isShuttingDown) {
+        return;
+    }
+    
     _isShuttingDown = true;
     OctreeServer::stopTrackingThread(this);
     
-    // this will cause us to wait till the process loop is complete, we do this after we change _isShuttingDown
-    QMutexLocker locker(&_processLock); 
+    // this will cause us to wait till a worker sending to us is done, we do this after we change _isShuttingDown
+    _myServer->getSendScheduler()->removeClient(this);
+
+    // no worker will send to us anymore, so the writer doesn't have to wait for us either
+    unpinSnapshot();
 }
 
 
@@ -63,73 +71,77 @@ bool OctreeSendThread::process() {
 
     OctreeServer::didProcess(this);
 
-    float lockWaitElapsedUsec = OctreeServer::SKIP_TIME;
-    quint64 lockWaitStart = usecTimestampNow();
-    _processLock.lock();
-    quint64 lockWaitEnd = usecTimestampNow();
-    lockWaitElapsedUsec = (float)(lockWaitEnd - lockWaitStart);
-    OctreeServer::trackProcessWaitTime(lockWaitElapsedUsec);
-    
-    quint64  start = usecTimestampNow();
-
-    // don't do any send processing until the initial load of the octree is complete...
-    if (_myServer->isInitialLoadComplete()) {
-        SharedNodePointer node = NodeList::getInstance()->nodeWithUUID(_nodeUUID, false);
-        if (node) {
-            _nodeMissingCount = 0;
-            OctreeQueryNode* nodeData = static_cast<OctreeQueryNode*>(node->getLinkedData());
-
-            // Sometimes the node data has not yet been linked, in which case we can't really do anything
-            if (nodeData && !nodeData->isShuttingDown()) {
-                bool viewFrustumChanged = nodeData->updateCurrentViewFrustum();
-                packetDistributor(node, nodeData, viewFrustumChanged);
+    SharedNodePointer node = NodeList::getInstance()->nodeWithUUID(_nodeUUID, false);
+    if (node) {
+        _nodeMissingCount = 0;
+        OctreeQueryNode* nodeData = static_cast<OctreeQueryNode*>(node->getLinkedData());
+
+        // Sometimes the node data has not yet been linked, in which case we can't really do anything
+        if (nodeData && !nodeData->isShuttingDown()) {
+            Octree* tree = _myServer->getOctree();
+            if (_myServer->getSnapshots()) {
+                tree = pinPublishedSnapshot(nodeData);
             }
-        } else {
-            _nodeMissingCount++;
-            const int MANY_FAILED_LOCKS = 1;
-            if (_nodeMissingCount >= MANY_FAILED_LOCKS) {
 
-                QString safeServerName("Octree");
-                if (_myServer) {
-                    safeServerName = _myServer->getMyServerName();
-                }
-                
-                qDebug() << qPrintable(safeServerName)  << "server: sending thread [" << this << "]"
-                        << "failed to get nodeWithUUID() " << _nodeUUID <<". Failed:" << _nodeMissingCount << "times";
+            bool viewFrustumChanged = nodeData->updateCurrentViewFrustum();
+            packetDistributor(node, nodeData, viewFrustumChanged, tree);
+
+            // hold on to the snapshot only while there is more of it to send
+            if (nodeData->nodeBag.isEmpty()) {
+                unpinSnapshot();
             }
+        } else {
+            unpinSnapshot();
+        }
+    } else {
+        unpinSnapshot();
+        _nodeMissingCount++;
+        const int MANY_FAILED_LOCKS = 1;
+        if (_nodeMissingCount >= MANY_FAILED_LOCKS) {
+
+            QString safeServerName("Octree");
+            if (_myServer) {
+                safeServerName = _myServer->getMyServerName();
+            }
+            
+            qDebug() << qPrintable(safeServerName)  << "server: sender [" << this << "]"
+                    << "failed to get nodeWithUUID() " << _nodeUUID <<". Failed:" << _nodeMissingCount << "times";
         }
     }
 
-    _processLock.unlock();
-    
-    if (_isShuttingDown) {
-        return false; // exit early if we're shutting down
-    }
+    return !_isShuttingDown;
+}
 
-    // Only sleep if we're still running and we got the lock last time we tried, otherwise try to get the lock asap
-    if (isStillRunning()) {
-        // dynamically sleep until we need to fire off the next set of octree elements
-        int elapsed = (usecTimestampNow() - start);
-        int usecToSleep =  OCTREE_SEND_INTERVAL_USECS - elapsed;
+Octree* OctreeSendThread::pinPublishedSnapshot(OctreeQueryNode* nodeData) {
+    OctreeSnapshots* snapshots = _myServer->getSnapshots();
 
-        if (usecToSleep > 0) {
-            PerformanceWarning warn(false,"OctreeSendThread... usleep()",false,&_usleepTime,&_usleepCalls);
-            usleep(usecToSleep);
-        } else {
-            const int MIN_USEC_TO_SLEEP = 1;
-            usleep(MIN_USEC_TO_SLEEP);
-        }
+    if (_snapshotIndex < 0) {
+        _snapshotIndex = snapshots->pinPublished();
+
+        // the writer never deletes elements from a pinned snapshot, so the bag doesn't need to hear about deletes, which
+        // it couldn't safely do while we use it anyway. Whatever is left in it is from a snapshot we let go of.
+        OctreeElement::removeDeleteHook(&nodeData->nodeBag);
+        nodeData->nodeBag.deleteAll();
+    } else if (!snapshots->isPublished(_snapshotIndex)) {
+        // carry on with the rest of the scene from the newer snapshot, so that the writer doesn't wait on us
+        _snapshotIndex = snapshots->movePinToPublished(_snapshotIndex, nodeData->nodeBag);
     }
 
-    return isStillRunning();  // keep running till they terminate us
+    return snapshots->getTree(_snapshotIndex);
 }
 
-quint64 OctreeSendThread::_usleepTime = 0;
-quint64 OctreeSendThread::_usleepCalls = 0;
+void OctreeSendThread::unpinSnapshot() {
+    if (_snapshotIndex >= 0) {
+        _myServer->getSnapshots()->unpin(_snapshotIndex);
+        _snapshotIndex = -1;
+    }
+}
 
 quint64 OctreeSendThread::_totalBytes = 0;
 quint64 OctreeSendThread::_totalWastedBytes = 0;
 quint64 OctreeSendThread::_totalPackets = 0;
+quint64 OctreeSendThread::_totalEncodeCacheHits = 0;
+quint64 OctreeSendThread::_totalEncodeCacheMisses = 0;
 
 int OctreeSendThread::handlePacketSend(const SharedNodePointer& node, 
                         OctreeQueryNode* nodeData, int& trueBytesSent, int& truePacketsSent) {
@@ -265,7 +277,8 @@ int OctreeSendThread::handlePacketSend(const SharedNodePointer& node,
 }
 
 /// Version of voxel distributor that sends the deepest LOD level at once
-int OctreeSendThread::packetDistributor(const SharedNodePointer& node, OctreeQueryNode* nodeData, bool viewFrustumChanged) {
+int OctreeSendThread::packetDistributor(const SharedNodePointer& node, OctreeQueryNode* nodeData, bool viewFrustumChanged,
+                                        Octree* tree) {
     OctreeServer::didPacketDistributor(this);
 
     // if shutting down, exit early
@@ -326,9 +339,15 @@ int OctreeSendThread::packetDistributor(const SharedNodePointer& node, OctreeQue
             nodeData->setLastTimeBagEmpty(now);
         }
 
+        // the scene's encode cache counts are reset when the next scene starts, so only add them once
+        if (nodeData->stats.getIsSceneStarted()) {
+            _totalEncodeCacheHits += nodeData->stats.getEncodeCacheHits();
+            _totalEncodeCacheMisses += nodeData->stats.getEncodeCacheMisses();
+        }
+
         // track completed scenes and send out the stats packet accordingly
         nodeData->stats.sceneCompleted();
-        nodeData->setLastRootTimestamp(_myServer->getOctree()->getRoot()->getLastChanged());
+        nodeData->setLastRootTimestamp(tree->getRoot()->getLastChanged());
 
         // TODO: add these to stats page
         //::endSceneSleepTime = _usleepTime;
@@ -348,16 +367,16 @@ int OctreeSendThread::packetDistributor(const SharedNodePointer& node, OctreeQue
         //::startSceneSleepTime = _usleepTime;
         
         // start tracking our stats
-        nodeData->stats.sceneStarted(isFullScene, viewFrustumChanged, _myServer->getOctree()->getRoot(), _myServer->getJurisdiction());
+        nodeData->stats.sceneStarted(isFullScene, viewFrustumChanged, tree->getRoot(), _myServer->getJurisdiction());
 
         // This is the start of "resending" the scene.
         bool dontRestartSceneOnMove = false; // this is experimental
         if (dontRestartSceneOnMove) {
             if (nodeData->nodeBag.isEmpty()) {
-                nodeData->nodeBag.insert(_myServer->getOctree()->getRoot()); // only in case of empty
+                nodeData->nodeBag.insert(tree->getRoot()); // only in case of empty
             }
         } else {
-            nodeData->nodeBag.insert(_myServer->getOctree()->getRoot()); // original behavior, reset on move or empty
+            nodeData->nodeBag.insert(tree->getRoot()); // original behavior, reset on move or empty
         }
     }
 
@@ -376,7 +395,6 @@ int OctreeSendThread::packetDistributor(const SharedNodePointer& node, OctreeQue
         int extraPackingAttempts = 0;
         bool completedScene = false;
         while (somethingToSend && packetsSentThisInterval < maxPacketsPerInterval && !nodeData->isShuttingDown()) {
-            float lockWaitElapsedUsec = OctreeServer::SKIP_TIME;
             float encodeElapsedUsec = OctreeServer::SKIP_TIME;
             float compressAndWriteElapsedUsec = OctreeServer::SKIP_TIME;
             float packetSendingElapsedUsec = OctreeServer::SKIP_TIME;
@@ -423,18 +441,12 @@ int OctreeSendThread::packetDistributor(const SharedNodePointer& node, OctreeQue
                                              nodeData->getLastTimeBagEmpty(),
                                              isFullScene, &nodeData->stats, _myServer->getJurisdiction());
 
-                // TODO: should this include the lock time or not? This stat is sent down to the client,
-                // it seems like it may be a good idea to include the lock time as part of the encode time
-                // are reported to client. Since you can encode without the lock
+                // the worker that called us already holds the tree's read lock for all of the clients it is sending to,
+                // or we have the snapshot pinned
                 nodeData->stats.encodeStarted();
                 
-                quint64 lockWaitStart = usecTimestampNow();
-                _myServer->getOctree()->lockForRead();
-                quint64 lockWaitEnd = usecTimestampNow();
-                lockWaitElapsedUsec = (float)(lockWaitEnd - lockWaitStart);
-
                 quint64 encodeStart = usecTimestampNow();
-                bytesWritten = _myServer->getOctree()->encodeTreeBitstream(subTree, &_packetData, nodeData->nodeBag, params);
+                bytesWritten = tree->encodeTreeBitstream(subTree, &_packetData, nodeData->nodeBag, params);
                 quint64 encodeEnd = usecTimestampNow();
                 encodeElapsedUsec = (float)(encodeEnd - encodeStart);
                 
@@ -460,7 +472,6 @@ int OctreeSendThread::packetDistributor(const SharedNodePointer& node, OctreeQue
                 }
 
                 nodeData->stats.encodeStopped();
-                _myServer->getOctree()->unlock();
             } else {
                 // If the bag was empty then we didn't even attempt to encode, and so we know the bytesWritten were 0
                 bytesWritten = 0;
@@ -528,7 +539,6 @@ int OctreeSendThread::packetDistributor(const SharedNodePointer& node, OctreeQue
                 _packetData.changeSettings(nodeData->getWantCompression(), targetSize); // will do reset
 
             }
-            OctreeServer::trackTreeWaitTime(lockWaitElapsedUsec);
             OctreeServer::trackEncodeTime(encodeElapsedUsec);
             OctreeServer::trackCompressAndWriteTime(compressAndWriteElapsedUsec);
             OctreeServer::trackPacketSendingTime(packetSendingElapsedUsec);
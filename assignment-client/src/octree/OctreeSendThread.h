@@ -4,51 +4,61 @@
 //  Created by Brad Hefta-Gaub on 8/21/13
 //  Copyright (c) 2013 High Fidelity, Inc. All rights reserved.
 //
-//  Threaded or non-threaded object for sending voxels to a client
+//  Object for sending voxels to a client, run by the OctreeServer's OctreeSendScheduler
 //
 
 #ifndef __octree_server__OctreeSendThread__
 #define __octree_server__OctreeSendThread__
 
-#include <GenericThread.h>
+#include <QtCore/QObject>
+
 #include <NetworkPacket.h>
 #include <OctreeElementBag.h>
 #include "OctreeQueryNode.h"
 #include "OctreeServer.h"
 
 
-/// Threaded processor for sending voxel packets to a single client
-class OctreeSendThread : public GenericThread {
+/// Sends voxel packets to a single client, one interval at a time, whenever a worker of the OctreeSendScheduler
+/// gets to it
+class OctreeSendThread : public QObject {
     Q_OBJECT
 public:
     OctreeSendThread(OctreeServer* myServer, SharedNodePointer node);
     virtual ~OctreeSendThread();
     
+    /// stops the scheduler from sending to us, waiting for a send that is in progress to finish
     void setIsShuttingDown();
 
+    /// sends this interval's packets to the client, must be called with the server's tree locked for reading, unless
+    /// the server has snapshots, in which case we send from the one we pinned
+    /// \return false once the client is shutting down and should no longer be scheduled
+    bool process();
+
     static quint64 _totalBytes;
     static quint64 _totalWastedBytes;
     static quint64 _totalPackets;
-
-    static quint64 _usleepTime;
-    static quint64 _usleepCalls;
-
-protected:
-    /// Implements generic processing behavior for this thread.
-    virtual bool process();
+    static quint64 _totalEncodeCacheHits;
+    static quint64 _totalEncodeCacheMisses;
 
 private:
     OctreeServer* _myServer;
     QUuid _nodeUUID;
 
     int handlePacketSend(const SharedNodePointer& node, OctreeQueryNode* nodeData, int& trueBytesSent, int& truePacketsSent);
-    int packetDistributor(const SharedNodePointer& node, OctreeQueryNode* nodeData, bool viewFrustumChanged);
+    int packetDistributor(const SharedNodePointer& node, OctreeQueryNode* nodeData, bool viewFrustumChanged,
+                          Octree* tree);
+
+    /// pins the published snapshot, moving what is left in the bag over to it if we had pinned the one before
+    Octree* pinPublishedSnapshot(OctreeQueryNode* nodeData);
+    void unpinSnapshot();
 
     OctreePacketData _packetData;
     
     int _nodeMissingCount;
-    QMutex _processLock; // don't allow us to have our nodeData, or our thread to be deleted while we're processing
     bool _isShuttingDown;
+
+    // the snapshot we send from until the bag is empty, -1 if none is pinned
+    int _snapshotIndex;
 };
 
 #endif // __octree_server__OctreeSendThread__
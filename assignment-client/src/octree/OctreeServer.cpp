@@ -8,12 +8,14 @@
 
 #include <QJsonObject>
 #include <QNetworkAccessManager>
+#include <QThread>
 #include <QTimer>
 #include <QUuid>
 
 #include <time.h>
 #include <HTTPConnection.h>
 #include <Logging.h>
+#include <OctreeEncodeCache.h>
 #include <UUID.h>
 
 #include "OctreeServer.h"
@@ -220,6 +222,9 @@ OctreeServer::OctreeServer(const QByteArray& packet) :
     _packetsPerClientPerInterval(10),
     _packetsTotalPerInterval(DEFAULT_PACKETS_PER_INTERVAL),
     _tree(NULL),
+    _snapshotTree(NULL),
+    _snapshots(NULL),
+    _editJournal(NULL),
     _wantPersist(true),
     _debugSending(false),
     _debugReceiving(false),
@@ -228,6 +233,7 @@ OctreeServer::OctreeServer(const QByteArray& packet) :
     _jurisdictionSender(NULL),
     _octreeInboundPacketProcessor(NULL),
     _persistThread(NULL),
+    _sendScheduler(NULL),
     _started(time(0)),
     _startedUSecs(usecTimestampNow())
 {
@@ -260,6 +266,19 @@ OctreeServer::~OctreeServer() {
         _persistThread->deleteLater();
     }
 
+    if (_sendScheduler) {
+        _sendScheduler->stop();
+        delete _sendScheduler;
+        _sendScheduler = NULL;
+    }
+
+    delete _editJournal;
+    _editJournal = NULL;
+    delete _snapshots;
+    _snapshots = NULL;
+    delete _snapshotTree;
+    _snapshotTree = NULL;
+
     delete _jurisdiction;
     _jurisdiction = NULL;
     qDebug() << qPrintable(_safeServerName) << "server DONE shutting down... [" << this << "]";
@@ -362,6 +381,45 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += QString("        Configured Max PPS/Server: %1 pps/server\r\n\r\n")
             .arg(locale.toString((uint)getPacketsTotalPerSecond()).rightJustified(COLUMN_WIDTH, ' '));
 
+        // display persistence stats
+        if (_persistThread) {
+            quint64 saves = _persistThread->getSaves();
+            quint64 saveUsecs = _persistThread->getSaveUsecs();
+            quint64 replayUsecs = _persistThread->getReplayUsecs();
+            const quint64 BYTES_PER_KB = 1024;
+
+            statsString += "<b>Persistence:</b>\r\n";
+            statsString += QString("                      Total Saves: %1 saves\r\n")
+                .arg(locale.toString((uint)saves).rightJustified(COLUMN_WIDTH, ' '));
+            statsString += QString("                Average Save Time: %1 usecs\r\n")
+                .arg(locale.toString((uint)(saves > 0 ? saveUsecs / saves : 0)).rightJustified(COLUMN_WIDTH, ' '));
+            statsString += QString("                  Save Throughput: %1 KB/s\r\n")
+                .arg(locale.toString((uint)(saveUsecs > 0 ? _persistThread->getSaveBytes() * USECS_PER_SECOND
+                                            / saveUsecs / BYTES_PER_KB : 0)).rightJustified(COLUMN_WIDTH, ' '));
+
+            if (_editJournal) {
+                quint64 packetsAppended = _editJournal->getPacketsAppended();
+                quint64 flushes = _editJournal->getFlushes();
+                quint64 packetsReplayed = _persistThread->getPacketsReplayed();
+
+                statsString += QString("           Journaled Edit Packets: %1 packets\r\n")
+                    .arg(locale.toString((uint)packetsAppended).rightJustified(COLUMN_WIDTH, ' '));
+                statsString += QString("             Journaled Edit Bytes: %1 bytes\r\n")
+                    .arg(locale.toString((uint)_editJournal->getBytesAppended()).rightJustified(COLUMN_WIDTH, ' '));
+                statsString += QString("       Average Journal Flush Time: %1 usecs\r\n")
+                    .arg(locale.toString((uint)(flushes > 0 ? _editJournal->getFlushUsecs() / flushes : 0))
+                         .rightJustified(COLUMN_WIDTH, ' '));
+                statsString += QString("          Journal Since Last Save: %1 bytes\r\n")
+                    .arg(locale.toString((uint)_editJournal->getCurrentBytes()).rightJustified(COLUMN_WIDTH, ' '));
+                statsString += QString("              Replayed At Startup: %1 packets\r\n")
+                    .arg(locale.toString((uint)packetsReplayed).rightJustified(COLUMN_WIDTH, ' '));
+                statsString += QString("                Replay Throughput: %1 packets/s\r\n")
+                    .arg(locale.toString((uint)(replayUsecs > 0 ? packetsReplayed * USECS_PER_SECOND / replayUsecs : 0))
+                         .rightJustified(COLUMN_WIDTH, ' '));
+            }
+            statsString += "\r\n";
+        }
+
 
         // display scene stats
         unsigned long nodeCount = OctreeElement::getNodeCount();
@@ -592,6 +650,37 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
             locale.toString((uint)totalBytesOfColor).rightJustified(COLUMN_WIDTH, ' ').toLocal8Bit().constData(),
             ((float)totalBytesOfColor / (float)totalOutboundBytes) * AS_PERCENT);
 
+        if (_tree->getEncodeCache()) {
+            quint64 totalEncodeCacheHits = OctreeSendThread::_totalEncodeCacheHits;
+            quint64 totalEncodeCacheLookups = totalEncodeCacheHits + OctreeSendThread::_totalEncodeCacheMisses;
+            float encodeCacheHitRate = totalEncodeCacheLookups == 0 ? 0.0f
+                : ((float)totalEncodeCacheHits / (float)totalEncodeCacheLookups) * AS_PERCENT;
+
+            // with snapshots, the clients are sent from both copies of the tree, and each has its own cache
+            OctreeEncodeCache* encodeCache = _tree->getEncodeCache();
+            int cachedSubtrees = encodeCache->getSubtreeCount();
+            int cachedBytes = encodeCache->getBytes();
+            quint64 cacheClears = encodeCache->getClears();
+            if (_snapshotTree && _snapshotTree->getEncodeCache()) {
+                cachedSubtrees += _snapshotTree->getEncodeCache()->getSubtreeCount();
+                cachedBytes += _snapshotTree->getEncodeCache()->getBytes();
+                cacheClears += _snapshotTree->getEncodeCache()->getClears();
+            }
+
+            statsString += "\r\n";
+            statsString += QString().sprintf("           Encode Cache Subtrees: %s hits (%5.2f%%)\r\n",
+                locale.toString((uint)totalEncodeCacheHits).rightJustified(COLUMN_WIDTH, ' ').toLocal8Bit().constData(),
+                encodeCacheHitRate);
+            statsString += QString("                                   %1 misses\r\n")
+                .arg(locale.toString((uint)(totalEncodeCacheLookups - totalEncodeCacheHits)).rightJustified(COLUMN_WIDTH, ' '));
+            statsString += QString("                                   %1 cached\r\n")
+                .arg(locale.toString((uint)cachedSubtrees).rightJustified(COLUMN_WIDTH, ' '));
+            statsString += QString("                Encode Cache Size: %1 bytes\r\n")
+                .arg(locale.toString((uint)cachedBytes).rightJustified(COLUMN_WIDTH, ' '));
+            statsString += QString("              Encode Cache Clears: %1 clears\r\n")
+                .arg(locale.toString((uint)cacheClears).rightJustified(COLUMN_WIDTH, ' '));
+        }
+
         statsString += "\r\n";
         statsString += "\r\n";
 
@@ -624,6 +713,36 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += QString("  Average Wait Lock Time/Element: %1 usecs\r\n")
             .arg(locale.toString((uint)averageLockWaitTimePerElement).rightJustified(COLUMN_WIDTH, ' '));
 
+        // edits are applied in batches, one write lock of the tree for all the edit packets that came in together
+        statsString += QString("              Total Edit Batches: %1 batches\r\n")
+            .arg(locale.toString((uint)_octreeInboundPacketProcessor->getTotalEditBatches()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString().sprintf("   Average Inbound Elements/Batch: %f elements/batch\r\n",
+                                         _octreeInboundPacketProcessor->getAverageEditsPerBatch());
+        statsString += QString("           Average Batch Latency: %1 usecs\r\n")
+            .arg(locale.toString((uint)_octreeInboundPacketProcessor->getAverageBatchLatency()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("    Average Batch Lock Hold Time: %1 usecs\r\n")
+            .arg(locale.toString((uint)_octreeInboundPacketProcessor->getAverageBatchLockHoldTime())
+                 .rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("        Max Batch Lock Hold Time: %1 usecs\r\n")
+            .arg(locale.toString((uint)_octreeInboundPacketProcessor->getMaxBatchLockHoldTime())
+                 .rightJustified(COLUMN_WIDTH, ' '));
+
+        // how far behind the inbound queue gets in bursts, and how long packets wait in it
+        const Histogram& queueDepths = _octreeInboundPacketProcessor->getQueueDepthHistogram();
+        const Histogram& queueWaitTimes = _octreeInboundPacketProcessor->getQueueWaitTimeHistogram();
+        statsString += QString("      Inbound Queue Depth 50/99%: %1 / %2 packets\r\n")
+            .arg(locale.toString((uint)queueDepths.getPercentile(0.5f)))
+            .arg(locale.toString((uint)queueDepths.getPercentile(0.99f)));
+        statsString += QString("         Max Inbound Queue Depth: %1 packets\r\n")
+            .arg(locale.toString((uint)queueDepths.getMax()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("  Inbound Queue Wait Time 50/99%: %1 / %2 usecs\r\n")
+            .arg(locale.toString((uint)queueWaitTimes.getPercentile(0.5f)))
+            .arg(locale.toString((uint)queueWaitTimes.getPercentile(0.99f)));
+        statsString += QString("     Max Inbound Queue Wait Time: %1 usecs\r\n")
+            .arg(locale.toString((uint)queueWaitTimes.getMax()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("   Inbound Queue Depth Histogram: %1\r\n").arg(queueDepths.toString());
+        statsString += QString("Inbound Queue Wait Time Histogram: %1\r\n").arg(queueWaitTimes.toString());
+
 
         int senderNumber = 0;
         NodeToSenderStatsMap& allSenderStats = _octreeInboundPacketProcessor->getSingleSenderStats();
@@ -694,6 +813,16 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
                                          OctreeElement::getTotalMemoryUsage() / memoryScale, memoryScaleLabel);
         statsString += "\r\n";
 
+        quint64 elementPoolBytes = OctreeElement::getElementPoolMemoryUsage();
+        quint64 childrenPoolBytes = OctreeElement::getExternalChildrenPoolMemoryUsage();
+        statsString += QString().sprintf("Element Pool Memory:             %8.2f %s (%5.2f%% in use)\r\n",
+            elementPoolBytes / memoryScale, memoryScaleLabel, elementPoolBytes > 0 ?
+            ((float)OctreeElement::getElementPoolMemoryInUse() / (float)elementPoolBytes) * AS_PERCENT : 0.0f);
+        statsString += QString().sprintf("External Children Pool Memory:   %8.2f %s (%5.2f%% in use)\r\n",
+            childrenPoolBytes / memoryScale, memoryScaleLabel, childrenPoolBytes > 0 ?
+            ((float)OctreeElement::getExternalChildrenPoolMemoryInUse() / (float)childrenPoolBytes) * AS_PERCENT : 0.0f);
+        statsString += "\r\n";
+
         statsString += "OctreeElement Children Population Statistics...\r\n";
         checkSum = 0;
         for (int i=0; i <= NUMBER_OF_CHILDREN; i++) {
@@ -801,12 +930,14 @@ void OctreeServer::parsePayload() {
 }
 
 void OctreeServer::readPendingDatagrams() {
+    PacketBuffer receivedDatagram;
     QByteArray receivedPacket;
     HifiSockAddr senderSockAddr;
     
     NodeList* nodeList = NodeList::getInstance();
     
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
+    while (readAvailableDatagram(receivedDatagram, senderSockAddr)) {
+        receivedDatagram.asByteArray(receivedPacket);
         if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
             PacketType packetType = packetTypeForPacket(receivedPacket);
             
@@ -839,9 +970,9 @@ void OctreeServer::readPendingDatagrams() {
                     }
                 }
             } else if (packetType == PacketTypeJurisdictionRequest) {
-                _jurisdictionSender->queueReceivedPacket(matchingNode, receivedPacket);
+                _jurisdictionSender->queueReceivedPacket(matchingNode, receivedDatagram);
             } else if (_octreeInboundPacketProcessor && getOctree()->handlesEditPacketType(packetType)) {
-                _octreeInboundPacketProcessor->queueReceivedPacket(matchingNode, receivedPacket);
+                _octreeInboundPacketProcessor->queueReceivedPacket(matchingNode, receivedDatagram);
             } else {
                 // let processNodeData handle it.
                 NodeList::getInstance()->processNodeData(senderSockAddr, receivedPacket);
@@ -950,6 +1081,31 @@ void OctreeServer::run() {
     }
     qDebug("wantPersist=%s", debug::valueOf(_wantPersist));
 
+    // Keep a second copy of the tree, so that clients and persistence are served from a published copy without locking
+    // it while edits go to the other. This only works for trees that can apply the same edits to both copies.
+    const char* SNAPSHOT_READS = "--snapshotReads";
+    if (cmdOptionExists(_argc, _argv, SNAPSHOT_READS)) {
+        if (_tree->canReplayEdits()) {
+            _snapshotTree = createTree();
+            _snapshots = new OctreeSnapshots(_tree, _snapshotTree);
+        } else {
+            qDebug("snapshotReads ignored, the %s server can't apply its edits to two trees", getMyServerName());
+        }
+    }
+    qDebug("snapshotReads=%s", debug::valueOf(_snapshots != NULL));
+
+    // By default subtrees that were encoded for one client are kept to be sent to the next client that sees them at the
+    // same level of detail, if the tree can tell when they've changed. If you want every scene encoded from the tree, then
+    // pass in this parameter
+    const char* NO_ENCODE_CACHE = "--NoEncodeCache";
+    if (!cmdOptionExists(_argc, _argv, NO_ENCODE_CACHE) && _tree->canCacheEncodedSubtrees()) {
+        _tree->setWantEncodeCache(true);
+        if (_snapshotTree) {
+            _snapshotTree->setWantEncodeCache(true);
+        }
+    }
+    qDebug("encodeCache=%s", debug::valueOf(_tree->getEncodeCache() != NULL));
+
     // if we want Persistence, set up the local file and persist thread
     if (_wantPersist) {
 
@@ -964,9 +1120,19 @@ void OctreeServer::run() {
 
         qDebug("persistFilename=%s", _persistFilename);
 
+        // By default the edits are journaled, and the file is only rewritten once in a while, if the tree can replay them.
+        // If you want to rewrite the file after edits every time instead, then pass in this parameter
+        const char* NO_EDIT_JOURNAL = "--NoEditJournal";
+        if (!cmdOptionExists(_argc, _argv, NO_EDIT_JOURNAL) && _tree->canReplayEdits()) {
+            _editJournal = new OctreeEditJournal(_persistFilename);
+        }
+        qDebug("editJournal=%s", debug::valueOf(_editJournal != NULL));
+
         // now set up PersistThread
         _persistThread = new OctreePersistThread(_tree, _persistFilename);
         if (_persistThread) {
+            _persistThread->setSnapshots(_snapshots);
+            _persistThread->setEditJournal(_editJournal);
             _persistThread->initialize(true);
         }
     }
@@ -1006,6 +1172,19 @@ void OctreeServer::run() {
     qDebug("packetsPerSecondTotalMax=%s _packetsTotalPerInterval=%d", 
                     packetsPerSecondTotalMax, _packetsTotalPerInterval);
 
+    // Check to see if the user passed in a command line option for the number of threads sending to clients
+    int sendThreads = std::max(1, QThread::idealThreadCount());
+    const char* SEND_THREADS = "--sendThreads";
+    const char* sendThreadsOption = getCmdOption(_argc, _argv, SEND_THREADS);
+    if (sendThreadsOption) {
+        sendThreads = std::max(1, atoi(sendThreadsOption));
+    }
+    qDebug("sendThreads=%d", sendThreads);
+
+    // every client is sent to from this one pool of threads
+    _sendScheduler = new OctreeSendScheduler(this);
+    _sendScheduler->start(sendThreads);
+
     HifiSockAddr senderSockAddr;
 
     // set up our jurisdiction broadcaster...
@@ -1188,6 +1367,26 @@ void OctreeServer::sendStatsPacket() {
     statsObject1[baseName + QString(".0.6.threads.4.writeDatagram")] = 
         (double)howManyThreadsDidCallWriteDatagram(oneSecondAgo);    
     
+    if (_sendScheduler) {
+        int treeLocks = _sendScheduler->getSumTreeLocks();
+        statsObject1[baseName + QString(".0.7.sendWorkers.1.count")] = _sendScheduler->getNumWorkers();
+        statsObject1[baseName + QString(".0.7.sendWorkers.2.avgClientsPerTreeLock")] =
+            treeLocks > 0 ? (double)_sendScheduler->getSumClientsSent() / treeLocks : 0.0;
+        statsObject1[baseName + QString(".0.7.sendWorkers.3.lateClientIntervals")] =
+            (double)_sendScheduler->getSumLateClients();
+        _sendScheduler->resetStats();
+    }
+
+    if (_snapshots) {
+        quint64 publishes = _snapshots->getSumPublishes();
+        statsObject1[baseName + QString(".0.8.snapshots.1.publishes")] = (double)publishes;
+        statsObject1[baseName + QString(".0.8.snapshots.2.avgWriterWaitUsecs")] =
+            publishes > 0 ? (double)_snapshots->getSumWriterWaitUsecs() / publishes : 0.0;
+        statsObject1[baseName + QString(".0.8.snapshots.3.deferredPublishes")] =
+            (double)_snapshots->getSumDeferredPublishes();
+        _snapshots->resetStats();
+    }
+    
     statsObject1[baseName + QString(".1.1.octree.elementCount")] = (double)OctreeElement::getNodeCount();
     statsObject1[baseName + QString(".1.2.octree.internalElementCount")] = (double)OctreeElement::getInternalNodeCount();
     statsObject1[baseName + QString(".1.3.octree.leafElementCount")] = (double)OctreeElement::getLeafNodeCount();
@@ -1204,6 +1403,9 @@ void OctreeServer::sendStatsPacket() {
     statsObject2[baseName + QString(".2.outbound.data.totalBytesBitMasks")] = 
         (double)OctreePacketData::getTotalBytesOfBitMasks();
     statsObject2[baseName + QString(".2.outbound.data.totalBytesBitMasks")] = (double)OctreePacketData::getTotalBytesOfColor();
+    statsObject2[baseName + QString(".2.outbound.data.totalEncodeCacheHits")] = (double)OctreeSendThread::_totalEncodeCacheHits;
+    statsObject2[baseName + QString(".2.outbound.data.totalEncodeCacheMisses")] =
+        (double)OctreeSendThread::_totalEncodeCacheMisses;
 
     statsObject2[baseName + QString(".2.outbound.timing.1.avgLoopTime")] = getAverageLoopTime();
     statsObject2[baseName + QString(".2.outbound.timing.2.avgInsideTime")] = getAverageInsideTime();
@@ -1231,6 +1433,24 @@ void OctreeServer::sendStatsPacket() {
         (double)_octreeInboundPacketProcessor->getAverageProcessTimePerElement();
     statsObject3[baseName + QString(".3.inbound.timing.5.avgLockWaitTimePerElement")] = 
         (double)_octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
+    statsObject3[baseName + QString(".3.inbound.batches.1.totalBatches")] = 
+        (double)_octreeInboundPacketProcessor->getTotalEditBatches();
+    statsObject3[baseName + QString(".3.inbound.batches.2.avgElementsPerBatch")] = 
+        _octreeInboundPacketProcessor->getAverageEditsPerBatch();
+    statsObject3[baseName + QString(".3.inbound.batches.3.avgBatchLatency")] = 
+        (double)_octreeInboundPacketProcessor->getAverageBatchLatency();
+    statsObject3[baseName + QString(".3.inbound.batches.4.avgBatchLockHoldTime")] = 
+        (double)_octreeInboundPacketProcessor->getAverageBatchLockHoldTime();
+    statsObject3[baseName + QString(".3.inbound.batches.5.maxBatchLockHoldTime")] = 
+        (double)_octreeInboundPacketProcessor->getMaxBatchLockHoldTime();
+    statsObject3[baseName + QString(".3.inbound.queue.1.depth50Percentile")] = 
+        (double)_octreeInboundPacketProcessor->getQueueDepthHistogram().getPercentile(0.5f);
+    statsObject3[baseName + QString(".3.inbound.queue.2.depth99Percentile")] = 
+        (double)_octreeInboundPacketProcessor->getQueueDepthHistogram().getPercentile(0.99f);
+    statsObject3[baseName + QString(".3.inbound.queue.3.waitTime50Percentile")] = 
+        (double)_octreeInboundPacketProcessor->getQueueWaitTimeHistogram().getPercentile(0.5f);
+    statsObject3[baseName + QString(".3.inbound.queue.4.waitTime99Percentile")] = 
+        (double)_octreeInboundPacketProcessor->getQueueWaitTimeHistogram().getPercentile(0.99f);
 
     NodeList::getInstance()->sendStatsToDomainServer(statsObject3);
 }
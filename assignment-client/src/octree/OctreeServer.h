@@ -18,8 +18,11 @@
 
 #include <ThreadedAssignment.h>
 #include <EnvironmentData.h>
+#include <OctreeEditJournal.h>
+#include <OctreeSnapshots.h>
 
 #include "OctreePersistThread.h"
+#include "OctreeSendScheduler.h"
 #include "OctreeSendThread.h"
 #include "OctreeServerConsts.h"
 #include "OctreeInboundPacketProcessor.h"
@@ -42,6 +45,13 @@ public:
 
     Octree* getOctree() { return _tree; }
     JurisdictionMap* getJurisdiction() { return _jurisdiction; }
+    OctreeSendScheduler* getSendScheduler() { return _sendScheduler; }
+
+    /// the two copies of the tree that clients are sent from without locking it, or NULL if they lock the one tree
+    OctreeSnapshots* getSnapshots() { return _snapshots; }
+
+    /// the journal every edit is written to before it is applied, or NULL if the tree is only saved as a whole
+    OctreeEditJournal* getEditJournal() { return _editJournal; }
 
     int getPacketsPerClientPerInterval() const { return std::min(_packetsPerClientPerInterval, 
                                 std::max(1, getPacketsTotalPerInterval() / std::max(1, getCurrentClientCount()))); }
@@ -145,6 +155,9 @@ protected:
     int _packetsPerClientPerInterval;
     int _packetsTotalPerInterval;
     Octree* _tree; // this IS a reaveraging tree
+    Octree* _snapshotTree; // the second copy of the tree, with --snapshotReads
+    OctreeSnapshots* _snapshots;
+    OctreeEditJournal* _editJournal;
     bool _wantPersist;
     bool _debugSending;
     bool _debugReceiving;
@@ -153,6 +166,7 @@ protected:
     JurisdictionSender* _jurisdictionSender;
     OctreeInboundPacketProcessor* _octreeInboundPacketProcessor;
     OctreePersistThread* _persistThread;
+    OctreeSendScheduler* _sendScheduler;
 
     static OctreeServer* _instance;
 
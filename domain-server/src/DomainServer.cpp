@@ -414,71 +414,86 @@ NodeSet DomainServer::nodeInterestListFromPacket(const QByteArray& packet, int n
     return nodeInterestSet;
 }
 
-void DomainServer::sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr &senderSockAddr,
-                                        const NodeSet& nodeInterestList) {
+quint32 DomainServer::acknowledgedListVersionFromPacket(const QByteArray& packet, int numPreceedingBytes) {
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numPreceedingBytes);
     
-    QByteArray broadcastPacket = byteArrayWithPopulatedHeader(PacketTypeDomainList);
+    // the version comes after the interest list
+    quint8 numInterestTypes = 0;
+    packetStream >> numInterestTypes;
+    packetStream.skipRawData(numInterestTypes);
     
-    // always send the node their own UUID back
-    QDataStream broadcastDataStream(&broadcastPacket, QIODevice::Append);
-    broadcastDataStream << node->getUUID();
+    quint32 acknowledgedListVersion = NO_DOMAIN_LIST_VERSION;
+    packetStream >> acknowledgedListVersion;
     
-    int numBroadcastPacketLeadBytes = broadcastDataStream.device()->pos();
+    return acknowledgedListVersion;
+}
+
+void DomainServer::sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr &senderSockAddr,
+                                        const NodeSet& nodeInterestList, quint32 acknowledgedListVersion) {
     
     DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
     
     NodeList* nodeList = NodeList::getInstance();
     
+    // a node that has a list we still have the changes since, of the same types of nodes, only needs those changes
+    // (unless there are so many of them that the whole list would be smaller)
+    QList<QUuid> updatedNodes;
+    QList<QUuid> removedNodes;
+    bool sendChanges = acknowledgedListVersion != NO_DOMAIN_LIST_VERSION
+        && nodeInterestList == nodeData->getListedNodeTypes()
+        && _domainListChanges.getChangesSince(acknowledgedListVersion, nodeInterestList, updatedNodes, removedNodes)
+        && updatedNodes.size() + removedNodes.size() < nodeList->size();
+    nodeData->setListedNodeTypes(nodeInterestList);
     
-    if (nodeInterestList.size() > 0) {
+    // always send the node their own UUID back
+    DomainListWriter listWriter(node->getUUID(), _domainListChanges.getVersion(),
+                                sendChanges ? acknowledgedListVersion : NO_DOMAIN_LIST_VERSION);
+    
+    if (sendChanges) {
+        foreach (const QUuid& updatedNodeUUID, updatedNodes) {
+            SharedNodePointer otherNode = nodeList->nodeWithUUID(updatedNodeUUID);
+            if (otherNode && otherNode->getUUID() != node->getUUID()) {
+                listWriter.appendUpdatedNode(*otherNode.data(), sessionSecretForNodes(node, otherNode));
+            }
+        }
+        
+        foreach (const QUuid& removedNodeUUID, removedNodes) {
+            listWriter.appendRemovedNode(removedNodeUUID);
+        }
+    } else if (nodeInterestList.size() > 0) {
         // if the node has any interest types, send back those nodes as well
         foreach (const SharedNodePointer& otherNode, nodeList->getNodeHash()) {
-            
-            // reset our nodeByteArray and nodeDataStream
-            QByteArray nodeByteArray;
-            QDataStream nodeDataStream(&nodeByteArray, QIODevice::Append);
-            
             if (otherNode->getUUID() != node->getUUID() && nodeInterestList.contains(otherNode->getType())) {
-                
-                // don't send avatar nodes to other avatars, that will come from avatar mixer
-                nodeDataStream << *otherNode.data();
-                
-                // pack the secret that these two nodes will use to communicate with each other
-                QUuid secretUUID = nodeData->getSessionSecretHash().value(otherNode->getUUID());
-                if (secretUUID.isNull()) {
-                    // generate a new secret UUID these two nodes can use
-                    secretUUID = QUuid::createUuid();
-                    
-                    // set that on the current Node's sessionSecretHash
-                    nodeData->getSessionSecretHash().insert(otherNode->getUUID(), secretUUID);
-                    
-                    // set it on the other Node's sessionSecretHash
-                    reinterpret_cast<DomainServerNodeData*>(otherNode->getLinkedData())
-                        ->getSessionSecretHash().insert(node->getUUID(), secretUUID);
-                    
-                }
-                
-                nodeDataStream << secretUUID;
-                
-                if (broadcastPacket.size() +  nodeByteArray.size() > MAX_PACKET_SIZE) {
-                    // we need to break here and start a new packet
-                    // so send the current one
-                    
-                    nodeList->writeDatagram(broadcastPacket, node, senderSockAddr);
-                    
-                    // reset the broadcastPacket structure
-                    broadcastPacket.resize(numBroadcastPacketLeadBytes);
-                    broadcastDataStream.device()->seek(numBroadcastPacketLeadBytes);
-                }
-                
-                // append the nodeByteArray to the current state of broadcastDataStream
-                broadcastPacket.append(nodeByteArray);
+                listWriter.appendUpdatedNode(*otherNode.data(), sessionSecretForNodes(node, otherNode));
             }
         }
     }
     
-    // always write the last broadcastPacket
-    nodeList->writeDatagram(broadcastPacket, node, senderSockAddr);
+    DatagramSendBatch sendBatch(nodeList->getNodeSocket());
+    foreach (const QByteArray& listPacket, listWriter.finish()) {
+        nodeList->writeDatagram(listPacket, node, senderSockAddr);
+    }
+}
+
+QUuid DomainServer::sessionSecretForNodes(const SharedNodePointer& node, const SharedNodePointer& otherNode) {
+    // the secret that these two nodes will use to communicate with each other
+    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+    QUuid secretUUID = nodeData->getSessionSecretHash().value(otherNode->getUUID());
+    if (secretUUID.isNull()) {
+        // generate a new secret UUID these two nodes can use
+        secretUUID = QUuid::createUuid();
+        
+        // set that on the current Node's sessionSecretHash
+        nodeData->getSessionSecretHash().insert(otherNode->getUUID(), secretUUID);
+        
+        // set it on the other Node's sessionSecretHash
+        reinterpret_cast<DomainServerNodeData*>(otherNode->getLinkedData())
+            ->getSessionSecretHash().insert(node->getUUID(), secretUUID);
+        
+    }
+    
+    return secretUUID;
 }
 
 void DomainServer::readAvailableDatagrams() {
@@ -490,12 +505,11 @@ void DomainServer::readAvailableDatagrams() {
     static QByteArray assignmentPacket = byteArrayWithPopulatedHeader(PacketTypeCreateAssignment);
     static int numAssignmentPacketHeaderBytes = assignmentPacket.size();
     
+    PacketBuffer receivedDatagram;
     QByteArray receivedPacket;
 
-    while (nodeList->getNodeSocket().hasPendingDatagrams()) {
-        receivedPacket.resize(nodeList->getNodeSocket().pendingDatagramSize());
-        nodeList->getNodeSocket().readDatagram(receivedPacket.data(), receivedPacket.size(),
-                                               senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
+    while (nodeList->readDatagram(receivedDatagram, senderSockAddr)) {
+        receivedDatagram.asByteArray(receivedPacket);
         
         if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
             PacketType requestType = packetTypeForPacket(receivedPacket);
@@ -553,14 +567,22 @@ void DomainServer::readAvailableDatagrams() {
                 int numNodeInfoBytes = parseNodeDataFromByteArray(throwawayNodeType, nodePublicAddress, nodeLocalAddress,
                                                                   receivedPacket, senderSockAddr);
                 
-                SharedNodePointer checkInNode = nodeList->updateSocketsForNode(nodeUUID, nodePublicAddress, nodeLocalAddress);
+                SharedNodePointer checkInNode = nodeList->nodeWithUUID(nodeUUID);
+                if (checkInNode && (checkInNode->getPublicSocket() != nodePublicAddress
+                                    || checkInNode->getLocalSocket() != nodeLocalAddress)) {
+                    // the nodes that have this one in their list need to hear where it can be reached now
+                    _domainListChanges.nodeUpdated(nodeUUID, checkInNode->getType());
+                }
+                
+                checkInNode = nodeList->updateSocketsForNode(nodeUUID, nodePublicAddress, nodeLocalAddress);
             
                 // update last receive to now
                 quint64 timeNow = usecTimestampNow();
                 checkInNode->setLastHeardMicrostamp(timeNow);
                 
                 
-                sendDomainListToNode(checkInNode, senderSockAddr, nodeInterestListFromPacket(receivedPacket, numNodeInfoBytes));
+                sendDomainListToNode(checkInNode, senderSockAddr, nodeInterestListFromPacket(receivedPacket, numNodeInfoBytes),
+                                     acknowledgedListVersionFromPacket(receivedPacket, numNodeInfoBytes));
                 
             } else if (requestType == PacketTypeRequestAssignment) {
                 
@@ -860,10 +882,14 @@ void DomainServer::refreshStaticAssignmentAndAddToQueue(SharedAssignmentPointer&
 void DomainServer::nodeAdded(SharedNodePointer node) {
     // we don't use updateNodeWithData, so add the DomainServerNodeData to the node here
     node->setLinkedData(new DomainServerNodeData());
+    
+    _domainListChanges.nodeUpdated(node->getUUID(), node->getType());
 }
 
 void DomainServer::nodeKilled(SharedNodePointer node) {
     
+    _domainListChanges.nodeRemoved(node->getUUID(), node->getType());
+    
     DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
     if (nodeData) {
         // if this node's UUID matches a static assignment we need to throw it back in the assignment queue
@@ -18,6 +18,7 @@
 #include <QtCore/QUrl>
 
 #include <Assignment.h>
+#include <DomainListDelta.h>
 #include <HTTPManager.h>
 #include <NodeList.h>
 
@@ -49,8 +50,10 @@ private:
     int parseNodeDataFromByteArray(NodeType_t& nodeType, HifiSockAddr& publicSockAddr,
                                     HifiSockAddr& localSockAddr, const QByteArray& packet, const HifiSockAddr& senderSockAddr);
     NodeSet nodeInterestListFromPacket(const QByteArray& packet, int numPreceedingBytes);
+    quint32 acknowledgedListVersionFromPacket(const QByteArray& packet, int numPreceedingBytes);
     void sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr& senderSockAddr,
-                              const NodeSet& nodeInterestList);
+                              const NodeSet& nodeInterestList, quint32 acknowledgedListVersion = NO_DOMAIN_LIST_VERSION);
+    QUuid sessionSecretForNodes(const SharedNodePointer& node, const SharedNodePointer& otherNode);
     
     void parseCommandLineTypeConfigs(const QStringList& argumentList, QSet<Assignment::Type>& excludedTypes);
     void readConfigFile(const QString& path, QSet<Assignment::Type>& excludedTypes);
@@ -78,6 +81,8 @@ private:
     QStringList _argumentList;
     
     QHash<QString, QJsonObject> _redeemedTokenResponses;
+    
+    DomainListChangeLog _domainListChanges;
 private slots:
     void requestCreationFromDataServer();
     void processCreateResponseFromDataServer(const QJsonObject& jsonObject);
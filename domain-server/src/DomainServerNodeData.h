@@ -13,6 +13,7 @@
 #include <QtCore/QUuid>
 
 #include <NodeData.h>
+#include <NodeList.h>
 
 class DomainServerNodeData : public NodeData {
 public:
@@ -27,12 +28,17 @@ public:
     const QUuid& getStaticAssignmentUUID() const { return _staticAssignmentUUID; }
     
     QHash<QUuid, QUuid>& getSessionSecretHash() { return _sessionSecretHash; }
+    
+    /// the types of nodes in the lists the node was sent, which changes to the list can only be sent for
+    void setListedNodeTypes(const NodeSet& listedNodeTypes) { _listedNodeTypes = listedNodeTypes; }
+    const NodeSet& getListedNodeTypes() const { return _listedNodeTypes; }
 private:
     QJsonObject mergeJSONStatsFromNewObject(const QJsonObject& newObject, QJsonObject destinationObject);
     
     QHash<QUuid, QUuid> _sessionSecretHash;
     QUuid _staticAssignmentUUID;
     QJsonObject _statsJSONObject;
+    NodeSet _listedNodeTypes;
 };
 
 #endif /* defined(__hifi__DomainServerNodeData__) */
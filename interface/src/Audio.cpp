@@ -55,6 +55,7 @@ Audio::Audio(Oscilloscope* scope, int16_t initialJitterBufferSamples, QObject* p
     _proceduralOutputDevice(NULL),
     _inputRingBuffer(0),
     _ringBuffer(NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL),
+    _inputEncoder(),
     _scope(scope),
     _averagedLatency(0.0),
     _measuredJitter(0),
@@ -345,9 +346,10 @@ void Audio::handleAudioInput() {
     static char monoAudioDataPacket[MAX_PACKET_SIZE];
 
     static int numBytesPacketHeader = numBytesForPacketHeaderGivenPacketType(PacketTypeMicrophoneAudioNoEcho);
-    static int leadingBytes = numBytesPacketHeader + sizeof(glm::vec3) + sizeof(glm::quat);
+    static int leadingBytes = numBytesPacketHeader + sizeof(glm::vec3) + sizeof(glm::quat) + sizeof(AudioCodecType_t);
 
-    static int16_t* monoAudioSamples = (int16_t*) (monoAudioDataPacket + leadingBytes);
+    // samples are encoded into the packet once they're ready, so they're processed in their own buffer
+    static int16_t monoAudioSamples[NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL];
 
     float inputToNetworkInputRatio = calculateDeviceToNetworkInputRatio(_numInputCallbackBytes);
 
@@ -536,19 +538,10 @@ void Audio::handleAudioInput() {
             // we need the amount of bytes in the buffer + 1 for type
             // + 12 for 3 floats for position + float for bearing + 1 attenuation byte
             
-            int numAudioBytes = 0;
-            
             PacketType packetType;
             if (_lastInputLoudness == 0) {
                 packetType = PacketTypeSilentAudioFrame;
-                
-                // we need to indicate how many silent samples this is to the audio mixer
-                monoAudioSamples[0] = NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL;
-                numAudioBytes = sizeof(int16_t);
-                
             } else {
-                numAudioBytes = NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL;
-                
                 if (Menu::getInstance()->isOptionChecked(MenuOption::EchoServerAudio)) {
                     packetType = PacketTypeMicrophoneAudioWithEcho;
                 } else {
@@ -566,6 +559,23 @@ void Audio::handleAudioInput() {
             memcpy(currentPacketPtr, &headOrientation, sizeof(headOrientation));
             currentPacketPtr += sizeof(headOrientation);
             
+            // the codec we encode with is also the one the audio-mixer will encode our mixes with
+            AudioCodecType_t codecType = _inputEncoder.getType();
+            memcpy(currentPacketPtr, &codecType, sizeof(codecType));
+            currentPacketPtr += sizeof(codecType);
+            
+            int numAudioBytes = 0;
+            
+            if (packetType == PacketTypeSilentAudioFrame) {
+                // we need to indicate how many silent samples this is to the audio mixer
+                int16_t numSilentSamples = NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL;
+                memcpy(currentPacketPtr, &numSilentSamples, sizeof(numSilentSamples));
+                numAudioBytes = sizeof(numSilentSamples);
+            } else {
+                numAudioBytes = _inputEncoder.encode(monoAudioSamples, NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL, 1,
+                                                     currentPacketPtr);
+            }
+            
             nodeList->writeDatagram(monoAudioDataPacket, numAudioBytes + leadingBytes, audioMixer);
 
             Application::getInstance()->getBandwidthMeter()->outputStream(BandwidthMeter::AUDIO)
@@ -28,6 +28,7 @@
 #include <QVector>
 
 #include <AbstractAudioInterface.h>
+#include <AudioCodec.h>
 #include <AudioRingBuffer.h>
 #include <StdDev.h>
 
@@ -119,6 +120,7 @@ private:
     QIODevice* _proceduralOutputDevice;
     AudioRingBuffer _inputRingBuffer;
     AudioRingBuffer _ringBuffer;
+    IMAADPCMAudioCodec _inputEncoder;
 
     QString _inputAudioDeviceName;
     QString _outputAudioDeviceName;
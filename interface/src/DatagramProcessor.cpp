@@ -27,15 +27,15 @@ void DatagramProcessor::processDatagrams() {
     
     HifiSockAddr senderSockAddr;
     
-    static QByteArray incomingPacket;
+    // the packet reads the datagram where it is, so what goes to another thread is queued with its buffer or copied
+    PacketBuffer incomingDatagram;
+    QByteArray incomingPacket;
     
     Application* application = Application::getInstance();
     NodeList* nodeList = NodeList::getInstance();
     
-    while (NodeList::getInstance()->getNodeSocket().hasPendingDatagrams()) {
-        incomingPacket.resize(nodeList->getNodeSocket().pendingDatagramSize());
-        nodeList->getNodeSocket().readDatagram(incomingPacket.data(), incomingPacket.size(),
-                                               senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
+    while (nodeList->readDatagram(incomingDatagram, senderSockAddr)) {
+        incomingDatagram.asByteArray(incomingPacket);
         
         _packetCount++;
         _byteCount += incomingPacket.size();
@@ -45,7 +45,7 @@ void DatagramProcessor::processDatagrams() {
             switch (packetTypeForPacket(incomingPacket)) {
                 case PacketTypeMixedAudio:
                     QMetaObject::invokeMethod(&application->_audio, "addReceivedAudioToBuffer", Qt::QueuedConnection,
-                                              Q_ARG(QByteArray, incomingPacket));
+                                              Q_ARG(QByteArray, incomingDatagram.toByteArray()));
                     break;
                     
                 case PacketTypeParticleAddResponse:
@@ -66,11 +66,12 @@ void DatagramProcessor::processDatagrams() {
                     bool wantExtraDebugging = application->getLogger()->extraDebugging();
                     if (wantExtraDebugging && packetTypeForPacket(incomingPacket) == PacketTypeVoxelData) {
                         int numBytesPacketHeader = numBytesForPacketHeader(incomingPacket);
-                        unsigned char* dataAt = reinterpret_cast<unsigned char*>(incomingPacket.data()) + numBytesPacketHeader;
+                        const unsigned char* dataAt = reinterpret_cast<const unsigned char*>(incomingPacket.constData()) +
+                            numBytesPacketHeader;
                         dataAt += sizeof(OCTREE_PACKET_FLAGS);
-                        OCTREE_PACKET_SEQUENCE sequence = (*(OCTREE_PACKET_SEQUENCE*)dataAt);
+                        OCTREE_PACKET_SEQUENCE sequence = (*(const OCTREE_PACKET_SEQUENCE*)dataAt);
                         dataAt += sizeof(OCTREE_PACKET_SEQUENCE);
-                        OCTREE_PACKET_SENT_TIME sentAt = (*(OCTREE_PACKET_SENT_TIME*)dataAt);
+                        OCTREE_PACKET_SENT_TIME sentAt = (*(const OCTREE_PACKET_SENT_TIME*)dataAt);
                         dataAt += sizeof(OCTREE_PACKET_SENT_TIME);
                         OCTREE_PACKET_SENT_TIME arrivedAt = usecTimestampNow();
                         int flightTime = arrivedAt - sentAt;
@@ -82,13 +83,14 @@ void DatagramProcessor::processDatagrams() {
                     
                     if (matchedNode) {
                         // add this packet to our list of voxel packets and process them on the voxel processing
-                        application->_voxelProcessor.queueReceivedPacket(matchedNode, incomingPacket);
+                        application->_voxelProcessor.queueReceivedPacket(matchedNode, incomingDatagram);
                     }
                     
                     break;
                 }
                 case PacketTypeMetavoxelData:
-                    nodeList->findNodeAndUpdateWithDataFromPacket(incomingPacket);
+                    // the client hands it to the thread its sequencer is on
+                    nodeList->findNodeAndUpdateWithDataFromPacket(incomingDatagram.toByteArray());
                     break;
                 case PacketTypeBulkAvatarData:
                 case PacketTypeKillAvatar:
@@ -102,7 +104,7 @@ void DatagramProcessor::processDatagrams() {
                         avatarMixer->recordBytesReceived(incomingPacket.size());
                         
                         QMetaObject::invokeMethod(&application->getAvatarManager(), "processAvatarMixerDatagram",
-                                                  Q_ARG(const QByteArray&, incomingPacket),
+                                                  Q_ARG(const QByteArray&, incomingDatagram.toByteArray()),
                                                   Q_ARG(const QWeakPointer<Node>&, avatarMixer));
                     }
                     
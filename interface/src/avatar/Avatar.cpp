@@ -56,6 +56,7 @@ Avatar::Avatar() :
     _owningAvatarMixer(),
     _collisionFlags(0),
     _initialized(false),
+    _receivedStates(),
     _shouldRenderBillboard(true)
 {
     // we may have been created in the network thread, but we live in the main thread
@@ -15,6 +15,7 @@
 #include <QtCore/QUuid>
 
 #include <AvatarData.h>
+#include <AvatarStateDelta.h>
 
 #include "Hand.h"
 #include "Head.h"
@@ -138,6 +139,9 @@ public:
     
     virtual int parseDataAtOffset(const QByteArray& packet, int offset);
 
+    /// the last states of this avatar we got from the avatar-mixer, which it sends new states as changes against
+    AvatarStateHistory& getReceivedStates() { return _receivedStates; }
+
     static void renderJointConnectingCone(glm::vec3 position1, glm::vec3 position2, float radius1, float radius2);
 
 
@@ -190,6 +194,7 @@ protected:
 private:
 
     bool _initialized;
+    AvatarStateHistory _receivedStates;
     QScopedPointer<Texture> _billboardTexture;
     bool _shouldRenderBillboard;
 
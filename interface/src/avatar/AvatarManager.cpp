@@ -5,6 +5,7 @@
 //  Created by Stephen Birarda on 1/23/2014.
 //  Copyright (c) 2014 HighFidelity, Inc. All rights reserved.
 //
+#include <cstring>
 #include <string>
 
 #include <glm/gtx/string_cast.hpp>
@@ -23,7 +24,11 @@
 const QUuid MY_AVATAR_KEY;  // NULL key
 
 AvatarManager::AvatarManager(QObject* parent) :
-    _avatarFades() {
+    _avatarFades(),
+    _bulkAvatarPacketMixerUUID(),
+    _hasAcknowledgedBulkAvatarPacket(false),
+    _latestBulkAvatarPacketSequence(0),
+    _previousBulkAvatarPacketBits(0) {
     // register a meta type for the weak pointer we'll use for the owning avatar mixer for each avatar
     qRegisterMetaType<QWeakPointer<Node> >("NodeWeakPointer");
     _myAvatar = QSharedPointer<MyAvatar>(new MyAvatar());
@@ -161,26 +166,129 @@ void AvatarManager::processAvatarMixerDatagram(const QByteArray& datagram, const
 }
 
 void AvatarManager::processAvatarDataPacket(const QByteArray &datagram, const QWeakPointer<Node> &mixerWeakPointer) {
+    // only add avatars if mixerWeakPointer points to something (meaning that mixer is still around)
+    SharedNodePointer avatarMixer = mixerWeakPointer.toStrongRef();
+    if (!avatarMixer) {
+        return;
+    }
+    
+    if (avatarMixer->getUUID() != _bulkAvatarPacketMixerUUID) {
+        // a new mixer numbers its packets and states from scratch, so nothing we kept from the last one is any good
+        _bulkAvatarPacketMixerUUID = avatarMixer->getUUID();
+        _hasAcknowledgedBulkAvatarPacket = false;
+        
+        foreach (const AvatarSharedPointer& avatarData, _avatarHash) {
+            reinterpret_cast<Avatar*>(avatarData.data())->getReceivedStates().clear();
+        }
+    }
+    
     int bytesRead = numBytesForPacketHeader(datagram);
     
+    quint16 packetSequence;
+    if (datagram.size() < bytesRead + (int) sizeof(packetSequence)) {
+        return;
+    }
+    memcpy(&packetSequence, datagram.constData() + bytesRead, sizeof(packetSequence));
+    bytesRead += sizeof(packetSequence);
+    
+    // the mixer sends us changes against the states we acknowledged, so we only acknowledge a packet if we kept every
+    // state in it
+    bool hasKeptEveryState = true;
+    
     // enumerate over all of the avatars in this packet
-    // only add them if mixerWeakPointer points to something (meaning that mixer is still around)
-    while (bytesRead < datagram.size() && mixerWeakPointer.data()) {
-        QUuid nodeUUID = QUuid::fromRfc4122(datagram.mid(bytesRead, NUM_BYTES_RFC4122_UUID));
+    while (bytesRead < datagram.size()) {
+        if (datagram.size() - bytesRead < BULK_AVATAR_DATA_ENTRY_HEADER_BYTES) {
+            hasKeptEveryState = false;
+            break;
+        }
+        
+        QUuid nodeUUID = QUuid::fromRfc4122(QByteArray::fromRawData(datagram.constData() + bytesRead,
+                                                                    NUM_BYTES_RFC4122_UUID));
         bytesRead += NUM_BYTES_RFC4122_UUID;
         
+        quint16 sequence, baseSequence;
+        memcpy(&sequence, datagram.constData() + bytesRead, sizeof(sequence));
+        bytesRead += sizeof(sequence);
+        memcpy(&baseSequence, datagram.constData() + bytesRead, sizeof(baseSequence));
+        bytesRead += sizeof(baseSequence);
+        
         AvatarSharedPointer matchingAvatarData = matchingOrNewAvatar(nodeUUID, mixerWeakPointer);
+        Avatar* matchingAvatar = reinterpret_cast<Avatar*>(matchingAvatarData.data());
+        AvatarStateHistory& receivedStates = matchingAvatar->getReceivedStates();
         
-        // have the matching (or new) avatar parse the data from the packet
-        bytesRead += matchingAvatarData->parseDataAtOffset(datagram, bytesRead);
+        const unsigned char* packedState = reinterpret_cast<const unsigned char*>(datagram.constData()) + bytesRead;
+        int maxPackedBytes = datagram.size() - bytesRead;
+        bool isDelta = (sequence != baseSequence);
         
-        Avatar* matchingAvatar = reinterpret_cast<Avatar*>(matchingAvatarData.data());
+        const QByteArray* baseState = isDelta ? receivedStates.getState(baseSequence) : NULL;
+        QByteArray* state = (isDelta && !baseState) ? NULL : receivedStates.getBufferForState(sequence);
+        
+        int numPackedBytes = -1;
+        if (state && state != baseState) {
+            numPackedBytes = unpackAvatarState(packedState, maxPackedBytes, baseState, *state);
+            
+            if (numPackedBytes != -1) {
+                // have the matching (or new) avatar parse its rebuilt state
+                matchingAvatar->parseDataAtOffset(*state, 0);
+            } else {
+                receivedStates.removeState(sequence);
+            }
+        }
+        
+        if (numPackedBytes == -1) {
+            // we are missing the base this was packed against (or have a newer state already), so skip over it
+            hasKeptEveryState = false;
+            numPackedBytes = numBytesForPackedAvatarState(packedState, maxPackedBytes, isDelta);
+            
+            if (numPackedBytes == -1) {
+                break;
+            }
+        }
+        bytesRead += numPackedBytes;
         
         if (!matchingAvatar->isInitialized()) {
             // now that we have AvatarData for this Avatar we are go for init
             matchingAvatar->init();
         }
     }
+    
+    if (hasKeptEveryState) {
+        sendBulkAvatarDataAck(packetSequence, avatarMixer);
+    }
+}
+
+void AvatarManager::sendBulkAvatarDataAck(quint16 packetSequence, const SharedNodePointer& avatarMixer) {
+    const int NUM_PREVIOUS_PACKET_BITS = sizeof(_previousBulkAvatarPacketBits) * BITS_IN_BYTE;
+    
+    if (!_hasAcknowledgedBulkAvatarPacket) {
+        _latestBulkAvatarPacketSequence = packetSequence;
+        _previousBulkAvatarPacketBits = 0;
+        _hasAcknowledgedBulkAvatarPacket = true;
+    } else if (isAvatarSequenceNewer(packetSequence, _latestBulkAvatarPacketSequence)) {
+        // the old latest becomes one of the bits, along with whatever packets were skipped over
+        int numNewPackets = (quint16) (packetSequence - _latestBulkAvatarPacketSequence);
+        if (numNewPackets > NUM_PREVIOUS_PACKET_BITS) {
+            _previousBulkAvatarPacketBits = 0;
+        } else {
+            _previousBulkAvatarPacketBits = (numNewPackets == NUM_PREVIOUS_PACKET_BITS)
+                ? 0 : (_previousBulkAvatarPacketBits << numNewPackets);
+            _previousBulkAvatarPacketBits |= 1u << (numNewPackets - 1);
+        }
+        _latestBulkAvatarPacketSequence = packetSequence;
+    } else {
+        int packetAge = (quint16) (_latestBulkAvatarPacketSequence - packetSequence);
+        if (packetAge > 0 && packetAge <= NUM_PREVIOUS_PACKET_BITS) {
+            _previousBulkAvatarPacketBits |= 1u << (packetAge - 1);
+        }
+    }
+    
+    QByteArray ackPacket = byteArrayWithPopulatedHeader(PacketTypeBulkAvatarDataAck);
+    ackPacket.append(reinterpret_cast<const char*>(&_latestBulkAvatarPacketSequence),
+                     sizeof(_latestBulkAvatarPacketSequence));
+    ackPacket.append(reinterpret_cast<const char*>(&_previousBulkAvatarPacketBits),
+                     sizeof(_previousBulkAvatarPacketBits));
+    
+    NodeList::getInstance()->writeDatagram(ackPacket, avatarMixer);
 }
 
 void AvatarManager::processAvatarIdentityPacket(const QByteArray &packet, const QWeakPointer<Node>& mixerWeakPointer) {
@@ -12,8 +12,10 @@
 #include <QtCore/QHash>
 #include <QtCore/QObject>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QUuid>
 
 #include <AvatarHashMap.h>
+#include <NodeList.h>
 
 #include "Avatar.h"
 
@@ -42,6 +44,10 @@ private:
     AvatarSharedPointer matchingOrNewAvatar(const QUuid& nodeUUID, const QWeakPointer<Node>& mixerWeakPointer);
     
     void processAvatarDataPacket(const QByteArray& packet, const QWeakPointer<Node>& mixerWeakPointer);
+    
+    /// tells the avatar-mixer we have every state in this bulk avatar packet, along with the packets before it
+    void sendBulkAvatarDataAck(quint16 packetSequence, const SharedNodePointer& avatarMixer);
+    
     void processAvatarIdentityPacket(const QByteArray& packet, const QWeakPointer<Node>& mixerWeakPointer);
     void processAvatarBillboardPacket(const QByteArray& packet, const QWeakPointer<Node>& mixerWeakPointer);
     void processKillAvatar(const QByteArray& datagram);
@@ -54,6 +60,11 @@ private:
     
     QVector<AvatarSharedPointer> _avatarFades;
     QSharedPointer<MyAvatar> _myAvatar;
+    
+    QUuid _bulkAvatarPacketMixerUUID;
+    bool _hasAcknowledgedBulkAvatarPacket;
+    quint16 _latestBulkAvatarPacketSequence;
+    quint32 _previousBulkAvatarPacketBits;
 };
 
 #endif /* defined(__hifi__AvatarManager__) */
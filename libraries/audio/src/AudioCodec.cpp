@@ -0,0 +1,202 @@
+//
+//  AudioCodec.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include "AudioCodec.h"
+
+AudioCodec* AudioCodec::create(AudioCodecType_t type) {
+    switch (type) {
+        case AudioCodecType::PCM:
+            return new PCMAudioCodec();
+        case AudioCodecType::IMAADPCM:
+            return new IMAADPCMAudioCodec();
+        default:
+            return NULL;
+    }
+}
+
+int PCMAudioCodec::getMaxEncodedBytes(int numSamples, int numChannels) const {
+    return numSamples * sizeof(int16_t);
+}
+
+int PCMAudioCodec::encode(const int16_t* samples, int numSamples, int numChannels, char* destination) {
+    memcpy(destination, samples, numSamples * sizeof(int16_t));
+    return numSamples * sizeof(int16_t);
+}
+
+int PCMAudioCodec::decode(const char* data, int numBytes, int16_t* samples, int maxSamples) {
+    int numSamples = std::min((int) (numBytes / sizeof(int16_t)), maxSamples);
+    memcpy(samples, data, numSamples * sizeof(int16_t));
+    return numSamples;
+}
+
+const int IMA_ADPCM_INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+const int IMA_ADPCM_STEP_TABLE[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+const int IMA_ADPCM_MAX_STEP_INDEX = 88;
+
+// frame header is the number of channels, the samples per channel and then a predictor and step index per channel
+const int IMA_ADPCM_FRAME_HEADER_BYTES = sizeof(uint8_t) + sizeof(uint16_t);
+const int IMA_ADPCM_CHANNEL_HEADER_BYTES = sizeof(int16_t) + sizeof(uint8_t);
+
+// applies one four bit code to a channel's predictor and step index, the encoder and decoder share this so they
+// always agree on the state
+template<typename State>
+static inline int16_t applyIMAADPCMCode(State& state, uint8_t code) {
+    int step = IMA_ADPCM_STEP_TABLE[state.stepIndex];
+
+    int difference = step >> 3;
+    if (code & 4) {
+        difference += step;
+    }
+    if (code & 2) {
+        difference += step >> 1;
+    }
+    if (code & 1) {
+        difference += step >> 2;
+    }
+
+    int predictor = (code & 8) ? state.predictor - difference : state.predictor + difference;
+    state.predictor = (int16_t) std::max(-32768, std::min(32767, predictor));
+
+    state.stepIndex = (uint8_t) std::max(0, std::min(IMA_ADPCM_MAX_STEP_INDEX,
+                                                     state.stepIndex + IMA_ADPCM_INDEX_TABLE[code]));
+    return state.predictor;
+}
+
+IMAADPCMAudioCodec::IMAADPCMAudioCodec() {
+    memset(_encoderStates, 0, sizeof(_encoderStates));
+}
+
+int IMAADPCMAudioCodec::getMaxEncodedBytes(int numSamples, int numChannels) const {
+    return IMA_ADPCM_FRAME_HEADER_BYTES + (numChannels * IMA_ADPCM_CHANNEL_HEADER_BYTES) + ((numSamples + 1) / 2);
+}
+
+int IMAADPCMAudioCodec::encode(const int16_t* samples, int numSamples, int numChannels, char* destination) {
+    if (numChannels < 1 || numChannels > MAX_CHANNELS) {
+        return 0;
+    }
+
+    char* currentPosition = destination;
+
+    uint8_t numChannelsByte = numChannels;
+    memcpy(currentPosition, &numChannelsByte, sizeof(numChannelsByte));
+    currentPosition += sizeof(numChannelsByte);
+
+    uint16_t numSamplesPerChannel = numSamples / numChannels;
+    memcpy(currentPosition, &numSamplesPerChannel, sizeof(numSamplesPerChannel));
+    currentPosition += sizeof(numSamplesPerChannel);
+
+    // the decoder starts from wherever our encoder left off after the last frame
+    for (int c = 0; c < numChannels; c++) {
+        memcpy(currentPosition, &_encoderStates[c].predictor, sizeof(_encoderStates[c].predictor));
+        currentPosition += sizeof(_encoderStates[c].predictor);
+        memcpy(currentPosition, &_encoderStates[c].stepIndex, sizeof(_encoderStates[c].stepIndex));
+        currentPosition += sizeof(_encoderStates[c].stepIndex);
+    }
+
+    int numEncodedSamples = numSamplesPerChannel * numChannels;
+    uint8_t* codes = reinterpret_cast<uint8_t*>(currentPosition);
+
+    for (int i = 0; i < numEncodedSamples; i++) {
+        ChannelState& state = _encoderStates[i % numChannels];
+
+        int difference = samples[i] - state.predictor;
+        uint8_t code = 0;
+        if (difference < 0) {
+            code = 8;
+            difference = -difference;
+        }
+
+        int step = IMA_ADPCM_STEP_TABLE[state.stepIndex];
+        if (difference >= step) {
+            code |= 4;
+            difference -= step;
+        }
+        step >>= 1;
+        if (difference >= step) {
+            code |= 2;
+            difference -= step;
+        }
+        step >>= 1;
+        if (difference >= step) {
+            code |= 1;
+        }
+
+        applyIMAADPCMCode(state, code);
+
+        // two codes per byte, low nibble first
+        if (i % 2 == 0) {
+            codes[i / 2] = code;
+        } else {
+            codes[i / 2] |= code << 4;
+        }
+    }
+
+    return IMA_ADPCM_FRAME_HEADER_BYTES + (numChannels * IMA_ADPCM_CHANNEL_HEADER_BYTES) + ((numEncodedSamples + 1) / 2);
+}
+
+int IMAADPCMAudioCodec::decode(const char* data, int numBytes, int16_t* samples, int maxSamples) {
+    if (numBytes < IMA_ADPCM_FRAME_HEADER_BYTES) {
+        return 0;
+    }
+
+    const char* currentPosition = data;
+
+    uint8_t numChannels = 0;
+    memcpy(&numChannels, currentPosition, sizeof(numChannels));
+    currentPosition += sizeof(numChannels);
+
+    uint16_t numSamplesPerChannel = 0;
+    memcpy(&numSamplesPerChannel, currentPosition, sizeof(numSamplesPerChannel));
+    currentPosition += sizeof(numSamplesPerChannel);
+
+    int numSamples = numSamplesPerChannel * numChannels;
+
+    if (numChannels < 1 || numChannels > MAX_CHANNELS
+        || numBytes < IMA_ADPCM_FRAME_HEADER_BYTES + (numChannels * IMA_ADPCM_CHANNEL_HEADER_BYTES) + ((numSamples + 1) / 2)) {
+        // this frame is malformed or truncated, don't read past the end of it
+        return 0;
+    }
+
+    ChannelState decoderStates[MAX_CHANNELS];
+    for (int c = 0; c < numChannels; c++) {
+        memcpy(&decoderStates[c].predictor, currentPosition, sizeof(decoderStates[c].predictor));
+        currentPosition += sizeof(decoderStates[c].predictor);
+        memcpy(&decoderStates[c].stepIndex, currentPosition, sizeof(decoderStates[c].stepIndex));
+        currentPosition += sizeof(decoderStates[c].stepIndex);
+
+        decoderStates[c].stepIndex = std::min((int) decoderStates[c].stepIndex, IMA_ADPCM_MAX_STEP_INDEX);
+    }
+
+    const uint8_t* codes = reinterpret_cast<const uint8_t*>(currentPosition);
+    numSamples = std::min(numSamples, maxSamples);
+
+    for (int i = 0; i < numSamples; i++) {
+        uint8_t code = (i % 2 == 0) ? (codes[i / 2] & 0x0F) : (codes[i / 2] >> 4);
+        samples[i] = applyIMAADPCMCode(decoderStates[i % numChannels], code);
+    }
+
+    return numSamples;
+}
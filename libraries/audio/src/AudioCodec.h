@@ -0,0 +1,78 @@
+//
+//  AudioCodec.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#ifndef __hifi__AudioCodec__
+#define __hifi__AudioCodec__
+
+#include <stdint.h>
+
+#include <QtCore/QtGlobal>
+
+typedef quint8 AudioCodecType_t;
+
+/// Every encoded audio payload starts with one of these, so the receiver knows how to decode it. A client also uses
+/// the codec of its microphone stream to tell the audio-mixer which codec it wants its mixes in.
+namespace AudioCodecType {
+    const AudioCodecType_t PCM = 0;
+    const AudioCodecType_t IMAADPCM = 1;
+}
+
+/// Encodes and decodes interleaved int16 audio. Encoders may keep state between frames, so use one instance per
+/// outgoing stream. Every encoded frame carries what its decoder needs, so lost packets never break later ones.
+class AudioCodec {
+public:
+    /// \return a new codec of the given type, or NULL if this build does not support that type
+    static AudioCodec* create(AudioCodecType_t type);
+
+    virtual ~AudioCodec() { }
+
+    virtual AudioCodecType_t getType() const = 0;
+
+    /// \return the most bytes encode() will write for numSamples interleaved samples on numChannels
+    virtual int getMaxEncodedBytes(int numSamples, int numChannels) const = 0;
+
+    /// encodes numSamples interleaved samples
+    /// \return the number of bytes written to destination
+    virtual int encode(const int16_t* samples, int numSamples, int numChannels, char* destination) = 0;
+
+    /// decodes one encoded frame
+    /// \return the number of interleaved samples written to samples, never more than maxSamples
+    virtual int decode(const char* data, int numBytes, int16_t* samples, int maxSamples) = 0;
+};
+
+/// Passes raw samples through untouched.
+class PCMAudioCodec : public AudioCodec {
+public:
+    AudioCodecType_t getType() const { return AudioCodecType::PCM; }
+    int getMaxEncodedBytes(int numSamples, int numChannels) const;
+    int encode(const int16_t* samples, int numSamples, int numChannels, char* destination);
+    int decode(const char* data, int numBytes, int16_t* samples, int maxSamples);
+};
+
+/// IMA ADPCM, four bits per sample. Each frame starts with the predictor and step index of every channel.
+class IMAADPCMAudioCodec : public AudioCodec {
+public:
+    IMAADPCMAudioCodec();
+
+    AudioCodecType_t getType() const { return AudioCodecType::IMAADPCM; }
+    int getMaxEncodedBytes(int numSamples, int numChannels) const;
+    int encode(const int16_t* samples, int numSamples, int numChannels, char* destination);
+    int decode(const char* data, int numBytes, int16_t* samples, int maxSamples);
+
+    static const int MAX_CHANNELS = 2;
+
+private:
+    struct ChannelState {
+        int16_t predictor;
+        uint8_t stepIndex;
+    };
+
+    ChannelState _encoderStates[MAX_CHANNELS];
+};
+
+#endif /* defined(__hifi__AudioCodec__) */
@@ -0,0 +1,169 @@
+//
+//  AudioMixKernel.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <limits>
+
+// pick the widest instruction set this translation unit is being compiled for, there is always a scalar tail
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define AUDIO_MIX_KERNEL_AVX2
+#define AUDIO_MIX_KERNEL_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AUDIO_MIX_KERNEL_SSE2
+#endif
+
+#include "AudioMixKernel.h"
+
+const int32_t MAX_MIXED_SAMPLE_VALUE = std::numeric_limits<int16_t>::max();
+const int32_t MIN_MIXED_SAMPLE_VALUE = std::numeric_limits<int16_t>::min();
+
+#if defined(AUDIO_MIX_KERNEL_AVX2)
+
+// sign extends eight int16 samples to int32 lanes
+static inline __m256i loadEightSamples(const int16_t* source) {
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*) source));
+}
+
+// multiplies the lanes by gain and truncates towards zero, the same as a C cast from float
+static inline __m256i scaleEightSamples(__m256i samples, __m256 gain) {
+    return _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(samples), gain));
+}
+
+static inline void addToEightAccumulated(int32_t* accumulator, __m256i samples) {
+    __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*) accumulator), samples);
+    _mm256_storeu_si256((__m256i*) accumulator, sum);
+}
+
+#elif defined(AUDIO_MIX_KERNEL_SSE2)
+
+// sign extends four int16 samples to int32 lanes (SSE2 has no pmovsxwd, so unpack and shift)
+static inline __m128i loadFourSamples(const int16_t* source) {
+    __m128i samples = _mm_loadl_epi64((const __m128i*) source);
+    return _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+}
+
+// multiplies the lanes by gain and truncates towards zero, the same as a C cast from float
+static inline __m128i scaleFourSamples(__m128i samples, __m128 gain) {
+    return _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(samples), gain));
+}
+
+static inline void addToFourAccumulated(int32_t* accumulator, __m128i samples) {
+    __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i*) accumulator), samples);
+    _mm_storeu_si128((__m128i*) accumulator, sum);
+}
+
+#endif
+
+const char* AudioMixKernel::getImplementationName() {
+#if defined(AUDIO_MIX_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(AUDIO_MIX_KERNEL_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+void AudioMixKernel::addScaled(int32_t* accumulator, const int16_t* source, float gain, int numSamples) {
+    int i = 0;
+
+#if defined(AUDIO_MIX_KERNEL_AVX2)
+    __m256 gainVector = _mm256_set1_ps(gain);
+    for (; i + 8 <= numSamples; i += 8) {
+        addToEightAccumulated(accumulator + i, scaleEightSamples(loadEightSamples(source + i), gainVector));
+    }
+#elif defined(AUDIO_MIX_KERNEL_SSE2)
+    __m128 gainVector = _mm_set1_ps(gain);
+    for (; i + 4 <= numSamples; i += 4) {
+        addToFourAccumulated(accumulator + i, scaleFourSamples(loadFourSamples(source + i), gainVector));
+    }
+#endif
+
+    for (; i < numSamples; i++) {
+        accumulator[i] += (int32_t) (source[i] * gain);
+    }
+}
+
+void AudioMixKernel::addAccumulated(int32_t* accumulator, const int32_t* source, int numSamples) {
+    int i = 0;
+
+#if defined(AUDIO_MIX_KERNEL_AVX2)
+    for (; i + 8 <= numSamples; i += 8) {
+        addToEightAccumulated(accumulator + i, _mm256_loadu_si256((const __m256i*) (source + i)));
+    }
+#elif defined(AUDIO_MIX_KERNEL_SSE2)
+    for (; i + 4 <= numSamples; i += 4) {
+        addToFourAccumulated(accumulator + i, _mm_loadu_si128((const __m128i*) (source + i)));
+    }
+#endif
+
+    for (; i < numSamples; i++) {
+        accumulator[i] += source[i];
+    }
+}
+
+void AudioMixKernel::addSpatialized(int32_t* goodChannel, int32_t* delayedChannel, const int16_t* source,
+                                    float attenuation, float weakChannelRatio, int numSamplesDelay, int numSamples) {
+    // the good channel hears every attenuated sample right away
+    addScaled(goodChannel, source, attenuation, numSamples);
+
+    // the delayed channel hears the same attenuated samples scaled down again, numSamplesDelay samples later
+    int32_t* delayedDestination = delayedChannel + numSamplesDelay;
+    int numDelayedSamples = numSamples - numSamplesDelay;
+    int i = 0;
+
+#if defined(AUDIO_MIX_KERNEL_AVX2)
+    __m256 attenuationVector = _mm256_set1_ps(attenuation);
+    __m256 weakChannelVector = _mm256_set1_ps(weakChannelRatio);
+    for (; i + 8 <= numDelayedSamples; i += 8) {
+        __m256i attenuatedSamples = scaleEightSamples(loadEightSamples(source + i), attenuationVector);
+        addToEightAccumulated(delayedDestination + i, scaleEightSamples(attenuatedSamples, weakChannelVector));
+    }
+#elif defined(AUDIO_MIX_KERNEL_SSE2)
+    __m128 attenuationVector = _mm_set1_ps(attenuation);
+    __m128 weakChannelVector = _mm_set1_ps(weakChannelRatio);
+    for (; i + 4 <= numDelayedSamples; i += 4) {
+        __m128i attenuatedSamples = scaleFourSamples(loadFourSamples(source + i), attenuationVector);
+        addToFourAccumulated(delayedDestination + i, scaleFourSamples(attenuatedSamples, weakChannelVector));
+    }
+#endif
+
+    for (; i < numDelayedSamples; i++) {
+        int32_t attenuatedSample = (int32_t) (source[i] * attenuation);
+        delayedDestination[i] += (int32_t) (attenuatedSample * weakChannelRatio);
+    }
+}
+
+void AudioMixKernel::saturateAndInterleave(const int32_t* leftChannel, const int32_t* rightChannel,
+                                           int16_t* destination, int numSamples) {
+    int i = 0;
+
+#if defined(AUDIO_MIX_KERNEL_SSE2)
+    for (; i + 8 <= numSamples; i += 8) {
+        // packs saturates each int32 lane to int16
+        __m128i leftSamples = _mm_packs_epi32(_mm_loadu_si128((const __m128i*) (leftChannel + i)),
+                                              _mm_loadu_si128((const __m128i*) (leftChannel + i + 4)));
+        __m128i rightSamples = _mm_packs_epi32(_mm_loadu_si128((const __m128i*) (rightChannel + i)),
+                                               _mm_loadu_si128((const __m128i*) (rightChannel + i + 4)));
+
+        _mm_storeu_si128((__m128i*) (destination + (i * 2)), _mm_unpacklo_epi16(leftSamples, rightSamples));
+        _mm_storeu_si128((__m128i*) (destination + (i * 2) + 8), _mm_unpackhi_epi16(leftSamples, rightSamples));
+    }
+#endif
+
+    for (; i < numSamples; i++) {
+        int32_t leftSample = leftChannel[i];
+        int32_t rightSample = rightChannel[i];
+
+        destination[i * 2] = (int16_t) (leftSample > MAX_MIXED_SAMPLE_VALUE ? MAX_MIXED_SAMPLE_VALUE
+                                        : (leftSample < MIN_MIXED_SAMPLE_VALUE ? MIN_MIXED_SAMPLE_VALUE : leftSample));
+        destination[(i * 2) + 1] = (int16_t) (rightSample > MAX_MIXED_SAMPLE_VALUE ? MAX_MIXED_SAMPLE_VALUE
+                                              : (rightSample < MIN_MIXED_SAMPLE_VALUE ? MIN_MIXED_SAMPLE_VALUE : rightSample));
+    }
+}
@@ -0,0 +1,41 @@
+//
+//  AudioMixKernel.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+//  Vectorized sample loops used by the audio mixer. Sources are accumulated into int32 per-channel buffers
+//  and only saturated back to int16 once the whole mix is done.
+//
+
+#ifndef __hifi__AudioMixKernel__
+#define __hifi__AudioMixKernel__
+
+#include <stdint.h>
+
+namespace AudioMixKernel {
+
+    /// \return the name of the instruction set the kernel was compiled for ("AVX2", "SSE2" or "scalar")
+    const char* getImplementationName();
+
+    /// accumulator[i] += (int) (source[i] * gain) for each of numSamples samples
+    void addScaled(int32_t* accumulator, const int16_t* source, float gain, int numSamples);
+
+    /// accumulator[i] += source[i] for each of numSamples samples, used to add a mix that was accumulated elsewhere
+    void addAccumulated(int32_t* accumulator, const int32_t* source, int numSamples);
+
+    /// adds a spatialized mono source to the two channel accumulators
+    /// \param goodChannel accumulator that receives each attenuated sample as-is
+    /// \param delayedChannel accumulator that receives the attenuated sample scaled by weakChannelRatio,
+    /// numSamplesDelay samples later - anything that would land past numSamples is dropped
+    /// \param source numSamples mono samples
+    void addSpatialized(int32_t* goodChannel, int32_t* delayedChannel, const int16_t* source,
+                        float attenuation, float weakChannelRatio, int numSamplesDelay, int numSamples);
+
+    /// saturates the accumulated channels to int16 and interleaves them into destination (2 * numSamples samples)
+    void saturateAndInterleave(const int32_t* leftChannel, const int32_t* rightChannel,
+                               int16_t* destination, int numSamples);
+}
+
+#endif /* defined(__hifi__AudioMixKernel__) */
@@ -20,7 +20,10 @@ AudioRingBuffer::AudioRingBuffer(int numFrameSamples) :
     _sampleCapacity(numFrameSamples * RING_BUFFER_LENGTH_FRAMES),
     _numFrameSamples(numFrameSamples),
     _isStarved(true),
-    _hasStarted(false)
+    _hasStarted(false),
+    _codecType(AudioCodecType::PCM),
+    _decoder(NULL),
+    _decoderType(AudioCodecType::PCM)
 {
     if (numFrameSamples) {
         _buffer = new int16_t[_sampleCapacity];
@@ -35,6 +38,7 @@ AudioRingBuffer::AudioRingBuffer(int numFrameSamples) :
 
 AudioRingBuffer::~AudioRingBuffer() {
     delete[] _buffer;
+    delete _decoder;
 }
 
 void AudioRingBuffer::reset() {
@@ -53,7 +57,43 @@ void AudioRingBuffer::resizeForFrameSize(qint64 numFrameSamples) {
 
 int AudioRingBuffer::parseData(const QByteArray& packet) {
     int numBytesPacketHeader = numBytesForPacketHeader(packet);
-    return writeData(packet.data() + numBytesPacketHeader, packet.size() - numBytesPacketHeader);
+    return writeEncodedData(packet.data() + numBytesPacketHeader, packet.size() - numBytesPacketHeader);
+}
+
+int AudioRingBuffer::writeEncodedData(const char* data, qint64 numBytes) {
+    if (numBytes < (qint64) sizeof(AudioCodecType_t)) {
+        return 0;
+    }
+    
+    memcpy(&_codecType, data, sizeof(AudioCodecType_t));
+    
+    if (_codecType == AudioCodecType::PCM) {
+        // nothing to decode, just copy the samples straight in
+        return sizeof(AudioCodecType_t) + writeData(data + sizeof(AudioCodecType_t), numBytes - sizeof(AudioCodecType_t));
+    }
+    
+    // a codec we can't create is only tried, and logged, once until the stream switches to another
+    if (_decoderType != _codecType) {
+        delete _decoder;
+        _decoder = AudioCodec::create(_codecType);
+        _decoderType = _codecType;
+        
+        if (!_decoder) {
+            qDebug() << "Dropping audio encoded with unsupported codec" << _codecType;
+        }
+    }
+    
+    if (!_decoder) {
+        return numBytes;
+    }
+    
+    // no frame we send is ever more than a stereo network buffer
+    int16_t decodedSamples[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+    int numDecodedSamples = _decoder->decode(data + sizeof(AudioCodecType_t), numBytes - sizeof(AudioCodecType_t),
+                                             decodedSamples, NETWORK_BUFFER_LENGTH_SAMPLES_STEREO);
+    writeSamples(decodedSamples, numDecodedSamples);
+    
+    return numBytes;
 }
 
 qint64 AudioRingBuffer::readSamples(int16_t* destination, qint64 maxSamples) {
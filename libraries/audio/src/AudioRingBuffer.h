@@ -18,6 +18,8 @@
 
 #include "NodeData.h"
 
+#include "AudioCodec.h"
+
 const int SAMPLE_RATE = 24000;
 
 const int NETWORK_BUFFER_LENGTH_BYTES_STEREO = 1024;
@@ -46,6 +48,13 @@ public:
     
     int parseData(const QByteArray& packet);
     
+    /// decodes a payload that starts with its AudioCodecType_t and writes the samples into the buffer
+    /// \return the number of bytes of the payload that were consumed
+    int writeEncodedData(const char* data, qint64 numBytes);
+    
+    /// the codec used by the last payload passed to writeEncodedData
+    AudioCodecType_t getCodecType() const { return _codecType; }
+    
     // assume callers using this will never wrap around the end
     const int16_t* getNextOutput() { return _nextOutput; }
     const int16_t* getBuffer() { return _buffer; }
@@ -84,6 +93,9 @@ protected:
     int16_t* _buffer;
     bool _isStarved;
     bool _hasStarted;
+    AudioCodecType_t _codecType;
+    AudioCodec* _decoder;
+    AudioCodecType_t _decoderType;
 };
 
 #endif /* defined(__interface__AudioRingBuffer__) */
@@ -40,6 +40,10 @@ int PositionalAudioRingBuffer::parseData(const QByteArray& packet) {
     readBytes += parsePositionalData(packet.mid(readBytes));
    
     if (packetTypeForPacket(packet) == PacketTypeSilentAudioFrame) {
+        // even with no audio the codec byte tells us how this client wants its mixes encoded
+        memcpy(&_codecType, packet.data() + readBytes, sizeof(AudioCodecType_t));
+        readBytes += sizeof(AudioCodecType_t);
+        
         // this source had no audio to send us, but this counts as a packet
         // write silence equivalent to the number of silent samples they just sent us
         int16_t numSilentSamples;
@@ -51,7 +55,7 @@ int PositionalAudioRingBuffer::parseData(const QByteArray& packet) {
         addSilentFrame(numSilentSamples);
     } else {
         // there is audio data to read
-        readBytes += writeData(packet.data() + readBytes, packet.size() - readBytes);
+        readBytes += writeEncodedData(packet.data() + readBytes, packet.size() - readBytes);
     }
     
     return readBytes;
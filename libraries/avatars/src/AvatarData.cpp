@@ -67,6 +67,14 @@ void AvatarData::setHandPosition(const glm::vec3& handPosition) {
 }
 
 QByteArray AvatarData::toByteArray() {
+    QByteArray avatarDataByteArray;
+    avatarDataByteArray.resize(MAX_PACKET_SIZE);
+    
+    avatarDataByteArray.resize(packAvatarData(reinterpret_cast<unsigned char*>(avatarDataByteArray.data())));
+    return avatarDataByteArray;
+}
+
+int AvatarData::packAvatarData(unsigned char* destinationBuffer) {
     // TODO: DRY this up to a shared method
     // that can pack any type given the number of bytes
     // and return the number of bytes to push the pointer
@@ -76,10 +84,6 @@ QByteArray AvatarData::toByteArray() {
         _headData = new HeadData(this);
     }
     
-    QByteArray avatarDataByteArray;
-    avatarDataByteArray.resize(MAX_PACKET_SIZE);
-    
-    unsigned char* destinationBuffer = reinterpret_cast<unsigned char*>(avatarDataByteArray.data());
     unsigned char* startPosition = destinationBuffer;
     
     memcpy(destinationBuffer, &_position, sizeof(_position));
@@ -145,10 +149,11 @@ QByteArray AvatarData::toByteArray() {
         memcpy(destinationBuffer, &_headData->_browAudioLift, sizeof(float));
         destinationBuffer += sizeof(float);
         
+        // blendshape coefficients are between 0 and 1, one byte each is plenty to drive the face
         *destinationBuffer++ = _headData->_blendshapeCoefficients.size();
-        memcpy(destinationBuffer, _headData->_blendshapeCoefficients.data(),
-            _headData->_blendshapeCoefficients.size() * sizeof(float));
-        destinationBuffer += _headData->_blendshapeCoefficients.size() * sizeof(float);
+        foreach (float coefficient, _headData->_blendshapeCoefficients) {
+            destinationBuffer += packFloatToByte(destinationBuffer, glm::clamp(coefficient, 0.0f, 1.0f), 1.0f);
+        }
     }
     
     // pupil dilation
@@ -172,11 +177,11 @@ QByteArray AvatarData::toByteArray() {
     }
     foreach (const JointData& data, _jointData) {
         if (data.valid) {
-            destinationBuffer += packOrientationQuatToBytes(destinationBuffer, data.rotation);
+            destinationBuffer += packOrientationQuatToSixBytes(destinationBuffer, data.rotation);
         }
     }
         
-    return avatarDataByteArray.left(destinationBuffer - startPosition);
+    return destinationBuffer - startPosition;
 }
 
 bool AvatarData::shouldLogError(const quint64& now) {
@@ -407,7 +412,7 @@ int AvatarData::parseDataAtOffset(const QByteArray& packet, int offset) {
             _headData->_browAudioLift = browAudioLift;
             
             int numCoefficients = (int)(*sourceBuffer++);
-            int blendDataSize = numCoefficients * sizeof(float);
+            int blendDataSize = numCoefficients * sizeof(unsigned char);
             minPossibleSize += blendDataSize;
             if (minPossibleSize > maxAvailableSize) {
                 if (shouldLogError(now)) {
@@ -420,8 +425,9 @@ int AvatarData::parseDataAtOffset(const QByteArray& packet, int offset) {
             }
 
             _headData->_blendshapeCoefficients.resize(numCoefficients);
-            memcpy(_headData->_blendshapeCoefficients.data(), sourceBuffer, blendDataSize);
-            sourceBuffer += numCoefficients * sizeof(float);
+            for (int i = 0; i < numCoefficients; i++) {
+                sourceBuffer += unpackFloatFromByte(sourceBuffer, _headData->_blendshapeCoefficients[i], 1.0f);
+            }
     
             //bitItemsDataSize = 4 * sizeof(float) + 1 + blendDataSize;
         }
@@ -463,9 +469,9 @@ int AvatarData::parseDataAtOffset(const QByteArray& packet, int offset) {
     }
     // 1 + bytesOfValidity bytes
 
-    // each joint rotation component is stored in two bytes (sizeof(uint16_t))
-    int COMPONENTS_PER_QUATERNION = 4;
-    minPossibleSize += numValidJoints * COMPONENTS_PER_QUATERNION * sizeof(uint16_t);
+    // each joint rotation is stored as its three smallest components in six bytes
+    const int BYTES_PER_JOINT_ROTATION = 6;
+    minPossibleSize += numValidJoints * BYTES_PER_JOINT_ROTATION;
     if (minPossibleSize > maxAvailableSize) {
         if (shouldLogError(now)) {
             qDebug() << "Malformed AvatarData packet after JointData;"
@@ -480,10 +486,10 @@ int AvatarData::parseDataAtOffset(const QByteArray& packet, int offset) {
         for (int i = 0; i < numJoints; i++) {
             JointData& data = _jointData[i];
             if (data.valid) {
-                sourceBuffer += unpackOrientationQuatFromBytes(sourceBuffer, data.rotation);
+                sourceBuffer += unpackOrientationQuatFromSixBytes(sourceBuffer, data.rotation);
             }
         }
-    } // numJoints * 8 bytes
+    } // numValidJoints * 6 bytes
     _hasNewJointRotations = true;
     
     return sourceBuffer - startPosition;
@@ -104,6 +104,10 @@ public:
     void setHandPosition(const glm::vec3& handPosition);
 
     QByteArray toByteArray();
+    
+    /// packs the same data as toByteArray into a buffer that can hold at least MAX_PACKET_SIZE bytes
+    /// \return the number of bytes packed
+    int packAvatarData(unsigned char* destinationBuffer);
 
     /// \return true if an error should be logged
     bool shouldLogError(const quint64& now);
@@ -0,0 +1,170 @@
+//
+//  AvatarStateDelta.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include <SharedUtil.h>
+
+#include "AvatarStateDelta.h"
+
+AvatarStateHistory::AvatarStateHistory() {
+    clear();
+}
+
+const QByteArray* AvatarStateHistory::getState(quint16 sequence) const {
+    int index = sequence % AVATAR_STATE_HISTORY_SIZE;
+    return (_isValid[index] && _sequences[index] == sequence) ? &_states[index] : NULL;
+}
+
+QByteArray* AvatarStateHistory::getBufferForState(quint16 sequence) {
+    int index = sequence % AVATAR_STATE_HISTORY_SIZE;
+
+    // a late state must not push out a newer one, which may still be needed as a base
+    if (_isValid[index] && _sequences[index] != sequence && !isAvatarSequenceNewer(sequence, _sequences[index])) {
+        return NULL;
+    }
+
+    _sequences[index] = sequence;
+    _isValid[index] = true;
+    return &_states[index];
+}
+
+void AvatarStateHistory::removeState(quint16 sequence) {
+    int index = sequence % AVATAR_STATE_HISTORY_SIZE;
+    if (_sequences[index] == sequence) {
+        _isValid[index] = false;
+    }
+}
+
+void AvatarStateHistory::clear() {
+    for (int i = 0; i < AVATAR_STATE_HISTORY_SIZE; i++) {
+        _sequences[i] = 0;
+        _isValid[i] = false;
+    }
+}
+
+static int numWordsForStateBytes(int numStateBytes) {
+    return (numStateBytes + AVATAR_STATE_DELTA_WORD_BYTES - 1) / AVATAR_STATE_DELTA_WORD_BYTES;
+}
+
+static int numMaskBytesForWords(int numWords) {
+    return (numWords + BITS_IN_BYTE - 1) / BITS_IN_BYTE;
+}
+
+int maxPackedAvatarStateBytes(int numStateBytes) {
+    return sizeof(quint16) + numMaskBytesForWords(numWordsForStateBytes(numStateBytes)) + numStateBytes;
+}
+
+int packAvatarState(const QByteArray& state, const QByteArray* baseState, unsigned char* destination) {
+    unsigned char* startPosition = destination;
+
+    quint16 numStateBytes = state.size();
+    memcpy(destination, &numStateBytes, sizeof(numStateBytes));
+    destination += sizeof(numStateBytes);
+
+    if (!baseState) {
+        memcpy(destination, state.constData(), numStateBytes);
+        return destination + numStateBytes - startPosition;
+    }
+
+    int numWords = numWordsForStateBytes(numStateBytes);
+    unsigned char* changedMask = destination;
+    memset(changedMask, 0, numMaskBytesForWords(numWords));
+    destination += numMaskBytesForWords(numWords);
+
+    for (int i = 0; i < numWords; i++) {
+        int wordOffset = i * AVATAR_STATE_DELTA_WORD_BYTES;
+        int wordBytes = std::min(AVATAR_STATE_DELTA_WORD_BYTES, numStateBytes - wordOffset);
+
+        // a word is only left out if the base has every one of its bytes
+        if (wordOffset + wordBytes <= baseState->size()
+            && memcmp(state.constData() + wordOffset, baseState->constData() + wordOffset, wordBytes) == 0) {
+            continue;
+        }
+
+        changedMask[i / BITS_IN_BYTE] |= (1 << (i % BITS_IN_BYTE));
+        memcpy(destination, state.constData() + wordOffset, wordBytes);
+        destination += wordBytes;
+    }
+
+    return destination - startPosition;
+}
+
+int numBytesForPackedAvatarState(const unsigned char* source, int maxBytes, bool isDelta) {
+    if (maxBytes < (int) sizeof(quint16)) {
+        return -1;
+    }
+
+    quint16 numStateBytes;
+    memcpy(&numStateBytes, source, sizeof(numStateBytes));
+
+    int numPackedBytes = sizeof(numStateBytes);
+
+    if (!isDelta) {
+        numPackedBytes += numStateBytes;
+        return numPackedBytes <= maxBytes ? numPackedBytes : -1;
+    }
+
+    int numWords = numWordsForStateBytes(numStateBytes);
+    int numMaskBytes = numMaskBytesForWords(numWords);
+    if (numPackedBytes + numMaskBytes > maxBytes) {
+        return -1;
+    }
+
+    const unsigned char* changedMask = source + numPackedBytes;
+    numPackedBytes += numMaskBytes;
+
+    for (int i = 0; i < numWords; i++) {
+        if (changedMask[i / BITS_IN_BYTE] & (1 << (i % BITS_IN_BYTE))) {
+            int wordOffset = i * AVATAR_STATE_DELTA_WORD_BYTES;
+            numPackedBytes += std::min(AVATAR_STATE_DELTA_WORD_BYTES, numStateBytes - wordOffset);
+        }
+    }
+
+    return numPackedBytes <= maxBytes ? numPackedBytes : -1;
+}
+
+int unpackAvatarState(const unsigned char* source, int maxBytes, const QByteArray* baseState, QByteArray& state) {
+    int numPackedBytes = numBytesForPackedAvatarState(source, maxBytes, baseState != NULL);
+    if (numPackedBytes == -1) {
+        return -1;
+    }
+
+    quint16 numStateBytes;
+    memcpy(&numStateBytes, source, sizeof(numStateBytes));
+    source += sizeof(numStateBytes);
+
+    state.resize(numStateBytes);
+
+    if (!baseState) {
+        memcpy(state.data(), source, numStateBytes);
+        return numPackedBytes;
+    }
+
+    int numWords = numWordsForStateBytes(numStateBytes);
+    const unsigned char* changedMask = source;
+    source += numMaskBytesForWords(numWords);
+
+    for (int i = 0; i < numWords; i++) {
+        int wordOffset = i * AVATAR_STATE_DELTA_WORD_BYTES;
+        int wordBytes = std::min(AVATAR_STATE_DELTA_WORD_BYTES, numStateBytes - wordOffset);
+
+        if (changedMask[i / BITS_IN_BYTE] & (1 << (i % BITS_IN_BYTE))) {
+            memcpy(state.data() + wordOffset, source, wordBytes);
+            source += wordBytes;
+        } else if (wordOffset + wordBytes <= baseState->size()) {
+            memcpy(state.data() + wordOffset, baseState->constData() + wordOffset, wordBytes);
+        } else {
+            // this was packed against some other base
+            return -1;
+        }
+    }
+
+    return numPackedBytes;
+}
@@ -0,0 +1,68 @@
+//
+//  AvatarStateDelta.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+//  The avatar-mixer numbers every packed state of an avatar and sends it to each listener as the words that changed
+//  since a state that listener has acknowledged. Both sides keep the last AVATAR_STATE_HISTORY_SIZE states so that
+//  the mixer only ever picks a base state the listener still has.
+
+#ifndef __hifi__AvatarStateDelta__
+#define __hifi__AvatarStateDelta__
+
+#include <QtCore/QByteArray>
+
+#include <UUID.h>
+
+const int AVATAR_STATE_HISTORY_SIZE = 32;
+
+/// states are compared in words of this many bytes, which lines up with most of the fields of a packed avatar
+const int AVATAR_STATE_DELTA_WORD_BYTES = 4;
+
+/// A PacketTypeBulkAvatarData packet is the sequence number of the packet followed by an entry per avatar. Each entry
+/// is the avatar's UUID, the sequence number of the state and the sequence number of the state it was packed against,
+/// which is the same as the first when the state is sent whole, then the packed state.
+const int BULK_AVATAR_DATA_ENTRY_HEADER_BYTES = NUM_BYTES_RFC4122_UUID + sizeof(quint16) + sizeof(quint16);
+
+/// \return true if sequence a is newer than sequence b, allowing for wrap around
+inline bool isAvatarSequenceNewer(quint16 a, quint16 b) { return (qint16) (a - b) > 0; }
+
+/// The last few packed states of one avatar, by sequence number.
+class AvatarStateHistory {
+public:
+    AvatarStateHistory();
+
+    /// \return the state with this sequence number, or NULL if it was never kept or a newer state has replaced it
+    const QByteArray* getState(quint16 sequence) const;
+
+    /// \return the buffer to keep the state with this sequence number in, or NULL if a newer state is using it
+    QByteArray* getBufferForState(quint16 sequence);
+
+    /// forgets a state whose buffer turned out not to hold a good one
+    void removeState(quint16 sequence);
+
+    void clear();
+
+private:
+    QByteArray _states[AVATAR_STATE_HISTORY_SIZE];
+    quint16 _sequences[AVATAR_STATE_HISTORY_SIZE];
+    bool _isValid[AVATAR_STATE_HISTORY_SIZE];
+};
+
+/// \return the most bytes packAvatarState will write for a state of numStateBytes
+int maxPackedAvatarStateBytes(int numStateBytes);
+
+/// packs the words of state that differ from baseState, or all of state if baseState is NULL
+/// \return the number of bytes written to destination
+int packAvatarState(const QByteArray& state, const QByteArray* baseState, unsigned char* destination);
+
+/// \return the number of bytes a packed state takes up in source, or -1 if it does not fit in maxBytes
+int numBytesForPackedAvatarState(const unsigned char* source, int maxBytes, bool isDelta);
+
+/// rebuilds a state packed by packAvatarState, baseState must be the one it was packed against (or NULL)
+/// \return the number of bytes read from source, or -1 if the packed state does not fit in maxBytes
+int unpackAvatarState(const unsigned char* source, int maxBytes, const QByteArray* baseState, QByteArray& state);
+
+#endif /* defined(__hifi__AvatarStateDelta__) */
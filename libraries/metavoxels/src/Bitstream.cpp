@@ -98,8 +98,9 @@ QList<const QMetaObject*> Bitstream::getMetaObjectSubClasses(const QMetaObject*
 Bitstream::Bitstream(QDataStream& underlying, MetadataType metadataType, QObject* parent) :
     QObject(parent),
     _underlying(underlying),
-    _byte(0),
-    _position(0),
+    _bits(0),
+    _bitCount(0),
+    _writeBufferSize(0),
     _metadataType(metadataType),
     _metaObjectStreamer(*this),
     _typeStreamerStreamer(*this),
@@ -118,52 +119,153 @@ void Bitstream::addTypeSubstitution(const QByteArray& typeName, int type) {
 
 const int LAST_BIT_POSITION = BITS_IN_BYTE - 1;
 
+/// The most bits moved through the accumulator at once, which leaves room for a partial byte on either side of them.
+const int MAX_ACCUMULATED_BITS = 56;
+
+/// Reads up to eight bytes as a little-endian word, which is the order bits are streamed in.
+static inline quint64 loadBytes(const quint8* bytes, int count) {
+    quint64 word = 0;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    memcpy(&word, bytes, count);
+#else
+    for (int i = 0; i < count; i++) {
+        word |= (quint64)bytes[i] << (i * BITS_IN_BYTE);
+    }
+#endif
+    return word;
+}
+
+/// Writes the low bytes of a word, in little-endian order.
+static inline void storeBytes(quint8* bytes, quint64 word, int count) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    memcpy(bytes, &word, count);
+#else
+    for (int i = 0; i < count; i++) {
+        bytes[i] = (quint8)(word >> (i * BITS_IN_BYTE));
+    }
+#endif
+}
+
+static inline quint64 lowBitMask(int bits) {
+    return ((quint64)1 << bits) - 1;
+}
+
 Bitstream& Bitstream::write(const void* data, int bits, int offset) {
-    const quint8* source = (const quint8*)data;
+    const quint8* source = (const quint8*)data + offset / BITS_IN_BYTE;
+    offset &= LAST_BIT_POSITION;
+    
+    // when neither side is in the middle of a byte, the whole bytes are copied as they are
+    if (offset == 0 && _bitCount == 0 && bits >= BITS_IN_BYTE) {
+        int bytes = bits / BITS_IN_BYTE;
+        writeBytes((const char*)source, bytes);
+        source += bytes;
+        bits -= bytes * BITS_IN_BYTE;
+    }
     while (bits > 0) {
-        int bitsToWrite = qMin(BITS_IN_BYTE - _position, qMin(BITS_IN_BYTE - offset, bits));
-        _byte |= ((*source >> offset) & ((1 << bitsToWrite) - 1)) << _position;
-        if ((_position += bitsToWrite) == BITS_IN_BYTE) {
-            flush();
-        }
-        if ((offset += bitsToWrite) == BITS_IN_BYTE) {
-            source++;
-            offset = 0;
+        int bitsToWrite = qMin(bits, MAX_ACCUMULATED_BITS);
+        quint64 value = (loadBytes(source, (offset + bitsToWrite + LAST_BIT_POSITION) / BITS_IN_BYTE) >> offset) &
+            lowBitMask(bitsToWrite);
+        _bits |= value << _bitCount;
+        _bitCount += bitsToWrite;
+        
+        // pass on the whole bytes, keeping the bits of the partial one
+        int bytes = _bitCount / BITS_IN_BYTE;
+        if (_writeBufferSize + (int)sizeof(quint64) > BITSTREAM_WRITE_BUFFER_BYTES) {
+            writeBufferedBytes();
         }
+        storeBytes((quint8*)_writeBuffer + _writeBufferSize, _bits, sizeof(quint64));
+        _writeBufferSize += bytes;
+        _bits >>= bytes * BITS_IN_BYTE;
+        _bitCount -= bytes * BITS_IN_BYTE;
+        
+        offset += bitsToWrite;
+        source += offset / BITS_IN_BYTE;
+        offset &= LAST_BIT_POSITION;
         bits -= bitsToWrite;
     }
     return *this;
 }
 
 Bitstream& Bitstream::read(void* data, int bits, int offset) {
-    quint8* dest = (quint8*)data;
+    quint8* dest = (quint8*)data + offset / BITS_IN_BYTE;
+    offset &= LAST_BIT_POSITION;
+    
+    // when neither side is in the middle of a byte, the whole bytes are copied as they are
+    if (offset == 0 && _bitCount == 0 && bits >= BITS_IN_BYTE) {
+        int bytes = bits / BITS_IN_BYTE;
+        readBytes((char*)dest, bytes);
+        dest += bytes;
+        bits -= bytes * BITS_IN_BYTE;
+    }
     while (bits > 0) {
-        if (_position == 0) {
-            _underlying >> _byte;
-        }
-        int bitsToRead = qMin(BITS_IN_BYTE - _position, qMin(BITS_IN_BYTE - offset, bits));
-        int mask = ((1 << bitsToRead) - 1) << offset;
-        *dest = (*dest & ~mask) | (((_byte >> _position) << offset) & mask);
-        _position = (_position + bitsToRead) & LAST_BIT_POSITION;
-        if ((offset += bitsToRead) == BITS_IN_BYTE) {
-            dest++;
-            offset = 0;
+        int bitsToRead = qMin(bits, MAX_ACCUMULATED_BITS);
+        if (_bitCount < bitsToRead) {
+            // take only the bytes these bits need, so as to leave the rest in the underlying stream
+            quint8 bytes[sizeof(quint64)];
+            int byteCount = (bitsToRead - _bitCount + LAST_BIT_POSITION) / BITS_IN_BYTE;
+            readBytes((char*)bytes, byteCount);
+            _bits |= loadBytes(bytes, byteCount) << _bitCount;
+            _bitCount += byteCount * BITS_IN_BYTE;
         }
+        quint64 value = _bits & lowBitMask(bitsToRead);
+        _bits >>= bitsToRead;
+        _bitCount -= bitsToRead;
+        
+        // replace the bits read in the destination, keeping those around them
+        int destBytes = (offset + bitsToRead + LAST_BIT_POSITION) / BITS_IN_BYTE;
+        quint64 mask = lowBitMask(bitsToRead) << offset;
+        storeBytes(dest, (loadBytes(dest, destBytes) & ~mask) | (value << offset), destBytes);
+        
+        offset += bitsToRead;
+        dest += offset / BITS_IN_BYTE;
+        offset &= LAST_BIT_POSITION;
         bits -= bitsToRead;
     }
     return *this;
 }
 
 void Bitstream::flush() {
-    if (_position != 0) {
-        _underlying << _byte;
-        reset();
+    if (_bitCount != 0) {
+        if (_writeBufferSize == BITSTREAM_WRITE_BUFFER_BYTES) {
+            writeBufferedBytes();
+        }
+        _writeBuffer[_writeBufferSize++] = (char)_bits;
     }
+    reset();
 }
 
 void Bitstream::reset() {
-    _byte = 0;
-    _position = 0;
+    writeBufferedBytes();
+    _bits = 0;
+    _bitCount = 0;
+}
+
+void Bitstream::writeBytes(const char* data, int size) {
+    if (_writeBufferSize + size > BITSTREAM_WRITE_BUFFER_BYTES) {
+        writeBufferedBytes();
+        if (size > BITSTREAM_WRITE_BUFFER_BYTES) {
+            _underlying.writeRawData(data, size);
+            return;
+        }
+    }
+    memcpy(_writeBuffer + _writeBufferSize, data, size);
+    _writeBufferSize += size;
+}
+
+void Bitstream::writeBufferedBytes() {
+    if (_writeBufferSize > 0) {
+        _underlying.writeRawData(_writeBuffer, _writeBufferSize);
+        _writeBufferSize = 0;
+    }
+}
+
+void Bitstream::readBytes(char* data, int size) {
+    // like reading a byte at a time from the underlying stream, bytes past its end read as zero
+    int bytesRead = qMax(_underlying.readRawData(data, size), 0);
+    if (bytesRead < size) {
+        memset(data + bytesRead, 0, size - bytesRead);
+        _underlying.setStatus(QDataStream::ReadPastEnd);
+    }
 }
 
 Bitstream::WriteMappings Bitstream::getAndResetWriteMappings() {
@@ -297,20 +399,29 @@ void Bitstream::readRawDelta(QObject*& value, const QObject* reference) {
 
 Bitstream& Bitstream::operator<<(bool value) {
     if (value) {
-        _byte |= (1 << _position);
+        _bits |= (1 << _bitCount);
     }
-    if (++_position == BITS_IN_BYTE) {
-        flush();
+    if (++_bitCount == BITS_IN_BYTE) {
+        if (_writeBufferSize == BITSTREAM_WRITE_BUFFER_BYTES) {
+            writeBufferedBytes();
+        }
+        _writeBuffer[_writeBufferSize++] = (char)_bits;
+        _bits = 0;
+        _bitCount = 0;
     }
     return *this;
 }
 
 Bitstream& Bitstream::operator>>(bool& value) {
-    if (_position == 0) {
-        _underlying >> _byte;
+    if (_bitCount == 0) {
+        quint8 byte;
+        readBytes((char*)&byte, 1);
+        _bits = byte;
+        _bitCount = BITS_IN_BYTE;
     }
-    value = _byte & (1 << _position);
-    _position = (_position + 1) & LAST_BIT_POSITION;
+    value = _bits & 1;
+    _bits >>= 1;
+    _bitCount--;
     return *this;
 }
 
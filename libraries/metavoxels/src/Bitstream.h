@@ -180,7 +180,13 @@ template<class K, class P, class V> inline RepeatedValueStreamer<K, P, V>&
     return *this;
 }
 
-/// A stream for bit-aligned data.
+/// The bytes a writing Bitstream keeps before handing them to the underlying stream.
+const int BITSTREAM_WRITE_BUFFER_BYTES = 1024;
+
+/// A stream for bit-aligned data.  Bits are moved up to 56 at a time through a 64-bit accumulator, and whole bytes are
+/// copied as they are when both sides are byte-aligned.  Written bytes are buffered and only reach the underlying stream
+/// when the buffer fills or the bitstream is flushed, so flush before using the underlying stream directly.  Reading takes
+/// no more bytes from the underlying stream than the bits read need.
 class Bitstream : public QObject {
     Q_OBJECT
 
@@ -242,10 +248,10 @@ public:
     /// \param offset the offset of the first bit
     Bitstream& read(void* data, int bits, int offset = 0);    
 
-    /// Flushes any unwritten bits to the underlying stream.
+    /// Flushes the buffered bytes and any unwritten bits, padded to a byte, to the underlying stream.
     void flush();
 
-    /// Resets to the initial state.
+    /// Resets to the initial state, writing out the buffered bytes but dropping any bits of a partial byte.
     void reset();
 
     /// Returns the set of transient mappings gathered during writing and resets them.
@@ -384,9 +390,15 @@ private slots:
 
 private:
     
+    void writeBytes(const char* data, int size);
+    void writeBufferedBytes();
+    void readBytes(char* data, int size);
+    
     QDataStream& _underlying;
-    quint8 _byte;
-    int _position;
+    quint64 _bits; ///< the bits of a partial byte, either waiting to be written or left over from the last byte read
+    int _bitCount;
+    char _writeBuffer[BITSTREAM_WRITE_BUFFER_BYTES];
+    int _writeBufferSize;
 
     MetadataType _metadataType;
 
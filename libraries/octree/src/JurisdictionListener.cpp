@@ -41,7 +41,7 @@ bool JurisdictionListener::queueJurisdictionRequest() {
     
     foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
         if (node->getType() == getNodeType() && node->getActiveSocket()) {
-            _packetSender.queuePacketForSending(node, QByteArray(reinterpret_cast<char*>(bufferOut), sizeOut));
+            _packetSender.queuePacketForSending(node, PacketBuffer(reinterpret_cast<char*>(bufferOut), sizeOut));
             nodeCount++;
         }
     }
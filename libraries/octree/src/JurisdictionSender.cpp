@@ -63,7 +63,7 @@ bool JurisdictionSender::process() {
             SharedNodePointer node = NodeList::getInstance()->nodeWithUUID(nodeUUID);
 
             if (node && node->getActiveSocket()) {
-                _packetSender.queuePacketForSending(node, QByteArray(reinterpret_cast<char *>(bufferOut), sizeOut));
+                _packetSender.queuePacketForSending(node, PacketBuffer(reinterpret_cast<char*>(bufferOut), sizeOut));
                 nodeCount++;
             }
         }
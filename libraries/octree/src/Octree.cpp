@@ -10,12 +10,20 @@
 #define _USE_MATH_DEFINES
 #endif
 
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <cmath>
 #include <fstream> // to load voxels from file
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QDebug>
+#include <QFile>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
 
 #include "CoverageMap.h"
 #include <GeometryUtil.h>
@@ -28,6 +36,7 @@
 #include "ViewFrustum.h"
 #include "OctreeConstants.h"
 #include "OctreeElementBag.h"
+#include "OctreeEncodeCache.h"
 #include "Octree.h"
 
 float boundaryDistanceForRenderLevel(unsigned int renderLevel, float voxelSizeScale) {
@@ -40,11 +49,15 @@ Octree::Octree(bool shouldReaverage) :
     _shouldReaverage(shouldReaverage),
     _stopImport(false),
     _lock(),
+    _encodeCache(NULL),
     _isViewing(false) 
 {
 }
 
 Octree::~Octree() {
+    // before the elements go, so that it isn't told about each of them
+    delete _encodeCache;
+
     // delete the children of the root node
     // this recursively deletes the tree
     delete _rootNode;
@@ -96,6 +109,135 @@ void Octree::recurseNodeWithPostOperation(OctreeElement* node, RecurseOctreeOper
 	operation(node, extraData);
 }
 
+static void visitSubtreeConcurrently(OctreeElement* element, OctreeConcurrentOperation& operation, bool postOrder,
+                                     int recursionCount = 0) {
+    if (recursionCount > DANGEROUSLY_DEEP_RECURSION) {
+        qDebug() << "Octree::recurseTreeWithConcurrentOperation() reached DANGEROUSLY_DEEP_RECURSION, bailing!";
+        return;
+    }
+
+    if (!postOrder && !operation.visit(element)) {
+        return;
+    }
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        OctreeElement* child = element->getChildAtIndex(i);
+        if (child) {
+            visitSubtreeConcurrently(child, operation, postOrder, recursionCount + 1);
+        }
+    }
+    if (postOrder) {
+        operation.visit(element);
+    }
+}
+
+// Visits subtrees with its copy of the operation, claiming the next subtree nobody has until there are none left
+class ConcurrentSubtreeVisitor : public QRunnable {
+public:
+    ConcurrentSubtreeVisitor(OctreeConcurrentOperation& operation, bool postOrder, OctreeElement* const* subtrees,
+                             int subtreeCount, QAtomicInt& nextSubtree, QSemaphore& finished) :
+        _operation(operation),
+        _postOrder(postOrder),
+        _subtrees(subtrees),
+        _subtreeCount(subtreeCount),
+        _nextSubtree(nextSubtree),
+        _finished(finished) { }
+
+    virtual void run() {
+        int subtreeIndex = _nextSubtree.fetchAndAddOrdered(1);
+        while (subtreeIndex < _subtreeCount) {
+            visitSubtreeConcurrently(_subtrees[subtreeIndex], _operation, _postOrder);
+            subtreeIndex = _nextSubtree.fetchAndAddOrdered(1);
+        }
+        _finished.release();
+    }
+
+private:
+    OctreeConcurrentOperation& _operation;
+    bool _postOrder;
+    OctreeElement* const* _subtrees;
+    int _subtreeCount;
+    QAtomicInt& _nextSubtree;
+    QSemaphore& _finished;
+};
+
+// the threads that help the calling thread with concurrent operations, shared by all trees, made the first time it's needed
+static QAtomicPointer<QThreadPool> concurrentOperationPoolPointer;
+
+static QThreadPool* concurrentOperationPool() {
+    QThreadPool* existingPool = concurrentOperationPoolPointer.loadAcquire();
+    if (existingPool) {
+        return existingPool;
+    }
+    QThreadPool* newPool = new QThreadPool();
+    newPool->setMaxThreadCount(std::max(QThread::idealThreadCount() - 1, 1));
+    if (concurrentOperationPoolPointer.testAndSetOrdered(NULL, newPool)) {
+        return newPool;
+    }
+    delete newPool; // another thread made it first
+    return concurrentOperationPoolPointer.loadAcquire();
+}
+
+// split the tree into this many subtrees for each thread, so that the threads that finish theirs first can take more
+const int CONCURRENT_SUBTREES_PER_THREAD = 8;
+
+// but visit no more than this many levels at the top of the tree on the calling thread alone
+const int MAX_CONCURRENT_SPLIT_LEVELS = 4;
+
+void Octree::recurseTreeWithConcurrentOperation(OctreeConcurrentOperation& operation, bool postOrder) {
+    QThreadPool* pool = concurrentOperationPool();
+    int threadCount = pool->maxThreadCount() + 1;
+
+    // visit the top of the tree a level at a time, until there are enough subtrees below it to go around
+    QVector<OctreeElement*> topElements;
+    QVector<OctreeElement*> subtrees;
+    subtrees.append(_rootNode);
+    for (int level = 0; level < MAX_CONCURRENT_SPLIT_LEVELS && !subtrees.isEmpty()
+            && subtrees.size() < threadCount * CONCURRENT_SUBTREES_PER_THREAD; level++) {
+        QVector<OctreeElement*> subtreesBelow;
+        foreach (OctreeElement* element, subtrees) {
+            topElements.append(element);
+            if (!postOrder && !operation.visit(element)) {
+                continue;
+            }
+            for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+                OctreeElement* child = element->getChildAtIndex(i);
+                if (child) {
+                    subtreesBelow.append(child);
+                }
+            }
+        }
+        subtrees = subtreesBelow;
+    }
+
+    // only threads that are free right away are asked to help, the calling thread takes whatever is left
+    QAtomicInt nextSubtree(0);
+    QSemaphore finished;
+    QVector<OctreeConcurrentOperation*> copies;
+    while (copies.size() < threadCount - 1 && copies.size() < subtrees.size() - 1) {
+        OctreeConcurrentOperation* copy = operation.clone();
+        if (!pool->tryStart(new ConcurrentSubtreeVisitor(*copy, postOrder, subtrees.constData(), subtrees.size(),
+                                                         nextSubtree, finished))) {
+            delete copy;
+            break;
+        }
+        copies.append(copy);
+    }
+    ConcurrentSubtreeVisitor(operation, postOrder, subtrees.constData(), subtrees.size(), nextSubtree, finished).run();
+    finished.acquire(copies.size() + 1);
+
+    foreach (OctreeConcurrentOperation* copy, copies) {
+        operation.merge(copy);
+        delete copy;
+    }
+
+    // the children of the top elements come after them, so in reverse each comes after its children
+    if (postOrder) {
+        for (int i = topElements.size() - 1; i >= 0; i--) {
+            operation.visit(topElements.at(i));
+        }
+    }
+}
+
 // Recurses voxel tree calling the RecurseOctreeOperation function for each node.
 // stops recursion if operation function returns false.
 void Octree::recurseTreeWithOperationDistanceSorted(RecurseOctreeOperation operation,
@@ -774,6 +916,96 @@ OctreeElement* Octree::getElementEnclosingPoint(const glm::vec3& point, Octree::
 
 
 
+void Octree::setWantEncodeCache(bool wantEncodeCache) {
+    if (wantEncodeCache && !_encodeCache && canCacheEncodedSubtrees()) {
+        _encodeCache = new OctreeEncodeCache();
+    } else if (!wantEncodeCache && _encodeCache) {
+        delete _encodeCache;
+        _encodeCache = NULL;
+    }
+}
+
+const int NOT_CACHEABLE = -1;
+
+// leaves room for the rounding of the distances to the elements below the one the key is for
+const float ENCODE_CACHE_DISTANCE_MARGIN = 0.001f;
+
+// smaller subtrees are about as quick to encode as to look up
+const int MIN_ENCODE_CACHE_SUBTREE_BYTES = 32;
+
+// The level of detail of the elements below one that is wholly in view depends on how far each of them is from the
+// camera. But if the element is far enough away that its nearest and furthest points are between the same two LOD
+// boundaries, every element below it is too, and it gets the same level of detail from every view that that is true of.
+// The key is the deepest level those views send and the kind of bitstream, for scenes that don't depend on what the viewer
+// was sent before.
+static int encodeCacheKeyFor(const OctreeElement* element, const EncodeBitstreamParams& params) {
+    if (!params.viewFrustum || params.deltaViewFrustum || params.wantOcclusionCulling || !params.forceSendScene
+            || params.maxEncodeLevel != INT_MAX) {
+        return NOT_CACHEABLE;
+    }
+
+    AABox box = element->getAABox();
+    box.scale(TREE_SCALE);
+    glm::vec3 nearCorner = box.getCorner();
+    glm::vec3 farCorner = box.getCorner() + glm::vec3(box.getScale(), box.getScale(), box.getScale());
+    glm::vec3 position = params.viewFrustum->getPosition();
+
+    glm::vec3 nearest = glm::clamp(position, nearCorner, farCorner);
+    glm::vec3 furthest(position.x < box.calcCenter().x ? farCorner.x : nearCorner.x,
+                       position.y < box.calcCenter().y ? farCorner.y : nearCorner.y,
+                       position.z < box.calcCenter().z ? farCorner.z : nearCorner.z);
+    float nearestDistance = glm::distance(position, nearest) * (1.0f - ENCODE_CACHE_DISTANCE_MARGIN);
+    float furthestDistance = glm::distance(position, furthest) * (1.0f + ENCODE_CACHE_DISTANCE_MARGIN);
+    if (nearestDistance <= 0.0f) {
+        return NOT_CACHEABLE;
+    }
+
+    // the boundaries halve with each level, find the deepest that's still beyond the furthest point, correcting for the
+    // rounding of the logarithm
+    int boundaryLevel = (int)floorf(logf(params.octreeElementSizeScale / furthestDistance) / logf(2.0f));
+    while (ldexpf(params.octreeElementSizeScale, -boundaryLevel) <= furthestDistance) {
+        boundaryLevel--;
+    }
+    while (ldexpf(params.octreeElementSizeScale, -(boundaryLevel + 1)) > furthestDistance) {
+        boundaryLevel++;
+    }
+    if (ldexpf(params.octreeElementSizeScale, -(boundaryLevel + 1)) >= nearestDistance) {
+        return NOT_CACHEABLE; // the next boundary is within the element
+    }
+
+    int deepestLevel = boundaryLevel - params.boundaryLevelAdjust;
+    if (deepestLevel < 0) {
+        return NOT_CACHEABLE;
+    }
+    return (deepestLevel << 3) | (params.includeColor ? 1 : 0) | (params.includeExistsBits ? 2 : 0)
+        | (params.jurisdictionMap ? 4 : 0);
+}
+
+int Octree::appendCachedSubtree(OctreeElement* node, int encodeCacheKey, OctreePacketData* packetData,
+                                EncodeBitstreamParams& params, int currentEncodeLevel) const {
+    QByteArray encoded;
+    int bytesWritten = 0;
+    int levelsBelow = 0;
+    OctreeEncodeCounts counts;
+    if (!_encodeCache->find(node, encodeCacheKey, encoded, bytesWritten, levelsBelow, counts)) {
+        return -1;
+    }
+
+    // a subtree that doesn't fit is encoded instead, to send as much of it as does fit
+    LevelDetails levelKey = packetData->startLevel();
+    if (!packetData->appendRawData(reinterpret_cast<const unsigned char*>(encoded.constData()), encoded.size())) {
+        packetData->discardLevel(levelKey);
+        return -1;
+    }
+    if (!packetData->endLevel(levelKey)) {
+        return -1;
+    }
+
+    params.maxLevelReached = std::max(params.maxLevelReached, currentEncodeLevel + levelsBelow);
+    params.stats->encodeCacheHit(counts);
+    return bytesWritten;
+}
+
 int Octree::encodeTreeBitstream(OctreeElement* node,
                         OctreePacketData* packetData, OctreeElementBag& bag,
                         EncodeBitstreamParams& params) {
@@ -1010,6 +1242,28 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* node,
         }
     }
 
+    // a subtree that encodes the same for several viewers may have been encoded for another one already
+    int encodeCacheKey = NOT_CACHEABLE;
+    int encodeCacheStartOffset = 0;
+    int maxLevelReachedBeforeSubtree = 0;
+    OctreeEncodeCounts countsBeforeSubtree;
+    if (_encodeCache && params.stats && nodeLocationThisView == ViewFrustum::INSIDE) {
+        encodeCacheKey = encodeCacheKeyFor(node, params);
+        if (encodeCacheKey != NOT_CACHEABLE) {
+            int cachedBytesWritten = appendCachedSubtree(node, encodeCacheKey, packetData, params, currentEncodeLevel);
+            if (cachedBytesWritten >= 0) {
+                return cachedBytesWritten;
+            }
+            params.stats->encodeCacheMiss();
+
+            // remember where the subtree starts and what has been counted, to cache it once it has been encoded
+            encodeCacheStartOffset = packetData->getUncompressedByteOffset();
+            maxLevelReachedBeforeSubtree = params.maxLevelReached;
+            params.maxLevelReached = currentEncodeLevel;
+            countsBeforeSubtree = params.stats->getEncodeCounts();
+        }
+    }
+
     bool keepDiggingDeeper = true; // Assuming we're in view we have a great work ethic, we're always ready for more!
 
     // At any given point in writing the bitstream, the largest minimum we might need to flesh out the current level
@@ -1424,86 +1678,293 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* node,
         bytesAtThisLevel = 0; // didn't fit
     }
 
+    if (encodeCacheKey != NOT_CACHEABLE) {
+        int levelsBelow = params.maxLevelReached - currentEncodeLevel;
+        params.maxLevelReached = std::max(params.maxLevelReached, maxLevelReachedBeforeSubtree);
+
+        // only whole subtrees are kept, not those that left some of their elements in the bag for the next packet
+        OctreeEncodeCounts counts = params.stats->getEncodeCounts().since(countsBeforeSubtree);
+        int encodedBytes = packetData->getUncompressedByteOffset() - encodeCacheStartOffset;
+        if (continueThisLevel && counts.didntFit == 0 && encodedBytes >= MIN_ENCODE_CACHE_SUBTREE_BYTES) {
+            QByteArray encoded(reinterpret_cast<const char*>(packetData->getUncompressedData()) + encodeCacheStartOffset,
+                               encodedBytes);
+            _encodeCache->insert(node, encodeCacheKey, encoded, bytesAtThisLevel, levelsBelow, counts);
+        }
+    }
+
     return bytesAtThisLevel;
 }
 
+// Chunked SVO files start with a byte that no plain SVO file can, since it would be the length of the first octal code.
+// The signature is followed by the container version, the packet type and version of the tree if it wants them, the
+// number of bytes in the top of the tree, the number of chunks and an index of them, then the top and the chunks. The
+// top is a bitstream of the elements above and including the chunk roots, each chunk a plain SVO bitstream of what is
+// below its root, so the chunks can be read into separate subtrees at once.
+const unsigned char CHUNKED_SVO_SIGNATURE[] = { 0xFF, 'S', 'V', 'C' };
+const quint8 CHUNKED_SVO_VERSION = 1;
+
+// the top of the tree is chunked at the shallowest level with enough subtrees to keep the loading threads busy
+const int MIN_SVO_CHUNKS = 64;
+const int MAX_SVO_CHUNK_LEVEL = 8;
+
+// how often the progress of a parallel load is reported
+const int SVO_CHUNK_PROGRESS_MSECS = 100;
+
+// an entry of the index, and the subtree it's read into
+class SVOChunk {
+public:
+    const unsigned char* octalCode;
+    const unsigned char* bitstream;
+    quint32 length;
+    OctreeElement* detachedRoot;
+    bool isBroken;
+};
+
+// Reads chunks into their detached roots, claiming the next chunk nobody has until there are none left
+class SVOChunkReader : public QRunnable {
+public:
+    SVOChunkReader(Octree* tree, SVOChunk* chunks, int chunkCount, QAtomicInt& nextChunk) :
+        _tree(tree),
+        _chunks(chunks),
+        _chunkCount(chunkCount),
+        _nextChunk(nextChunk) { }
+
+    virtual void run() {
+        ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS);
+        int chunkIndex = _nextChunk.fetchAndAddOrdered(1);
+        while (chunkIndex < _chunkCount) {
+            SVOChunk& chunk = _chunks[chunkIndex];
+            chunk.isBroken = !_tree->readBitstreamToSubtree(chunk.detachedRoot, chunk.bitstream, chunk.length, args);
+            chunkIndex = _nextChunk.fetchAndAddOrdered(1);
+        }
+    }
+
+private:
+    Octree* _tree;
+    SVOChunk* _chunks;
+    int _chunkCount;
+    QAtomicInt& _nextChunk;
+};
+
+bool Octree::readSVOFileVersion(const unsigned char*& dataAt, const unsigned char* dataEnd) {
+    if (!getWantSVOfileVersions()) {
+        return true; // assume the file is ok
+    }
+
+    // if so, read the first byte of the file and see if it matches the expected version code
+    PacketType expectedType = expectedDataPacketType();
+    if (dataEnd - dataAt < (int)(sizeof(PacketType) + sizeof(PacketVersion))) {
+        qDebug("SVO file is too short to have a type and version");
+        return false;
+    }
+
+    PacketType gotType;
+    memcpy(&gotType, dataAt, sizeof(gotType));
+    if (gotType != expectedType) {
+        qDebug("SVO file type mismatch. Expected: %c Got: %c", expectedType, gotType);
+        return false;
+    }
+    dataAt += sizeof(expectedType);
+
+    PacketVersion expectedVersion = versionForPacketType(expectedType);
+    PacketVersion gotVersion = *dataAt;
+    if (gotVersion != expectedVersion) {
+        qDebug("SVO file version mismatch. Expected: %d Got: %d", expectedVersion, gotVersion);
+        return false;
+    }
+    dataAt += sizeof(expectedVersion);
+    return true;
+}
+
+void Octree::writeSVOFileVersion(std::ostream& file) {
+    if (getWantSVOfileVersions()) {
+        PacketType expectedType = expectedDataPacketType();
+        PacketVersion expectedVersion = versionForPacketType(expectedType);
+        file.write(reinterpret_cast<char*>(&expectedType), sizeof(expectedType));
+        file.write(&expectedVersion, sizeof(expectedVersion));
+    }
+}
+
 bool Octree::readFromSVOFile(const char* fileName) {
     bool fileOk = false;
-    std::ifstream file(fileName, std::ios::in|std::ios::binary|std::ios::ate);
-    if(file.is_open()) {
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly)) {
         emit importSize(1.0f, 1.0f, 1.0f);
         emit importProgress(0);
 
         qDebug("Loading file %s...", fileName);
 
-        // get file length....
-        unsigned long fileLength = file.tellg();
-        file.seekg( 0, std::ios::beg );
+        // map the file rather than reading it into a buffer, unless it can't be
+        qint64 fileLength = file.size();
+        QByteArray entireFile;
+        const unsigned char* dataAt = file.map(0, fileLength);
+        if (!dataAt) {
+            entireFile = file.readAll();
+            dataAt = reinterpret_cast<const unsigned char*>(entireFile.constData());
+        }
+        const unsigned char* dataEnd = dataAt + fileLength;
 
-        // read the entire file into a buffer, WHAT!? Why not.
-        unsigned char* entireFile = new unsigned char[fileLength];
-        file.read((char*)entireFile, fileLength);
-        bool wantImportProgress = true;
+        if (fileLength >= (qint64)sizeof(CHUNKED_SVO_SIGNATURE)
+                && memcmp(dataAt, CHUNKED_SVO_SIGNATURE, sizeof(CHUNKED_SVO_SIGNATURE)) == 0) {
+            fileOk = readChunkedSVOFile(dataAt, fileLength);
+        } else if (readSVOFileVersion(dataAt, dataEnd)) {
+            bool wantImportProgress = true;
+            ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS, NULL, 0, SharedNodePointer(), wantImportProgress);
+            readBitstreamToTree(dataAt, dataEnd - dataAt, args);
+            fileOk = true;
+        }
 
-        unsigned char* dataAt = entireFile;
-        unsigned long  dataLength = fileLength;
-
-        // before reading the file, check to see if this version of the Octree supports file versions
-        if (getWantSVOfileVersions()) {
-            // if so, read the first byte of the file and see if it matches the expected version code
-            PacketType expectedType = expectedDataPacketType();
-            
-            PacketType gotType;
-            memcpy(&gotType, dataAt, sizeof(gotType));
-            
-            if (gotType == expectedType) {
-                dataAt += sizeof(expectedType);
-                dataLength -= sizeof(expectedType);
-                PacketVersion expectedVersion = versionForPacketType(expectedType);
-                PacketVersion gotVersion = *dataAt;
-                if (gotVersion == expectedVersion) {
-                    dataAt += sizeof(expectedVersion);
-                    dataLength -= sizeof(expectedVersion);
-                    fileOk = true;
-                } else {
-                    qDebug("SVO file version mismatch. Expected: %d Got: %d", expectedVersion, gotVersion);
-                }
-            } else {
-                qDebug("SVO file type mismatch. Expected: %c Got: %c", expectedType, gotType);
+        emit importProgress(100);
+
+        file.close(); // which unmaps it
+    }
+    return fileOk;
+}
+
+bool Octree::readChunkedSVOFile(const unsigned char* data, qint64 dataLength) {
+    const unsigned char* dataAt = data + sizeof(CHUNKED_SVO_SIGNATURE);
+    const unsigned char* dataEnd = data + dataLength;
+
+    quint32 topBytes;
+    quint32 chunkCount;
+    const int HEADER_BYTES = sizeof(CHUNKED_SVO_VERSION) + sizeof(topBytes) + sizeof(chunkCount);
+    if (dataEnd - dataAt < HEADER_BYTES || *dataAt != CHUNKED_SVO_VERSION) {
+        qDebug("Chunked SVO file version mismatch. Expected: %d", CHUNKED_SVO_VERSION);
+        return false;
+    }
+    dataAt += sizeof(CHUNKED_SVO_VERSION);
+
+    if (!readSVOFileVersion(dataAt, dataEnd) || dataEnd - dataAt < HEADER_BYTES - (int)sizeof(CHUNKED_SVO_VERSION)) {
+        return false;
+    }
+    memcpy(&topBytes, dataAt, sizeof(topBytes));
+    dataAt += sizeof(topBytes);
+    memcpy(&chunkCount, dataAt, sizeof(chunkCount));
+    dataAt += sizeof(chunkCount);
+
+    QVector<SVOChunk> chunks;
+    for (quint32 i = 0; i < chunkCount; i++) {
+        SVOChunk chunk;
+        quint64 offset;
+        if (dataEnd - dataAt < (int)(sizeof(offset) + sizeof(chunk.length)) + 1) {
+            qDebug("Chunked SVO file index is cut short");
+            return false;
+        }
+        memcpy(&offset, dataAt, sizeof(offset));
+        dataAt += sizeof(offset);
+        memcpy(&chunk.length, dataAt, sizeof(chunk.length));
+        dataAt += sizeof(chunk.length);
+
+        chunk.octalCode = dataAt;
+        int octalCodeBytes = bytesRequiredForCodeLength(*dataAt);
+        if (dataEnd - dataAt < octalCodeBytes || offset > (quint64)dataLength || chunk.length > dataLength - offset) {
+            qDebug("Chunked SVO file index has a chunk from outside of the file");
+            return false;
+        }
+        dataAt += octalCodeBytes;
+
+        chunk.bitstream = data + offset;
+        chunk.detachedRoot = NULL;
+        chunk.isBroken = false;
+        chunks.append(chunk);
+    }
+
+    if (topBytes > dataEnd - dataAt) {
+        qDebug("Chunked SVO file is cut short");
+        return false;
+    }
+    ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS);
+    readBitstreamToTree(dataAt, topBytes, args);
+
+    // the top gives us the roots of the chunks, and, as it is read here first, the key of the source UUID they all share.
+    // update hooks, like those of a VoxelSystem, expect to hear about elements on the thread that owns the tree.
+    if (canReadSubtreesConcurrently() && !OctreeElement::hasUpdateHooks() && chunks.size() > 1) {
+        for (int i = 0; i < chunks.size(); i++) {
+            int octalCodeBytes = bytesRequiredForCodeLength(*chunks[i].octalCode);
+            unsigned char* octalCode = new unsigned char[octalCodeBytes];
+            memcpy(octalCode, chunks[i].octalCode, octalCodeBytes);
+            chunks[i].detachedRoot = createNewElement(octalCode);
+        }
+
+        QThreadPool readerPool;
+        int readerCount = std::min(QThread::idealThreadCount(), chunks.size());
+        readerPool.setMaxThreadCount(readerCount);
+        QAtomicInt nextChunk(0);
+        for (int i = 0; i < readerCount; i++) {
+            readerPool.start(new SVOChunkReader(this, chunks.data(), chunks.size(), nextChunk));
+        }
+        while (!readerPool.waitForDone(SVO_CHUNK_PROGRESS_MSECS)) {
+            emit importProgress((100 * std::min(nextChunk.load(), chunks.size())) / chunks.size());
+        }
+    }
+
+    bool fileOk = true;
+    for (int i = 0; i < chunks.size(); i++) {
+        SVOChunk& chunk = chunks[i];
+        OctreeElement* chunkRoot = nodeForOctalCode(_rootNode, chunk.octalCode, NULL);
+        if (*chunkRoot->getOctalCode() != *chunk.octalCode) {
+            chunkRoot = createMissingNode(_rootNode, chunk.octalCode);
+        }
+
+        if (chunk.detachedRoot) {
+            // graft the subtree read in parallel onto the tree
+            if (!chunk.isBroken) {
+                chunkRoot->takeChildrenFrom(chunk.detachedRoot);
             }
+            delete chunk.detachedRoot;
         } else {
-            fileOk = true; // assume the file is ok
+            chunk.isBroken = !readBitstreamToSubtree(chunkRoot, chunk.bitstream, chunk.length, args);
+            emit importProgress((100 * (i + 1)) / chunks.size());
         }
-        if (fileOk) {
-            ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS, NULL, 0, SharedNodePointer(), wantImportProgress);
-            readBitstreamToTree(dataAt, dataLength, args);
+
+        if (chunk.isBroken) {
+            qDebug() << "Chunked SVO file has a broken chunk" << i << "- skipping it";
+            fileOk = false;
         }
-        delete[] entireFile;
+    }
+    _isDirty = true;
 
-        emit importProgress(100);
+    return fileOk;
+}
+
+bool Octree::readBitstreamToSubtree(OctreeElement* subtreeRoot, const unsigned char* bitstream, int bufferSizeBytes,
+                                    ReadBitstreamToTreeParams& args) {
+    const unsigned char* bitstreamAt = bitstream;
+    const unsigned char* bitstreamEnd = bitstream + bufferSizeBytes;
+
+    // like readBitstreamToTree(), except that subtreeRoot stands in for the root, and everything has to be below it
+    while (bitstreamAt < bitstreamEnd) {
+        int octalCodeBytes = bytesRequiredForCodeLength(*bitstreamAt);
+        if (octalCodeBytes > bitstreamEnd - bitstreamAt || !isAncestorOf(subtreeRoot->getOctalCode(), bitstreamAt)) {
+            return false;
+        }
+
+        OctreeElement* bitstreamRootNode = subtreeRoot;
+        if (*bitstreamAt != *subtreeRoot->getOctalCode()) {
+            bitstreamRootNode = nodeForOctalCode(subtreeRoot, bitstreamAt, NULL);
+            if (*bitstreamAt != *bitstreamRootNode->getOctalCode()) {
+                bitstreamRootNode = createMissingNode(subtreeRoot, bitstreamAt);
+            }
+        }
 
-        file.close();
+        bitstreamAt += octalCodeBytes;
+        bitstreamAt += readNodeData(bitstreamRootNode, bitstreamAt, bitstreamEnd - bitstreamAt, args);
     }
-    return fileOk;
+    return true;
 }
 
-void Octree::writeToSVOFile(const char* fileName, OctreeElement* node) {
+bool Octree::writeToSVOFile(const char* fileName, OctreeElement* node, bool wantTreeLock) {
 
     std::ofstream file(fileName, std::ios::out|std::ios::binary);
 
     if(file.is_open()) {
         qDebug("Saving to file %s...", fileName);
 
-        // before reading the file, check to see if this version of the Octree supports file versions
-        if (getWantSVOfileVersions()) {
-            // if so, read the first byte of the file and see if it matches the expected version code
-            PacketType expectedType = expectedDataPacketType();
-            PacketVersion expectedVersion = versionForPacketType(expectedType);
-            file.write(reinterpret_cast<char*>(&expectedType), sizeof(expectedType));
-            file.write(&expectedVersion, sizeof(expectedVersion));
-        }
+        // start with the packet type and version, if this Octree wants them
+        writeSVOFileVersion(file);
 
-        OctreeElementBag nodeBag;
+        // without the tree lock the tree can't change while we write it, so there are no deletes to hear about
+        OctreeElementBag nodeBag(wantTreeLock);
         // If we were given a specific node, start from there, otherwise start from root
         if (node) {
             nodeBag.insert(node);
@@ -1511,48 +1972,220 @@ void Octree::writeToSVOFile(const char* fileName, OctreeElement* node) {
             nodeBag.insert(_rootNode);
         }
 
-        static OctreePacketData packetData;
-        int bytesWritten = 0;
-        bool lastPacketWritten = false;
+        writeBagToSVOFile(file, nodeBag, wantTreeLock);
+    }
+    file.close();
+    return !file.fail();
+}
+
+qint64 Octree::writeBagToSVOFile(std::ostream& file, OctreeElementBag& nodeBag, bool wantTreeLock) {
+    static OctreePacketData packetData;
+    int bytesWritten = 0;
+    bool lastPacketWritten = false;
+    qint64 fileBytesWritten = 0;
 
-        while (!nodeBag.isEmpty()) {
-            OctreeElement* subTree = nodeBag.extract();
+    while (!nodeBag.isEmpty()) {
+        OctreeElement* subTree = nodeBag.extract();
 
+        if (wantTreeLock) {
             lockForRead(); // do tree locking down here so that we have shorter slices and less thread contention
-            EncodeBitstreamParams params(INT_MAX, IGNORE_VIEW_FRUSTUM, WANT_COLOR, NO_EXISTS_BITS);
-            bytesWritten = encodeTreeBitstream(subTree, &packetData, nodeBag, params);
+        }
+        EncodeBitstreamParams params(INT_MAX, IGNORE_VIEW_FRUSTUM, WANT_COLOR, NO_EXISTS_BITS);
+        bytesWritten = encodeTreeBitstream(subTree, &packetData, nodeBag, params);
+        if (wantTreeLock) {
             unlock();
+        }
+
+        // if the subTree couldn't fit, and so we should reset the packet and reinsert the node in our bag and try again...
+        if (bytesWritten == 0 && (params.stopReason == EncodeBitstreamParams::DIDNT_FIT)) {
+            if (packetData.hasContent()) {
+                file.write((const char*)packetData.getFinalizedData(), packetData.getFinalizedSize());
+                fileBytesWritten += packetData.getFinalizedSize();
+                lastPacketWritten = true;
+            }
+            packetData.reset(); // is there a better way to do this? could we fit more?
+            nodeBag.insert(subTree);
+        } else {
+            lastPacketWritten = false;
+        }
+    }
+
+    if (!lastPacketWritten) {
+        file.write((const char*)packetData.getFinalizedData(), packetData.getFinalizedSize());
+        fileBytesWritten += packetData.getFinalizedSize();
+    }
+    packetData.reset(); // so the next write doesn't start with what this one left
+
+    return fileBytesWritten;
+}
 
-            // if the subTree couldn't fit, and so we should reset the packet and reinsert the node in our bag and try again...
-            if (bytesWritten == 0 && (params.stopReason == EncodeBitstreamParams::DIDNT_FIT)) {
-                if (packetData.hasContent()) {
-                    file.write((const char*)packetData.getFinalizedData(), packetData.getFinalizedSize());
-                    lastPacketWritten = true;
+int Octree::chunkLevelForSVOFile(QVector<OctreeElement*>& chunkRoots) {
+    chunkRoots.clear();
+    if (!_rootNode->isLeaf()) {
+        chunkRoots.append(_rootNode);
+    }
+
+    int chunkLevel = 0;
+    while (chunkRoots.size() > 0 && chunkRoots.size() < MIN_SVO_CHUNKS && chunkLevel < MAX_SVO_CHUNK_LEVEL) {
+        QVector<OctreeElement*> nextLevel;
+        foreach (OctreeElement* element, chunkRoots) {
+            for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+                OctreeElement* child = element->getChildAtIndex(i);
+                if (child && !child->isLeaf()) {
+                    nextLevel.append(child);
                 }
-                packetData.reset(); // is there a better way to do this? could we fit more?
-                nodeBag.insert(subTree);
-            } else {
-                lastPacketWritten = false;
             }
         }
+        if (nextLevel.isEmpty()) {
+            break;
+        }
+        chunkRoots = nextLevel;
+        chunkLevel++;
+    }
+    return chunkLevel;
+}
+
+void Octree::appendTopOfChunkedSVOFile(OctreeElement* element, int levelsBelow, OctreePacketData* elementData,
+                                       QByteArray& bitstream) {
+    // the same as encodeTreeBitstreamRecursion() writes without a view, down to levelsBelow
+    unsigned char childrenColoredBits = 0;
+    unsigned char childrenExistInPacketBits = 0;
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        OctreeElement* child = element->getChildAtIndex(i);
+        if (child) {
+            childrenColoredBits += (1 << (7 - i));
+            if (levelsBelow > 1 && !child->isLeaf()) {
+                childrenExistInPacketBits += (1 << (7 - i));
+            }
+        }
+    }
 
-        if (!lastPacketWritten) {
-            file.write((const char*)packetData.getFinalizedData(), packetData.getFinalizedSize());
+    bitstream.append((char)childrenColoredBits);
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        if (oneAtBit(childrenColoredBits, i)) {
+            elementData->reset();
+            element->getChildAtIndex(i)->appendElementData(elementData);
+            bitstream.append(reinterpret_cast<const char*>(elementData->getUncompressedData()),
+                             elementData->getUncompressedSize());
         }
+    }
 
+    bitstream.append((char)childrenExistInPacketBits);
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        if (oneAtBit(childrenExistInPacketBits, i)) {
+            appendTopOfChunkedSVOFile(element->getChildAtIndex(i), levelsBelow - 1, elementData, bitstream);
+        }
     }
-    file.close();
 }
 
-unsigned long Octree::getOctreeElementsCount() {
-    unsigned long nodeCount = 0;
-    recurseTreeWithOperation(countOctreeElementsOperation, &nodeCount);
-    return nodeCount;
+bool Octree::writeToChunkedSVOFile(const char* fileName, bool wantTreeLock) {
+    if (!canReadSubtreesConcurrently()) {
+        return writeToSVOFile(fileName, NULL, wantTreeLock);
+    }
+
+    std::ofstream file(fileName, std::ios::out|std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    qDebug("Saving to chunked file %s...", fileName);
+
+    // the top of the tree and the chunk roots under it are taken at once, the chunks themselves a packet at a time
+    if (wantTreeLock) {
+        lockForRead();
+    }
+    QVector<OctreeElement*> chunkRoots;
+    int chunkLevel = chunkLevelForSVOFile(chunkRoots);
+
+    QByteArray top;
+    if (chunkLevel > 0) {
+        top.append(reinterpret_cast<const char*>(_rootNode->getOctalCode()),
+                   bytesRequiredForCodeLength(*_rootNode->getOctalCode()));
+        OctreePacketData elementData;
+        appendTopOfChunkedSVOFile(_rootNode, chunkLevel, &elementData, top);
+    }
+
+    QVector<QByteArray> chunkCodes;
+    foreach (OctreeElement* chunkRoot, chunkRoots) {
+        chunkCodes.append(QByteArray(reinterpret_cast<const char*>(chunkRoot->getOctalCode()),
+                                     bytesRequiredForCodeLength(*chunkRoot->getOctalCode())));
+    }
+    if (wantTreeLock) {
+        unlock();
+    }
+
+    file.write(reinterpret_cast<const char*>(CHUNKED_SVO_SIGNATURE), sizeof(CHUNKED_SVO_SIGNATURE));
+    file.write(reinterpret_cast<const char*>(&CHUNKED_SVO_VERSION), sizeof(CHUNKED_SVO_VERSION));
+    writeSVOFileVersion(file);
+
+    quint32 topBytes = top.size();
+    quint32 chunkCount = chunkCodes.size();
+    file.write(reinterpret_cast<const char*>(&topBytes), sizeof(topBytes));
+    file.write(reinterpret_cast<const char*>(&chunkCount), sizeof(chunkCount));
+
+    // the index is written once we know where the chunks ended up, so leave room for it
+    std::streampos indexAt = file.tellp();
+    QByteArray index;
+    foreach (const QByteArray& chunkCode, chunkCodes) {
+        index.append(QByteArray(sizeof(quint64) + sizeof(quint32), 0));
+        index.append(chunkCode);
+    }
+    file.write(index.constData(), index.size());
+    file.write(top.constData(), top.size());
+
+    index.clear();
+    foreach (const QByteArray& chunkCode, chunkCodes) {
+        quint64 offset = file.tellp();
+        const unsigned char* octalCode = reinterpret_cast<const unsigned char*>(chunkCode.constData());
+
+        // edits may have taken a chunk root away since we looked, and it's written empty then
+        OctreeElementBag nodeBag(wantTreeLock);
+        if (wantTreeLock) {
+            lockForRead();
+        }
+        OctreeElement* chunkRoot = nodeForOctalCode(_rootNode, octalCode, NULL);
+        if (*chunkRoot->getOctalCode() == *octalCode) {
+            nodeBag.insert(chunkRoot);
+        }
+        if (wantTreeLock) {
+            unlock();
+        }
+        quint32 length = writeBagToSVOFile(file, nodeBag, wantTreeLock);
+
+        index.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        index.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        index.append(chunkCode);
+    }
+
+    file.seekp(indexAt);
+    file.write(index.constData(), index.size());
+
+    file.close();
+    return !file.fail();
 }
 
-bool Octree::countOctreeElementsOperation(OctreeElement* node, void* extraData) {
-    (*(unsigned long*)extraData)++;
-    return true; // keep going
+class CountOctreeElementsOperation : public OctreeConcurrentOperation {
+public:
+    CountOctreeElementsOperation() : _count(0) { }
+
+    virtual bool visit(OctreeElement* element) {
+        _count++;
+        return true; // keep going
+    }
+    virtual OctreeConcurrentOperation* clone() const { return new CountOctreeElementsOperation(); }
+    virtual void merge(const OctreeConcurrentOperation* copy) {
+        _count += static_cast<const CountOctreeElementsOperation*>(copy)->_count;
+    }
+
+    unsigned long getCount() const { return _count; }
+
+private:
+    unsigned long _count;
+};
+
+unsigned long Octree::getOctreeElementsCount() {
+    CountOctreeElementsOperation countOperation;
+    recurseTreeWithConcurrentOperation(countOperation);
+    return countOperation.getCount();
 }
 
 void Octree::copySubTreeIntoNewTree(OctreeElement* startNode, Octree* destinationTree, bool rebaseToRoot) {
@@ -9,10 +9,12 @@
 #ifndef __hifi__Octree__
 #define __hifi__Octree__
 
+#include <iosfwd>
 #include <set>
 #include <SimpleMovingAverage.h>
 
 class CoverageMap;
+class OctreeEncodeCache;
 class ReadBitstreamToTreeParams;
 class Octree;
 class OctreeElement;
@@ -29,6 +31,7 @@ class OctreePacketData;
 
 #include <QObject>
 #include <QReadWriteLock>
+#include <QVector>
 
 // Callback function, for recuseTreeWithOperation
 typedef bool (*RecurseOctreeOperation)(OctreeElement* node, void* extraData);
@@ -53,6 +56,28 @@ const quint64 IGNORE_LAST_SENT  = 0;
 #define IGNORE_COVERAGE_MAP      NULL
 #define IGNORE_JURISDICTION_MAP  NULL
 
+const bool PRE_ORDER_OPERATION  = false;
+const bool POST_ORDER_OPERATION = true;
+
+/// An operation for Octree::recurseTreeWithConcurrentOperation(), which visits the subtrees below the top levels of the
+/// tree on several threads at once. Each thread uses a copy of the operation made by clone(), and every copy is handed to
+/// merge() on the calling thread once all of the subtrees have been visited, so results can be gathered without locking.
+///
+/// visit() is called for different elements on different threads at the same time. It may change the element it is
+/// given, and read the elements above it, but it must not add or delete elements, and anything it shares with the
+/// other copies, or with the rest of the program, must be locked. The elements are visited in no particular order, except
+/// that a pre-order operation visits each element before its children and a post-order one after them.
+class OctreeConcurrentOperation {
+public:
+    virtual ~OctreeConcurrentOperation() { }
+
+    /// \return false to skip the children of the element, for pre-order operations
+    virtual bool visit(OctreeElement* element) = 0;
+
+    virtual OctreeConcurrentOperation* clone() const = 0;
+    virtual void merge(const OctreeConcurrentOperation* copy) { }
+};
+
 class EncodeBitstreamParams {
 public:
     int maxEncodeLevel;
@@ -191,6 +216,22 @@ public:
     virtual int processEditPacketData(PacketType packetType, const unsigned char* packetData, int packetLength,
                     const unsigned char* editData, int maxLength, const SharedNodePointer& sourceNode) { return 0; }
 
+    /// Implement this to let the server size, batch and sort edit records by their octal code before it locks the tree.
+    /// \return the length of the edit record at editData, which must start with the octal code of the element it edits,
+    /// or 0 if the record (and the rest of its packet) can only be read as it is applied
+    virtual int getEditRecordLength(PacketType packetType, const unsigned char* editData, int maxLength) const { return 0; }
+
+    /// Implement this to return true if applying the same edit packets to two copies of the tree leaves them the same, so
+    /// that a server can keep a second copy for its readers (see OctreeSnapshots)
+    virtual bool canReplayEdits() const { return false; }
+
+    /// Implement this to return true if separate subtrees can be read from bitstreams on several threads at once, with
+    /// their elements created off of the tree, so that chunked SVO files can be loaded in parallel
+    virtual bool canReadSubtreesConcurrently() const { return false; }
+
+    /// Implement this to return true if every change to an element changes the time of the elements above it too, so that
+    /// the encoded subtrees of the tree can be cached (see OctreeEncodeCache)
+    virtual bool canCacheEncodedSubtrees() const { return false; }
 
     virtual void update() { }; // nothing to do by default
 
@@ -200,6 +241,11 @@ public:
 
     void processRemoveOctreeElementsBitstream(const unsigned char* bitstream, int bufferSizeBytes);
     void readBitstreamToTree(const unsigned char* bitstream,  unsigned long int bufferSizeBytes, ReadBitstreamToTreeParams& args);
+
+    /// reads a bitstream whose subtrees all start at or below subtreeRoot, which doesn't have to be in the tree yet
+    /// \return false if the bitstream has a subtree from outside of subtreeRoot
+    bool readBitstreamToSubtree(OctreeElement* subtreeRoot, const unsigned char* bitstream, int bufferSizeBytes,
+                                ReadBitstreamToTreeParams& args);
     void deleteOctalCodeFromTree(const unsigned char* codeBuffer, bool collapseEmptyTrees = DONT_COLLAPSE);
     void reaverageOctreeElements(OctreeElement* startNode = NULL);
 
@@ -211,12 +257,21 @@ public:
 
     void recurseTreeWithPostOperation(RecurseOctreeOperation operation, void* extraData = NULL);
 
+    /// visits the elements like recurseTreeWithOperation() or recurseTreeWithPostOperation() do, but splits the tree at its
+    /// top levels and has several threads take the subtrees below them, one at a time, until there are none left
+    void recurseTreeWithConcurrentOperation(OctreeConcurrentOperation& operation, bool postOrder = PRE_ORDER_OPERATION);
+
     void recurseTreeWithOperationDistanceSorted(RecurseOctreeOperation operation,
                                                 const glm::vec3& point, void* extraData = NULL);
 
     int encodeTreeBitstream(OctreeElement* node, OctreePacketData* packetData, OctreeElementBag& bag,
                             EncodeBitstreamParams& params) ;
 
+    /// keeps the subtrees that encodeTreeBitstream() writes for views that others may share, and copies them from there
+    /// the next time, for trees that can cache them
+    void setWantEncodeCache(bool wantEncodeCache);
+    OctreeEncodeCache* getEncodeCache() const { return _encodeCache; }
+
     bool isDirty() const { return _isDirty; }
     void clearDirtyBit() { _isDirty = false; }
     void setDirtyBit() { _isDirty = true; }
@@ -249,7 +304,15 @@ public:
     void loadOctreeFile(const char* fileName, bool wantColorRandomizer);
 
     // these will read/write files that match the wireformat, excluding the 'V' leading
-    void writeToSVOFile(const char* filename, OctreeElement* node = NULL);
+    /// \param wantTreeLock false if the tree can't change while it's written, like a pinned snapshot
+    /// \return false if the file couldn't be written
+    bool writeToSVOFile(const char* filename, OctreeElement* node = NULL, bool wantTreeLock = true);
+
+    /// writes the whole tree as a chunked SVO file, an index of subtrees followed by each of them as a plain SVO bitstream,
+    /// which readFromSVOFile() reads in parallel. Trees that can't read subtrees concurrently are written as plain files.
+    bool writeToChunkedSVOFile(const char* filename, bool wantTreeLock = true);
+
+    /// reads plain and chunked SVO files, mapping them into memory rather than reading them into a buffer
     bool readFromSVOFile(const char* filename);
     
 
@@ -290,13 +353,32 @@ protected:
                                      EncodeBitstreamParams& params, int& currentEncodeLevel,
                                      const ViewFrustum::location& parentLocationThisView) const;
 
-    static bool countOctreeElementsOperation(OctreeElement* node, void* extraData);
+    /// copies an element's encoded subtree from the encode cache, if it's there and fits, in place of encoding it
+    /// \return the bytes written, as encodeTreeBitstreamRecursion() would have returned them, or -1 if it wasn't copied
+    int appendCachedSubtree(OctreeElement* node, int encodeCacheKey, OctreePacketData* packetData,
+                            EncodeBitstreamParams& params, int currentEncodeLevel) const;
 
     OctreeElement* nodeForOctalCode(OctreeElement* ancestorNode, const unsigned char* needleCode, OctreeElement** parentOfFoundNode) const;
     OctreeElement* createMissingNode(OctreeElement* lastParentNode, const unsigned char* codeToReach);
     int readNodeData(OctreeElement *destinationNode, const unsigned char* nodeData,
                 int bufferSizeBytes, ReadBitstreamToTreeParams& args);
 
+    /// checks and skips the packet type and version that start SVO files of trees that want them
+    bool readSVOFileVersion(const unsigned char*& dataAt, const unsigned char* dataEnd);
+    void writeSVOFileVersion(std::ostream& file);
+
+    /// writes the bag's subtrees to an SVO file the way they would be sent, a packet at a time
+    /// \return the number of bytes written
+    qint64 writeBagToSVOFile(std::ostream& file, OctreeElementBag& nodeBag, bool wantTreeLock);
+
+    bool readChunkedSVOFile(const unsigned char* data, qint64 dataLength);
+
+    /// the deepest level that elements are written at in the top of a chunked SVO file, whose non-leaf elements the rest
+    /// of the file is chunked by
+    int chunkLevelForSVOFile(QVector<OctreeElement*>& chunkRoots);
+    void appendTopOfChunkedSVOFile(OctreeElement* element, int levelsBelow, OctreePacketData* elementData,
+                                   QByteArray& bitstream);
+
     OctreeElement* _rootNode;
 
     bool _isDirty;
@@ -304,6 +386,8 @@ protected:
     bool _stopImport;
 
     QReadWriteLock _lock;
+
+    OctreeEncodeCache* _encodeCache;
     
     /// This tree is receiving inbound viewer datagrams.
     bool _isViewing;
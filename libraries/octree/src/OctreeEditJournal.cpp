@@ -0,0 +1,185 @@
+//
+//  OctreeEditJournal.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <cstring>
+
+#include <QtCore/QDebug>
+#include <QtCore/QMutexLocker>
+
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "Octree.h"
+#include "OctreeEditJournal.h"
+
+typedef quint32 JOURNAL_RECORD_LENGTH;
+typedef quint16 JOURNAL_RECORD_CHECKSUM;
+
+const int JOURNAL_RECORD_HEADER_BYTES = sizeof(JOURNAL_RECORD_LENGTH) + sizeof(JOURNAL_RECORD_CHECKSUM);
+
+// applies the edit records of a packet the way the server's inbound packet processor does
+static void replayEditPacket(Octree* tree, const QByteArray& packet) {
+    PacketType packetType = packetTypeForPacket(packet);
+    const unsigned char* packetData = reinterpret_cast<const unsigned char*>(packet.constData());
+
+    // the records come after the sequence number and the time the packet was sent
+    int atByte = numBytesForPacketHeader(packet) + sizeof(unsigned short int) + sizeof(quint64);
+    while (atByte < packet.size()) {
+        int editDataBytesRead = tree->processEditPacketData(packetType, packetData, packet.size(), packetData + atByte,
+                                                            packet.size() - atByte, SharedNodePointer());
+        if (editDataBytesRead <= 0) {
+            break;
+        }
+        atByte += editDataBytesRead;
+    }
+}
+
+OctreeEditJournal::OctreeEditJournal(const QString& persistFilename) :
+    _filename(persistFilename + ".journal"),
+    _rotatedFilename(persistFilename + ".journal.rotated"),
+    _mutex(),
+    _file(),
+    _currentBytes(0),
+    _packetsAppended(0),
+    _bytesAppended(0),
+    _flushes(0),
+    _flushUsecs(0)
+{
+}
+
+OctreeEditJournal::~OctreeEditJournal() {
+    _file.close();
+}
+
+int OctreeEditJournal::replay(Octree* tree) {
+    return replayFile(_rotatedFilename, tree) + replayFile(_filename, tree);
+}
+
+int OctreeEditJournal::replayFile(const QString& filename, Octree* tree) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    QByteArray journal = file.readAll();
+    file.close();
+
+    int packetsReplayed = 0;
+    int atByte = 0;
+    while (atByte + JOURNAL_RECORD_HEADER_BYTES <= journal.size()) {
+        JOURNAL_RECORD_LENGTH length;
+        JOURNAL_RECORD_CHECKSUM checksum;
+        memcpy(&length, journal.constData() + atByte, sizeof(length));
+        memcpy(&checksum, journal.constData() + atByte + sizeof(length), sizeof(checksum));
+
+        const char* packetData = journal.constData() + atByte + JOURNAL_RECORD_HEADER_BYTES;
+        if (length > (JOURNAL_RECORD_LENGTH)(journal.size() - atByte - JOURNAL_RECORD_HEADER_BYTES)
+                || qChecksum(packetData, length) != checksum) {
+            qDebug() << "edit journal" << filename << "has a broken record at byte" << atByte << "- ignoring the rest";
+            break;
+        }
+
+        replayEditPacket(tree, QByteArray::fromRawData(packetData, length));
+        packetsReplayed++;
+        atByte += JOURNAL_RECORD_HEADER_BYTES + length;
+    }
+
+    qDebug() << "replayed" << packetsReplayed << "edit packets from" << filename;
+    return packetsReplayed;
+}
+
+bool OctreeEditJournal::start() {
+    QMutexLocker locker(&_mutex);
+
+    _file.setFileName(_filename);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "unable to open edit journal" << _filename << "-" << _file.errorString();
+        return false;
+    }
+    _currentBytes = _file.size();
+    return true;
+}
+
+void OctreeEditJournal::discard() {
+    QMutexLocker locker(&_mutex);
+
+    _file.close();
+    QFile::remove(_filename);
+    QFile::remove(_rotatedFilename);
+    _currentBytes = 0;
+}
+
+void OctreeEditJournal::beginBatch() {
+    _mutex.lock();
+}
+
+void OctreeEditJournal::append(const QByteArray& packet) {
+    if (!_file.isOpen()) {
+        return;
+    }
+
+    char recordHeader[JOURNAL_RECORD_HEADER_BYTES];
+    JOURNAL_RECORD_LENGTH length = packet.size();
+    JOURNAL_RECORD_CHECKSUM checksum = qChecksum(packet.constData(), packet.size());
+    memcpy(recordHeader, &length, sizeof(length));
+    memcpy(recordHeader + sizeof(length), &checksum, sizeof(checksum));
+
+    _file.write(recordHeader, JOURNAL_RECORD_HEADER_BYTES);
+    _file.write(packet);
+
+    _currentBytes += JOURNAL_RECORD_HEADER_BYTES + packet.size();
+    _packetsAppended++;
+    _bytesAppended += JOURNAL_RECORD_HEADER_BYTES + packet.size();
+}
+
+void OctreeEditJournal::flush() {
+    // this hands the records to the OS, which keeps them if the server dies, though not if the machine does
+    quint64 flushStart = usecTimestampNow();
+    _file.flush();
+    _flushes++;
+    _flushUsecs += usecTimestampNow() - flushStart;
+}
+
+void OctreeEditJournal::endBatch() {
+    _mutex.unlock();
+}
+
+bool OctreeEditJournal::rotate() {
+    QMutexLocker locker(&_mutex);
+
+    _file.close();
+
+    if (QFile::exists(_rotatedFilename)) {
+        // the save after the last rotation failed, so its journal has to stay, with this one after it
+        QFile rotated(_rotatedFilename);
+        QFile current(_filename);
+        if (!rotated.open(QIODevice::WriteOnly | QIODevice::Append) || !current.open(QIODevice::ReadOnly)
+                || rotated.write(current.readAll()) < 0) {
+            qDebug() << "unable to rotate edit journal" << _filename << "-" << rotated.errorString();
+            _file.open(QIODevice::WriteOnly | QIODevice::Append);
+            return false;
+        }
+        rotated.close();
+        current.close();
+        QFile::remove(_filename);
+    } else if (!QFile::rename(_filename, _rotatedFilename)) {
+        qDebug() << "unable to rotate edit journal" << _filename;
+        _file.open(QIODevice::WriteOnly | QIODevice::Append);
+        return false;
+    }
+
+    _currentBytes = 0;
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "unable to open edit journal" << _filename << "-" << _file.errorString();
+    }
+    return true;
+}
+
+void OctreeEditJournal::endRotation() {
+    QMutexLocker locker(&_mutex);
+    QFile::remove(_rotatedFilename);
+}
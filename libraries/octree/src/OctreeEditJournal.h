@@ -0,0 +1,81 @@
+//
+//  OctreeEditJournal.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Append-only log of the edit packets applied to a persisted octree
+//
+
+#ifndef __hifi__OctreeEditJournal__
+#define __hifi__OctreeEditJournal__
+
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+class Octree;
+
+/// Logs every edit packet applied to a tree next to its persist file, so that the file only has to be rewritten once in
+/// a while and a server that dies in between can get all of its edits back by replaying the journal over the file. The
+/// edits of a tree have to replay to the same tree (see Octree::canReplayEdits()).
+///
+/// Each record is the length of a packet, a checksum of it, and the packet. A record cut short by a crash, and
+/// everything after it, is ignored on replay.
+class OctreeEditJournal {
+public:
+    /// \param persistFilename the file the tree is saved to, the journal is kept beside it
+    OctreeEditJournal(const QString& persistFilename);
+    ~OctreeEditJournal();
+
+    /// replays the journal of a save that didn't finish, then the current journal, into a tree locked for writing
+    /// \return the number of packets replayed
+    int replay(Octree* tree);
+
+    /// opens the current journal for appending, after any replay
+    bool start();
+
+    /// removes both journals, once a save has everything in them
+    void discard();
+
+    /// locks out rotate() until endBatch(), so that every edit in a rotated journal is in the tree by the time it has
+    /// been rotated
+    void beginBatch();
+    void append(const QByteArray& packet);
+
+    /// writes the appended packets through to the file, which should be done before they are applied
+    void flush();
+    void endBatch();
+
+    /// moves the current journal aside for a save to replace and starts a new one, call before saving the tree
+    bool rotate();
+
+    /// removes the journal moved aside by rotate(), call once the saved file is in place
+    void endRotation();
+
+    qint64 getCurrentBytes() const { return _currentBytes; }
+
+    quint64 getPacketsAppended() const { return _packetsAppended; }
+    quint64 getBytesAppended() const { return _bytesAppended; }
+    quint64 getFlushes() const { return _flushes; }
+    quint64 getFlushUsecs() const { return _flushUsecs; }
+
+private:
+    /// \return the number of packets replayed from the file
+    int replayFile(const QString& filename, Octree* tree);
+
+    QString _filename;
+    QString _rotatedFilename;
+
+    QMutex _mutex;
+    QFile _file;
+    qint64 _currentBytes;
+
+    quint64 _packetsAppended;
+    quint64 _bytesAppended;
+    quint64 _flushes;
+    quint64 _flushUsecs;
+};
+
+#endif /* defined(__hifi__OctreeEditJournal__) */
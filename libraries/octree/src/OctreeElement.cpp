@@ -10,7 +10,9 @@
 #include <cstring>
 #include <stdio.h>
 
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QDebug>
+#include <QtCore/QThreadStorage>
 
 #include <NodeList.h>
 #include <PerfStat.h>
@@ -21,6 +23,7 @@
 #include "SharedUtil.h"
 #include "OctreeConstants.h"
 #include "OctreeElement.h"
+#include "OctreeElementPool.h"
 #include "Octree.h"
 
 quint64 OctreeElement::_voxelMemoryUsage = 0;
@@ -34,6 +37,109 @@ void OctreeElement::resetPopulationStatistics() {
     _voxelNodeLeafCount = 0;
 }
 
+// The pools are made the first time they're needed and never deleted, since elements can be made by static initializers
+// and deleted by static destructors.
+static OctreeElementPool* getPool(QAtomicPointer<OctreeElementPool>& pool, int blockBytes, bool wantSiblingGroups) {
+    OctreeElementPool* existingPool = pool.loadAcquire();
+    if (existingPool) {
+        return existingPool;
+    }
+    OctreeElementPool* newPool = new OctreeElementPool(blockBytes, wantSiblingGroups);
+    if (pool.testAndSetOrdered(NULL, newPool)) {
+        return newPool;
+    }
+    delete newPool; // another thread made it first
+    return pool.loadAcquire();
+}
+
+// elements come from a pool for each size of element, in steps of ELEMENT_POOL_STEP_BYTES. Anything bigger than the
+// largest size comes from the heap.
+const int ELEMENT_POOL_STEP_BYTES = 16;
+const int NUMBER_OF_ELEMENT_POOLS = 16;
+static QAtomicPointer<OctreeElementPool> elementPools[NUMBER_OF_ELEMENT_POOLS];
+
+static OctreeElementPool* elementPoolForBytes(size_t bytes) {
+    int poolIndex = (bytes + ELEMENT_POOL_STEP_BYTES - 1) / ELEMENT_POOL_STEP_BYTES - 1;
+    if (poolIndex >= NUMBER_OF_ELEMENT_POOLS) {
+        return NULL;
+    }
+    return getPool(elementPools[poolIndex], (poolIndex + 1) * ELEMENT_POOL_STEP_BYTES, true);
+}
+
+// external children are always an array of NUMBER_OF_CHILDREN
+static QAtomicPointer<OctreeElementPool> externalChildrenPoolPointer;
+
+static OctreeElementPool* externalChildrenPool() {
+    return getPool(externalChildrenPoolPointer, NUMBER_OF_CHILDREN * sizeof(OctreeElement*), false);
+}
+
+// addChildAtIndex() can't hand operator new the element the new child belongs to, since the child is made by a subclass
+// in createNewElement(), so it leaves where the child goes here for the thread's next element
+struct ChildPlacement {
+    ChildPlacement() : isWanted(false), sibling(NULL), siblingIndex(0), childIndex(0) { }
+
+    bool isWanted;
+    const OctreeElement* sibling;
+    int siblingIndex;
+    int childIndex;
+};
+static QThreadStorage<ChildPlacement> childPlacements;
+
+void* OctreeElement::operator new(size_t size) {
+    OctreeElementPool* pool = elementPoolForBytes(size);
+    if (!pool) {
+        return ::operator new(size);
+    }
+
+    if (childPlacements.hasLocalData()) {
+        ChildPlacement& placement = childPlacements.localData();
+        if (placement.isWanted) {
+            placement.isWanted = false;
+            return pool->allocateChild(placement.sibling, placement.siblingIndex, placement.childIndex);
+        }
+    }
+    return pool->allocate();
+}
+
+void OctreeElement::operator delete(void* element, size_t size) {
+    OctreeElementPool* pool = elementPoolForBytes(size);
+    if (pool) {
+        pool->release(element);
+    } else {
+        ::operator delete(element);
+    }
+}
+
+quint64 OctreeElement::getElementPoolMemoryUsage() {
+    quint64 reservedBytes = 0;
+    for (int i = 0; i < NUMBER_OF_ELEMENT_POOLS; i++) {
+        OctreeElementPool* pool = elementPools[i].loadAcquire();
+        if (pool) {
+            reservedBytes += pool->getReservedBytes();
+        }
+    }
+    return reservedBytes;
+}
+
+quint64 OctreeElement::getElementPoolMemoryInUse() {
+    quint64 bytesInUse = 0;
+    for (int i = 0; i < NUMBER_OF_ELEMENT_POOLS; i++) {
+        OctreeElementPool* pool = elementPools[i].loadAcquire();
+        if (pool) {
+            bytesInUse += pool->getBytesInUse();
+        }
+    }
+    return bytesInUse;
+}
+
+quint64 OctreeElement::getExternalChildrenPoolMemoryUsage() {
+    return externalChildrenPool()->getReservedBytes();
+}
+
+quint64 OctreeElement::getExternalChildrenPoolMemoryInUse() {
+    return externalChildrenPool()->getBytesInUse();
+}
+
 OctreeElement::OctreeElement() {
     // Note: you must call init() from your subclass, otherwise the OctreeElement will not be properly
     // initialized. You will see DEADBEEF in your memory debugger if you have not properly called init()
@@ -90,7 +196,6 @@ void OctreeElement::init(unsigned char * octalCode) {
     _isDirty = true;
     _shouldRender = false;
     _sourceUUIDKey = 0;
-    calculateAABox();
     markWithChangedTime();
 }
 
@@ -187,15 +292,19 @@ void OctreeElement::setShouldRender(bool shouldRender) {
     }
 }
 
-void OctreeElement::calculateAABox() {
+glm::vec3 OctreeElement::getCorner() const {
     glm::vec3 corner;
+    copyFirstVertexForCode(getOctalCode(), (float*)&corner);
+    return corner;
+}
 
-    // copy corner into box
-    copyFirstVertexForCode(getOctalCode(),(float*)&corner);
-
+float OctreeElement::getScale() const {
     // this tells you the "size" of the voxel
-    float voxelScale = 1 / powf(2, numberOfThreeBitSectionsInCode(getOctalCode()));
-    _box.setBox(corner,voxelScale);
+    return ldexpf(1.0f, -numberOfThreeBitSectionsInCode(getOctalCode()));
+}
+
+AABox OctreeElement::getAABox() const {
+    return AABox(getCorner(), getScale());
 }
 
 void OctreeElement::deleteChildAtIndex(int childIndex) {
@@ -237,6 +346,24 @@ OctreeElement* OctreeElement::removeChildAtIndex(int childIndex) {
     return returnedChild;
 }
 
+void OctreeElement::takeChildrenFrom(OctreeElement* element) {
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        if (element->getChildAtIndex(i) && !getChildAtIndex(i)) {
+            // before adding a child, see if we're currently a leaf
+            if (isLeaf()) {
+                _voxelNodeLeafCount--;
+            }
+            setChildAtIndex(i, element->removeChildAtIndex(i));
+        }
+    }
+    _isDirty = true;
+    markWithChangedTime();
+
+#ifdef HAS_AUDIT_CHILDREN
+    auditChildren("takeChildrenFrom()");
+#endif // def HAS_AUDIT_CHILDREN
+}
+
 #ifdef HAS_AUDIT_CHILDREN
 void OctreeElement::auditChildren(const char* label) const {
     bool auditFailed = false;
@@ -644,6 +771,16 @@ void OctreeElement::deleteAllChildren() {
         }
     }
 
+#ifdef SIMPLE_EXTERNAL_CHILDREN
+    // then give back the array they were in, if there was more than one of them
+    if (getChildCount() > 1) {
+        externalChildrenPool()->release(_children.external);
+        _externalChildrenMemoryUsage -= NUMBER_OF_CHILDREN * sizeof(OctreeElement*);
+    }
+    _children.single = NULL;
+    _childBitmask = 0;
+#endif // def SIMPLE_EXTERNAL_CHILDREN
+
 #ifdef BLENDED_UNION_CHILDREN
     // now, reset our internal state and ANY and all population data
     int childCount = getChildCount();
@@ -736,7 +873,7 @@ void OctreeElement::setChildAtIndex(int childIndex, OctreeElement* child) {
         _children.single = child;
     } else if (previousChildCount == 1 && newChildCount == 2) {
         OctreeElement* previousChild = _children.single;
-        _children.external = new OctreeElement*[NUMBER_OF_CHILDREN];
+        _children.external = static_cast<OctreeElement**>(externalChildrenPool()->allocate());
         memset(_children.external, 0, sizeof(OctreeElement*) * NUMBER_OF_CHILDREN);
         _children.external[firstIndex] = previousChild;
         _children.external[childIndex] = child;
@@ -747,7 +884,7 @@ void OctreeElement::setChildAtIndex(int childIndex, OctreeElement* child) {
         assert(!child); // we are removing a child, so this must be true!
         OctreeElement* previousFirstChild = _children.external[firstIndex];
         OctreeElement* previousSecondChild = _children.external[secondIndex];
-        delete[] _children.external;
+        externalChildrenPool()->release(_children.external);
         _externalChildrenMemoryUsage -= NUMBER_OF_CHILDREN * sizeof(OctreeElement*);
         if (childIndex == firstIndex) {
             _children.single = previousSecondChild;
@@ -1117,8 +1254,19 @@ OctreeElement* OctreeElement::addChildAtIndex(int childIndex) {
             _voxelNodeLeafCount--;
         }
 
+        // the child goes in the same group of blocks as its siblings, if it has any
+        ChildPlacement& placement = childPlacements.localData();
+        placement.isWanted = true;
+        placement.sibling = NULL;
+        placement.childIndex = childIndex;
+        for (int i = 0; i < NUMBER_OF_CHILDREN && !placement.sibling; i++) {
+            placement.sibling = getChildAtIndex(i);
+            placement.siblingIndex = i;
+        }
+
         unsigned char* newChildCode = childOctalCode(getOctalCode(), childIndex);
         childAt = createNewElement(newChildCode);
+        placement.isWanted = false;
         setChildAtIndex(childIndex, childAt);
 
         _isDirty = true;
@@ -1175,7 +1323,7 @@ void OctreeElement::printDebugDetails(const char* label) const {
 
     QString resultString;
     resultString.sprintf("%s - Voxel at corner=(%f,%f,%f) size=%f\n isLeaf=%s isDirty=%s shouldRender=%s\n children=", label,
-                         _box.getCorner().x, _box.getCorner().y, _box.getCorner().z, _box.getScale(),
+                         getCorner().x, getCorner().y, getCorner().z, getScale(),
                          debug::valueOf(isLeaf()), debug::valueOf(isDirty()), debug::valueOf(getShouldRender()));
     elementDebug << resultString;
 
@@ -1189,7 +1337,7 @@ float OctreeElement::getEnclosingRadius() const {
 }
 
 ViewFrustum::location OctreeElement::inFrustum(const ViewFrustum& viewFrustum) const {
-    AABox box = _box; // use temporary box so we can scale it
+    AABox box = getAABox(); // use temporary box so we can scale it
     box.scale(TREE_SCALE);
     return viewFrustum.boxInFrustum(box);
 }
@@ -1231,20 +1379,20 @@ float OctreeElement::furthestDistanceToCamera(const ViewFrustum& viewFrustum) co
 }
 
 float OctreeElement::distanceToCamera(const ViewFrustum& viewFrustum) const {
-    glm::vec3 center = _box.calcCenter() * (float)TREE_SCALE;
+    glm::vec3 center = getAABox().calcCenter() * (float)TREE_SCALE;
     glm::vec3 temp = viewFrustum.getPosition() - center;
     float distanceToVoxelCenter = sqrtf(glm::dot(temp, temp));
     return distanceToVoxelCenter;
 }
 
 float OctreeElement::distanceSquareToPoint(const glm::vec3& point) const {
-    glm::vec3 temp = point - _box.calcCenter();
+    glm::vec3 temp = point - getAABox().calcCenter();
     float distanceSquare = glm::dot(temp, temp);
     return distanceSquare;
 }
 
 float OctreeElement::distanceToPoint(const glm::vec3& point) const {
-    glm::vec3 temp = point - _box.calcCenter();
+    glm::vec3 temp = point - getAABox().calcCenter();
     float distance = sqrtf(glm::dot(temp, temp));
     return distance;
 }
@@ -1300,7 +1448,7 @@ void OctreeElement::notifyUpdateHooks() {
 
 bool OctreeElement::findSpherePenetration(const glm::vec3& center, float radius,
                         glm::vec3& penetration, void** penetratedObject) const {
-    return _box.findSpherePenetration(center, radius, penetration);
+    return getAABox().findSpherePenetration(center, radius, penetration);
 }
 
 
@@ -1319,7 +1467,7 @@ OctreeElement* OctreeElement::getOrCreateChildElementAt(float x, float y, float
         return this;
     }
     // otherwise, we need to find which of our children we should recurse
-    glm::vec3 ourCenter = _box.calcCenter();
+    glm::vec3 ourCenter = getAABox().calcCenter();
 
     int childIndex = CHILD_UNKNOWN;
     // left half
@@ -102,13 +102,17 @@ public:
     void deleteChildAtIndex(int childIndex);
     OctreeElement* removeChildAtIndex(int childIndex);
 
+    /// moves the children of an element that was built outside of the tree over to this one, where this one has none
+    void takeChildrenFrom(OctreeElement* element);
+
     /// handles deletion of all descendants, returns false if delete not approved
     bool safeDeepDeleteChildAtIndex(int childIndex, int recursionCount = 0); 
 
 
-    const AABox& getAABox() const { return _box; }
-    const glm::vec3& getCorner() const { return _box.getCorner(); }
-    float getScale() const { return _box.getScale(); }
+    /// the bounds of an element aren't stored, they come from its octal code
+    AABox getAABox() const;
+    glm::vec3 getCorner() const;
+    float getScale() const;
     int getLevel() const { return numberOfThreeBitSectionsInCode(getOctalCode()) + 1; }
     
     float getEnclosingRadius() const;
@@ -151,6 +155,7 @@ public:
 
     static void addUpdateHook(OctreeElementUpdateHook* hook);
     static void removeUpdateHook(OctreeElementUpdateHook* hook);
+    static bool hasUpdateHooks() { return !_updateHooks.empty(); }
     
     static void resetPopulationStatistics();
     static unsigned long getNodeCount() { return _voxelNodeCount; }
@@ -162,6 +167,18 @@ public:
     static quint64 getExternalChildrenMemoryUsage() { return _externalChildrenMemoryUsage; }
     static quint64 getTotalMemoryUsage() { return _voxelMemoryUsage + _octcodeMemoryUsage + _externalChildrenMemoryUsage; }
 
+    /// elements and their arrays of external children are carved out of pooled slabs, which are never given back, so
+    /// these are the bytes the pools hold and how many of them are in use
+    static quint64 getElementPoolMemoryUsage();
+    static quint64 getElementPoolMemoryInUse();
+    static quint64 getExternalChildrenPoolMemoryUsage();
+    static quint64 getExternalChildrenPoolMemoryInUse();
+
+    /// elements of all the subclasses come from a pool for their size, where the children that addChildAtIndex() makes
+    /// are placed next to their siblings
+    static void* operator new(size_t size);
+    static void operator delete(void* element, size_t size);
+
     static quint64 getGetChildAtIndexTime() { return _getChildAtIndexTime; }
     static quint64 getGetChildAtIndexCalls() { return _getChildAtIndexCalls; }
     static quint64 getSetChildAtIndexTime() { return _setChildAtIndexTime; }
@@ -228,12 +245,9 @@ protected:
     void encodeThreeOffsets(int64_t offsetOne, int64_t offsetTwo, int64_t offsetThree);
     void checkStoreFourChildren(OctreeElement* childOne, OctreeElement* childTwo, OctreeElement* childThree, OctreeElement* childFour);
 #endif
-    void calculateAABox();
     void notifyDeleteHooks();
     void notifyUpdateHooks();
 
-    AABox _box; /// Client and server, axis aligned box for bounds of this voxel, 48 bytes
-
     /// Client and server, buffer containing the octal code or a pointer to octal code for this node, 8 bytes
     union octalCode_t {
       unsigned char buffer[8];
@@ -9,14 +9,19 @@
 #include "OctreeElementBag.h"
 #include <OctalCode.h>
 
-OctreeElementBag::OctreeElementBag() : 
-    _bagElements()
+OctreeElementBag::OctreeElementBag(bool wantDeleteHook) : 
+    _bagElements(),
+    _wantDeleteHook(wantDeleteHook)
 {
-    OctreeElement::addDeleteHook(this);
+    if (_wantDeleteHook) {
+        OctreeElement::addDeleteHook(this);
+    }
 };
 
 OctreeElementBag::~OctreeElementBag() {
-    OctreeElement::removeDeleteHook(this);
+    if (_wantDeleteHook) {
+        OctreeElement::removeDeleteHook(this);
+    }
     deleteAll();
 }
 
@@ -19,7 +19,9 @@
 class OctreeElementBag : public OctreeElementDeleteHook {
 
 public:
-    OctreeElementBag();
+    /// \param wantDeleteHook false for a bag of elements that can't be deleted while they're in it, like those of a
+    /// locked or pinned tree, which saves the bag from being told about every element deleted from any other tree
+    OctreeElementBag(bool wantDeleteHook = true);
     ~OctreeElementBag();
     
     void insert(OctreeElement* element); // put a element into the bag
@@ -35,6 +37,7 @@ public:
 
 private:
     QSet<OctreeElement*> _bagElements;
+    bool _wantDeleteHook;
 };
 
 #endif /* defined(__hifi__OctreeElementBag__) */
@@ -0,0 +1,184 @@
+//
+//  OctreeElementPool.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include <QtCore/QMutexLocker>
+
+#include "OctreeElementPool.h"
+
+const int SLAB_BYTES = 256 * 1024;
+
+// blocks are at least big enough to link into the free list, and aligned like anything new would return
+const int BLOCK_ALIGNMENT = 16;
+
+const quint8 FULL_SIBLING_GROUP = 0xff;
+
+static int alignedBytes(int bytes) {
+    return ((bytes + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT) * BLOCK_ALIGNMENT;
+}
+
+OctreeElementPool::OctreeElementPool(int blockBytes, bool wantSiblingGroups) :
+    _mutex(),
+    _blockBytes(alignedBytes(blockBytes)),
+    _wantSiblingGroups(wantSiblingGroups),
+    _groupBytes(_blockBytes),
+    _groupsOffset(0),
+    _freeBlocks(NULL),
+    _looseGroup(NULL),
+    _slabAt(NULL),
+    _slabEnd(NULL),
+    _slabs(),
+    _reservedBytes(0),
+    _blocksInUse(0)
+{
+    if (_wantSiblingGroups) {
+        _groupBytes = BLOCKS_PER_SIBLING_GROUP * _blockBytes;
+
+        // as many groups as fit in a slab along with a byte of occupancy bits for each
+        int groupsPerSlab = SLAB_BYTES / (_groupBytes + 1);
+        while (alignedBytes(groupsPerSlab) + groupsPerSlab * _groupBytes > SLAB_BYTES) {
+            groupsPerSlab--;
+        }
+        _groupsOffset = alignedBytes(groupsPerSlab);
+    }
+}
+
+void* OctreeElementPool::allocate() {
+    QMutexLocker locker(&_mutex);
+
+    _blocksInUse++;
+    if (!_wantSiblingGroups) {
+        if (_freeBlocks) {
+            void* block = _freeBlocks;
+            _freeBlocks = *static_cast<void**>(block);
+            return block;
+        }
+
+        if (_slabEnd - _slabAt < _blockBytes) {
+            addSlab();
+        }
+        void* block = _slabAt;
+        _slabAt += _blockBytes;
+        return block;
+    }
+
+    char* slab = _looseGroup ? slabForBlock(_looseGroup) : NULL;
+    if (!slab || occupancyOfGroup(slab, _looseGroup) == FULL_SIBLING_GROUP) {
+        _looseGroup = takeGroup();
+        slab = slabForBlock(_looseGroup);
+    }
+
+    quint8 occupancy = occupancyOfGroup(slab, _looseGroup);
+    int blockIndex = 0;
+    while (occupancy & (1 << blockIndex)) {
+        blockIndex++;
+    }
+    return takeBlockOfGroup(slab, _looseGroup, blockIndex);
+}
+
+void* OctreeElementPool::allocateChild(const void* sibling, int siblingIndex, int childIndex) {
+    if (!_wantSiblingGroups) {
+        return allocate();
+    }
+
+    QMutexLocker locker(&_mutex);
+
+    if (!sibling) {
+        _blocksInUse++;
+        char* group = takeGroup();
+        return takeBlockOfGroup(slabForBlock(group), group, childIndex);
+    }
+
+    char* slab = slabForBlock(sibling);
+    int siblingOffset = slab ? static_cast<const char*>(sibling) - slab - _groupsOffset : -1;
+    if (siblingOffset >= 0 && siblingOffset % _groupBytes == siblingIndex * _blockBytes) {
+        char* group = slab + _groupsOffset + (siblingOffset / _groupBytes) * _groupBytes;
+        if (!(occupancyOfGroup(slab, group) & (1 << childIndex))) {
+            _blocksInUse++;
+            return takeBlockOfGroup(slab, group, childIndex);
+        }
+    }
+
+    locker.unlock();
+    return allocate();
+}
+
+void OctreeElementPool::release(void* block) {
+    QMutexLocker locker(&_mutex);
+
+    _blocksInUse--;
+    if (!_wantSiblingGroups) {
+        *static_cast<void**>(block) = _freeBlocks;
+        _freeBlocks = block;
+        return;
+    }
+
+    char* slab = slabForBlock(block);
+    int blockOffset = static_cast<char*>(block) - slab - _groupsOffset;
+    char* group = slab + _groupsOffset + (blockOffset / _groupBytes) * _groupBytes;
+
+    quint8& occupancy = occupancyOfGroup(slab, group);
+    occupancy &= ~(1 << ((blockOffset % _groupBytes) / _blockBytes));
+
+    // the loose group stays where it is, so that the blocks allocated without siblings fill it back up
+    if (occupancy == 0 && group != _looseGroup) {
+        *reinterpret_cast<void**>(group) = _freeBlocks;
+        _freeBlocks = group;
+    }
+}
+
+char* OctreeElementPool::addSlab() {
+    char* slab = new char[SLAB_BYTES];
+    _slabs.insert(std::upper_bound(_slabs.begin(), _slabs.end(), slab), slab);
+    _reservedBytes += SLAB_BYTES;
+
+    if (_wantSiblingGroups) {
+        // no block of any group is in use yet
+        memset(slab, 0, _groupsOffset);
+    }
+    _slabAt = slab + _groupsOffset;
+    _slabEnd = _slabAt + ((SLAB_BYTES - _groupsOffset) / _groupBytes) * _groupBytes;
+    return slab;
+}
+
+char* OctreeElementPool::slabForBlock(const void* block) const {
+    const char* blockBytes = static_cast<const char*>(block);
+
+    QVector<char*>::const_iterator slabAfter = std::upper_bound(_slabs.constBegin(), _slabs.constEnd(), blockBytes);
+    if (slabAfter == _slabs.constBegin()) {
+        return NULL;
+    }
+    char* slab = *(slabAfter - 1);
+    return blockBytes < slab + SLAB_BYTES ? slab : NULL;
+}
+
+quint8& OctreeElementPool::occupancyOfGroup(char* slab, char* group) {
+    return *reinterpret_cast<quint8*>(slab + (group - slab - _groupsOffset) / _groupBytes);
+}
+
+char* OctreeElementPool::takeGroup() {
+    if (_freeBlocks) {
+        char* group = static_cast<char*>(_freeBlocks);
+        _freeBlocks = *static_cast<void**>(_freeBlocks);
+        return group;
+    }
+
+    if (_slabEnd - _slabAt < _groupBytes) {
+        addSlab();
+    }
+    char* group = _slabAt;
+    _slabAt += _groupBytes;
+    return group;
+}
+
+void* OctreeElementPool::takeBlockOfGroup(char* slab, char* group, int blockIndex) {
+    occupancyOfGroup(slab, group) |= (1 << blockIndex);
+    return group + blockIndex * _blockBytes;
+}
@@ -0,0 +1,81 @@
+//
+//  OctreeElementPool.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Fixed size blocks for octree elements and their child arrays
+//
+
+#ifndef __hifi__OctreeElementPool__
+#define __hifi__OctreeElementPool__
+
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+
+/// the blocks of a group, one for each child of an element
+const int BLOCKS_PER_SIBLING_GROUP = 8;
+
+/// Hands out blocks of one size carved from large slabs, so that freeing them doesn't fragment the heap. Slabs are kept
+/// for the life of the process, since trees may be deleted after the pools are.
+///
+/// A pool of sibling groups carves its slabs into groups of BLOCKS_PER_SIBLING_GROUP blocks, and puts the children of
+/// an element in one group, each at the block for its index, so that siblings sit next to each other in memory in
+/// child order. A group is reused once all of its blocks are free, and until then any free block in it is kept for the
+/// child it belongs to. Blocks allocated without a sibling share groups with each other.
+///
+/// A pool without sibling groups just hands out the block freed last, or carves a new one.
+class OctreeElementPool {
+public:
+    OctreeElementPool(int blockBytes, bool wantSiblingGroups);
+
+    void* allocate();
+
+    /// a block for the child at childIndex of an element, in the group of the sibling at siblingIndex, or the start of a
+    /// group of its own if the element has no other children. A sibling that isn't where its index says, as one that
+    /// was allocated without a sibling may not be, gets the new child a block like allocate() does.
+    void* allocateChild(const void* sibling, int siblingIndex, int childIndex);
+
+    void release(void* block);
+
+    int getBlockBytes() const { return _blockBytes; }
+
+    /// the bytes of all the slabs, and of the blocks of them handed out
+    quint64 getReservedBytes() const { return _reservedBytes; }
+    quint64 getBytesInUse() const { return _blocksInUse * _blockBytes; }
+
+private:
+    /// \return a new slab, which is also made the one blocks or groups are carved from
+    char* addSlab();
+
+    /// \return the slab the block was carved from, or NULL if it didn't come from this pool
+    char* slabForBlock(const void* block) const;
+
+    /// \return one byte of a slab's occupancy bits for each of its groups, with a bit for each block of the group
+    quint8& occupancyOfGroup(char* slab, char* group);
+
+    /// \return a group with none of its blocks in use
+    char* takeGroup();
+
+    void* takeBlockOfGroup(char* slab, char* group, int blockIndex);
+
+    QMutex _mutex;
+    int _blockBytes;
+    bool _wantSiblingGroups;
+
+    // with sibling groups a slab starts with the occupancy bits of its groups, followed by the groups
+    int _groupBytes;
+    int _groupsOffset;
+
+    void* _freeBlocks; /// each free block or group starts with a pointer to the next
+    char* _looseGroup;
+    char* _slabAt;
+    char* _slabEnd;
+    QVector<char*> _slabs; /// sorted by address
+
+    quint64 _reservedBytes;
+    quint64 _blocksInUse;
+};
+
+#endif /* defined(__hifi__OctreeElementPool__) */
@@ -0,0 +1,105 @@
+//
+//  OctreeEncodeCache.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <QtCore/QReadLocker>
+#include <QtCore/QWriteLocker>
+
+#include "OctreeEncodeCache.h"
+
+OctreeEncodeCache::OctreeEncodeCache(int maxBytes) :
+    _lock(),
+    _subtrees(),
+    _maxBytes(maxBytes),
+    _subtreeCount(0),
+    _bytes(0),
+    _clears(0)
+{
+    OctreeElement::addDeleteHook(this);
+}
+
+OctreeEncodeCache::~OctreeEncodeCache() {
+    OctreeElement::removeDeleteHook(this);
+}
+
+bool OctreeEncodeCache::find(const OctreeElement* element, int key, QByteArray& encoded, int& bytesWritten, int& levels,
+                             OctreeEncodeCounts& counts) {
+    QReadLocker locker(&_lock);
+
+    QHash<const OctreeElement*, QVector<Subtree> >::const_iterator subtrees = _subtrees.constFind(element);
+    if (subtrees == _subtrees.constEnd()) {
+        return false;
+    }
+    foreach (const Subtree& subtree, subtrees.value()) {
+        if (subtree.key == key) {
+            if (subtree.lastChanged != element->getLastChanged()) {
+                return false; // insert() will replace it
+            }
+            encoded = subtree.encoded;
+            bytesWritten = subtree.bytesWritten;
+            levels = subtree.levels;
+            counts = subtree.counts;
+            return true;
+        }
+    }
+    return false;
+}
+
+void OctreeEncodeCache::insert(const OctreeElement* element, int key, const QByteArray& encoded, int bytesWritten,
+                               int levels, const OctreeEncodeCounts& counts) {
+    QWriteLocker locker(&_lock);
+
+    // there's no telling which subtrees will be wanted again, so a full cache starts over
+    if (_bytes + encoded.size() > _maxBytes) {
+        _subtrees.clear();
+        _subtreeCount = 0;
+        _bytes = 0;
+        _clears++;
+    }
+
+    QVector<Subtree>& subtrees = _subtrees[element];
+    for (int i = 0; i < subtrees.size(); i++) {
+        if (subtrees.at(i).key == key) {
+            _bytes -= subtrees.at(i).encoded.size();
+            _subtreeCount--;
+            subtrees.remove(i);
+            break;
+        }
+    }
+
+    Subtree subtree;
+    subtree.key = key;
+    subtree.lastChanged = element->getLastChanged();
+    subtree.encoded = encoded;
+    subtree.bytesWritten = bytesWritten;
+    subtree.levels = levels;
+    subtree.counts = counts;
+    subtrees.append(subtree);
+
+    _bytes += encoded.size();
+    _subtreeCount++;
+}
+
+void OctreeEncodeCache::clear() {
+    QWriteLocker locker(&_lock);
+    _subtrees.clear();
+    _subtreeCount = 0;
+    _bytes = 0;
+}
+
+void OctreeEncodeCache::elementDeleted(OctreeElement* element) {
+    QWriteLocker locker(&_lock);
+
+    QHash<const OctreeElement*, QVector<Subtree> >::iterator subtrees = _subtrees.find(element);
+    if (subtrees != _subtrees.end()) {
+        foreach (const Subtree& subtree, subtrees.value()) {
+            _bytes -= subtree.encoded.size();
+            _subtreeCount--;
+        }
+        _subtrees.erase(subtrees);
+    }
+}
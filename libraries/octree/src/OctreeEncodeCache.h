@@ -0,0 +1,78 @@
+//
+//  OctreeEncodeCache.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Encoded subtrees of an octree, kept to be sent again to other viewers
+//
+
+#ifndef __hifi__OctreeEncodeCache__
+#define __hifi__OctreeEncodeCache__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QVector>
+
+#include "OctreeElement.h"
+#include "OctreeSceneStats.h"
+
+const int DEFAULT_MAX_ENCODE_CACHE_BYTES = 16 * 1024 * 1024;
+
+/// Keeps the bytes that Octree::encodeTreeBitstream() wrote for subtrees that every viewer who sees them at the same level
+/// of detail gets the same bytes for, so that the next viewer can be sent them without encoding the subtree again.
+///
+/// Each subtree is kept under a key for the level of detail and the kind of bitstream it was encoded for, along with the
+/// time its element last changed. Every change to an element changes the time of it and the elements above it (see
+/// OctreeElement::markWithChangedTime()), so a subtree is only found while nothing in it has changed. Entries of deleted
+/// elements are removed, so that an element made in the same place can't be mistaken for one.
+///
+/// Any number of threads may find and insert subtrees at once.
+class OctreeEncodeCache : public OctreeElementDeleteHook {
+public:
+    OctreeEncodeCache(int maxBytes = DEFAULT_MAX_ENCODE_CACHE_BYTES);
+    ~OctreeEncodeCache();
+
+    /// \param encoded set to the bytes that were written for the subtree
+    /// \param bytesWritten set to the byte count the encoding returned, which isn't always the number of bytes written
+    /// \param levels set to the number of levels the encoding went below the element
+    /// \param counts set to the scene stats that the encoding added to
+    /// \return true if the subtree is cached for the element as it is now
+    bool find(const OctreeElement* element, int key, QByteArray& encoded, int& bytesWritten, int& levels,
+              OctreeEncodeCounts& counts);
+
+    /// keeps an encoded subtree, emptying the cache first if it is full
+    void insert(const OctreeElement* element, int key, const QByteArray& encoded, int bytesWritten, int levels,
+                const OctreeEncodeCounts& counts);
+
+    void clear();
+
+    virtual void elementDeleted(OctreeElement* element);
+
+    int getSubtreeCount() const { return _subtreeCount; }
+    int getBytes() const { return _bytes; }
+    int getMaxBytes() const { return _maxBytes; }
+    quint64 getClears() const { return _clears; }
+
+private:
+    struct Subtree {
+        int key;
+        quint64 lastChanged;
+        QByteArray encoded;
+        int bytesWritten;
+        int levels;
+        OctreeEncodeCounts counts;
+    };
+
+    QReadWriteLock _lock;
+    QHash<const OctreeElement*, QVector<Subtree> > _subtrees;
+
+    int _maxBytes;
+    int _subtreeCount;
+    int _bytes;
+    quint64 _clears;
+};
+
+#endif /* defined(__hifi__OctreeEncodeCache__) */
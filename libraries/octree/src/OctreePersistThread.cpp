@@ -8,7 +8,10 @@
 //  Threaded or non-threaded Octree persistence
 //
 
+#include <cstdio>
+
 #include <QDebug>
+#include <QFileInfo>
 #include <PerfStat.h>
 #include <SharedUtil.h>
 
@@ -16,10 +19,18 @@
 
 OctreePersistThread::OctreePersistThread(Octree* tree, const QString& filename, int persistInterval) :
     _tree(tree),
+    _snapshots(NULL),
+    _journal(NULL),
     _filename(filename),
     _persistInterval(persistInterval),
     _initialLoadComplete(false),
-    _loadTimeUSecs(0) 
+    _loadTimeUSecs(0),
+    _lastCheck(0),
+    _saves(0),
+    _saveUsecs(0),
+    _saveBytes(0),
+    _packetsReplayed(0),
+    _replayUsecs(0)
 {
 }
 
@@ -29,19 +40,30 @@ bool OctreePersistThread::process() {
         quint64 loadStarted = usecTimestampNow();
         qDebug() << "loading Octrees from file: " << _filename << "...";
 
-        bool persistantFileRead;
+        bool persistantFileRead = false;
+
+        // with snapshots both copies have to start out the same
+        int treesToLoad = _snapshots ? NUMBER_OF_OCTREE_SNAPSHOTS : 1;
+        for (int i = 0; i < treesToLoad; i++) {
+            Octree* tree = _snapshots ? _snapshots->getTree(i) : _tree;
 
-        _tree->lockForWrite();
-        {
-            PerformanceWarning warn(true, "Loading Octree File", true);
-            persistantFileRead = _tree->readFromSVOFile(_filename.toLocal8Bit().constData());
+            tree->lockForWrite();
+            {
+                PerformanceWarning warn(true, "Loading Octree File", true);
+                persistantFileRead = tree->readFromSVOFile(_filename.toLocal8Bit().constData());
+            }
+            tree->unlock();
+
+            tree->clearDirtyBit(); // the tree is clean since we just loaded it
+        }
+
+        if (_journal) {
+            recoverEdits();
         }
-        _tree->unlock();
 
         quint64 loadDone = usecTimestampNow();
         _loadTimeUSecs = loadDone - loadStarted;
 
-        _tree->clearDirtyBit(); // the tree is clean since we just loaded it
         qDebug("DONE loading Octrees from file... fileRead=%s", debug::valueOf(persistantFileRead));
 
         unsigned long nodeCount = OctreeElement::getNodeCount();
@@ -68,23 +90,114 @@ bool OctreePersistThread::process() {
         quint64 USECS_TO_SLEEP = 10 * MSECS_TO_USECS; // every 10ms
         usleep(USECS_TO_SLEEP);
 
-        // do our updates then check to save...
-        _tree->update();
+        // do our updates then check to save... snapshot trees only ever change by the edits applied to them
+        if (!_snapshots) {
+            _tree->update();
+        }
 
         quint64 now = usecTimestampNow();
         quint64 sinceLastSave = now - _lastCheck;
         quint64 intervalToCheck = _persistInterval * MSECS_TO_USECS;
+        bool isDue = sinceLastSave > intervalToCheck;
+
+        // a journal keeps every edit safe in between, so the whole file only has to be written now and then
+        if (_journal) {
+            isDue = _journal->getCurrentBytes() >= JOURNAL_BYTES_TO_COMPACT
+                || sinceLastSave > DEFAULT_COMPACTION_INTERVAL * MSECS_TO_USECS;
+        }
 
-        if (sinceLastSave > intervalToCheck) {
+        if (isDue) {
             // check the dirty bit and persist here...
             _lastCheck = usecTimestampNow();
-            if (_tree->isDirty()) {
-                qDebug() << "saving Octrees to file " << _filename << "...";
-                _tree->writeToSVOFile(_filename.toLocal8Bit().constData());
-                _tree->clearDirtyBit(); // tree is clean after saving
-                qDebug("DONE saving Octrees to file...");
-            }
+            persist();
         }
     }
     return isStillRunning();  // keep running till they terminate us
 }
+
+void OctreePersistThread::persist() {
+    // with a journal, the edits since the last save are the ones in it, which we move aside before saving, at which point
+    // all of them are in the tree
+    if (_journal && (_journal->getCurrentBytes() == 0 || !_journal->rotate())) {
+        return;
+    }
+
+    bool saved = false;
+    if (!_snapshots) {
+        if (_journal || _tree->isDirty()) {
+            qDebug() << "saving Octrees to file " << _filename << "...";
+            saved = saveTree(_tree, true);
+            _tree->clearDirtyBit(); // tree is clean after saving
+            qDebug("DONE saving Octrees to file...");
+        }
+    } else {
+        // each copy has its own dirty bit, so the same edits may be saved once from each of them. Holding the copy keeps
+        // it published while we save it, so the writer goes on editing the other one instead of waiting for us.
+        int snapshotIndex = _snapshots->holdPublished();
+        Octree* snapshot = _snapshots->getTree(snapshotIndex);
+        if (_journal || snapshot->isDirty()) {
+            qDebug() << "saving Octrees to file " << _filename << "from snapshot" << snapshotIndex << "...";
+            bool wantTreeLock = false;
+            saved = saveTree(snapshot, wantTreeLock);
+            snapshot->clearDirtyBit(); // this copy is clean after saving
+            qDebug("DONE saving Octrees to file...");
+        }
+        _snapshots->release(snapshotIndex);
+    }
+
+    // a journal we couldn't save stays, to be replayed, or saved along with the next one
+    if (_journal && saved) {
+        _journal->endRotation();
+    }
+}
+
+bool OctreePersistThread::saveTree(Octree* tree, bool wantTreeLock) {
+    quint64 saveStart = usecTimestampNow();
+
+    QString savingFilename = _filename + ".saving";
+    if (!tree->writeToChunkedSVOFile(savingFilename.toLocal8Bit().constData(), wantTreeLock)) {
+        qDebug() << "unable to write" << savingFilename;
+        return false;
+    }
+    qint64 fileBytes = QFileInfo(savingFilename).size();
+
+#ifdef WIN32
+    // rename won't replace a file on windows, so there we can't do this in one step
+    QFile::remove(_filename);
+#endif
+    if (rename(savingFilename.toLocal8Bit().constData(), _filename.toLocal8Bit().constData()) != 0) {
+        qDebug() << "unable to replace" << _filename << "with" << savingFilename;
+        return false;
+    }
+
+    _saves++;
+    _saveUsecs += usecTimestampNow() - saveStart;
+    _saveBytes += fileBytes;
+    return true;
+}
+
+void OctreePersistThread::recoverEdits() {
+    quint64 replayStart = usecTimestampNow();
+
+    int packetsReplayed = 0;
+    int treesToReplay = _snapshots ? NUMBER_OF_OCTREE_SNAPSHOTS : 1;
+    for (int i = 0; i < treesToReplay; i++) {
+        Octree* tree = _snapshots ? _snapshots->getTree(i) : _tree;
+
+        tree->lockForWrite();
+        packetsReplayed = _journal->replay(tree);
+        tree->unlock();
+    }
+
+    _packetsReplayed += packetsReplayed;
+    _replayUsecs += usecTimestampNow() - replayStart;
+
+    // edits aren't taken until we're done loading, so nothing can be added to the journal while we save
+    if (packetsReplayed > 0) {
+        qDebug() << "saving Octrees to file " << _filename << "with the" << packetsReplayed << "edits replayed...";
+        if (saveTree(_snapshots ? _snapshots->getTree(0) : _tree, true)) {
+            _journal->discard();
+        }
+    }
+    _journal->start();
+}
@@ -14,6 +14,8 @@
 #include <QString>
 #include <GenericThread.h>
 #include "Octree.h"
+#include "OctreeEditJournal.h"
+#include "OctreeSnapshots.h"
 
 /// Generalized threaded processor for handling received inbound packets.
 class OctreePersistThread : public GenericThread {
@@ -21,11 +23,28 @@ class OctreePersistThread : public GenericThread {
 public:
     static const int DEFAULT_PERSIST_INTERVAL = 1000 * 30; // every 30 seconds
 
+    // with an edit journal the file is only rewritten this often, or once the journal grows this large
+    static const int DEFAULT_COMPACTION_INTERVAL = 1000 * 60 * 10; // every 10 minutes
+    static const qint64 JOURNAL_BYTES_TO_COMPACT = 16 * 1024 * 1024;
+
     OctreePersistThread(Octree* tree, const QString& filename, int persistInterval = DEFAULT_PERSIST_INTERVAL);
 
+    /// loads into and saves from both copies of the snapshots instead of the tree, must be set before the thread starts
+    void setSnapshots(OctreeSnapshots* snapshots) { _snapshots = snapshots; }
+
+    /// replays the journal over the file when loading, and saves by compacting the journal into the file, must be set
+    /// before the thread starts
+    void setEditJournal(OctreeEditJournal* journal) { _journal = journal; }
+
     bool isInitialLoadComplete() const { return _initialLoadComplete; }
     quint64 getLoadElapsedTime() const { return _loadTimeUSecs; }
 
+    quint64 getSaves() const { return _saves; }
+    quint64 getSaveUsecs() const { return _saveUsecs; }
+    quint64 getSaveBytes() const { return _saveBytes; }
+    quint64 getPacketsReplayed() const { return _packetsReplayed; }
+    quint64 getReplayUsecs() const { return _replayUsecs; }
+
 signals:
     void loadCompleted();
 
@@ -33,13 +52,30 @@ protected:
     /// Implements generic processing behavior for this thread.
     virtual bool process();
 private:
+    /// saves the tree if it's dirty, or the published snapshot if we have them, which is pinned rather than locked
+    void persist();
+
+    /// writes the tree next to the file and then moves it over the file, so that a crash never leaves half a file
+    bool saveTree(Octree* tree, bool wantTreeLock);
+
+    /// replays the edit journal into each tree and saves them, so that the journal can start over
+    void recoverEdits();
+
     Octree* _tree;
+    OctreeSnapshots* _snapshots;
+    OctreeEditJournal* _journal;
     QString _filename;
     int _persistInterval;
     bool _initialLoadComplete;
 
     quint64 _loadTimeUSecs;
     quint64 _lastCheck;
+
+    quint64 _saves;
+    quint64 _saveUsecs;
+    quint64 _saveBytes;
+    quint64 _packetsReplayed;
+    quint64 _replayUsecs;
 };
 
 #endif // __Octree_server__OctreePersistThread__
@@ -116,6 +116,9 @@ void OctreeSceneStats::copyFromOther(const OctreeSceneStats& other) {
     _existsInPacketBitsWritten = other._existsInPacketBitsWritten;
     _treesRemoved = other._treesRemoved;
 
+    _encodeCacheHits = other._encodeCacheHits;
+    _encodeCacheMisses = other._encodeCacheMisses;
+
     // before copying the jurisdictions, delete any current values...
     if (_jurisdictionRoot) {
         delete[] _jurisdictionRoot;
@@ -283,6 +286,9 @@ void OctreeSceneStats::reset() {
     _existsInPacketBitsWritten = 0;
     _treesRemoved = 0;
 
+    _encodeCacheHits = 0;
+    _encodeCacheMisses = 0;
+
     if (_jurisdictionRoot) {
         delete[] _jurisdictionRoot;
         _jurisdictionRoot = NULL;
@@ -395,6 +401,62 @@ void OctreeSceneStats::childBitsRemoved(bool includesExistsBits, bool includesCo
     _treesRemoved++;
 }
 
+OctreeEncodeCounts OctreeEncodeCounts::since(const OctreeEncodeCounts& earlier) const {
+    // some of the counts go down when child bits are removed, which the unsigned difference still gets right when added
+    OctreeEncodeCounts counts;
+    counts.internal = internal - earlier.internal;
+    counts.leaves = leaves - earlier.leaves;
+    counts.internalSkippedDistance = internalSkippedDistance - earlier.internalSkippedDistance;
+    counts.leavesSkippedDistance = leavesSkippedDistance - earlier.leavesSkippedDistance;
+    counts.internalColorSent = internalColorSent - earlier.internalColorSent;
+    counts.leavesColorSent = leavesColorSent - earlier.leavesColorSent;
+    counts.colorBitsWritten = colorBitsWritten - earlier.colorBitsWritten;
+    counts.existsBitsWritten = existsBitsWritten - earlier.existsBitsWritten;
+    counts.existsInPacketBitsWritten = existsInPacketBitsWritten - earlier.existsInPacketBitsWritten;
+    counts.treesRemoved = treesRemoved - earlier.treesRemoved;
+    counts.didntFit = didntFit - earlier.didntFit;
+    return counts;
+}
+
+OctreeEncodeCounts OctreeSceneStats::getEncodeCounts() const {
+    OctreeEncodeCounts counts;
+    counts.internal = _internal;
+    counts.leaves = _leaves;
+    counts.internalSkippedDistance = _internalSkippedDistance;
+    counts.leavesSkippedDistance = _leavesSkippedDistance;
+    counts.internalColorSent = _internalColorSent;
+    counts.leavesColorSent = _leavesColorSent;
+    counts.colorBitsWritten = _colorBitsWritten;
+    counts.existsBitsWritten = _existsBitsWritten;
+    counts.existsInPacketBitsWritten = _existsInPacketBitsWritten;
+    counts.treesRemoved = _treesRemoved;
+    counts.didntFit = _didntFit;
+    return counts;
+}
+
+void OctreeSceneStats::encodeCacheHit(const OctreeEncodeCounts& counts) {
+    _encodeCacheHits++;
+
+    // a cached subtree is one that fit, so it has no didn't fit count to add
+    _traversed += counts.internal + counts.leaves;
+    _internal += counts.internal;
+    _leaves += counts.leaves;
+    _skippedDistance += counts.internalSkippedDistance + counts.leavesSkippedDistance;
+    _internalSkippedDistance += counts.internalSkippedDistance;
+    _leavesSkippedDistance += counts.leavesSkippedDistance;
+    _colorSent += counts.internalColorSent + counts.leavesColorSent;
+    _internalColorSent += counts.internalColorSent;
+    _leavesColorSent += counts.leavesColorSent;
+    _colorBitsWritten += counts.colorBitsWritten;
+    _existsBitsWritten += counts.existsBitsWritten;
+    _existsInPacketBitsWritten += counts.existsInPacketBitsWritten;
+    _treesRemoved += counts.treesRemoved;
+}
+
+void OctreeSceneStats::encodeCacheMiss() {
+    _encodeCacheMisses++;
+}
+
 int OctreeSceneStats::packIntoMessage(unsigned char* destinationBuffer, int availableBytes) {
     unsigned char* bufferStart = destinationBuffer;
     
@@ -462,6 +524,10 @@ int OctreeSceneStats::packIntoMessage(unsigned char* destinationBuffer, int avai
     destinationBuffer += sizeof(_existsInPacketBitsWritten);
     memcpy(destinationBuffer, &_treesRemoved, sizeof(_treesRemoved));
     destinationBuffer += sizeof(_treesRemoved);
+    memcpy(destinationBuffer, &_encodeCacheHits, sizeof(_encodeCacheHits));
+    destinationBuffer += sizeof(_encodeCacheHits);
+    memcpy(destinationBuffer, &_encodeCacheMisses, sizeof(_encodeCacheMisses));
+    destinationBuffer += sizeof(_encodeCacheMisses);
 
     // add the root jurisdiction
     if (_jurisdictionRoot) {
@@ -589,6 +655,10 @@ int OctreeSceneStats::unpackFromMessage(const unsigned char* sourceBuffer, int a
     sourceBuffer += sizeof(_existsInPacketBitsWritten);
     memcpy(&_treesRemoved, sourceBuffer, sizeof(_treesRemoved));
     sourceBuffer += sizeof(_treesRemoved);
+    memcpy(&_encodeCacheHits, sourceBuffer, sizeof(_encodeCacheHits));
+    sourceBuffer += sizeof(_encodeCacheHits);
+    memcpy(&_encodeCacheMisses, sourceBuffer, sizeof(_encodeCacheMisses));
+    sourceBuffer += sizeof(_encodeCacheMisses);
 
     // before allocating new juridiction, clean up existing ones
     if (_jurisdictionRoot) {
@@ -689,6 +759,8 @@ void OctreeSceneStats::printDebugDetails() {
     qDebug("    exists bits         : %lu", _existsBitsWritten        );
     qDebug("    in packet bit       : %lu", _existsInPacketBitsWritten);
     qDebug("    trees removed       : %lu", _treesRemoved             );
+    qDebug("    encode cache hits   : %lu", _encodeCacheHits          );
+    qDebug("    encode cache misses : %lu", _encodeCacheMisses        );
 }
 
 OctreeSceneStats::ItemInfo OctreeSceneStats::_ITEMS[] = {
@@ -707,6 +779,7 @@ OctreeSceneStats::ItemInfo OctreeSceneStats::_ITEMS[] = {
     { "Skipped - No Change"  , GREENISH  , 3 , "Total,Internal,Leaves" },
     { "Skipped - Occluded"   , YELLOWISH , 3 , "Total,Internal,Leaves" },
     { "Didn't fit in packet" , GREYISH   , 4 , "Total,Internal,Leaves,Removed" },
+    { "Encode Cache"         , YELLOWISH , 3 , "Hits,Misses,Hit Rate" },
     { "Mode"                 , GREENISH  , 4 , "Moving,Stationary,Partial,Full" },
 };
 
@@ -800,6 +873,13 @@ const char* OctreeSceneStats::getItemValue(Item item) {
                     _didntFit, _internalDidntFit, _leavesDidntFit, _treesRemoved);
             break;
         }
+        case ITEM_ENCODE_CACHE: {
+            unsigned long lookups = _encodeCacheHits + _encodeCacheMisses;
+            float hitRate = lookups == 0 ? 0.0f : (float)_encodeCacheHits / lookups;
+            sprintf(_itemValueBuffer, "%lu hits %lu misses (%.0f%% hit rate)",
+                    _encodeCacheHits, _encodeCacheMisses, hitRate * 100.0f);
+            break;
+        }
         case ITEM_BITS: {
             sprintf(_itemValueBuffer, "colors: %lu, exists: %lu, in packets: %lu", 
                     _colorBitsWritten, _existsBitsWritten, _existsInPacketBitsWritten);
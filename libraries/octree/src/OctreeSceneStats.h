@@ -21,6 +21,25 @@
 
 class OctreeElement;
 
+/// The counts OctreeSceneStats keeps of what encoding a subtree wrote and skipped, which the OctreeEncodeCache keeps with
+/// the encoded subtree, so that a scene the subtree is reused in counts it the same as one it was encoded in
+struct OctreeEncodeCounts {
+    unsigned long internal;
+    unsigned long leaves;
+    unsigned long internalSkippedDistance;
+    unsigned long leavesSkippedDistance;
+    unsigned long internalColorSent;
+    unsigned long leavesColorSent;
+    unsigned long colorBitsWritten;
+    unsigned long existsBitsWritten;
+    unsigned long existsInPacketBitsWritten;
+    unsigned long treesRemoved;
+    unsigned long didntFit;
+
+    /// the counts added since the earlier ones
+    OctreeEncodeCounts since(const OctreeEncodeCounts& earlier) const;
+};
+
 /// Collects statistics for calculating and sending a scene from a octree server to an interface client
 class OctreeSceneStats {
 public:
@@ -85,6 +104,18 @@ public:
     /// Fix up tracking statistics in case where bitmasks were removed for some reason
     void childBitsRemoved(bool includesExistsBits, bool includesColors);
 
+    /// Returns the counts that encoding a subtree adds to
+    OctreeEncodeCounts getEncodeCounts() const;
+
+    /// Track that a subtree was copied from the encode cache, along with the counts of encoding it
+    void encodeCacheHit(const OctreeEncodeCounts& counts);
+
+    /// Track that a subtree that could have been copied from the encode cache had to be encoded
+    void encodeCacheMiss();
+
+    unsigned long getEncodeCacheHits() const { return _encodeCacheHits; }
+    unsigned long getEncodeCacheMisses() const { return _encodeCacheMisses; }
+
     /// Pack the details of the statistics into a buffer for sending as a network packet
     int packIntoMessage(unsigned char* destinationBuffer, int availableBytes);
 
@@ -117,6 +148,7 @@ public:
         ITEM_SKIPPED_NO_CHANGE,
         ITEM_SKIPPED_OCCLUDED,
         ITEM_DIDNT_FIT,
+        ITEM_ENCODE_CACHE,
         ITEM_MODE,
         ITEM_COUNT
     };
@@ -237,6 +269,9 @@ private:
     unsigned long _existsInPacketBitsWritten;
     unsigned long _treesRemoved;
 
+    unsigned long _encodeCacheHits;
+    unsigned long _encodeCacheMisses;
+
     // Accounting Notes:
     //
     // 1) number of octrees sent can be calculated as _colorSent + _colorBitsWritten. This works because each internal 
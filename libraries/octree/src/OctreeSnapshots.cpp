@@ -0,0 +1,126 @@
+//
+//  OctreeSnapshots.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <QtCore/QVector>
+
+#include <SharedUtil.h>
+
+#include "Octree.h"
+#include "OctreeElementBag.h"
+#include "OctreeSnapshots.h"
+
+// how long the writer sleeps between checks for readers that are still on the copy it wants to write to
+const quint64 WRITER_WAIT_FOR_READERS_USECS = 100;
+
+OctreeSnapshots::OctreeSnapshots(Octree* first, Octree* second) :
+    _publishedIndex(0),
+    _holdMutex(),
+    _isWriting(false),
+    _isPublishDeferred(false),
+    _sumPublishes(0),
+    _sumDeferredPublishes(0),
+    _sumWriterWaitUsecs(0)
+{
+    _trees[0] = first;
+    _trees[1] = second;
+    _holders[0] = 0;
+    _holders[1] = 0;
+}
+
+int OctreeSnapshots::pinPublished() {
+    forever {
+        int index = _publishedIndex.load();
+        _readers[index].ref();
+
+        // the writer may have published the other copy and checked our count before we raised it, in which case it could
+        // be writing to this one now, so we only keep the pin if this copy is still published
+        if (_publishedIndex.fetchAndAddOrdered(0) == index) {
+            return index;
+        }
+        _readers[index].deref();
+    }
+}
+
+void OctreeSnapshots::unpin(int index) {
+    _readers[index].deref();
+}
+
+int OctreeSnapshots::holdPublished() {
+    // the writer never writes to the published copy, and won't unpublish this one until it is released, so unlike a pin,
+    // a hold doesn't have to be counted as a reader
+    QMutexLocker holdLocker(&_holdMutex);
+    int index = _publishedIndex.load();
+    _holders[index]++;
+    return index;
+}
+
+void OctreeSnapshots::release(int index) {
+    QMutexLocker holdLocker(&_holdMutex);
+    _holders[index]--;
+
+    // the writer may not write again for a while, and its edits shouldn't wait for it
+    if (_holders[index] == 0 && _isPublishDeferred && !_isWriting) {
+        publishUnpublished();
+    }
+}
+
+int OctreeSnapshots::movePinToPublished(int index, OctreeElementBag& bag) {
+    int publishedIndex = pinPublished();
+    Octree* published = _trees[publishedIndex];
+
+    QVector<OctreeElement*> elementsLeft;
+    while (!bag.isEmpty()) {
+        elementsLeft.append(bag.extract());
+    }
+    foreach (OctreeElement* element, elementsLeft) {
+        bag.insert(published->nodeForOctalCode(published->getRoot(), element->getOctalCode(), NULL));
+    }
+
+    unpin(index);
+    return publishedIndex;
+}
+
+Octree* OctreeSnapshots::beginWrite() {
+    _holdMutex.lock();
+    _isWriting = true;
+    int unpublishedIndex = 1 - _publishedIndex.load();
+    _holdMutex.unlock();
+
+    quint64 waitStart = usecTimestampNow();
+    while (_readers[unpublishedIndex].fetchAndAddOrdered(0) > 0) {
+        usleep(WRITER_WAIT_FOR_READERS_USECS);
+    }
+    _sumWriterWaitUsecs += usecTimestampNow() - waitStart;
+
+    return _trees[unpublishedIndex];
+}
+
+bool OctreeSnapshots::publish() {
+    QMutexLocker holdLocker(&_holdMutex);
+    _isWriting = false;
+    if (_holders[_publishedIndex.load()] > 0) {
+        _isPublishDeferred = true;
+        _sumDeferredPublishes++;
+        return false;
+    }
+
+    publishUnpublished();
+    return true;
+}
+
+void OctreeSnapshots::publishUnpublished() {
+    _publishedIndex.fetchAndStoreOrdered(1 - _publishedIndex.load());
+    _isPublishDeferred = false;
+    _sumPublishes++;
+}
+
+void OctreeSnapshots::resetStats() {
+    _sumPublishes = 0;
+    _sumDeferredPublishes = 0;
+    _sumWriterWaitUsecs = 0;
+}
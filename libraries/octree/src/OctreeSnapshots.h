@@ -0,0 +1,87 @@
+//
+//  OctreeSnapshots.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Two copies of an octree, so that readers never wait on the writer
+//
+
+#ifndef __hifi__OctreeSnapshots__
+#define __hifi__OctreeSnapshots__
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+
+class Octree;
+class OctreeElementBag;
+
+const int NUMBER_OF_OCTREE_SNAPSHOTS = 2;
+
+/// Keeps two copies of the same octree, one published to readers and one for the writer. Readers pin the published copy
+/// and read it without any lock, for as long as they like. The writer applies its edits to the other copy, publishes it,
+/// and applies the same edits to the copy it replaced once the readers have moved off of that one, so every edit has to
+/// be applied to both (see Octree::canReplayEdits()). A reader that needs a copy for a long time, like the persist
+/// thread saving it, holds it instead, and the writer keeps writing to its own copy rather than wait for it.
+class OctreeSnapshots {
+public:
+    /// the trees must hold the same octree, and are not owned by the snapshots
+    OctreeSnapshots(Octree* first, Octree* second);
+
+    Octree* getTree(int index) const { return _trees[index]; }
+
+    /// pins the published copy, which won't be written to until it is unpinned
+    /// \return the index of the pinned copy
+    int pinPublished();
+    void unpin(int index);
+
+    /// holds the published copy for as long as a reader likes, in the meantime publish() leaves it published, and the
+    /// last release() publishes the writer's copy, if that was held back and the writer is done with it
+    /// \return the index of the held copy
+    int holdPublished();
+    void release(int index);
+
+    /// a reader that holds on to a pin should move to the published copy once the one it pinned isn't anymore
+    bool isPublished(int index) const { return _publishedIndex.load() == index; }
+
+    /// moves a reader's pin to the published copy, along with the elements in its bag, each of which is replaced by the
+    /// same element of that copy, or by the closest ancestor it has of an element that is gone
+    /// \return the index of the newly pinned copy
+    int movePinToPublished(int index, OctreeElementBag& bag);
+
+    /// waits for the readers to leave the unpublished copy, which the caller may then write to until it calls publish().
+    /// That is the copy the caller wrote to last, unless it has been published since.
+    Octree* beginWrite();
+
+    /// publishes the copy returned by beginWrite() to readers, unless the published copy is held, in which case the next
+    /// beginWrite() returns the same copy again
+    /// \return whether the copy was published
+    bool publish();
+
+    quint64 getSumPublishes() const { return _sumPublishes; }
+    quint64 getSumDeferredPublishes() const { return _sumDeferredPublishes; }
+    quint64 getSumWriterWaitUsecs() const { return _sumWriterWaitUsecs; }
+    void resetStats();
+
+private:
+    /// called with _holdMutex locked
+    void publishUnpublished();
+
+    Octree* _trees[NUMBER_OF_OCTREE_SNAPSHOTS];
+    QAtomicInt _readers[NUMBER_OF_OCTREE_SNAPSHOTS];
+    QAtomicInt _publishedIndex;
+
+    // guards the holders, so that a copy can't be held just as publish() replaces it, and whether the writer has a copy
+    // to publish, so that release() doesn't publish one it is writing to
+    QMutex _holdMutex;
+    int _holders[NUMBER_OF_OCTREE_SNAPSHOTS];
+    bool _isWriting;
+    bool _isPublishDeferred;
+
+    quint64 _sumPublishes;
+    quint64 _sumDeferredPublishes;
+    quint64 _sumWriterWaitUsecs;
+};
+
+#endif /* defined(__hifi__OctreeSnapshots__) */
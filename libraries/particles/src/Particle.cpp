@@ -24,6 +24,7 @@
 
 #include "ParticlesScriptingInterface.h"
 #include "Particle.h"
+#include "ParticleScriptContexts.h"
 #include "ParticleTree.h"
 
 uint32_t Particle::_nextID = 0;
@@ -846,20 +847,20 @@ void Particle::update(const quint64& now) {
     }
 }
 
-void Particle::startParticleScriptContext(ScriptEngine& engine, ParticleScriptObject& particleScriptable) {
+ParticleScriptObject& Particle::startParticleScriptContext(ParticleScriptContext& context) {
+    ScriptEngine& engine = context.getEngine();
     if (_voxelEditSender) {
         engine.getVoxelsScriptingInterface()->setPacketSender(_voxelEditSender);
     }
     if (_particleEditSender) {
         engine.getParticlesScriptingInterface()->setPacketSender(_particleEditSender);
     }
-
-    // Add the "this" Particle object
-    engine.registerGlobalObject("Particle", &particleScriptable);
-    engine.evaluate();
+    return context.start(this);
 }
 
-void Particle::endParticleScriptContext(ScriptEngine& engine, ParticleScriptObject& particleScriptable) {
+void Particle::endParticleScriptContext(ParticleScriptContext& context) {
+    context.end();
+
     if (_voxelEditSender) {
         _voxelEditSender->releaseQueuedMessages();
     }
@@ -871,34 +872,28 @@ void Particle::endParticleScriptContext(ScriptEngine& engine, ParticleScriptObje
 void Particle::executeUpdateScripts() {
     // Only run this particle script if there's a script attached directly to the particle.
     if (!_script.isEmpty()) {
-        ScriptEngine engine(_script);
-        ParticleScriptObject particleScriptable(this);
-        startParticleScriptContext(engine, particleScriptable);
-        particleScriptable.emitUpdate();
-        endParticleScriptContext(engine, particleScriptable);
+        ParticleScriptContext* context = ParticleScriptContexts::contextForScript(_script);
+        startParticleScriptContext(*context).emitUpdate();
+        endParticleScriptContext(*context);
     }
 }
 
 void Particle::collisionWithParticle(Particle* other, const glm::vec3& penetration) {
     // Only run this particle script if there's a script attached directly to the particle.
     if (!_script.isEmpty()) {
-        ScriptEngine engine(_script);
-        ParticleScriptObject particleScriptable(this);
-        startParticleScriptContext(engine, particleScriptable);
+        ParticleScriptContext* context = ParticleScriptContexts::contextForScript(_script);
         ParticleScriptObject otherParticleScriptable(other);
-        particleScriptable.emitCollisionWithParticle(&otherParticleScriptable, penetration);
-        endParticleScriptContext(engine, particleScriptable);
+        startParticleScriptContext(*context).emitCollisionWithParticle(&otherParticleScriptable, penetration);
+        endParticleScriptContext(*context);
     }
 }
 
 void Particle::collisionWithVoxel(VoxelDetail* voxelDetails, const glm::vec3& penetration) {
     // Only run this particle script if there's a script attached directly to the particle.
     if (!_script.isEmpty()) {
-        ScriptEngine engine(_script);
-        ParticleScriptObject particleScriptable(this);
-        startParticleScriptContext(engine, particleScriptable);
-        particleScriptable.emitCollisionWithVoxel(*voxelDetails, penetration);
-        endParticleScriptContext(engine, particleScriptable);
+        ParticleScriptContext* context = ParticleScriptContexts::contextForScript(_script);
+        startParticleScriptContext(*context).emitCollisionWithVoxel(*voxelDetails, penetration);
+        endParticleScriptContext(*context);
     }
 }
 
@@ -23,6 +23,7 @@
 class Particle;
 class ParticleEditPacketSender;
 class ParticleProperties;
+class ParticleScriptContext;
 class ParticlesScriptingInterface;
 class ParticleScriptObject;
 class ParticleTree;
@@ -322,8 +323,9 @@ protected:
     static VoxelEditPacketSender* _voxelEditSender;
     static ParticleEditPacketSender* _particleEditSender;
 
-    void startParticleScriptContext(ScriptEngine& engine, ParticleScriptObject& particleScriptable);
-    void endParticleScriptContext(ScriptEngine& engine, ParticleScriptObject& particleScriptable);
+    /// points the context's "Particle" object at this particle for one update or collision, until it is ended
+    ParticleScriptObject& startParticleScriptContext(ParticleScriptContext& context);
+    void endParticleScriptContext(ParticleScriptContext& context);
     void executeUpdateScripts();
 
     void setAge(float age);
@@ -370,6 +372,9 @@ public:
     ParticleScriptObject(Particle* particle) { _particle = particle; }
     //~ParticleScriptObject() { qDebug() << "~ParticleScriptObject() this=" << this; }
 
+    /// lets a script that was evaluated once be run for any particle, NULL between runs
+    void setParticle(Particle* particle) { _particle = particle; }
+
     void emitUpdate() { emit update(); }
     void emitCollisionWithParticle(QObject* other, const glm::vec3& penetration) 
                 { emit collisionWithParticle(other, penetration); }
@@ -377,45 +382,47 @@ public:
                 { emit collisionWithVoxel(voxel, penetration); }
 
 public slots:
-    unsigned int getID() const { return _particle->getID(); }
+    // the object only has a particle while a script is run for one, so a script that calls these at any other time (like
+    // from its top level code in a pooled context) gets defaults and changes nothing
+    unsigned int getID() const { return _particle ? _particle->getID() : UNKNOWN_PARTICLE_ID; }
     
     /// get position in meter units
-    glm::vec3 getPosition() const { return _particle->getPosition() * (float)TREE_SCALE; }
+    glm::vec3 getPosition() const { return _particle ? _particle->getPosition() * (float)TREE_SCALE : glm::vec3(); }
 
     /// get velocity in meter units
-    glm::vec3 getVelocity() const { return _particle->getVelocity() * (float)TREE_SCALE; }
-    xColor getColor() const { return _particle->getXColor(); }
+    glm::vec3 getVelocity() const { return _particle ? _particle->getVelocity() * (float)TREE_SCALE : glm::vec3(); }
+    xColor getColor() const { return _particle ? _particle->getXColor() : xColor(); }
 
     /// get gravity in meter units
-    glm::vec3 getGravity() const { return _particle->getGravity() * (float)TREE_SCALE; }
+    glm::vec3 getGravity() const { return _particle ? _particle->getGravity() * (float)TREE_SCALE : glm::vec3(); }
 
-    float getDamping() const { return _particle->getDamping(); }
+    float getDamping() const { return _particle ? _particle->getDamping() : 0.0f; }
 
     /// get radius in meter units
-    float getRadius() const { return _particle->getRadius() * (float)TREE_SCALE; }
-    bool getShouldDie() { return _particle->getShouldDie(); }
-    float getAge() const { return _particle->getAge(); }
-    float getLifetime() const { return _particle->getLifetime(); }
-    ParticleProperties getProperties() const { return _particle->getProperties(); }
+    float getRadius() const { return _particle ? _particle->getRadius() * (float)TREE_SCALE : 0.0f; }
+    bool getShouldDie() { return _particle ? _particle->getShouldDie() : false; }
+    float getAge() const { return _particle ? _particle->getAge() : 0.0f; }
+    float getLifetime() const { return _particle ? _particle->getLifetime() : 0.0f; }
+    ParticleProperties getProperties() const { return _particle ? _particle->getProperties() : ParticleProperties(); }
 
     /// set position in meter units
-    void setPosition(glm::vec3 value) { _particle->setPosition(value / (float)TREE_SCALE); }
+    void setPosition(glm::vec3 value) { if (_particle) { _particle->setPosition(value / (float)TREE_SCALE); } }
 
     /// set velocity in meter units
-    void setVelocity(glm::vec3 value) { _particle->setVelocity(value / (float)TREE_SCALE); }
+    void setVelocity(glm::vec3 value) { if (_particle) { _particle->setVelocity(value / (float)TREE_SCALE); } }
 
     /// set gravity in meter units
-    void setGravity(glm::vec3 value) { _particle->setGravity(value / (float)TREE_SCALE); }
+    void setGravity(glm::vec3 value) { if (_particle) { _particle->setGravity(value / (float)TREE_SCALE); } }
     
-    void setDamping(float value) { _particle->setDamping(value); }
-    void setColor(xColor value) { _particle->setColor(value); }
+    void setDamping(float value) { if (_particle) { _particle->setDamping(value); } }
+    void setColor(xColor value) { if (_particle) { _particle->setColor(value); } }
 
     /// set radius in meter units
-    void setRadius(float value) { _particle->setRadius(value / (float)TREE_SCALE); }
-    void setShouldDie(bool value) { _particle->setShouldDie(value); }
-    void setScript(const QString& script) { _particle->setScript(script); }
-    void setLifetime(float value) const { return _particle->setLifetime(value); }
-    void setProperties(const ParticleProperties& properties) { return _particle->setProperties(properties); }
+    void setRadius(float value) { if (_particle) { _particle->setRadius(value / (float)TREE_SCALE); } }
+    void setShouldDie(bool value) { if (_particle) { _particle->setShouldDie(value); } }
+    void setScript(const QString& script) { if (_particle) { _particle->setScript(script); } }
+    void setLifetime(float value) const { if (_particle) { _particle->setLifetime(value); } }
+    void setProperties(const ParticleProperties& properties) { if (_particle) { _particle->setProperties(properties); } }
 
 signals:
     void update();
@@ -0,0 +1,70 @@
+//
+//  ParticleScriptContexts.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <QtCore/QCache>
+#include <QtCore/QThreadStorage>
+
+// see the note in Particle.cpp, we only need script-engine's headers here, linking it would be circular
+#include "../../script-engine/src/ScriptEngine.h"
+
+#include "ParticleScriptContexts.h"
+
+QAtomicInt ParticleScriptContexts::_scriptEvaluations;
+QAtomicInt ParticleScriptContexts::_contextHits;
+
+// a script engine belongs to the thread that made it, so each thread keeps contexts of its own
+static QThreadStorage<QCache<QString, ParticleScriptContext>*> threadContexts;
+
+ParticleScriptContext::ParticleScriptContext(const QString& script) :
+    _engine(new ScriptEngine(script)),
+    _particleScriptable(NULL),
+    _isEvaluated(false)
+{
+    _engine->registerGlobalObject("Particle", &_particleScriptable);
+}
+
+ParticleScriptContext::~ParticleScriptContext() {
+    delete _engine;
+}
+
+ParticleScriptObject& ParticleScriptContext::start(Particle* particle) {
+    _particleScriptable.setParticle(particle);
+
+    // the script connects its handlers to the signals of the "Particle" object when it is evaluated, so we only do that once
+    if (!_isEvaluated) {
+        _isEvaluated = true;
+        _engine->evaluate();
+        ParticleScriptContexts::_scriptEvaluations.ref();
+    }
+    return _particleScriptable;
+}
+
+void ParticleScriptContext::end() {
+    // the engine outlives this call, a timer the script set up for this particle must not fire once it's gone
+    _engine->stopAllTimers();
+    _particleScriptable.setParticle(NULL);
+}
+
+ParticleScriptContext* ParticleScriptContexts::contextForScript(const QString& script) {
+    if (!threadContexts.hasLocalData()) {
+        threadContexts.setLocalData(new QCache<QString, ParticleScriptContext>(MAX_PARTICLE_SCRIPT_CONTEXTS_PER_THREAD));
+    }
+    QCache<QString, ParticleScriptContext>* contexts = threadContexts.localData();
+
+    ParticleScriptContext* context = contexts->object(script);
+    if (context) {
+        _contextHits.ref();
+        return context;
+    }
+
+    context = new ParticleScriptContext(script);
+
+    // each context costs one, so that the cache holds up to MAX_PARTICLE_SCRIPT_CONTEXTS_PER_THREAD of them
+    contexts->insert(script, context);
+    return context;
+}
@@ -0,0 +1,69 @@
+//
+//  ParticleScriptContexts.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Per thread pool of script engines that have already evaluated a particle script
+//
+
+#ifndef __hifi__ParticleScriptContexts__
+#define __hifi__ParticleScriptContexts__
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QString>
+
+#include "Particle.h"
+
+class ScriptEngine;
+
+/// the most particle scripts each thread keeps an evaluated engine for, the least recently run one goes first
+const int MAX_PARTICLE_SCRIPT_CONTEXTS_PER_THREAD = 64;
+
+/// A script engine that has evaluated one particle script, with the "Particle" object the script connected its handlers
+/// to. Running the script for a particle is then only a matter of pointing that object at the particle and emitting.
+///
+/// The engine is shared by every particle on the thread that runs the same script text, so the script's global variables
+/// are too: its top level code runs once, for the first particle, and what it keeps in globals carries over from one
+/// particle's call to the next.
+class ParticleScriptContext {
+public:
+    ParticleScriptContext(const QString& script);
+    ~ParticleScriptContext();
+
+    ScriptEngine& getEngine() { return *_engine; }
+
+    /// points the "Particle" object at the particle the script is run for, and evaluates the script with it the first
+    /// time, so that top level code that uses the object has a particle to use
+    ParticleScriptObject& start(Particle* particle);
+
+    /// stops the timers the script set up and points the "Particle" object at no particle, so that nothing the script
+    /// kept can reach the particle after the call
+    void end();
+
+private:
+    ScriptEngine* _engine;
+    ParticleScriptObject _particleScriptable;
+    bool _isEvaluated;
+};
+
+/// Keeps the contexts of the particle scripts run on each thread, keyed by their script text, so that a scripted particle
+/// update or collision doesn't build a new engine and parse its script every time.
+class ParticleScriptContexts {
+public:
+    /// returns the context of a script on the calling thread, which evaluates the script when it is first started
+    static ParticleScriptContext* contextForScript(const QString& script);
+
+    /// how many times a particle script was evaluated, and how many times an evaluated one was found for a call
+    static int getScriptEvaluations() { return _scriptEvaluations.load(); }
+    static int getContextHits() { return _contextHits.load(); }
+
+private:
+    friend class ParticleScriptContext;
+
+    static QAtomicInt _scriptEvaluations;
+    static QAtomicInt _contextHits;
+};
+
+#endif /* defined(__hifi__ParticleScriptContexts__) */
@@ -12,6 +12,12 @@ ParticleTree::ParticleTree(bool shouldReaverage) : Octree(shouldReaverage) {
     _rootNode = createNewElement();
 }
 
+ParticleTree::~ParticleTree() {
+    // the elements forget their particles as they are deleted, so they have to go before the index does
+    delete _rootNode;
+    _rootNode = NULL;
+}
+
 ParticleTreeElement* ParticleTree::createNewElement(unsigned char * octalCode) {
     ParticleTreeElement* newElement = new ParticleTreeElement(octalCode);
     newElement->setTree(this);
@@ -29,73 +35,34 @@ bool ParticleTree::handlesEditPacketType(PacketType packetType) const {
     }
 }
 
-class FindAndDeleteParticlesArgs {
-public:
-    QList<uint32_t> _idsToDelete;
-};
-
-bool ParticleTree::findAndDeleteOperation(OctreeElement* element, void* extraData) {
-    //qDebug() << "findAndDeleteOperation()";
-
-    FindAndDeleteParticlesArgs* args = static_cast< FindAndDeleteParticlesArgs*>(extraData);
-
-    // if we've found and deleted all our target particles, then we can stop looking
-    if (args->_idsToDelete.size() <= 0) {
-        return false;
-    }
-
-    ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
-
-    //qDebug() << "findAndDeleteOperation() args->_idsToDelete.size():" << args->_idsToDelete.size();
-
-    for (QList<uint32_t>::iterator it = args->_idsToDelete.begin(); it != args->_idsToDelete.end(); it++) {
-        uint32_t particleID = *it;
-        //qDebug() << "findAndDeleteOperation() particleID:" << particleID;
-
-        if (particleTreeElement->removeParticleWithID(particleID)) {
-            // if the particle was in this element, then remove it from our search list.
-            //qDebug() << "findAndDeleteOperation() it = args->_idsToDelete.erase(it)";
-            it = args->_idsToDelete.erase(it);
-        }
-
-        if (it == args->_idsToDelete.end()) {
-            //qDebug() << "findAndDeleteOperation() breaking";
-            break;
-        }
+void ParticleTree::setContainingElement(uint32_t particleID, ParticleTreeElement* element) {
+    // particles that are still waiting on their ID from the server are only found by their creator token
+    if (particleID != UNKNOWN_PARTICLE_ID) {
+        _particleElements.insert(particleID, element);
     }
+}
 
-    // if we've found and deleted all our target particles, then we can stop looking
-    if (args->_idsToDelete.size() <= 0) {
-        return false;
+void ParticleTree::forgetContainingElement(uint32_t particleID, ParticleTreeElement* element) {
+    QHash<uint32_t, ParticleTreeElement*>::iterator indexed = _particleElements.find(particleID);
+    if (indexed != _particleElements.end() && indexed.value() == element) {
+        _particleElements.erase(indexed);
     }
-    return true;
 }
 
-
-class FindAndUpdateParticleArgs {
-public:
-    const Particle& searchParticle;
-    bool found;
-};
-
-bool ParticleTree::findAndUpdateOperation(OctreeElement* element, void* extraData) {
-    FindAndUpdateParticleArgs* args = static_cast<FindAndUpdateParticleArgs*>(extraData);
-    ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
-    // Note: updateParticle() will only operate on correctly found particles
-    if (particleTreeElement->updateParticle(args->searchParticle)) {
-        args->found = true;
-        return false; // stop searching
-    }
-    return true;
+bool ParticleTree::removeParticle(uint32_t particleID) {
+    ParticleTreeElement* element = getContainingElement(particleID);
+    return element && element->removeParticleWithID(particleID);
 }
 
 void ParticleTree::storeParticle(const Particle& particle, const SharedNodePointer& senderNode) {
     // First, look for the existing particle in the tree..
-    FindAndUpdateParticleArgs args = { particle, false };
-    recurseTreeWithOperation(findAndUpdateOperation, &args);
+    ParticleTreeElement* containingElement = getContainingElement(particle.getID());
+
+    // Note: updateParticle() will only operate on correctly found particles
+    bool found = containingElement && containingElement->updateParticle(particle);
 
     // if we didn't find it in the tree, then store it...
-    if (!args.found) {
+    if (!found) {
         glm::vec3 position = particle.getPosition();
         float size = std::max(MINIMUM_PARTICLE_ELEMENT_SIZE, particle.getRadius());
 
@@ -131,9 +98,14 @@ bool ParticleTree::findAndUpdateWithIDandPropertiesOperation(OctreeElement* elem
 }
 
 void ParticleTree::updateParticle(const ParticleID& particleID, const ParticleProperties& properties) {
-    // First, look for the existing particle in the tree..
+    // First, look for the existing particle in the tree.. only those without a known ID need a search
     FindAndUpdateParticleWithIDandPropertiesArgs args = { particleID, properties, false };
-    recurseTreeWithOperation(findAndUpdateWithIDandPropertiesOperation, &args);
+    if (particleID.isKnownID) {
+        ParticleTreeElement* element = getContainingElement(particleID.id);
+        args.found = element && element->updateParticle(particleID, properties);
+    } else {
+        recurseTreeWithOperation(findAndUpdateWithIDandPropertiesOperation, &args);
+    }
     // if we found it in the tree, then mark the tree as dirty
     if (args.found) {
         _isDirty = true;
@@ -157,9 +129,7 @@ void ParticleTree::addParticle(const ParticleID& particleID, const ParticlePrope
 
 void ParticleTree::deleteParticle(const ParticleID& particleID) {
     if (particleID.isKnownID) {
-        FindAndDeleteParticlesArgs args;
-        args._idsToDelete.push_back(particleID.id);
-        recurseTreeWithOperation(findAndDeleteOperation, &args);
+        removeParticle(particleID.id);
     }
 }
 
@@ -337,49 +307,16 @@ void ParticleTree::findParticlesForUpdate(const AABox& box, QVector<Particle*> f
     foundParticles.swap(args._foundParticles);
 }
 
-class FindByIDArgs {
-public:
-    uint32_t id;
-    bool found;
-    const Particle* foundParticle;
-};
-
-
-bool ParticleTree::findByIDOperation(OctreeElement* element, void* extraData) {
-//qDebug() << "ParticleTree::findByIDOperation()....";
-
-    FindByIDArgs* args = static_cast<FindByIDArgs*>(extraData);
-    ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
-
-    // if already found, stop looking
-    if (args->found) {
-        return false;
-    }
-
-    // as the tree element if it has this particle
-    const Particle* foundParticle = particleTreeElement->getParticleWithID(args->id);
-    if (foundParticle) {
-        args->foundParticle = foundParticle;
-        args->found = true;
-        return false;
-    }
-
-    // keep looking
-    return true;
-}
-
-
 const Particle* ParticleTree::findParticleByID(uint32_t id, bool alreadyLocked) {
-    FindByIDArgs args = { id, false, NULL };
-
     if (!alreadyLocked) {
         lockForRead();
     }
-    recurseTreeWithOperation(findByIDOperation, &args);
+    ParticleTreeElement* element = getContainingElement(id);
+    const Particle* foundParticle = element ? element->getParticleWithID(id) : NULL;
     if (!alreadyLocked) {
         unlock();
     }
-    return args.foundParticle;
+    return foundParticle;
 }
 
 
@@ -446,6 +383,35 @@ bool ParticleTree::updateOperation(OctreeElement* element, void* extraData) {
     return true;
 }
 
+// Updates the elements on several threads at once, leaving those with scripted particles to be updated afterwards on the
+// thread that owns the tree, as that is where the scripts' engines run
+class ConcurrentUpdateOperation : public OctreeConcurrentOperation {
+public:
+    virtual bool visit(OctreeElement* element) {
+        ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
+        if (particleTreeElement->hasParticleScripts()) {
+            _scriptedElements.append(particleTreeElement);
+        } else {
+            particleTreeElement->update(_args);
+        }
+        return true;
+    }
+    virtual OctreeConcurrentOperation* clone() const { return new ConcurrentUpdateOperation(); }
+    virtual void merge(const OctreeConcurrentOperation* copy) {
+        const ConcurrentUpdateOperation* other = static_cast<const ConcurrentUpdateOperation*>(copy);
+        _args._movingParticles += other->_args._movingParticles;
+        _args._movingParticleElements += other->_args._movingParticleElements;
+        _scriptedElements += other->_scriptedElements;
+    }
+
+    ParticleTreeUpdateArgs& getArgs() { return _args; }
+    const QVector<ParticleTreeElement*>& getScriptedElements() const { return _scriptedElements; }
+
+private:
+    ParticleTreeUpdateArgs _args;
+    QVector<ParticleTreeElement*> _scriptedElements;
+};
+
 bool ParticleTree::pruneOperation(OctreeElement* element, void* extraData) {
     ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
     for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
@@ -461,11 +427,24 @@ void ParticleTree::update() {
     lockForWrite();
     _isDirty = true;
 
+    // update hooks, like those of a VoxelSystem, expect to hear about elements on the thread that owns the tree
     ParticleTreeUpdateArgs args = { };
-    recurseTreeWithOperation(updateOperation, &args);
+    if (OctreeElement::hasUpdateHooks()) {
+        recurseTreeWithOperation(updateOperation, &args);
+    } else {
+        ConcurrentUpdateOperation concurrentUpdate;
+        recurseTreeWithConcurrentOperation(concurrentUpdate);
+        args = concurrentUpdate.getArgs();
+        foreach (ParticleTreeElement* scriptedElement, concurrentUpdate.getScriptedElements()) {
+            scriptedElement->update(args);
+        }
+    }
 
     // now add back any of the particles that moved elements....
     int movingParticles = args._movingParticles.size();
+    for (int i = 0; i < movingParticles; i++) {
+        forgetContainingElement(args._movingParticles[i].getID(), args._movingParticleElements[i]);
+    }
     for (int i = 0; i < movingParticles; i++) {
         bool shouldDie = args._movingParticles[i].getShouldDie();
 
@@ -611,23 +590,16 @@ void ParticleTree::processEraseMessage(const QByteArray& dataByteArray, const Sh
     dataAt += sizeof(numberOfIds);
     processedBytes += sizeof(numberOfIds);
 
-    if (numberOfIds > 0) {
-        FindAndDeleteParticlesArgs args;
-
-        for (size_t i = 0; i < numberOfIds; i++) {
-            if (processedBytes + sizeof(uint32_t) > packetLength) {
-                break; // bail to prevent buffer overflow
-            }
-
-            uint32_t particleID = 0; // placeholder for now
-            memcpy(&particleID, dataAt, sizeof(particleID));
-            dataAt += sizeof(particleID);
-            processedBytes += sizeof(particleID);
-
-            args._idsToDelete.push_back(particleID);
+    for (size_t i = 0; i < numberOfIds; i++) {
+        if (processedBytes + sizeof(uint32_t) > packetLength) {
+            break; // bail to prevent buffer overflow
         }
 
-        // calling recurse to actually delete the particles
-        recurseTreeWithOperation(findAndDeleteOperation, &args);
+        uint32_t particleID = 0; // placeholder for now
+        memcpy(&particleID, dataAt, sizeof(particleID));
+        dataAt += sizeof(particleID);
+        processedBytes += sizeof(particleID);
+
+        removeParticle(particleID);
     }
 }
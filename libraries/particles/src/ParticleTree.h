@@ -9,6 +9,8 @@
 #ifndef __hifi__ParticleTree__
 #define __hifi__ParticleTree__
 
+#include <QtCore/QHash>
+
 #include <Octree.h>
 #include "ParticleTreeElement.h"
 
@@ -21,6 +23,7 @@ class ParticleTree : public Octree {
     Q_OBJECT
 public:
     ParticleTree(bool shouldReaverage = false);
+    virtual ~ParticleTree();
 
     /// Implements our type specific root element factory
     virtual ParticleTreeElement* createNewElement(unsigned char * octalCode = NULL);
@@ -70,20 +73,32 @@ public:
     void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
     void handleAddParticleResponse(const QByteArray& packet);
 
+    /// the element that holds the particle with a known ID, or NULL if the tree doesn't have it
+    ParticleTreeElement* getContainingElement(uint32_t particleID) const { return _particleElements.value(particleID); }
+
+    /// called by the elements as they take in a particle, or as a particle they hold learns its ID
+    void setContainingElement(uint32_t particleID, ParticleTreeElement* element);
+
+    /// called by the elements as a particle leaves them, only forgets the particle if it is still indexed to that element
+    void forgetContainingElement(uint32_t particleID, ParticleTreeElement* element);
+
 private:
 
     static bool updateOperation(OctreeElement* element, void* extraData);
-    static bool findAndUpdateOperation(OctreeElement* element, void* extraData);
     static bool findAndUpdateWithIDandPropertiesOperation(OctreeElement* element, void* extraData);
     static bool findNearPointOperation(OctreeElement* element, void* extraData);
     static bool findInSphereOperation(OctreeElement* element, void* extraData);
     static bool pruneOperation(OctreeElement* element, void* extraData);
-    static bool findByIDOperation(OctreeElement* element, void* extraData);
-    static bool findAndDeleteOperation(OctreeElement* element, void* extraData);
     static bool findAndUpdateParticleIDOperation(OctreeElement* element, void* extraData);
 
     void notifyNewlyCreatedParticle(const Particle& newParticle, const SharedNodePointer& senderNode);
 
+    /// removes a particle with a known ID from the element that holds it
+    bool removeParticle(uint32_t particleID);
+
+    // every particle with a known ID, indexed to the element that holds it, so that finding one is not a walk of the tree
+    QHash<uint32_t, ParticleTreeElement*> _particleElements;
+
     QReadWriteLock _newlyCreatedHooksLock;
     std::vector<NewlyCreatedParticleHook*> _newlyCreatedHooks;
 
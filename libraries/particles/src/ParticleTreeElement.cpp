@@ -11,12 +11,17 @@
 #include "ParticleTree.h"
 #include "ParticleTreeElement.h"
 
-ParticleTreeElement::ParticleTreeElement(unsigned char* octalCode) : OctreeElement(), _particles(NULL) {
+ParticleTreeElement::ParticleTreeElement(unsigned char* octalCode) : OctreeElement(), _myTree(NULL), _particles(NULL) {
     init(octalCode);
 };
 
 ParticleTreeElement::~ParticleTreeElement() {
     _voxelMemoryUsage -= sizeof(ParticleTreeElement);
+    if (_myTree) {
+        for (int i = 0; i < _particles->size(); i++) {
+            _myTree->forgetContainingElement((*_particles)[i].getID(), this);
+        }
+    }
     delete _particles;
     _particles = NULL;
 }
@@ -75,10 +80,12 @@ void ParticleTreeElement::update(ParticleTreeUpdateArgs& args) {
 
         // If the particle wants to die, or if it's left our bounding box, then move it
         // into the arguments moving particles. These will be added back or deleted completely
-        if (particle.getShouldDie() || !_box.contains(particle.getPosition())) {
+        if (particle.getShouldDie() || !getAABox().contains(particle.getPosition())) {
             args._movingParticles.push_back(particle);
 
-            // erase this particle
+            // erase this particle, the tree forgets it was here once all of the elements are updated, and indexes it again
+            // if it stores it in another element
+            args._movingParticleElements.push_back(this);
             particleItr = _particles->erase(particleItr);
         } else {
             ++particleItr;
@@ -90,6 +97,15 @@ void ParticleTreeElement::update(ParticleTreeUpdateArgs& args) {
     // roaming piles of particles.
 }
 
+bool ParticleTreeElement::hasParticleScripts() const {
+    foreach (const Particle& particle, *_particles) {
+        if (!particle.getScript().isEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool ParticleTreeElement::findSpherePenetration(const glm::vec3& center, float radius,
                                     glm::vec3& penetration, void** penetratedObject) const {
     QList<Particle>::iterator particleItr = _particles->begin();
@@ -199,6 +215,7 @@ void ParticleTreeElement::updateParticleID(FindAndUpdateParticleIDArgs* args) {
             // first, we're looking for matching creatorTokenIDs, if we find that, then we fix it to know the actual ID
             if (thisParticle.getCreatorTokenID() == args->creatorTokenID) {
                 thisParticle.setID(args->particleID);
+                _myTree->setContainingElement(args->particleID, this);
                 args->creatorTokenFound = true;
             }
         }
@@ -206,6 +223,7 @@ void ParticleTreeElement::updateParticleID(FindAndUpdateParticleIDArgs* args) {
         // if we're in an isViewing tree, we also need to look for an kill any viewed particles
         if (!args->viewedParticleFound && args->isViewing) {
             if (thisParticle.getCreatorTokenID() == UNKNOWN_TOKEN && thisParticle.getID() == args->particleID) {
+                _myTree->forgetContainingElement(args->particleID, this);
                 _particles->removeAt(i); // remove the particle at this index
                 numberOfParticles--; // this means we have 1 fewer particle in this list
                 i--; // and we actually want to back up i as well.
@@ -252,7 +270,7 @@ void ParticleTreeElement::getParticlesForUpdate(const AABox& box, QVector<Partic
         // TODO: decide whether to replace particleBox-box query with sphere-box (requires a square root
         // but will be slightly more accurate).
         particleBox.setBox(particle->getPosition() - glm::vec3(radius), 2.f * radius);
-        if (particleBox.touches(_box)) {
+        if (particleBox.touches(getAABox())) {
             foundParticles.push_back(particle);
         }
         ++particleItr;
@@ -278,6 +296,7 @@ bool ParticleTreeElement::removeParticleWithID(uint32_t id) {
     for (uint16_t i = 0; i < numberOfParticles; i++) {
         if ((*_particles)[i].getID() == id) {
             foundParticle = true;
+            _myTree->forgetContainingElement(id, this);
             _particles->removeAt(i);
             break;
         }
@@ -332,6 +351,7 @@ bool ParticleTreeElement::collapseChildren() {
 
 void ParticleTreeElement::storeParticle(const Particle& particle) {
     _particles->push_back(particle);
+    _myTree->setContainingElement(particle.getID(), this);
     markWithChangedTime();
 }
 
@@ -24,6 +24,7 @@ class ParticleTreeElement;
 class ParticleTreeUpdateArgs {
 public:
     QList<Particle> _movingParticles;
+    QList<ParticleTreeElement*> _movingParticleElements; // the element each of the moving particles left
 };
 
 class FindAndUpdateParticleIDArgs {
@@ -93,6 +94,7 @@ public:
     const QList<Particle>& getParticles() const { return *_particles; }
     QList<Particle>& getParticles() { return *_particles; }
     bool hasParticles() const { return _particles->size() > 0; }
+    bool hasParticleScripts() const;
 
     void update(ParticleTreeUpdateArgs& args);
     void setTree(ParticleTree* tree) { _myTree = tree; }
@@ -354,6 +354,9 @@ void ScriptEngine::run() {
                 glm::quat headOrientation = _avatarData->getHeadOrientation();
                 packetStream.writeRawData(reinterpret_cast<const char*>(&headOrientation), sizeof(glm::quat));
 
+                // agents send and receive raw samples
+                packetStream << AudioCodecType::PCM;
+
                 if (silentFrame) {
                     if (!_isListeningToAudioStream) {
                         // if we have a silent frame and we're not listening then just send nothing and break out of here
@@ -468,6 +471,12 @@ void ScriptEngine::stopTimer(QTimer *timer) {
     }
 }
 
+void ScriptEngine::stopAllTimers() {
+    foreach (QTimer* timer, _timerFunctionMap.keys()) {
+        stopTimer(timer);
+    }
+}
+
 QUrl ScriptEngine::resolveInclude(const QString& include) const {
     // first lets check to see if it's already a full URL
     QUrl url(include);
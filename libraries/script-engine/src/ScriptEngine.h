@@ -71,6 +71,9 @@ public:
 
     void timerFired();
 
+    /// stops and deletes the timers the script set up, for an engine that is kept around between evaluations
+    void stopAllTimers();
+
     bool hasScript() const { return !_scriptContents.isEmpty(); }
 
 public slots:
@@ -0,0 +1,254 @@
+//
+//  DatagramBatch.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <errno.h>
+#include <string.h>
+
+#include <QtCore/QDebug>
+#include <QtCore/QThreadStorage>
+
+#include "DatagramBatch.h"
+
+DatagramReader::DatagramReader(QUdpSocket& socket) :
+    _socket(socket),
+    _numDatagrams(0),
+    _nextDatagram(0)
+#ifdef Q_OS_LINUX
+    , _slab(NULL)
+    , _spilledDatagram(-1)
+#endif
+{
+}
+
+DatagramReader::~DatagramReader() {
+#ifdef Q_OS_LINUX
+    delete[] _slab;
+#endif
+}
+
+bool DatagramReader::readDatagram(PacketBuffer& datagram, HifiSockAddr& senderSockAddr) {
+#ifdef Q_OS_LINUX
+    int index;
+    forever {
+        if (_nextDatagram == _numDatagrams && !readBatch()) {
+            return false;
+        }
+        index = _nextDatagram++;
+
+        if ((int)_headers[index].msg_len <= _datagrams[index].size() || index == _spilledDatagram) {
+            break;
+        }
+        // a later datagram of the batch spilled over the end of this one
+        qDebug() << "Dropping a datagram of" << _headers[index].msg_len << "bytes that another large one overwrote";
+    }
+
+    int datagramSize = _headers[index].msg_len;
+    PacketBuffer& received = _datagrams[index];
+    if (datagramSize <= received.size()) {
+        // the buffer is handed out, and the next batch reads into a new one
+        received.resize(datagramSize);
+        datagram = received;
+        received = PacketBuffer();
+
+    } else {
+        // the rest of it is in the slab, so it's put together in a buffer large enough for all of it
+        datagram = PacketBuffer(datagramSize);
+        memcpy(datagram.data(), received.constData(), received.size());
+        memcpy(datagram.data() + received.size(), _slab, datagramSize - received.size());
+    }
+
+    if (_headers[index].msg_hdr.msg_namelen == 0) {
+        senderSockAddr = _socketReadSender;
+    } else {
+        const sockaddr* sender = reinterpret_cast<const sockaddr*>(&_senders[index]);
+        senderSockAddr = HifiSockAddr(QHostAddress(sender), ntohs(sender->sa_family == AF_INET6
+            ? reinterpret_cast<const sockaddr_in6*>(sender)->sin6_port
+            : reinterpret_cast<const sockaddr_in*>(sender)->sin_port));
+    }
+    return true;
+#else
+    if (!_socket.hasPendingDatagrams()) {
+        return false;
+    }
+    datagram = PacketBuffer((int)_socket.pendingDatagramSize());
+    _socket.readDatagram(datagram.data(), datagram.size(), senderSockAddr.getAddressPointer(),
+                         senderSockAddr.getPortPointer());
+    return true;
+#endif
+}
+
+void DatagramReader::clear() {
+    _numDatagrams = 0;
+    _nextDatagram = 0;
+}
+
+bool DatagramReader::readBatch() {
+    _numDatagrams = 0;
+    _nextDatagram = 0;
+
+#ifdef Q_OS_LINUX
+    if (!_slab) {
+        _slab = new char[MAX_DATAGRAM_BYTES];
+    }
+
+    // each datagram is read into a pooled buffer, those handed out by the last batch are replaced and the rest reused
+    for (int i = 0; i < DATAGRAM_BATCH_SIZE; i++) {
+        _datagrams[i].resize(PacketBuffer::getMaxPooledSize());
+        _buffers[i][0].iov_base = _datagrams[i].data();
+        _buffers[i][0].iov_len = _datagrams[i].size();
+        _buffers[i][1].iov_base = _slab;
+        _buffers[i][1].iov_len = MAX_DATAGRAM_BYTES - _datagrams[i].size();
+    }
+
+    // the kernel writes back the lengths of the addresses, so they're reset before every batch
+    memset(_headers, 0, sizeof(_headers));
+    for (int i = 0; i < DATAGRAM_BATCH_SIZE; i++) {
+        _headers[i].msg_hdr.msg_iov = _buffers[i];
+        _headers[i].msg_hdr.msg_iovlen = 2;
+        _headers[i].msg_hdr.msg_name = &_senders[i];
+        _headers[i].msg_hdr.msg_namelen = sizeof(_senders[i]);
+    }
+
+    int numRead;
+    do {
+        numRead = recvmmsg(_socket.socketDescriptor(), _headers, DATAGRAM_BATCH_SIZE, MSG_DONTWAIT, NULL);
+    } while (numRead < 0 && errno == EINTR);
+
+    if (numRead > 0) {
+        _numDatagrams = numRead;
+
+        // datagrams hardly ever spill, and each that does writes over the end of the one before it
+        _spilledDatagram = -1;
+        for (int i = 0; i < numRead; i++) {
+            if ((int)_headers[i].msg_len > _datagrams[i].size()) {
+                _spilledDatagram = i;
+            }
+        }
+        return true;
+    }
+
+    // QUdpSocket stops watching the descriptor after it emits readyRead() until readDatagram() is called, so the socket
+    // is read once itself when the batches run dry - which also picks up a datagram that arrived in between. That one is
+    // read into the slab, and copied out of it as though it didn't fit its buffer.
+    qint64 datagramSize = _socket.readDatagram(_slab, MAX_DATAGRAM_BYTES, _socketReadSender.getAddressPointer(),
+                                               _socketReadSender.getPortPointer());
+    if (datagramSize < 0) {
+        return false;
+    }
+    _datagrams[0].resize(0);
+    _headers[0].msg_len = datagramSize;
+    _headers[0].msg_hdr.msg_namelen = 0;
+    _spilledDatagram = 0;
+    _numDatagrams = 1;
+    return true;
+#else
+    return false;
+#endif
+}
+
+static QThreadStorage<DatagramSendBatch*> openSendBatches;
+
+DatagramSendBatch::DatagramSendBatch(QUdpSocket& socket) :
+    _socket(socket),
+    _outerBatch(openSendBatches.localData()),
+    _datagrams(),
+    _destinations(),
+    _numDatagramsSent(0),
+    _numBatchesSent(0)
+{
+    _datagrams.reserve(DATAGRAM_BATCH_SIZE);
+    _destinations.reserve(DATAGRAM_BATCH_SIZE);
+    openSendBatches.setLocalData(this);
+}
+
+DatagramSendBatch::~DatagramSendBatch() {
+    flush();
+    openSendBatches.setLocalData(_outerBatch);
+}
+
+DatagramSendBatch* DatagramSendBatch::getOpenBatch(const QUdpSocket& socket) {
+    for (DatagramSendBatch* batch = openSendBatches.localData(); batch; batch = batch->_outerBatch) {
+        if (&batch->_socket == &socket) {
+            return batch;
+        }
+    }
+    return NULL;
+}
+
+void DatagramSendBatch::writeDatagram(const PacketBuffer& datagram, const HifiSockAddr& destinationSockAddr) {
+    _datagrams.append(datagram);
+    _destinations.append(destinationSockAddr);
+
+    if (_datagrams.size() == DATAGRAM_BATCH_SIZE) {
+        flush();
+    }
+}
+
+void DatagramSendBatch::flush() {
+    if (_datagrams.isEmpty()) {
+        return;
+    }
+
+#ifdef Q_OS_LINUX
+    mmsghdr headers[DATAGRAM_BATCH_SIZE];
+    iovec buffers[DATAGRAM_BATCH_SIZE];
+    sockaddr_in destinations[DATAGRAM_BATCH_SIZE];
+    memset(headers, 0, sizeof(headers));
+    memset(destinations, 0, sizeof(destinations));
+
+    int numDatagrams = 0;
+    for (int i = 0; i < _datagrams.size(); i++) {
+        if (_destinations.at(i).getAddress().protocol() != QAbstractSocket::IPv4Protocol) {
+            // the node socket is IPv4, anything else is left for the socket to sort out
+            _socket.writeDatagram(_datagrams.at(i).constData(), _datagrams.at(i).size(), _destinations.at(i).getAddress(),
+                                  _destinations.at(i).getPort());
+            continue;
+        }
+        buffers[numDatagrams].iov_base = const_cast<char*>(_datagrams.at(i).constData());
+        buffers[numDatagrams].iov_len = _datagrams.at(i).size();
+
+        destinations[numDatagrams].sin_family = AF_INET;
+        destinations[numDatagrams].sin_addr.s_addr = htonl(_destinations.at(i).getAddress().toIPv4Address());
+        destinations[numDatagrams].sin_port = htons(_destinations.at(i).getPort());
+
+        headers[numDatagrams].msg_hdr.msg_iov = &buffers[numDatagrams];
+        headers[numDatagrams].msg_hdr.msg_iovlen = 1;
+        headers[numDatagrams].msg_hdr.msg_name = &destinations[numDatagrams];
+        headers[numDatagrams].msg_hdr.msg_namelen = sizeof(destinations[numDatagrams]);
+        numDatagrams++;
+    }
+
+    // a datagram that can't be sent is dropped, the same as when QUdpSocket::writeDatagram() fails
+    for (int numSent = 0; numSent < numDatagrams; ) {
+        int numWritten = sendmmsg(_socket.socketDescriptor(), headers + numSent, numDatagrams - numSent, 0);
+        if (numWritten > 0) {
+            numSent += numWritten;
+        } else if (numWritten == 0) {
+            // nothing was sent and there is no error to go by, so the next datagram is given up on like a failed one
+            qDebug() << "ERROR in sendmmsg: no datagrams sent";
+            numSent++;
+        } else if (errno != EINTR) {
+            qDebug() << "ERROR in sendmmsg:" << strerror(errno);
+            numSent++;
+        }
+    }
+#else
+    for (int i = 0; i < _datagrams.size(); i++) {
+        if (_socket.writeDatagram(_datagrams.at(i).constData(), _datagrams.at(i).size(), _destinations.at(i).getAddress(),
+                                  _destinations.at(i).getPort()) < 0) {
+            qDebug() << "ERROR in writeDatagram:" << _socket.error() << "-" << _socket.errorString();
+        }
+    }
+#endif
+
+    _numDatagramsSent += _datagrams.size();
+    _numBatchesSent++;
+
+    _datagrams.resize(0);
+    _destinations.resize(0);
+}
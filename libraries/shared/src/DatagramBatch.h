@@ -0,0 +1,116 @@
+//
+//  DatagramBatch.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+//  Reads and writes the datagrams of a QUdpSocket a batch at a time. On Linux each batch is a single recvmmsg() or
+//  sendmmsg() on the socket's descriptor, elsewhere the datagrams go through the QUdpSocket one by one.
+//
+
+#ifndef __hifi__DatagramBatch__
+#define __hifi__DatagramBatch__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+#include <QtNetwork/QUdpSocket>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#include "HifiSockAddr.h"
+#include "PacketBuffer.h"
+
+const int DATAGRAM_BATCH_SIZE = 32;
+
+// large enough for any UDP datagram, so none are ever cut short
+const int MAX_DATAGRAM_BYTES = 65536;
+
+/// Hands out the datagrams waiting on a socket one at a time, reading as many as DATAGRAM_BATCH_SIZE of them at once.
+/// Each is read straight into a pooled PacketBuffer that is handed out as it is, only the rare datagram too large for
+/// one spills into a slab that is kept for the next batch and is copied out of it. There is one slab, large enough for
+/// any datagram, that all of the batch spills into, so if more than one datagram of a batch is too large for its buffer,
+/// only the last of them is handed out.
+///
+/// Only the thread the socket belongs to may read, and the socket must not be read from any other way while the reader
+/// still has datagrams from it.
+class DatagramReader {
+public:
+    DatagramReader(QUdpSocket& socket);
+    ~DatagramReader();
+
+    /// \return false once there are no more datagrams waiting
+    bool readDatagram(PacketBuffer& datagram, HifiSockAddr& senderSockAddr);
+
+    /// forgets the datagrams that were read from the socket but not handed out yet
+    void clear();
+
+private:
+    DatagramReader(const DatagramReader&); // not copyable
+    void operator=(const DatagramReader&);
+
+    bool readBatch();
+
+    QUdpSocket& _socket;
+    int _numDatagrams;
+    int _nextDatagram;
+
+#ifdef Q_OS_LINUX
+    char* _slab;
+    int _spilledDatagram; // the datagram of the batch whose end is in the slab, or -1
+    PacketBuffer _datagrams[DATAGRAM_BATCH_SIZE];
+    mmsghdr _headers[DATAGRAM_BATCH_SIZE];
+    iovec _buffers[DATAGRAM_BATCH_SIZE][2]; // the datagram's buffer, then the slab
+    sockaddr_storage _senders[DATAGRAM_BATCH_SIZE];
+    HifiSockAddr _socketReadSender;
+#endif
+};
+
+/// Holds the datagrams written to a socket from one thread until there are DATAGRAM_BATCH_SIZE of them, it is flushed or
+/// it goes out of scope, then sends them all at once. While a batch is open, NodeList::writeDatagram() adds to it
+/// instead of sending right away, so a burst of sends only has to be wrapped in one:
+///
+///     DatagramSendBatch sendBatch(nodeList->getNodeSocket());
+///     foreach (const SharedNodePointer& node, listeners) {
+///         nodeList->writeDatagram(packet, node);
+///     }
+///
+/// Batches can be nested, the innermost one is the one that is added to.
+class DatagramSendBatch {
+public:
+    DatagramSendBatch(QUdpSocket& socket);
+    ~DatagramSendBatch();
+
+    /// \return the innermost batch open on this thread for the socket, or NULL if there is none
+    static DatagramSendBatch* getOpenBatch(const QUdpSocket& socket);
+
+    QUdpSocket& getSocket() const { return _socket; }
+
+    /// queues a datagram, sending the batch if it is full
+    void writeDatagram(const PacketBuffer& datagram, const HifiSockAddr& destinationSockAddr);
+    void writeDatagram(const QByteArray& datagram, const HifiSockAddr& destinationSockAddr)
+        { writeDatagram(PacketBuffer(datagram), destinationSockAddr); }
+
+    /// sends the queued datagrams
+    void flush();
+
+    int getNumDatagramsSent() const { return _numDatagramsSent; }
+    int getNumBatchesSent() const { return _numBatchesSent; }
+
+private:
+    DatagramSendBatch(const DatagramSendBatch&); // not copyable
+    void operator=(const DatagramSendBatch&);
+
+    QUdpSocket& _socket;
+    DatagramSendBatch* _outerBatch;
+
+    QVector<PacketBuffer> _datagrams;
+    QVector<HifiSockAddr> _destinations;
+    int _numDatagramsSent;
+    int _numBatchesSent;
+};
+
+#endif /* defined(__hifi__DatagramBatch__) */
@@ -0,0 +1,171 @@
+//
+//  DomainListDelta.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+
+#include <QtCore/QHash>
+#include <QtCore/QtEndian>
+
+#include "PacketHeaders.h"
+#include "SharedUtil.h"
+
+#include "DomainListDelta.h"
+
+QDataStream& operator<<(QDataStream& out, const DomainListHeader& header) {
+    out << header.sessionUUID << header.version << header.baseVersion << header.packetIndex << header.packetCount;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, DomainListHeader& header) {
+    in >> header.sessionUUID >> header.version >> header.baseVersion >> header.packetIndex >> header.packetCount;
+    return in;
+}
+
+// versions wrap around, but never onto NO_DOMAIN_LIST_VERSION
+static quint32 versionAfter(quint32 version) {
+    return version + 1 == NO_DOMAIN_LIST_VERSION ? version + 2 : version + 1;
+}
+
+DomainListChangeLog::DomainListChangeLog(int maxChanges) :
+    _changes(maxChanges),
+    _newestChange(maxChanges - 1),
+    _numChanges(0),
+    _version(versionAfter(QUuid::createUuid().data1)) // any random number will do
+{
+}
+
+void DomainListChangeLog::nodeUpdated(const QUuid& nodeUUID, NodeType_t nodeType) {
+    logChange(nodeUUID, nodeType, false);
+}
+
+void DomainListChangeLog::nodeRemoved(const QUuid& nodeUUID, NodeType_t nodeType) {
+    logChange(nodeUUID, nodeType, true);
+}
+
+void DomainListChangeLog::logChange(const QUuid& nodeUUID, NodeType_t nodeType, bool isRemoval) {
+    _newestChange = (_newestChange + 1) % _changes.size();
+    Change& change = _changes[_newestChange];
+    change.nodeUUID = nodeUUID;
+    change.nodeType = nodeType;
+    change.isRemoval = isRemoval;
+
+    _numChanges = std::min(_numChanges + 1, _changes.size());
+    _version = versionAfter(_version);
+}
+
+bool DomainListChangeLog::getChangesSince(quint32 version, const QSet<NodeType_t>& nodeTypes, QList<QUuid>& updatedNodes,
+                                          QList<QUuid>& removedNodes) const {
+    // there's a change for each version, so the ones since a version are the last few
+    quint32 numChangesSince = _version - version;
+    if (version > _version) {
+        // the versions wrapped around since, past the one that was skipped
+        numChangesSince--;
+    }
+    if (version == NO_DOMAIN_LIST_VERSION || numChangesSince > (quint32)_numChanges) {
+        return false;
+    }
+
+    // only the last change to a node matters, it's either in the list now or it isn't
+    QHash<QUuid, bool> lastChanges;
+    for (int i = numChangesSince - 1; i >= 0; i--) {
+        const Change& change = _changes.at((_newestChange - i + _changes.size()) % _changes.size());
+        if (nodeTypes.contains(change.nodeType)) {
+            lastChanges.insert(change.nodeUUID, change.isRemoval);
+        }
+    }
+    for (QHash<QUuid, bool>::const_iterator lastChange = lastChanges.constBegin(); lastChange != lastChanges.constEnd();
+            ++lastChange) {
+        if (lastChange.value()) {
+            removedNodes.append(lastChange.key());
+        } else {
+            updatedNodes.append(lastChange.key());
+        }
+    }
+    return true;
+}
+
+DomainListWriter::DomainListWriter(const QUuid& sessionUUID, quint32 version, quint32 baseVersion) :
+    _packetHeader(byteArrayWithPopulatedHeader(PacketTypeDomainList))
+{
+    _header.sessionUUID = sessionUUID;
+    _header.version = version;
+    _header.baseVersion = baseVersion;
+    _header.packetIndex = 0;
+    _header.packetCount = 0;
+}
+
+void DomainListWriter::appendUpdatedNode(const Node& node, const QUuid& connectionSecret) {
+    QByteArray entry;
+    QDataStream entryStream(&entry, QIODevice::Append);
+    entryStream << (quint8)DomainListNodeUpdated << node << connectionSecret;
+    appendEntry(entry);
+}
+
+void DomainListWriter::appendRemovedNode(const QUuid& nodeUUID) {
+    QByteArray entry;
+    QDataStream entryStream(&entry, QIODevice::Append);
+    entryStream << (quint8)DomainListNodeRemoved << nodeUUID;
+    appendEntry(entry);
+}
+
+void DomainListWriter::appendEntry(const QByteArray& entry) {
+    if (_packets.isEmpty() || _packets.last().size() + entry.size() > MAX_PACKET_SIZE) {
+        _header.packetIndex = _packets.size();
+
+        QByteArray packet = _packetHeader;
+        QDataStream packetStream(&packet, QIODevice::Append);
+        packetStream << _header;
+        _packets.append(packet);
+    }
+    _packets.last().append(entry);
+}
+
+const QList<QByteArray>& DomainListWriter::finish() {
+    if (_packets.isEmpty()) {
+        appendEntry(QByteArray());
+    }
+
+    // now that it's known, the packet count goes at the end of each header
+    int packetCountOffset = _packetHeader.size() + DOMAIN_LIST_HEADER_BYTES - sizeof(quint16);
+    for (int i = 0; i < _packets.size(); i++) {
+        qToBigEndian<quint16>(_packets.size(), reinterpret_cast<uchar*>(_packets[i].data()) + packetCountOffset);
+    }
+    return _packets;
+}
+
+DomainListVersionTracker::DomainListVersionTracker() :
+    _acknowledgedVersion(NO_DOMAIN_LIST_VERSION),
+    _pendingVersion(NO_DOMAIN_LIST_VERSION),
+    _pendingBaseVersion(NO_DOMAIN_LIST_VERSION),
+    _pendingPackets()
+{
+}
+
+void DomainListVersionTracker::packetReceived(const DomainListHeader& header) {
+    if (header.version != _pendingVersion || header.baseVersion != _pendingBaseVersion) {
+        _pendingVersion = header.version;
+        _pendingBaseVersion = header.baseVersion;
+        _pendingPackets.clear();
+    }
+    _pendingPackets.insert(header.packetIndex);
+
+    if (_pendingPackets.size() >= header.packetCount) {
+        // changes taken against another version leave us with a mix of the two, which the next check-in sorts out
+        if (header.baseVersion == NO_DOMAIN_LIST_VERSION || header.baseVersion == _acknowledgedVersion) {
+            _acknowledgedVersion = header.version;
+        }
+        _pendingPackets.clear();
+    }
+}
+
+void DomainListVersionTracker::reset() {
+    _acknowledgedVersion = NO_DOMAIN_LIST_VERSION;
+    _pendingVersion = NO_DOMAIN_LIST_VERSION;
+    _pendingBaseVersion = NO_DOMAIN_LIST_VERSION;
+    _pendingPackets.clear();
+}
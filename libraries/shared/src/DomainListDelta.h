@@ -0,0 +1,127 @@
+//
+//  DomainListDelta.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+//  The domain-server numbers every change to its node list and answers a check-in with only the nodes that were added,
+//  moved or removed since the version of the list the node acknowledged in it. It keeps the last
+//  DOMAIN_LIST_CHANGE_LOG_SIZE changes, and a node that is further behind than that, or has no list yet, is sent all of it.
+
+#ifndef __hifi__DomainListDelta__
+#define __hifi__DomainListDelta__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QUuid>
+#include <QtCore/QVector>
+
+#include "Node.h"
+#include "UUID.h"
+
+const quint32 NO_DOMAIN_LIST_VERSION = 0;
+
+const int DOMAIN_LIST_CHANGE_LOG_SIZE = 4096;
+
+/// A PacketTypeDomainList packet is the session UUID of the node it is sent to, the version of the list, the version the
+/// entries were taken against (NO_DOMAIN_LIST_VERSION when it is the whole list), the index of the packet and the number
+/// of packets the list was split into, then an entry per node. An entry is a DomainListEntryType followed by the node
+/// and the connection secret for it, or by just the UUID of a removed node.
+const int DOMAIN_LIST_HEADER_BYTES = NUM_BYTES_RFC4122_UUID + sizeof(quint32) + sizeof(quint32) + sizeof(quint16)
+    + sizeof(quint16);
+
+enum DomainListEntryType {
+    DomainListNodeRemoved = 0,
+    DomainListNodeUpdated = 1
+};
+
+class DomainListHeader {
+public:
+    QUuid sessionUUID;
+    quint32 version;
+    quint32 baseVersion;
+    quint16 packetIndex;
+    quint16 packetCount;
+};
+
+QDataStream& operator<<(QDataStream& out, const DomainListHeader& header);
+QDataStream& operator>>(QDataStream& in, DomainListHeader& header);
+
+/// The domain-server's numbered changes to its node list.
+class DomainListChangeLog {
+public:
+    DomainListChangeLog(int maxChanges = DOMAIN_LIST_CHANGE_LOG_SIZE);
+
+    /// the version of the list with every change logged so far, which starts out random so that the nodes of an earlier
+    /// domain-server can't be mistaken for being up to date
+    quint32 getVersion() const { return _version; }
+
+    /// logs a node that was added, or whose sockets changed
+    void nodeUpdated(const QUuid& nodeUUID, NodeType_t nodeType);
+    void nodeRemoved(const QUuid& nodeUUID, NodeType_t nodeType);
+
+    /// finds the nodes of the given types that changed after a version, by their last change
+    /// \return false if the log doesn't go back that far, in which case the whole list has to be sent
+    bool getChangesSince(quint32 version, const QSet<NodeType_t>& nodeTypes, QList<QUuid>& updatedNodes,
+                         QList<QUuid>& removedNodes) const;
+
+private:
+    struct Change {
+        QUuid nodeUUID;
+        NodeType_t nodeType;
+        bool isRemoval;
+    };
+
+    void logChange(const QUuid& nodeUUID, NodeType_t nodeType, bool isRemoval);
+
+    QVector<Change> _changes; // a ring of the last changes, the newest of them for _version
+    int _newestChange;
+    int _numChanges;
+    quint32 _version;
+};
+
+/// Splits the entries of a domain list into as many PacketTypeDomainList packets as they need.
+class DomainListWriter {
+public:
+    DomainListWriter(const QUuid& sessionUUID, quint32 version, quint32 baseVersion);
+
+    void appendUpdatedNode(const Node& node, const QUuid& connectionSecret);
+    void appendRemovedNode(const QUuid& nodeUUID);
+
+    /// \return the numbered packets, at least one even if there are no entries
+    const QList<QByteArray>& finish();
+
+private:
+    void appendEntry(const QByteArray& entry);
+
+    DomainListHeader _header;
+    QByteArray _packetHeader;
+    QList<QByteArray> _packets;
+};
+
+/// Follows the packets of the domain lists a node is sent, to know which version of the list it has all of.
+class DomainListVersionTracker {
+public:
+    DomainListVersionTracker();
+
+    /// the version to acknowledge in the next check-in
+    quint32 getAcknowledgedVersion() const { return _acknowledgedVersion; }
+
+    /// a packet was read, once all of the packets of a list are in its version is acknowledged, as long as it was taken
+    /// against the version the node already had
+    void packetReceived(const DomainListHeader& header);
+
+    /// forgets the list, after nodes were removed from it other than by the domain-server, so the next one is sent whole
+    void reset();
+
+private:
+    quint32 _acknowledgedVersion;
+    quint32 _pendingVersion;
+    quint32 _pendingBaseVersion;
+    QSet<quint16> _pendingPackets;
+};
+
+#endif /* defined(__hifi__DomainListDelta__) */
@@ -0,0 +1,71 @@
+//
+//  Histogram.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <string.h>
+
+#include <QtCore/QStringList>
+
+#include "Histogram.h"
+
+Histogram::Histogram() {
+    reset();
+}
+
+// the number of bits up to and including the highest set one, found in six steps whatever the value
+static int significantBits(quint64 value) {
+    int bits = 0;
+    for (int shift = 32; shift > 0; shift >>= 1) {
+        if (value >> shift) {
+            value >>= shift;
+            bits += shift;
+        }
+    }
+    return bits + (int)value;
+}
+
+void Histogram::add(quint64 sample) {
+    int bucket = qMin(significantBits(sample), HISTOGRAM_BUCKETS - 1);
+    _buckets[bucket]++;
+    _count++;
+    _sum += sample;
+    if (sample > _max) {
+        _max = sample;
+    }
+}
+
+void Histogram::reset() {
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _sum = 0;
+    _max = 0;
+}
+
+quint64 Histogram::getBucketLimit(int bucket) {
+    return bucket == HISTOGRAM_BUCKETS - 1 ? ~(quint64)0 : ((quint64)1 << bucket) - 1;
+}
+
+quint64 Histogram::getPercentile(float fraction) const {
+    quint64 count = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        count += _buckets[i];
+        if (count > 0 && count >= fraction * _count) {
+            return qMin(getBucketLimit(i), _max);
+        }
+    }
+    return _max;
+}
+
+QString Histogram::toString() const {
+    QStringList buckets;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (_buckets[i] > 0) {
+            buckets.append(QString("%1:%2").arg(getBucketLimit(i)).arg(_buckets[i]));
+        }
+    }
+    return buckets.join(" ");
+}
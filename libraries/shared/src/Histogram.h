@@ -0,0 +1,48 @@
+//
+//  Histogram.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Counts samples in buckets by powers of two, for queue depths and wait times
+//
+
+#ifndef __hifi__Histogram__
+#define __hifi__Histogram__
+
+#include <QtCore/QString>
+
+const int HISTOGRAM_BUCKETS = 65;
+
+/// Bucket 0 counts samples of 0, and bucket i counts samples from 2^(i - 1) up to 2^i - 1. One thread adds the samples,
+/// others may read them as they go, which is close enough for stats.
+class Histogram {
+public:
+    Histogram();
+
+    void add(quint64 sample);
+    void reset();
+
+    quint64 getCount() const { return _count; }
+    quint64 getMax() const { return _max; }
+    float getAverage() const { return _count == 0 ? 0.0f : (float)_sum / _count; }
+    quint64 getBucketCount(int bucket) const { return _buckets[bucket]; }
+
+    /// \return the largest sample the bucket counts
+    static quint64 getBucketLimit(int bucket);
+
+    /// \return the limit of the bucket the given fraction of the samples are at or under, so at most twice the sample
+    quint64 getPercentile(float fraction) const;
+
+    /// \return the count of each bucket that has any, by the largest sample it counts, like "0:12 1:40 3:2 7:1"
+    QString toString() const;
+
+private:
+    quint64 _buckets[HISTOGRAM_BUCKETS];
+    quint64 _count;
+    quint64 _sum;
+    quint64 _max;
+};
+
+#endif /* defined(__hifi__Histogram__) */
@@ -8,46 +8,27 @@
 //  A really simple class that stores a network packet between being received and being processed
 //
 
-#include <cassert>
-#include <cstring>
 #include <QtDebug>
 
 #include "SharedUtil.h"
 
 #include "NetworkPacket.h"
 
-void NetworkPacket::copyContents(const SharedNodePointer& destinationNode, const QByteArray& packet) {
-    if (packet.size() && packet.size() <= MAX_PACKET_SIZE) {
-        _destinationNode = destinationNode;
-        _byteArray = packet;
-    } else {
-        qDebug(">>> NetworkPacket::copyContents() unexpected length = %d", packet.size());
-    }
-}
-
-NetworkPacket::NetworkPacket(const NetworkPacket& packet) {
-    copyContents(packet.getDestinationNode(), packet.getByteArray());
+NetworkPacket::NetworkPacket() :
+    _destinationNode(),
+    _buffer()
+{
 }
 
-NetworkPacket::NetworkPacket(const SharedNodePointer& destinationNode, const QByteArray& packet) {
-    copyContents(destinationNode, packet);
-};
-
-// copy assignment 
-NetworkPacket& NetworkPacket::operator=(NetworkPacket const& other) {
-    copyContents(other.getDestinationNode(), other.getByteArray());
-    return *this;
+NetworkPacket::NetworkPacket(const SharedNodePointer& destinationNode, const PacketBuffer& buffer) :
+    _destinationNode(destinationNode),
+    _buffer(buffer)
+{
+    checkSize();
 }
 
-#ifdef HAS_MOVE_SEMANTICS
-// move, same as copy, but other packet won't be used further
-NetworkPacket::NetworkPacket(NetworkPacket && packet) {
-    copyContents(packet.getDestinationNode(), packet.getByteArray());
-}
-
-// move assignment
-NetworkPacket& NetworkPacket::operator=(NetworkPacket&& other) {
-    copyContents(other.getDestinationNode(), other.getByteArray());
-    return *this;
+void NetworkPacket::checkSize() const {
+    if (_buffer.size() == 0 || _buffer.size() > MAX_PACKET_SIZE) {
+        qDebug(">>> NetworkPacket unexpected length = %d", _buffer.size());
+    }
 }
-#endif
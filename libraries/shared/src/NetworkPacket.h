@@ -19,28 +19,26 @@
 #endif
 
 #include "NodeList.h"
+#include "PacketBuffer.h"
 
-/// Storage of not-yet processed inbound, or not yet sent outbound generic UDP network packet
+/// Storage of not-yet processed inbound, or not yet sent outbound generic UDP network packet. Copies share the bytes of
+/// the packet.
 class NetworkPacket {
 public:
-    NetworkPacket(const NetworkPacket& packet); // copy constructor
-    NetworkPacket& operator= (const NetworkPacket& other);    // copy assignment
+    NetworkPacket();
 
-#ifdef HAS_MOVE_SEMANTICS
-    NetworkPacket(NetworkPacket&& packet); // move?? // same as copy, but other packet won't be used further
-    NetworkPacket& operator= (NetworkPacket&& other);         // move assignment
-#endif
-
-    NetworkPacket(const SharedNodePointer& destinationNode, const QByteArray& byteArray);
+    /// shares the buffer, without copying the packet
+    NetworkPacket(const SharedNodePointer& destinationNode, const PacketBuffer& buffer);
 
     const SharedNodePointer& getDestinationNode() const { return _destinationNode; }
-    const QByteArray& getByteArray() const { return _byteArray; }
+    const PacketBuffer& getBuffer() const { return _buffer; }
+    PacketBuffer& getBuffer() { return _buffer; }
 
 private:
-    void copyContents(const SharedNodePointer& destinationNode, const QByteArray& byteArray);
+    void checkSize() const;
 
     SharedNodePointer _destinationNode;
-    QByteArray _byteArray;
+    PacketBuffer _buffer;
 };
 
 #endif /* defined(__shared_NetworkPacket__) */
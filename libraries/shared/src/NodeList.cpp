@@ -62,6 +62,7 @@ NodeList::NodeList(char newOwnerType, unsigned short int newSocketListenPort) :
     _nodeHash(),
     _nodeHashMutex(QMutex::Recursive),
     _nodeSocket(this),
+    _datagramReader(_nodeSocket),
     _ownerType(newOwnerType),
     _nodeTypesOfInterest(),
     _sessionUUID(),
@@ -72,6 +73,8 @@ NodeList::NodeList(char newOwnerType, unsigned short int newSocketListenPort) :
     _stunRequestsSinceSuccess(0),
     _numCollectedPackets(0),
     _numCollectedBytes(0),
+    _packetBuffersAtStatReset(PacketBuffer::getTotalBuffers()),
+    _packetBufferHeapAllocationsAtStatReset(PacketBuffer::getTotalHeapAllocations()),
     _packetStatTimer()
 {
     _nodeSocket.bind(QHostAddress::AnyIPv4, newSocketListenPort);
@@ -112,17 +115,17 @@ void NodeList::changeSendSocketBufferSize(int numSendBytes) {
 
 bool NodeList::packetVersionAndHashMatch(const QByteArray& packet) {
     PacketType checkType = packetTypeForPacket(packet);
-    if (packet[1] != versionForPacketType(checkType)
+    if (versionFromPacketHeader(packet) != versionForPacketType(checkType)
         && checkType != PacketTypeStunResponse) {
         PacketType mismatchType = packetTypeForPacket(packet);
-        int numPacketTypeBytes = numBytesArithmeticCodingFromBuffer(packet.data());
         
         static QMultiMap<QUuid, PacketType> versionDebugSuppressMap;
         
         QUuid senderUUID = uuidFromPacketHeader(packet);
         if (!versionDebugSuppressMap.contains(senderUUID, checkType)) {
             qDebug() << "Packet version mismatch on" << packetTypeForPacket(packet) << "- Sender"
-            << uuidFromPacketHeader(packet) << "sent" << qPrintable(QString::number(packet[numPacketTypeBytes])) << "but"
+            << uuidFromPacketHeader(packet) << "sent" << qPrintable(QString::number(versionFromPacketHeader(packet)))
+            << "but"
             << qPrintable(QString::number(versionForPacketType(mismatchType))) << "expected.";
             
             versionDebugSuppressMap.insert(senderUUID, checkType);
@@ -141,8 +144,8 @@ bool NodeList::packetVersionAndHashMatch(const QByteArray& packet) {
         // figure out which node this is from
         SharedNodePointer sendingNode = sendingNodeForPacket(packet);
         if (sendingNode) {
-            // check if the md5 hash in the header matches the hash we would expect
-            if (hashFromPacketHeader(packet) == hashForPacketAndConnectionUUID(packet, sendingNode->getConnectionSecret())) {
+            // check if the hash in the header matches the hash we would expect
+            if (packetHashMatchesConnectionUUID(packet, sendingNode->getConnectionSecret())) {
                 return true;
             } else {
                 qDebug() << "Packet hash mismatch on" << checkType << "- Sender"
@@ -162,7 +165,7 @@ bool NodeList::packetVersionAndHashMatch(const QByteArray& packet) {
                 }
                 
                 if (_domainInfo.getUUID() == uuidFromPacketHeader(packet)) {
-                    if (hashForPacketAndConnectionUUID(packet, _domainInfo.getConnectionSecret()) == hashFromPacketHeader(packet)) {
+                    if (packetHashMatchesConnectionUUID(packet, _domainInfo.getConnectionSecret())) {
                         // this is a packet from the domain-server (PacketTypeDomainServerListRequest)
                         // and the sender UUID matches the UUID we expect for the domain
                         return true;
@@ -184,18 +187,23 @@ bool NodeList::packetVersionAndHashMatch(const QByteArray& packet) {
     return false;
 }
 
-qint64 NodeList::writeDatagram(const QByteArray& datagram, const HifiSockAddr& destinationSockAddr,
+qint64 NodeList::writeDatagram(PacketBuffer& datagram, const HifiSockAddr& destinationSockAddr,
                                const QUuid& connectionSecret) {
-    QByteArray datagramCopy = datagram;
-    
-    // setup the MD5 hash for source verification in the header
-    replaceHashInPacketGivenConnectionUUID(datagramCopy, connectionSecret);
+    // setup the hash for source verification in the header
+    replaceHashInPacketGivenConnectionUUID(datagram.data(), datagram.size(), connectionSecret);
     
     // stat collection for packets
     ++_numCollectedPackets;
     _numCollectedBytes += datagram.size();
     
-    qint64 bytesWritten = _nodeSocket.writeDatagram(datagramCopy, destinationSockAddr.getAddress(), destinationSockAddr.getPort());
+    DatagramSendBatch* sendBatch = DatagramSendBatch::getOpenBatch(_nodeSocket);
+    if (sendBatch) {
+        sendBatch->writeDatagram(datagram, destinationSockAddr);
+        return datagram.size();
+    }
+    
+    qint64 bytesWritten = _nodeSocket.writeDatagram(datagram.constData(), datagram.size(),
+                                                    destinationSockAddr.getAddress(), destinationSockAddr.getPort());
     
     if (bytesWritten < 0) {
         qDebug() << "ERROR in writeDatagram:" << _nodeSocket.error() << "-" << _nodeSocket.errorString();
@@ -204,7 +212,7 @@ qint64 NodeList::writeDatagram(const QByteArray& datagram, const HifiSockAddr& d
     return bytesWritten;
 }
 
-qint64 NodeList::writeDatagram(const QByteArray& datagram, const SharedNodePointer& destinationNode,
+qint64 NodeList::writeDatagram(PacketBuffer& datagram, const SharedNodePointer& destinationNode,
                                const HifiSockAddr& overridenSockAddr) {
     if (destinationNode) {
         // if we don't have an ovveriden address, assume they want to send to the node's active socket
@@ -226,9 +234,17 @@ qint64 NodeList::writeDatagram(const QByteArray& datagram, const SharedNodePoint
     return 0;
 }
 
+qint64 NodeList::writeDatagram(const QByteArray& datagram, const SharedNodePointer& destinationNode,
+                               const HifiSockAddr& overridenSockAddr) {
+    // the hash goes into a copy, so that the caller can send the same packet to other nodes
+    PacketBuffer datagramCopy(datagram);
+    return writeDatagram(datagramCopy, destinationNode, overridenSockAddr);
+}
+
 qint64 NodeList::writeDatagram(const char* data, qint64 size, const SharedNodePointer& destinationNode,
                                const HifiSockAddr& overridenSockAddr) {
-    return writeDatagram(QByteArray(data, size), destinationNode, overridenSockAddr);
+    PacketBuffer datagramCopy(data, size);
+    return writeDatagram(datagramCopy, destinationNode, overridenSockAddr);
 }
 
 qint64 NodeList::sendStatsToDomainServer(const QJsonObject& statsObject) {
@@ -237,7 +253,8 @@ qint64 NodeList::sendStatsToDomainServer(const QJsonObject& statsObject) {
     
     statsPacketStream << statsObject.toVariantMap();
     
-    return writeDatagram(statsPacket, _domainInfo.getSockAddr(), _domainInfo.getConnectionSecret());
+    PacketBuffer statsDatagram(statsPacket);
+    return writeDatagram(statsDatagram, _domainInfo.getSockAddr(), _domainInfo.getConnectionSecret());
 }
 
 void NodeList::timePingReply(const QByteArray& packet, const SharedNodePointer& sendingNode) {
@@ -409,6 +426,10 @@ void NodeList::eraseAllNodes() {
 void NodeList::reset() {
     eraseAllNodes();
     _numNoReplyDomainCheckIns = 0;
+    _domainListVersions.reset();
+    
+    // whatever is left of the last batch of datagrams was meant for the old domain (or assignment)
+    _datagramReader.clear();
 
     // refresh the owner UUID to the NULL UUID
     setSessionUUID(QUuid());
@@ -582,6 +603,9 @@ void NodeList::processKillNode(const QByteArray& dataByteArray) {
 
     // kill the node with this UUID, if it exists
     killNodeWithUUID(nodeUUID);
+
+    // the domain-server may still list it, so ask for the whole list next time
+    _domainListVersions.reset();
 }
 
 void NodeList::sendDomainServerCheckIn() {
@@ -623,7 +647,13 @@ void NodeList::sendDomainServerCheckIn() {
                 packetStream << nodeTypeOfInterest;
             }
             
-            writeDatagram(domainServerPacket, _domainInfo.getSockAddr(), _domainInfo.getConnectionSecret());
+            if (domainPacketType == PacketTypeDomainListRequest) {
+                // let the domain-server know which list we have, so that it only sends what changed since
+                packetStream << _domainListVersions.getAcknowledgedVersion();
+            }
+            
+            PacketBuffer domainServerDatagram(domainServerPacket);
+            writeDatagram(domainServerDatagram, _domainInfo.getSockAddr(), _domainInfo.getConnectionSecret());
             const int NUM_DOMAIN_SERVER_CHECKINS_PER_STUN_REQUEST = 5;
             static unsigned int numDomainCheckins = 0;
             
@@ -679,13 +709,22 @@ int NodeList::processDomainServerList(const QByteArray& packet) {
     QDataStream packetStream(packet);
     packetStream.skipRawData(numBytesForPacketHeader(packet));
     
-    // pull our owner UUID from the packet, it's always the first thing
-    QUuid newUUID;
-    packetStream >> newUUID;
-    setSessionUUID(newUUID);
+    // pull our owner UUID and the version of the list from the packet, it's always the first thing
+    DomainListHeader listHeader;
+    packetStream >> listHeader;
+    setSessionUUID(listHeader.sessionUUID);
     
     // pull each node in the packet
     while(packetStream.device()->pos() < packet.size()) {
+        quint8 entryType;
+        packetStream >> entryType;
+        
+        if (entryType == DomainListNodeRemoved) {
+            packetStream >> nodeUUID;
+            killNodeWithUUID(nodeUUID);
+            continue;
+        }
+        
         packetStream >> nodeType >> nodeUUID >> nodePublicSocket >> nodeLocalSocket;
 
         // if the public socket address is 0 then it's reachable at the same IP
@@ -700,6 +739,8 @@ int NodeList::processDomainServerList(const QByteArray& packet) {
         node->setConnectionSecret(connectionUUID);
     }
     
+    _domainListVersions.packetReceived(listHeader);
+    
     // ping inactive nodes in conjunction with receipt of list from domain-server
     // this makes it happen every second and also pings any newly added nodes
     pingInactiveNodes();
@@ -858,6 +899,7 @@ SharedNodePointer NodeList::updateSocketsForNode(const QUuid& uuid,
 
 unsigned NodeList::broadcastToNodes(const QByteArray& packet, const NodeSet& destinationNodeTypes) {
     unsigned n = 0;
+    DatagramSendBatch sendBatch(_nodeSocket);
 
     foreach (const SharedNodePointer& node, getNodeHash()) {
         // only send to the NodeTypes we are asked to send to.
@@ -915,9 +957,18 @@ void NodeList::getPacketStats(float& packetsPerSecond, float& bytesPerSecond) {
     bytesPerSecond = (float) _numCollectedBytes / ((float) _packetStatTimer.elapsed() / 1000.0f);
 }
 
+void NodeList::getPacketBufferStats(float& buffersPerSecond, float& heapAllocationsPerSecond) {
+    float secondsSinceReset = (float) _packetStatTimer.elapsed() / 1000.0f;
+    buffersPerSecond = (PacketBuffer::getTotalBuffers() - _packetBuffersAtStatReset) / secondsSinceReset;
+    heapAllocationsPerSecond = (PacketBuffer::getTotalHeapAllocations() - _packetBufferHeapAllocationsAtStatReset)
+        / secondsSinceReset;
+}
+
 void NodeList::resetPacketStats() {
     _numCollectedPackets = 0;
     _numCollectedBytes = 0;
+    _packetBuffersAtStatReset = PacketBuffer::getTotalBuffers();
+    _packetBufferHeapAllocationsAtStatReset = PacketBuffer::getTotalHeapAllocations();
     _packetStatTimer.restart();
 }
 
@@ -935,6 +986,9 @@ void NodeList::removeSilentNodes() {
         if ((usecTimestampNow() - node->getLastHeardMicrostamp()) > NODE_SILENCE_THRESHOLD_USECS) {
             // call our private method to kill this node (removes it and emits the right signal)
             nodeItem = killNodeAtHashIterator(nodeItem);
+            
+            // the domain-server may still list it, so ask for the whole list next time
+            _domainListVersions.reset();
         } else {
             // we didn't kill this node, push the iterator forwards
             ++nodeItem;
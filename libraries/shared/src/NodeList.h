@@ -29,8 +29,11 @@
 #include <QtNetwork/QHostAddress>
 #include <QtNetwork/QUdpSocket>
 
+#include "DatagramBatch.h"
 #include "DomainInfo.h"
+#include "DomainListDelta.h"
 #include "Node.h"
+#include "PacketBuffer.h"
 
 const quint64 NODE_SILENCE_THRESHOLD_USECS = 2 * 1000 * 1000;
 const quint64 DOMAIN_SERVER_CHECK_IN_USECS = 1 * 1000000;
@@ -76,6 +79,16 @@ public:
     
     bool packetVersionAndHashMatch(const QByteArray& packet);
     
+    /// reads the next datagram waiting on the node socket, from the thread the socket belongs to, into a buffer that can
+    /// be queued for another thread as it is
+    /// \return false if there are none
+    bool readDatagram(PacketBuffer& datagram, HifiSockAddr& senderSockAddr)
+        { return _datagramReader.readDatagram(datagram, senderSockAddr); }
+    
+    /// sends right away, or with the rest of the DatagramSendBatch that is open on this thread
+    /// \param datagram the packet, which the hash is written into (in place, unless the buffer is shared)
+    qint64 writeDatagram(PacketBuffer& datagram, const SharedNodePointer& destinationNode,
+                         const HifiSockAddr& overridenSockAddr = HifiSockAddr());
     qint64 writeDatagram(const QByteArray& datagram, const SharedNodePointer& destinationNode,
                          const HifiSockAddr& overridenSockAddr = HifiSockAddr());
     qint64 writeDatagram(const char* data, qint64 size, const SharedNodePointer& destinationNode,
@@ -122,6 +135,7 @@ public:
     SharedNodePointer soloNodeOfType(char nodeType);
 
     void getPacketStats(float &packetsPerSecond, float &bytesPerSecond);
+    void getPacketBufferStats(float& buffersPerSecond, float& heapAllocationsPerSecond);
     void resetPacketStats();
     
     void loadData(QSettings* settings);
@@ -151,7 +165,7 @@ private:
     void sendSTUNRequest();
     void processSTUNResponse(const QByteArray& packet);
     
-    qint64 writeDatagram(const QByteArray& datagram, const HifiSockAddr& destinationSockAddr,
+    qint64 writeDatagram(PacketBuffer& datagram, const HifiSockAddr& destinationSockAddr,
                          const QUuid& connectionSecret);
 
     NodeHash::iterator killNodeAtHashIterator(NodeHash::iterator& nodeItemToKill);
@@ -166,9 +180,11 @@ private:
     NodeHash _nodeHash;
     QMutex _nodeHashMutex;
     QUdpSocket _nodeSocket;
+    DatagramReader _datagramReader;
     NodeType_t _ownerType;
     NodeSet _nodeTypesOfInterest;
     DomainInfo _domainInfo;
+    DomainListVersionTracker _domainListVersions;
     QUuid _sessionUUID;
     int _numNoReplyDomainCheckIns;
     HifiSockAddr _assignmentServerSocket;
@@ -177,6 +193,8 @@ private:
     unsigned int _stunRequestsSinceSuccess;
     int _numCollectedPackets;
     int _numCollectedBytes;
+    quint64 _packetBuffersAtStatReset;
+    quint64 _packetBufferHeapAllocationsAtStatReset;
     QElapsedTimer _packetStatTimer;
 };
 
@@ -150,8 +150,9 @@ void copyFirstVertexForCode(const unsigned char* octalCode, float* output) {
     memset(output, 0, 3 * sizeof(float));
     
     float currentScale = 0.5;
+    int numberOfSections = numberOfThreeBitSectionsInCode(octalCode);
     
-    for (int i = 0; i < numberOfThreeBitSectionsInCode(octalCode); i++) {
+    for (int i = 0; i < numberOfSections; i++) {
         int sectionIndex = sectionValue(octalCode + 1 + (3 * i / 8), (3 * i) % 8);
         
         for (int j = 0; j < 3; j++) {
@@ -0,0 +1,307 @@
+//
+//  PacketBuffer.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <string.h>
+
+#include <new>
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QVector>
+
+#include "SharedUtil.h"
+
+#include "PacketBuffer.h"
+
+// room for a packet of the largest size we send, and a header in front of it
+const int POOLED_BLOCK_BYTES = 2048;
+const int SLAB_BLOCKS = 128;
+
+// the free blocks a thread takes from the pool when it has none, and gives back when it has twice as many
+const int CACHE_EXCHANGE_BLOCKS = 32;
+
+const int MAX_UNCOUNTED_BUFFERS = 1 << 20;
+
+// the free blocks of one thread, which only that thread changes. The counts are atomic so that the stats can read them.
+struct BlockCache {
+    BlockCache();
+    ~BlockCache();
+
+    void* freeBlocks;
+    QAtomicInt numFreeBlocks;
+    QAtomicInt buffersMade; // since they were last added to totalBuffers
+};
+
+static QMutex poolMutex;
+static void* freeBlocks = NULL; // each free block starts with a pointer to the next
+static QVector<char*> slabs;
+static QVector<BlockCache*> blockCaches;
+static quint64 blocksTaken = 0; // by the threads' caches, to be used or kept
+static quint64 totalBuffers = 0;
+static quint64 totalHeapAllocations = 0;
+
+// never deleted, so that buffers released as the process exits still find it
+static QThreadStorage<BlockCache*>* threadBlockCaches = new QThreadStorage<BlockCache*>();
+
+// moves up to numBlocks blocks from one free list to the other, with the pool locked
+static int moveFreeBlocks(void*& from, void*& to, int numBlocks) {
+    int numMoved = 0;
+    while (from && numMoved < numBlocks) {
+        void* block = from;
+        from = *static_cast<void**>(block);
+        *static_cast<void**>(block) = to;
+        to = block;
+        numMoved++;
+    }
+    return numMoved;
+}
+
+BlockCache::BlockCache() :
+    freeBlocks(NULL),
+    numFreeBlocks(0),
+    buffersMade(0)
+{
+    QMutexLocker locker(&poolMutex);
+    blockCaches.append(this);
+}
+
+BlockCache::~BlockCache() {
+    QMutexLocker locker(&poolMutex);
+    blocksTaken -= moveFreeBlocks(freeBlocks, ::freeBlocks, numFreeBlocks.load());
+    totalBuffers += buffersMade.load();
+    blockCaches.remove(blockCaches.indexOf(this));
+}
+
+static BlockCache* getBlockCache() {
+    BlockCache* cache = threadBlockCaches->localData();
+    if (!cache) {
+        cache = new BlockCache();
+        threadBlockCaches->setLocalData(cache);
+    }
+    return cache;
+}
+
+PacketBuffer::Block* PacketBuffer::allocateBlock(int capacity) {
+    int blockBytes = sizeof(Block) + capacity;
+    void* memory;
+    if (blockBytes > POOLED_BLOCK_BYTES) {
+        memory = new char[blockBytes];
+
+        QMutexLocker locker(&poolMutex);
+        totalBuffers++;
+        totalHeapAllocations++;
+
+    } else {
+        capacity = POOLED_BLOCK_BYTES - sizeof(Block);
+
+        // the pool is only locked when the thread has run out of blocks, or to add up the buffers it made before their
+        // count can overflow
+        BlockCache* cache = getBlockCache();
+        if (!cache->freeBlocks || cache->buffersMade.load() == MAX_UNCOUNTED_BUFFERS) {
+            QMutexLocker locker(&poolMutex);
+            totalBuffers += cache->buffersMade.load();
+            cache->buffersMade.store(0);
+
+            if (!cache->freeBlocks) {
+                if (!freeBlocks) {
+                    char* slab = new char[SLAB_BLOCKS * POOLED_BLOCK_BYTES];
+                    slabs.append(slab);
+                    totalHeapAllocations++;
+                    for (int i = SLAB_BLOCKS - 1; i >= 0; i--) {
+                        void* slabBlock = slab + i * POOLED_BLOCK_BYTES;
+                        *static_cast<void**>(slabBlock) = freeBlocks;
+                        freeBlocks = slabBlock;
+                    }
+                }
+                int numTaken = moveFreeBlocks(freeBlocks, cache->freeBlocks, CACHE_EXCHANGE_BLOCKS);
+                cache->numFreeBlocks.store(numTaken);
+                blocksTaken += numTaken;
+            }
+        }
+        memory = cache->freeBlocks;
+        cache->freeBlocks = *static_cast<void**>(memory);
+        cache->numFreeBlocks.store(cache->numFreeBlocks.load() - 1);
+        cache->buffersMade.store(cache->buffersMade.load() + 1);
+    }
+
+    Block* block = new (memory) Block();
+    block->refCount.store(1);
+    block->capacity = capacity;
+    return block;
+}
+
+void PacketBuffer::releaseBlock(Block* block) {
+    if (block->refCount.deref()) {
+        return;
+    }
+    bool isPooled = (int)sizeof(Block) + block->capacity == POOLED_BLOCK_BYTES;
+    block->~Block();
+
+    if (!isPooled) {
+        delete[] reinterpret_cast<char*>(block);
+        return;
+    }
+
+    // the block goes to the thread that released it, which may not be the one that made it
+    BlockCache* cache = getBlockCache();
+    *reinterpret_cast<void**>(block) = cache->freeBlocks;
+    cache->freeBlocks = block;
+    cache->numFreeBlocks.store(cache->numFreeBlocks.load() + 1);
+
+    if (cache->numFreeBlocks.load() == 2 * CACHE_EXCHANGE_BLOCKS) {
+        QMutexLocker locker(&poolMutex);
+        blocksTaken -= moveFreeBlocks(cache->freeBlocks, freeBlocks, CACHE_EXCHANGE_BLOCKS);
+        cache->numFreeBlocks.store(CACHE_EXCHANGE_BLOCKS);
+    }
+}
+
+PacketBuffer::PacketBuffer() :
+    _block(NULL),
+    _offset(0),
+    _size(0)
+{
+}
+
+PacketBuffer::PacketBuffer(int size) :
+    _block(allocateBlock(PACKET_BUFFER_HEADROOM + size)),
+    _offset(PACKET_BUFFER_HEADROOM),
+    _size(size)
+{
+}
+
+PacketBuffer::PacketBuffer(const char* data, int size) :
+    _block(allocateBlock(PACKET_BUFFER_HEADROOM + size)),
+    _offset(PACKET_BUFFER_HEADROOM),
+    _size(size)
+{
+    memcpy(blockData() + _offset, data, size);
+}
+
+PacketBuffer::PacketBuffer(const QByteArray& byteArray) :
+    _block(allocateBlock(PACKET_BUFFER_HEADROOM + byteArray.size())),
+    _offset(PACKET_BUFFER_HEADROOM),
+    _size(byteArray.size())
+{
+    memcpy(blockData() + _offset, byteArray.constData(), _size);
+}
+
+PacketBuffer::PacketBuffer(const PacketBuffer& other) :
+    _block(other._block),
+    _offset(other._offset),
+    _size(other._size)
+{
+    if (_block) {
+        _block->refCount.ref();
+    }
+}
+
+PacketBuffer& PacketBuffer::operator=(const PacketBuffer& other) {
+    if (other._block) {
+        other._block->refCount.ref();
+    }
+    if (_block) {
+        releaseBlock(_block);
+    }
+    _block = other._block;
+    _offset = other._offset;
+    _size = other._size;
+    return *this;
+}
+
+PacketBuffer::~PacketBuffer() {
+    if (_block) {
+        releaseBlock(_block);
+    }
+}
+
+const char* PacketBuffer::constData() const {
+    return _block ? blockData() + _offset : NULL;
+}
+
+char* PacketBuffer::data() {
+    if (!_block) {
+        return NULL;
+    }
+    if (_block->refCount.load() > 1) {
+        reallocate(_offset);
+    }
+    return blockData() + _offset;
+}
+
+char* PacketBuffer::prepend(int numBytes) {
+    if (!_block) {
+        *this = PacketBuffer(0);
+    }
+    if (_offset < numBytes) {
+        reallocate(PACKET_BUFFER_HEADROOM + numBytes);
+
+    } else if (_block->refCount.load() > 1) {
+        reallocate(_offset);
+    }
+    _offset -= numBytes;
+    _size += numBytes;
+    return blockData() + _offset;
+}
+
+int PacketBuffer::capacity() const {
+    return _block ? _block->capacity - _offset : 0;
+}
+
+void PacketBuffer::resize(int size) {
+    if (_block && size <= capacity()) {
+        _size = size;
+        return;
+    }
+    PacketBuffer resized(size);
+    if (_size > 0) {
+        memcpy(resized.blockData() + resized._offset, constData(), _size);
+    }
+    *this = resized;
+}
+
+void PacketBuffer::reallocate(int offset) {
+    Block* block = allocateBlock(offset + _size);
+    memcpy(reinterpret_cast<char*>(block + 1) + offset, blockData() + _offset, _size);
+
+    releaseBlock(_block);
+    _block = block;
+    _offset = offset;
+}
+
+int PacketBuffer::getMaxPooledSize() {
+    return POOLED_BLOCK_BYTES - sizeof(Block) - PACKET_BUFFER_HEADROOM;
+}
+
+quint64 PacketBuffer::getTotalBuffers() {
+    QMutexLocker locker(&poolMutex);
+    quint64 buffers = totalBuffers;
+    foreach (BlockCache* cache, blockCaches) {
+        buffers += cache->buffersMade.load();
+    }
+    return buffers;
+}
+
+quint64 PacketBuffer::getTotalHeapAllocations() {
+    QMutexLocker locker(&poolMutex);
+    return totalHeapAllocations;
+}
+
+quint64 PacketBuffer::getPooledBytes() {
+    QMutexLocker locker(&poolMutex);
+    return (quint64)slabs.size() * SLAB_BLOCKS * POOLED_BLOCK_BYTES;
+}
+
+quint64 PacketBuffer::getPooledBytesInUse() {
+    QMutexLocker locker(&poolMutex);
+    quint64 blocksInUse = blocksTaken;
+    foreach (BlockCache* cache, blockCaches) {
+        blocksInUse -= cache->numFreeBlocks.load();
+    }
+    return blocksInUse * POOLED_BLOCK_BYTES;
+}
@@ -0,0 +1,100 @@
+//
+//  PacketBuffer.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#ifndef __hifi__PacketBuffer__
+#define __hifi__PacketBuffer__
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+
+#include "PacketHeaders.h"
+
+// the room kept in front of a packet, so that a payload can be written before the header that goes in front of it
+const int PACKET_BUFFER_HEADROOM = MAX_PACKET_HEADER_BYTES;
+
+/// The bytes of a packet, in a block from a pool shared by every thread. Copies share the block, which goes back to the
+/// pool when the last of them is gone, and writing through one that is shared copies it first. Packets that are larger
+/// than a block get one of their own from the heap. Each thread keeps a few free blocks of its own, so that most packets
+/// are made and released without locking the pool.
+class PacketBuffer {
+public:
+    /// a null buffer
+    PacketBuffer();
+
+    /// an uninitialized packet of the given size
+    explicit PacketBuffer(int size);
+
+    /// a copy of the given bytes
+    PacketBuffer(const char* data, int size);
+    explicit PacketBuffer(const QByteArray& byteArray);
+
+    PacketBuffer(const PacketBuffer& other);
+    PacketBuffer& operator=(const PacketBuffer& other);
+    ~PacketBuffer();
+
+    bool isNull() const { return !_block; }
+    int size() const { return _size; }
+
+    /// \return the size the packet can grow to without moving
+    int capacity() const;
+
+    /// sets the size of the packet, moving it to a larger block if it doesn't fit in its own. Bytes past the old size are
+    /// uninitialized.
+    void resize(int size);
+
+    const char* constData() const;
+
+    /// \return the bytes of the packet, after copying them if the block is shared
+    char* data();
+
+    /// grows the packet at the front, into the room in front of it if there is enough
+    /// \return the new start of the packet
+    char* prepend(int numBytes);
+
+    /// \return a QByteArray that reads the bytes of this buffer where they are, and which (along with any copies of it)
+    /// may only be used while this buffer exists and isn't written to
+    QByteArray asByteArray() const { return QByteArray::fromRawData(constData(), _size); }
+
+    /// points the given array at the bytes of this buffer the same way, reusing it rather than allocating a new one if
+    /// nothing else shares it
+    void asByteArray(QByteArray& byteArray) const { byteArray.setRawData(constData(), _size); }
+
+    /// \return a copy of the bytes
+    QByteArray toByteArray() const { return QByteArray(constData(), _size); }
+
+    /// \return the largest packet that fits in a pooled block
+    static int getMaxPooledSize();
+
+    /// the number of buffers made since the process started
+    static quint64 getTotalBuffers();
+
+    /// the number of times buffers had to go to the heap, for a new slab of blocks or for a packet too large for one
+    static quint64 getTotalHeapAllocations();
+
+    /// the bytes of the blocks in the pool, and of those of them in use
+    static quint64 getPooledBytes();
+    static quint64 getPooledBytesInUse();
+
+private:
+    struct Block {
+        QAtomicInt refCount;
+        int capacity;
+    };
+
+    static Block* allocateBlock(int capacity);
+    static void releaseBlock(Block* block);
+
+    char* blockData() const { return reinterpret_cast<char*>(_block + 1); }
+    void reallocate(int offset);
+
+    Block* _block;
+    int _offset;
+    int _size;
+};
+
+#endif /* defined(__hifi__PacketBuffer__) */
@@ -9,8 +9,10 @@
 #include <math.h>
 
 #include <QtCore/QDebug>
+#include <QtCore/QtEndian>
 
 #include "NodeList.h"
+#include "SipHash.h"
 
 #include "PacketHeaders.h"
 
@@ -45,14 +47,16 @@ int packArithmeticallyCodedValue(int value, char* destination) {
 PacketVersion versionForPacketType(PacketType type) {
     switch (type) {
         case PacketTypeAvatarData:
-            return 3;
+            return 4;
+        case PacketTypeBulkAvatarData:
+            return 1;
         case PacketTypeEnvironmentData:
             return 1;
         case PacketTypeParticleData:
             return 1;
         case PacketTypeDomainList:
         case PacketTypeDomainListRequest:
-            return 1;
+            return 2;
         case PacketTypeCreateAssignment:
         case PacketTypeRequestAssignment:
             return 1;
@@ -64,11 +68,22 @@ PacketVersion versionForPacketType(PacketType type) {
         case PacketTypeVoxelSet:
         case PacketTypeVoxelSetDestructive:
             return 1;
+        case PacketTypeOctreeStats:
+            return 1;
+        case PacketTypeMicrophoneAudioNoEcho:
+        case PacketTypeMicrophoneAudioWithEcho:
+        case PacketTypeSilentAudioFrame:
+        case PacketTypeMixedAudio:
+            return 1;
         default:
             return 0;
     }
 }
 
+PacketVersion versionFromPacketHeader(const QByteArray& packet) {
+    return packet[numBytesArithmeticCodingFromBuffer(packet.data())] & ~PACKET_VERSION_KEYED_HASH_BIT;
+}
+
 QByteArray byteArrayWithPopulatedHeader(PacketType type, const QUuid& connectionUUID) {
     QByteArray freshByteArray(MAX_PACKET_HEADER_BYTES, 0);
     freshByteArray.resize(populatePacketHeader(freshByteArray, type, connectionUUID));
@@ -131,9 +146,51 @@ QByteArray hashForPacketAndConnectionUUID(const QByteArray& packet, const QUuid&
                                     QCryptographicHash::Md5);
 }
 
+// hashes the payload where it is, with the RFC 4122 bytes of the secret as the key
+static void keyedHashForPayload(const char* payload, int payloadSize, const QUuid& connectionUUID, uchar* hash) {
+    uchar key[NUM_BYTES_SIPHASH_KEY];
+    qToBigEndian<quint32>(connectionUUID.data1, key);
+    qToBigEndian<quint16>(connectionUUID.data2, key + sizeof(quint32));
+    qToBigEndian<quint16>(connectionUUID.data3, key + sizeof(quint32) + sizeof(quint16));
+    memcpy(key + sizeof(quint32) + 2 * sizeof(quint16), connectionUUID.data4, sizeof(connectionUUID.data4));
+
+    sipHash128(payload, payloadSize, key, hash);
+}
+
+bool packetHashMatchesConnectionUUID(const QByteArray& packet, const QUuid& connectionUUID) {
+    int numHeaderBytes = numBytesForPacketHeader(packet);
+    if (packet.size() < numHeaderBytes) {
+        return false;
+    }
+    const char* packetHash = packet.constData() + numHeaderBytes - NUM_BYTES_MD5_HASH;
+
+    if (!(packet[numBytesArithmeticCodingFromBuffer(packet.data())] & PACKET_VERSION_KEYED_HASH_BIT)) {
+        // the MD5 that older nodes send isn't keyed by the secret, so there's nothing in it to trust
+        return false;
+    }
+
+    uchar expectedHash[NUM_BYTES_SIPHASH_128];
+    keyedHashForPayload(packet.constData() + numHeaderBytes, packet.size() - numHeaderBytes, connectionUUID,
+                        expectedHash);
+
+    // look at every byte no matter where the first difference is, so the time taken doesn't tell how close a guess was
+    uchar difference = 0;
+    for (int i = 0; i < NUM_BYTES_SIPHASH_128; i++) {
+        difference |= expectedHash[i] ^ (uchar)packetHash[i];
+    }
+    return difference == 0;
+}
+
 void replaceHashInPacketGivenConnectionUUID(QByteArray& packet, const QUuid& connectionUUID) {
-    packet.replace(numBytesForPacketHeader(packet) - NUM_BYTES_MD5_HASH, NUM_BYTES_MD5_HASH,
-                   hashForPacketAndConnectionUUID(packet, connectionUUID));
+    replaceHashInPacketGivenConnectionUUID(packet.data(), packet.size(), connectionUUID);
+}
+
+void replaceHashInPacketGivenConnectionUUID(char* packet, int packetSize, const QUuid& connectionUUID) {
+    int numHeaderBytes = numBytesForPacketHeader(packet);
+
+    packet[numBytesArithmeticCodingFromBuffer(packet)] |= PACKET_VERSION_KEYED_HASH_BIT;
+    keyedHashForPayload(packet + numHeaderBytes, packetSize - numHeaderBytes, connectionUUID,
+                        reinterpret_cast<uchar*>(packet + numHeaderBytes - NUM_BYTES_MD5_HASH));
 }
 
 PacketType packetTypeForPacket(const QByteArray& packet) {
@@ -59,16 +59,22 @@ enum PacketType {
     PacketTypeAvatarBillboard,
     PacketTypeDomainConnectRequest,
     PacketTypeDomainServerAuthRequest,
-    PacketTypeNodeJsonStats
+    PacketTypeNodeJsonStats,
+    PacketTypeBulkAvatarDataAck
 };
 
 typedef char PacketVersion;
 
 const int NUM_BYTES_MD5_HASH = 16;
+
+// set in the version of a packet whose hash is the SipHash of its payload keyed by the connection secret, rather than the
+// MD5 of the payload and the secret that older nodes send - packets without it don't verify
+const PacketVersion PACKET_VERSION_KEYED_HASH_BIT = 0x40;
 const int NUM_STATIC_HEADER_BYTES = sizeof(PacketVersion) + NUM_BYTES_RFC4122_UUID + NUM_BYTES_MD5_HASH;
 const int MAX_PACKET_HEADER_BYTES = sizeof(PacketType) + NUM_STATIC_HEADER_BYTES;
 
 PacketVersion versionForPacketType(PacketType type);
+PacketVersion versionFromPacketHeader(const QByteArray& packet);
 
 const QUuid nullUUID = QUuid();
 
@@ -84,7 +90,9 @@ QUuid uuidFromPacketHeader(const QByteArray& packet);
 
 QByteArray hashFromPacketHeader(const QByteArray& packet);
 QByteArray hashForPacketAndConnectionUUID(const QByteArray& packet, const QUuid& connectionUUID);
+bool packetHashMatchesConnectionUUID(const QByteArray& packet, const QUuid& connectionUUID);
 void replaceHashInPacketGivenConnectionUUID(QByteArray& packet, const QUuid& connectionUUID);
+void replaceHashInPacketGivenConnectionUUID(char* packet, int packetSize, const QUuid& connectionUUID);
 
 PacketType packetTypeForPacket(const QByteArray& packet);
 PacketType packetTypeForPacket(const char* packet);
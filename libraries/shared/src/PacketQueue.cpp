@@ -0,0 +1,187 @@
+//
+//  PacketQueue.cpp
+//  shared
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Queue of packets between the threads that receive or make them and the thread that processes or sends them
+//
+
+#include <QtCore/QMutexLocker>
+
+#include "SharedUtil.h"
+
+#include "PacketQueue.h"
+
+// positions and sequence numbers count up forever and wrap around, so they're compared by their difference
+static inline int positionDifference(int a, int b) {
+    return (int)((quint32)a - (quint32)b);
+}
+
+static inline int nextPosition(int position, int count) {
+    return (int)((quint32)position + (quint32)count);
+}
+
+// an adding thread can stamp a packet after the taking thread read the time, and the clock isn't monotonic
+static inline quint64 waitTime(quint64 now, quint64 queuedAt) {
+    return now > queuedAt ? now - queuedAt : 0;
+}
+
+PacketQueue::PacketQueue(int capacity) :
+    _slots(NULL),
+    _capacity(1),
+    _mask(0),
+    _enqueuePosition(0),
+    _dequeuePosition(0),
+    _overflowMutex(),
+    _overflow(),
+    _overflowSize(0),
+    _overflowedPackets(0),
+    _waitMutex(),
+    _hasPackets(),
+    _isWaiting(0),
+    _wakeRequested(0),
+    _histogramResetRequested(0),
+    _depthHistogram(),
+    _waitTimeHistogram()
+{
+    while (_capacity < capacity) {
+        _capacity <<= 1;
+    }
+    _mask = _capacity - 1;
+
+    // a slot is free for the position that is its sequence number, and filled for the one after
+    _slots = new Slot[_capacity];
+    for (int i = 0; i < _capacity; i++) {
+        _slots[i].sequence.store(i);
+        _slots[i].queuedAt = 0;
+    }
+}
+
+PacketQueue::~PacketQueue() {
+    delete[] _slots;
+}
+
+void PacketQueue::enqueue(const NetworkPacket& packet) {
+    quint64 now = usecTimestampNow();
+
+    // once packets overflow the rest follow them, until the overflow is emptied, so none are taken ahead of earlier ones
+    if (_overflowSize.load() > 0 || !enqueueInRing(packet, now)) {
+        QMutexLocker locker(&_overflowMutex);
+        OverflowPacket overflowPacket = { packet, now };
+        _overflow.enqueue(overflowPacket);
+        _overflowSize.ref();
+        _overflowedPackets++;
+    }
+
+    // the ordered read pairs with the one in waitForPackets(), so that either it sees this packet or we see it waiting
+    if (_isWaiting.fetchAndAddOrdered(0)) {
+        QMutexLocker locker(&_waitMutex);
+        _hasPackets.wakeAll();
+    }
+}
+
+bool PacketQueue::enqueueInRing(const NetworkPacket& packet, quint64 now) {
+    int position = _enqueuePosition.load();
+    Slot* slot;
+    while (true) {
+        slot = &_slots[position & _mask];
+        int difference = positionDifference(slot->sequence.loadAcquire(), position);
+        if (difference == 0) {
+            // the slot is free, claim it unless another thread got to it first
+            if (_enqueuePosition.testAndSetOrdered(position, nextPosition(position, 1))) {
+                break;
+            }
+            position = _enqueuePosition.load();
+
+        } else if (difference < 0) {
+            // the slot still holds the packet from one time around the ring ago
+            return false;
+
+        } else {
+            // another thread claimed the slot since we read the position
+            position = _enqueuePosition.load();
+        }
+    }
+
+    slot->packet = packet;
+    slot->queuedAt = now;
+    slot->sequence.storeRelease(nextPosition(position, 1));
+    return true;
+}
+
+int PacketQueue::dequeue(QVector<NetworkPacket>& packets, int maxPackets) {
+    // only this thread adds to the histograms, so it's the one to start them over
+    if (_histogramResetRequested.fetchAndStoreOrdered(0)) {
+        _depthHistogram.reset();
+        _waitTimeHistogram.reset();
+    }
+
+    int depth = size();
+    quint64 now = usecTimestampNow();
+    int packetsTaken = 0;
+
+    int position = _dequeuePosition.load();
+    while (packetsTaken < maxPackets) {
+        Slot& slot = _slots[position & _mask];
+        if (positionDifference(slot.sequence.loadAcquire(), nextPosition(position, 1)) < 0) {
+            break; // not filled yet
+        }
+        packets.append(slot.packet);
+        _waitTimeHistogram.add(waitTime(now, slot.queuedAt));
+
+        // let go of the node and the buffer, then free the slot for the position one time around the ring from here
+        slot.packet = NetworkPacket();
+        slot.sequence.storeRelease(nextPosition(position, _capacity));
+
+        position = nextPosition(position, 1);
+        packetsTaken++;
+    }
+    _dequeuePosition.storeRelease(position);
+
+    // the overflowed packets were added after the ones in the ring, so they're taken once it's empty
+    if (packetsTaken < maxPackets && _overflowSize.load() > 0) {
+        QMutexLocker locker(&_overflowMutex);
+        while (packetsTaken < maxPackets && !_overflow.isEmpty()) {
+            OverflowPacket overflowPacket = _overflow.dequeue();
+            _overflowSize.deref();
+            packets.append(overflowPacket.packet);
+            _waitTimeHistogram.add(waitTime(now, overflowPacket.queuedAt));
+            packetsTaken++;
+        }
+    }
+
+    if (packetsTaken > 0) {
+        _depthHistogram.add(depth);
+    }
+    return packetsTaken;
+}
+
+void PacketQueue::waitForPackets() {
+    QMutexLocker locker(&_waitMutex);
+
+    // the ordered write pairs with the read in enqueue(), see there
+    _isWaiting.fetchAndStoreOrdered(1);
+    if (size() == 0 && !_wakeRequested.fetchAndStoreOrdered(0)) {
+        _hasPackets.wait(&_waitMutex);
+        _wakeRequested.fetchAndStoreOrdered(0);
+    }
+    _isWaiting.fetchAndStoreOrdered(0);
+}
+
+void PacketQueue::wake() {
+    _wakeRequested.fetchAndStoreOrdered(1);
+
+    QMutexLocker locker(&_waitMutex);
+    _hasPackets.wakeAll();
+}
+
+int PacketQueue::size() const {
+    // packets whose slots are claimed but not filled yet are counted
+    return positionDifference(_enqueuePosition.load(), _dequeuePosition.load()) + _overflowSize.load();
+}
+
+void PacketQueue::resetHistograms() {
+    _histogramResetRequested.fetchAndStoreOrdered(1);
+}
@@ -0,0 +1,112 @@
+//
+//  PacketQueue.h
+//  shared
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+//  Queue of packets between the threads that receive or make them and the thread that processes or sends them
+//
+
+#ifndef __shared__PacketQueue__
+#define __shared__PacketQueue__
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+
+#include "Histogram.h"
+#include "NetworkPacket.h"
+
+const int DEFAULT_PACKET_QUEUE_CAPACITY = 1024;
+
+/// A bounded ring of packets that any number of threads may add to without locking, and one thread takes from in
+/// batches. Each slot of the ring carries a sequence number that tells the adding threads when it is free and the taking
+/// thread when it is filled, so the only contention is on the position that adding threads claim slots at.
+///
+/// When the ring is full, packets go to an overflow queue under a lock instead, and keep going there until the taking
+/// thread has emptied it, so that the packets of each thread are taken in the order they were added. Nothing is dropped,
+/// and adding never blocks, which a thread that also takes from the queue (as in PacketSender's non-threaded mode) needs.
+///
+/// The depth of the queue every time packets are taken, and how long each packet waited, are kept in histograms.
+class PacketQueue {
+public:
+    /// \param capacity the number of packets the ring holds, rounded up to a power of two
+    PacketQueue(int capacity = DEFAULT_PACKET_QUEUE_CAPACITY);
+    ~PacketQueue();
+
+    /// \thread any thread
+    void enqueue(const NetworkPacket& packet);
+
+    /// takes as many as maxPackets of the oldest packets, appending them to the given list
+    /// \return the number of packets taken
+    /// \thread the taking thread only
+    int dequeue(QVector<NetworkPacket>& packets, int maxPackets);
+
+    /// waits until there are packets to take or wake() is called, returning right away if either already happened
+    /// \thread the taking thread only
+    void waitForPackets();
+
+    /// lets a waitForPackets() return, or the next one if nothing is waiting yet
+    /// \thread any thread
+    void wake();
+
+    /// the number of packets in the queue, which may already be out of date for any thread but the taking one
+    int size() const;
+
+    /// the number of packets that found the ring full
+    quint64 getOverflowedPackets() const { return _overflowedPackets; }
+
+    /// the number of packets in the queue each time packets were taken, read by other threads as they change
+    const Histogram& getDepthHistogram() const { return _depthHistogram; }
+
+    /// the usecs each packet spent in the queue, read by other threads as they change
+    const Histogram& getWaitTimeHistogram() const { return _waitTimeHistogram; }
+
+    /// starts the histograms over the next time the taking thread calls dequeue(), so any thread may ask for it
+    void resetHistograms();
+
+private:
+    PacketQueue(const PacketQueue&); // not copyable
+    void operator=(const PacketQueue&);
+
+    struct Slot {
+        QAtomicInt sequence;
+        NetworkPacket packet;
+        quint64 queuedAt;
+    };
+
+    struct OverflowPacket {
+        NetworkPacket packet;
+        quint64 queuedAt;
+    };
+
+    /// \return false if the ring is full
+    bool enqueueInRing(const NetworkPacket& packet, quint64 now);
+
+    Slot* _slots;
+    int _capacity;
+    int _mask;
+
+    QAtomicInt _enqueuePosition;
+    char _enqueuePadding[64]; // keeps the adding threads' position off the cache line the taking thread writes
+    QAtomicInt _dequeuePosition;
+
+    QMutex _overflowMutex;
+    QQueue<OverflowPacket> _overflow;
+    QAtomicInt _overflowSize;
+    quint64 _overflowedPackets;
+
+    QMutex _waitMutex;
+    QWaitCondition _hasPackets;
+    QAtomicInt _isWaiting;
+    QAtomicInt _wakeRequested;
+
+    QAtomicInt _histogramResetRequested;
+    Histogram _depthHistogram;
+    Histogram _waitTimeHistogram;
+};
+
+#endif // __shared__PacketQueue__
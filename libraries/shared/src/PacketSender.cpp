@@ -47,16 +47,15 @@ PacketSender::~PacketSender() {
 }
 
 
-void PacketSender::queuePacketForSending(const SharedNodePointer& destinationNode, const QByteArray& packet) {
-    NetworkPacket networkPacket(destinationNode, packet);
-    lock();
-    _packets.push_back(networkPacket);
-    unlock();
-    _totalPacketsQueued++;
-    _totalBytesQueued += packet.size();
+void PacketSender::queuePacketForSending(const SharedNodePointer& destinationNode, const PacketBuffer& packet) {
+    queuePacketForSending(NetworkPacket(destinationNode, packet));
+}
 
-    // Make sure to  wake our actual processing thread because we  now have packets for it to process.
-    _hasPackets.wakeAll();
+void PacketSender::queuePacketForSending(const NetworkPacket& packet) {
+    // the queue wakes our processing thread if it is waiting for packets
+    _packets.enqueue(packet);
+    _totalPacketsQueued++;
+    _totalBytesQueued += packet.getBuffer().size();
 }
 
 void PacketSender::setPacketsPerSecond(int packetsPerSecond) {
@@ -72,7 +71,7 @@ bool PacketSender::process() {
 }
 
 void PacketSender::terminating() {
-    _hasPackets.wakeAll();
+    _packets.wake();
 }
 
 bool PacketSender::threadedProcess() {
@@ -117,10 +116,8 @@ bool PacketSender::threadedProcess() {
 
     // if threaded and we haven't slept? We want to wait for our consumer to signal us with new packets
     if (!hasSlept) {
-        // wait till we have packets        
-        _waitingOnPacketsMutex.lock();
-        _hasPackets.wait(&_waitingOnPacketsMutex);
-        _waitingOnPacketsMutex.unlock();
+        // wait till we have packets, unless some came in since we looked
+        _packets.waitForPackets();
     }
 
     return isStillRunning();
@@ -258,27 +255,25 @@ bool PacketSender::nonThreadedProcess() {
         }
     }
 
-    int packetsLeft = _packets.size();
-
-    // Now that we know how many packets to send this call to process, just send them.
-    while ((packetsSentThisCall < packetsToSendThisCall) && (packetsLeft > 0)) {
-        lock();
-        NetworkPacket& packet = _packets.front();
-        NetworkPacket temporary = packet; // make a copy
-        _packets.erase(_packets.begin());
-        packetsLeft = _packets.size();
-        unlock();
+    // Now that we know how many packets to send this call to process, take them from the queue all at once and send them.
+    if (packetsToSendThisCall > 0) {
+        _packets.dequeue(_packetsToSend, packetsToSendThisCall);
+    }
+    for (int i = 0; i < _packetsToSend.size(); i++) {
+        NetworkPacket& packet = _packetsToSend[i];
 
-        // send the packet through the NodeList...
-        NodeList::getInstance()->writeDatagram(temporary.getByteArray(), temporary.getDestinationNode());
+        // send the packet through the NodeList, which writes the hash into the buffer we now hold the only reference to
+        int packetSize = packet.getBuffer().size();
+        NodeList::getInstance()->writeDatagram(packet.getBuffer(), packet.getDestinationNode());
         packetsSentThisCall++;
         _packetsOverCheckInterval++;
         _totalPacketsSent++;
-        _totalBytesSent += temporary.getByteArray().size();
+        _totalBytesSent += packetSize;
         
-        emit packetSent(temporary.getByteArray().size());
+        emit packetSent(packetSize);
         
         _lastSendTime = now;
     }
+    _packetsToSend.resize(0); // unlike clear(), keeps the storage for the next call
     return isStillRunning();
 }
\ No newline at end of file
@@ -11,11 +11,10 @@
 #ifndef __shared__PacketSender__
 #define __shared__PacketSender__
 
-#include <QWaitCondition>
-
 #include "GenericThread.h"
 #include "NetworkPacket.h"
 #include "NodeList.h"
+#include "PacketQueue.h"
 #include "SharedUtil.h"
 
 /// Generalized threaded processor for queueing and sending of outbound packets.
@@ -35,12 +34,11 @@ public:
     PacketSender(int packetsPerSecond = DEFAULT_PACKETS_PER_SECOND);
     ~PacketSender();
 
-    /// Add packet to outbound queue.
-    /// \param HifiSockAddr& address the destination address
-    /// \param packetData pointer to data
-    /// \param ssize_t packetLength size of data
+    /// Add packet to outbound queue, without copying it.
+    /// \param destinationNode the node to send the packet to
+    /// \param packet the buffer the packet was written into
     /// \thread any thread, typically the application thread
-    void queuePacketForSending(const SharedNodePointer& destinationNode, const QByteArray& packet);
+    void queuePacketForSending(const SharedNodePointer& destinationNode, const PacketBuffer& packet);
 
     void setPacketsPerSecond(int packetsPerSecond);
     int getPacketsPerSecond() const { return _packetsPerSecond; }
@@ -92,6 +90,14 @@ public:
 
     /// returns the total bytes queued by this object over its lifetime
     quint64 getLifetimeBytesQueued() const { return _totalBytesQueued; }
+
+    /// the number of packets waiting to be sent each time some were taken to send, since the histograms were reset
+    const Histogram& getQueueDepthHistogram() const { return _packets.getDepthHistogram(); }
+
+    /// the usecs each packet waited to be sent, since the histograms were reset
+    const Histogram& getQueueWaitTimeHistogram() const { return _packets.getWaitTimeHistogram(); }
+
+    void resetQueueHistograms() { _packets.resetHistograms(); }
 signals:
     void packetSent(quint64);
 protected:
@@ -101,7 +107,10 @@ protected:
     SimpleMovingAverage _averageProcessCallTime;
 
 private:
-    std::vector<NetworkPacket> _packets;
+    void queuePacketForSending(const NetworkPacket& packet);
+
+    PacketQueue _packets;
+    QVector<NetworkPacket> _packetsToSend; // kept between calls to process, so that its storage is reused
     quint64 _lastSendTime;
 
     bool threadedProcess();
@@ -116,9 +125,6 @@ private:
 
     quint64 _totalPacketsQueued;
     quint64 _totalBytesQueued;
-
-    QWaitCondition _hasPackets;
-    QMutex _waitingOnPacketsMutex;
 };
 
 #endif // __shared__PacketSender__
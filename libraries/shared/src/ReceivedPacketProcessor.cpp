@@ -12,37 +12,42 @@
 #include "ReceivedPacketProcessor.h"
 #include "SharedUtil.h"
 
+ReceivedPacketProcessor::ReceivedPacketProcessor() :
+    _packets(),
+    _processBatch(),
+    _packetsLeftInProcessBatch(0)
+{
+}
+
 void ReceivedPacketProcessor::terminating() {
-    _hasPackets.wakeAll();
+    _packets.wake();
+}
+
+void ReceivedPacketProcessor::queueReceivedPacket(const SharedNodePointer& destinationNode, const PacketBuffer& packet) {
+    queueReceivedPacket(NetworkPacket(destinationNode, packet));
 }
 
-void ReceivedPacketProcessor::queueReceivedPacket(const SharedNodePointer& destinationNode, const QByteArray& packet) {
+void ReceivedPacketProcessor::queueReceivedPacket(const NetworkPacket& packet) {
     // Make sure our Node and NodeList knows we've heard from this node.
-    destinationNode->setLastHeardMicrostamp(usecTimestampNow());
-
-    NetworkPacket networkPacket(destinationNode, packet);
-    lock();
-    _packets.push_back(networkPacket);
-    unlock();
-    
-    // Make sure to  wake our actual processing thread because we  now have packets for it to process.
-    _hasPackets.wakeAll();
+    packet.getDestinationNode()->setLastHeardMicrostamp(usecTimestampNow());
+
+    // the queue wakes our processing thread if it is waiting for packets
+    _packets.enqueue(packet);
 }
 
 bool ReceivedPacketProcessor::process() {
 
-    if (_packets.size() == 0) {
-        _waitingOnPacketsMutex.lock();
-        _hasPackets.wait(&_waitingOnPacketsMutex);
-        _waitingOnPacketsMutex.unlock();
-    }
-    while (_packets.size() > 0) {
-        lock(); // lock to make sure nothing changes on us
-        NetworkPacket& packet = _packets.front(); // get the oldest packet
-        NetworkPacket temporary = packet; // make a copy of the packet in case the vector is resized on us
-        _packets.erase(_packets.begin()); // remove the oldest packet
-        unlock(); // let others add to the packets
-        processPacket(temporary.getDestinationNode(), temporary.getByteArray()); // process our temporary copy
+    // returns right away if packets came in since we last looked
+    _packets.waitForPackets();
+
+    // take the oldest packets a batch at a time, which share their bytes rather than copying them
+    while (_packets.dequeue(_processBatch, MAX_PACKETS_PER_PROCESS_BATCH) > 0) {
+        for (int i = 0; i < _processBatch.size(); i++) {
+            _packetsLeftInProcessBatch = _processBatch.size() - i - 1;
+            const NetworkPacket& packet = _processBatch.at(i);
+            processPacketBuffer(packet.getDestinationNode(), packet.getBuffer()); // process it where it is
+        }
+        _processBatch.resize(0); // unlike clear(), keeps the storage for the next batch
     }
     return isStillRunning();  // keep running till they terminate us
 }
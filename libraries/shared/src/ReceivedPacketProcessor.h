@@ -11,29 +11,40 @@
 #ifndef __shared__ReceivedPacketProcessor__
 #define __shared__ReceivedPacketProcessor__
 
-#include <QWaitCondition>
-
 #include "GenericThread.h"
 #include "NetworkPacket.h"
+#include "PacketQueue.h"
+
+/// the most packets taken from the queue at once, to be processed one after another
+const int MAX_PACKETS_PER_PROCESS_BATCH = 64;
 
 /// Generalized threaded processor for handling received inbound packets. 
 class ReceivedPacketProcessor : public GenericThread {
     Q_OBJECT
 public:
-    ReceivedPacketProcessor() { }
+    ReceivedPacketProcessor();
 
-    /// Add packet from network receive thread to the processing queue.
-    /// \param sockaddr& senderAddress the address of the sender
-    /// \param packetData pointer to received data
-    /// \param ssize_t packetLength size of received data
+    /// Add packet from network receive thread to the processing queue, without copying it.
+    /// \param destinationNode the node that sent the packet
+    /// \param packet the buffer the packet was read into
     /// \thread network receive thread
-    void queueReceivedPacket(const SharedNodePointer& destinationNode, const QByteArray& packet);
+    void queueReceivedPacket(const SharedNodePointer& destinationNode, const PacketBuffer& packet);
 
     /// Are there received packets waiting to be processed
-    bool hasPacketsToProcess() const { return _packets.size() > 0; }
+    bool hasPacketsToProcess() const { return packetsToProcessCount() > 0; }
 
-    /// How many received packets waiting are to be processed
-    int packetsToProcessCount() const { return _packets.size(); }
+    /// How many received packets waiting are to be processed, including those taken from the queue with the one being
+    /// processed
+    int packetsToProcessCount() const { return _packets.size() + _packetsLeftInProcessBatch; }
+
+    /// the number of packets waiting to be processed each time some were taken from the queue, since the histograms were
+    /// reset
+    const Histogram& getQueueDepthHistogram() const { return _packets.getDepthHistogram(); }
+
+    /// the usecs each packet waited in the queue, since the histograms were reset
+    const Histogram& getQueueWaitTimeHistogram() const { return _packets.getWaitTimeHistogram(); }
+
+    void resetQueueHistograms() { _packets.resetHistograms(); }
 
 protected:
     /// Callback for processing of recieved packets. Implement this to process the incoming packets.
@@ -41,7 +52,15 @@ protected:
     /// \param packetData pointer to received data
     /// \param ssize_t packetLength size of received data
     /// \thread "this" individual processing thread
-    virtual void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) = 0;
+    /// The packet reads the queued buffer where it is, so copy it to keep any of it after returning. Processors that
+    /// implement processPacketBuffer() instead needn't implement this.
+    virtual void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) { }
+
+    /// Callback for processing of received packets along with the buffer they are in, which calls processPacket(). Implement
+    /// this instead to keep packets past the call, by sharing their buffers rather than copying them.
+    /// \thread "this" individual processing thread
+    virtual void processPacketBuffer(const SharedNodePointer& sendingNode, const PacketBuffer& packet)
+        { processPacket(sendingNode, packet.asByteArray()); }
 
     /// Implements generic processing behavior for this thread.
     virtual bool process();
@@ -49,10 +68,11 @@ protected:
     virtual void terminating();
 
 private:
+    void queueReceivedPacket(const NetworkPacket& packet);
 
-    std::vector<NetworkPacket> _packets;
-    QWaitCondition _hasPackets;
-    QMutex _waitingOnPacketsMutex;
+    PacketQueue _packets;
+    QVector<NetworkPacket> _processBatch;
+    int _packetsLeftInProcessBatch;
 };
 
 #endif // __shared__PacketReceiver__
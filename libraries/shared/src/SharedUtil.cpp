@@ -538,6 +538,69 @@ int unpackOrientationQuatFromBytes(const unsigned char* buffer, glm::quat& quatO
     return sizeof(quatParts);
 }
 
+const int SMALLEST_THREE_COMPONENT_BITS = 15;
+const uint16_t SMALLEST_THREE_COMPONENT_MASK = (1 << SMALLEST_THREE_COMPONENT_BITS) - 1;
+const float SMALLEST_THREE_COMPONENT_RANGE = 0.70710678f; // 1 / sqrt(2)
+
+int packOrientationQuatToSixBytes(unsigned char* buffer, const glm::quat& quatInput) {
+    glm::quat normalized = glm::normalize(quatInput);
+    float components[4] = { normalized.x, normalized.y, normalized.z, normalized.w };
+
+    int largestIndex = 0;
+    for (int i = 1; i < 4; i++) {
+        if (fabsf(components[i]) > fabsf(components[largestIndex])) {
+            largestIndex = i;
+        }
+    }
+
+    // q and -q are the same rotation, so flip the quat if we need to for the dropped component to be positive
+    float sign = (components[largestIndex] < 0.f) ? -1.f : 1.f;
+
+    uint16_t quatParts[3];
+    int partIndex = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i != largestIndex) {
+            float scaled = ((sign * components[i] / SMALLEST_THREE_COMPONENT_RANGE) + 1.f) * 0.5f;
+            scaled = glm::clamp(scaled, 0.f, 1.f);
+            quatParts[partIndex++] = (uint16_t) floorf((scaled * SMALLEST_THREE_COMPONENT_MASK) + 0.5f);
+        }
+    }
+
+    // the index of the largest component rides in the high bits of the first two parts
+    quatParts[0] |= (largestIndex & 1) << SMALLEST_THREE_COMPONENT_BITS;
+    quatParts[1] |= (largestIndex >> 1) << SMALLEST_THREE_COMPONENT_BITS;
+
+    memcpy(buffer, &quatParts, sizeof(quatParts));
+    return sizeof(quatParts);
+}
+
+int unpackOrientationQuatFromSixBytes(const unsigned char* buffer, glm::quat& quatOutput) {
+    uint16_t quatParts[3];
+    memcpy(&quatParts, buffer, sizeof(quatParts));
+
+    int largestIndex = (quatParts[0] >> SMALLEST_THREE_COMPONENT_BITS)
+        | ((quatParts[1] >> SMALLEST_THREE_COMPONENT_BITS) << 1);
+
+    float components[4];
+    float sumOfSquares = 0.f;
+    int partIndex = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i != largestIndex) {
+            float scaled = (quatParts[partIndex++] & SMALLEST_THREE_COMPONENT_MASK) / (float) SMALLEST_THREE_COMPONENT_MASK;
+            components[i] = ((scaled * 2.f) - 1.f) * SMALLEST_THREE_COMPONENT_RANGE;
+            sumOfSquares += components[i] * components[i];
+        }
+    }
+    components[largestIndex] = sqrtf(std::max(0.f, 1.f - sumOfSquares));
+
+    quatOutput.x = components[0];
+    quatOutput.y = components[1];
+    quatOutput.z = components[2];
+    quatOutput.w = components[3];
+
+    return sizeof(quatParts);
+}
+
 float SMALL_LIMIT = 10.f;
 float LARGE_LIMIT = 1000.f;
 
@@ -0,0 +1,65 @@
+//
+//  SipHash.cpp
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+
+#include <QtCore/QtEndian>
+
+#include "SipHash.h"
+
+static inline quint64 rotateLeft(quint64 value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+#define SIP_ROUND \
+    v0 += v1; v1 = rotateLeft(v1, 13); v1 ^= v0; v0 = rotateLeft(v0, 32); \
+    v2 += v3; v3 = rotateLeft(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = rotateLeft(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = rotateLeft(v1, 17); v1 ^= v2; v2 = rotateLeft(v2, 32)
+
+void sipHash128(const char* data, int size, const uchar* key, uchar* hash) {
+    quint64 k0 = qFromLittleEndian<quint64>(key);
+    quint64 k1 = qFromLittleEndian<quint64>(key + sizeof(quint64));
+
+    quint64 v0 = k0 ^ 0x736f6d6570736575ULL;
+    quint64 v1 = k1 ^ 0x646f72616e646f6dULL ^ 0xee;
+    quint64 v2 = k0 ^ 0x6c7967656e657261ULL;
+    quint64 v3 = k1 ^ 0x7465646279746573ULL;
+
+    const uchar* position = reinterpret_cast<const uchar*>(data);
+    const uchar* blocksEnd = position + (size & ~7);
+    for (; position != blocksEnd; position += sizeof(quint64)) {
+        quint64 block = qFromLittleEndian<quint64>(position);
+        v3 ^= block;
+        SIP_ROUND;
+        SIP_ROUND;
+        v0 ^= block;
+    }
+
+    // the last block is what's left over, with the size in its top byte
+    quint64 lastBlock = (quint64)size << 56;
+    for (int i = 0; i < (size & 7); i++) {
+        lastBlock |= (quint64)position[i] << (8 * i);
+    }
+    v3 ^= lastBlock;
+    SIP_ROUND;
+    SIP_ROUND;
+    v0 ^= lastBlock;
+
+    v2 ^= 0xee;
+    SIP_ROUND;
+    SIP_ROUND;
+    SIP_ROUND;
+    SIP_ROUND;
+    qToLittleEndian<quint64>(v0 ^ v1 ^ v2 ^ v3, hash);
+
+    v1 ^= 0xdd;
+    SIP_ROUND;
+    SIP_ROUND;
+    SIP_ROUND;
+    SIP_ROUND;
+    qToLittleEndian<quint64>(v0 ^ v1 ^ v2 ^ v3, hash + sizeof(quint64));
+}
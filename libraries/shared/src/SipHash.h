@@ -0,0 +1,22 @@
+//
+//  SipHash.h
+//  hifi
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 HighFidelity, Inc. All rights reserved.
+//
+//  SipHash-2-4 (Aumasson and Bernstein), a keyed hash that is fast on short inputs like our packets
+//
+
+#ifndef __hifi__SipHash__
+#define __hifi__SipHash__
+
+#include <QtCore/QtGlobal>
+
+const int NUM_BYTES_SIPHASH_KEY = 16;
+const int NUM_BYTES_SIPHASH_128 = 16;
+
+/// computes the 128 bit output variant of SipHash-2-4 of the data, reading it where it is
+void sipHash128(const char* data, int size, const uchar* key, uchar* hash);
+
+#endif /* defined(__hifi__SipHash__) */
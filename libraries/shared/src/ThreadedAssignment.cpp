@@ -60,10 +60,15 @@ void ThreadedAssignment::addPacketStatsAndSendStatsPacket(QJsonObject &statsObje
     
     float packetsPerSecond, bytesPerSecond;
     nodeList->getPacketStats(packetsPerSecond, bytesPerSecond);
+    
+    float packetBuffersPerSecond, packetBufferHeapAllocationsPerSecond;
+    nodeList->getPacketBufferStats(packetBuffersPerSecond, packetBufferHeapAllocationsPerSecond);
     nodeList->resetPacketStats();
     
     statsObject["packets_per_second"] = packetsPerSecond;
     statsObject["bytes_per_second"] = bytesPerSecond;
+    statsObject["packet_buffers_per_second"] = packetBuffersPerSecond;
+    statsObject["packet_buffer_heap_allocations_per_second"] = packetBufferHeapAllocationsPerSecond;
     
     nodeList->sendStatsToDomainServer(statsObject);
 }
@@ -81,15 +86,6 @@ void ThreadedAssignment::checkInWithDomainServerOrExit() {
     }
 }
 
-bool ThreadedAssignment::readAvailableDatagram(QByteArray& destinationByteArray, HifiSockAddr& senderSockAddr) {
-    NodeList* nodeList = NodeList::getInstance();
-    
-    if (nodeList->getNodeSocket().hasPendingDatagrams()) {
-        destinationByteArray.resize(nodeList->getNodeSocket().pendingDatagramSize());
-        nodeList->getNodeSocket().readDatagram(destinationByteArray.data(), destinationByteArray.size(),
-                                               senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
-        return true;
-    } else {
-        return false;
-    }
+bool ThreadedAssignment::readAvailableDatagram(PacketBuffer& datagram, HifiSockAddr& senderSockAddr) {
+    return NodeList::getInstance()->readDatagram(datagram, senderSockAddr);
 }
@@ -12,6 +12,7 @@
 #include <QtCore/QSharedPointer>
 
 #include "Assignment.h"
+#include "PacketBuffer.h"
 
 class ThreadedAssignment : public Assignment {
     Q_OBJECT
@@ -28,7 +29,7 @@ public slots:
     virtual void sendStatsPacket();
 
 protected:
-    bool readAvailableDatagram(QByteArray& destinationByteArray, HifiSockAddr& senderSockAddr);
+    bool readAvailableDatagram(PacketBuffer& datagram, HifiSockAddr& senderSockAddr);
     void commonInit(const QString& targetName, NodeType_t nodeType, bool shouldSendStats = true);
     bool _isFinished;
 private slots:
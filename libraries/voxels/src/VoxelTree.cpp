@@ -560,3 +560,20 @@ int VoxelTree::processEditPacketData(PacketType packetType, const unsigned char*
             return 0;
     }
 }
+
+int VoxelTree::getEditRecordLength(PacketType packetType, const unsigned char* editData, int maxLength) const {
+    // only set records are code and color, an erase packet is read as a whole
+    if (packetType != PacketTypeVoxelSet && packetType != PacketTypeVoxelSetDestructive) {
+        return 0;
+    }
+
+    // records that would overflow are left to processEditPacketData(), which warns about them
+    int octets = numberOfThreeBitSectionsInCode(editData, maxLength);
+    if (octets == OVERFLOWED_OCTCODE_BUFFER) {
+        return 0;
+    }
+
+    const int COLOR_SIZE_IN_BYTES = 3;
+    int voxelDataSize = bytesRequiredForCodeLength(octets) + COLOR_SIZE_IN_BYTES;
+    return voxelDataSize > maxLength ? 0 : voxelDataSize;
+}
@@ -44,6 +44,10 @@ public:
     virtual bool handlesEditPacketType(PacketType packetType) const;
     virtual int processEditPacketData(PacketType packetType, const unsigned char* packetData, int packetLength,
                     const unsigned char* editData, int maxLength, const SharedNodePointer& node);
+    virtual int getEditRecordLength(PacketType packetType, const unsigned char* editData, int maxLength) const;
+    virtual bool canReplayEdits() const { return true; }
+    virtual bool canReadSubtreesConcurrently() const { return true; }
+    virtual bool canCacheEncodedSubtrees() const { return true; }
 
 private:
     // helper functions for nudgeSubTree
@@ -0,0 +1,214 @@
+//
+//  AudioCodecTests.cpp
+//  audio-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <iostream>
+
+#include <AudioCodec.h>
+#include <AudioRingBuffer.h>
+#include <SharedUtil.h>
+
+#include "AudioCodecTests.h"
+
+const int TEST_NUM_FRAMES = 32;
+const int TEST_FRAME_SAMPLES = NETWORK_BUFFER_LENGTH_SAMPLES_STEREO;
+const int TEST_MAX_ENCODED_BYTES = sizeof(int16_t) * TEST_FRAME_SAMPLES;
+
+// fills interleaved stereo frames with two tones and a little noise, which is closer to speech than white noise
+static void generateStereoFrames(int16_t* samples, int numFrames) {
+    const float LEFT_FREQUENCY = 220.0f;
+    const float RIGHT_FREQUENCY = 330.0f;
+    const float AMPLITUDE = MAX_SAMPLE_VALUE / 4.0f;
+    const int NOISE_AMPLITUDE = 200;
+
+    int numSamplesPerChannel = numFrames * TEST_FRAME_SAMPLES / 2;
+    for (int i = 0; i < numSamplesPerChannel; i++) {
+        float time = i / (float) SAMPLE_RATE;
+        samples[i * 2] = AMPLITUDE * sinf(2.0f * PI * LEFT_FREQUENCY * time)
+            + (rand() % (2 * NOISE_AMPLITUDE + 1)) - NOISE_AMPLITUDE;
+        samples[(i * 2) + 1] = AMPLITUDE * sinf(2.0f * PI * RIGHT_FREQUENCY * time)
+            + (rand() % (2 * NOISE_AMPLITUDE + 1)) - NOISE_AMPLITUDE;
+    }
+}
+
+void AudioCodecTests::roundTripsPCM() {
+    int16_t* samples = new int16_t[TEST_FRAME_SAMPLES];
+    generateStereoFrames(samples, 1);
+
+    PCMAudioCodec codec;
+    char encoded[TEST_MAX_ENCODED_BYTES];
+    int16_t decoded[TEST_FRAME_SAMPLES];
+
+    int numEncodedBytes = codec.encode(samples, TEST_FRAME_SAMPLES, 2, encoded);
+    int numDecodedSamples = codec.decode(encoded, numEncodedBytes, decoded, TEST_FRAME_SAMPLES);
+
+    if (numDecodedSamples != TEST_FRAME_SAMPLES) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: decoded " << numDecodedSamples << " samples but we expected " << TEST_FRAME_SAMPLES
+            << std::endl;
+    }
+
+    for (int i = 0; i < numDecodedSamples; i++) {
+        if (decoded[i] != samples[i]) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: sample " << i << " decoded to " << decoded[i] << " but was " << samples[i]
+                << std::endl;
+            break;
+        }
+    }
+
+    delete[] samples;
+}
+
+void AudioCodecTests::roundTripsADPCM() {
+    // ADPCM is lossy, but for tones like these it should stay well above 20dB of signal to noise
+    const float MIN_SIGNAL_TO_NOISE_DB = 20.0f;
+
+    int16_t* samples = new int16_t[TEST_NUM_FRAMES * TEST_FRAME_SAMPLES];
+    generateStereoFrames(samples, TEST_NUM_FRAMES);
+
+    IMAADPCMAudioCodec encoder;
+    char* encodedFrames = new char[TEST_NUM_FRAMES * TEST_MAX_ENCODED_BYTES];
+    int encodedFrameBytes[TEST_NUM_FRAMES];
+
+    for (int frame = 0; frame < TEST_NUM_FRAMES; frame++) {
+        encodedFrameBytes[frame] = encoder.encode(samples + (frame * TEST_FRAME_SAMPLES), TEST_FRAME_SAMPLES, 2,
+                                                  encodedFrames + (frame * TEST_MAX_ENCODED_BYTES));
+
+        if (encodedFrameBytes[frame] > encoder.getMaxEncodedBytes(TEST_FRAME_SAMPLES, 2)) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: frame " << frame << " encoded to " << encodedFrameBytes[frame]
+                << " bytes, more than the maximum of " << encoder.getMaxEncodedBytes(TEST_FRAME_SAMPLES, 2)
+                << std::endl;
+        }
+    }
+
+    // decode the frames backwards, as if every one had been lost or re-ordered, each should still decode the same
+    IMAADPCMAudioCodec decoder;
+    int16_t decoded[TEST_FRAME_SAMPLES];
+    double signalPower = 0.0;
+    double noisePower = 0.0;
+
+    for (int frame = TEST_NUM_FRAMES - 1; frame >= 0; frame--) {
+        int numDecodedSamples = decoder.decode(encodedFrames + (frame * TEST_MAX_ENCODED_BYTES), encodedFrameBytes[frame],
+                                               decoded, TEST_FRAME_SAMPLES);
+
+        if (numDecodedSamples != TEST_FRAME_SAMPLES) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: frame " << frame << " decoded " << numDecodedSamples
+                << " samples but we expected " << TEST_FRAME_SAMPLES
+                << std::endl;
+            continue;
+        }
+
+        const int16_t* original = samples + (frame * TEST_FRAME_SAMPLES);
+        for (int i = 0; i < numDecodedSamples; i++) {
+            double error = decoded[i] - original[i];
+            signalPower += (double) original[i] * original[i];
+            noisePower += error * error;
+        }
+    }
+
+    float signalToNoise = (noisePower > 0.0) ? 10.0f * log10(signalPower / noisePower) : INFINITY;
+    if (signalToNoise < MIN_SIGNAL_TO_NOISE_DB) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: ADPCM round trip has " << signalToNoise << "dB signal to noise, we expected at least "
+            << MIN_SIGNAL_TO_NOISE_DB << "dB"
+            << std::endl;
+    }
+
+    delete[] encodedFrames;
+    delete[] samples;
+}
+
+void AudioCodecTests::rejectsMalformedFrames() {
+    int16_t* samples = new int16_t[TEST_FRAME_SAMPLES];
+    generateStereoFrames(samples, 1);
+
+    IMAADPCMAudioCodec codec;
+    char encoded[TEST_MAX_ENCODED_BYTES];
+    int16_t decoded[TEST_FRAME_SAMPLES];
+
+    int numEncodedBytes = codec.encode(samples, TEST_FRAME_SAMPLES, 2, encoded);
+
+    int numDecodedSamples = codec.decode(encoded, numEncodedBytes - 1, decoded, TEST_FRAME_SAMPLES);
+    if (numDecodedSamples != 0) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: a truncated frame decoded " << numDecodedSamples << " samples"
+            << std::endl;
+    }
+
+    // claim more channels than any frame can have
+    encoded[0] = IMAADPCMAudioCodec::MAX_CHANNELS + 1;
+    numDecodedSamples = codec.decode(encoded, numEncodedBytes, decoded, TEST_FRAME_SAMPLES);
+    if (numDecodedSamples != 0) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: a frame with " << IMAADPCMAudioCodec::MAX_CHANNELS + 1 << " channels decoded "
+            << numDecodedSamples << " samples"
+            << std::endl;
+    }
+
+    delete[] samples;
+}
+
+static void benchmarkCodec(AudioCodec* codec, const char* name) {
+    const int NUM_BENCHMARK_PASSES = 100;
+
+    int16_t* samples = new int16_t[TEST_NUM_FRAMES * TEST_FRAME_SAMPLES];
+    generateStereoFrames(samples, TEST_NUM_FRAMES);
+
+    char* encodedFrames = new char[TEST_NUM_FRAMES * TEST_MAX_ENCODED_BYTES];
+    int encodedFrameBytes[TEST_NUM_FRAMES];
+    int16_t decoded[TEST_FRAME_SAMPLES];
+
+    quint64 encodeUsecs = 0;
+    quint64 decodeUsecs = 0;
+
+    for (int pass = 0; pass < NUM_BENCHMARK_PASSES; pass++) {
+        quint64 startTime = usecTimestampNow();
+        for (int frame = 0; frame < TEST_NUM_FRAMES; frame++) {
+            encodedFrameBytes[frame] = codec->encode(samples + (frame * TEST_FRAME_SAMPLES), TEST_FRAME_SAMPLES, 2,
+                                                     encodedFrames + (frame * TEST_MAX_ENCODED_BYTES));
+        }
+        encodeUsecs += usecTimestampNow() - startTime;
+
+        startTime = usecTimestampNow();
+        for (int frame = 0; frame < TEST_NUM_FRAMES; frame++) {
+            codec->decode(encodedFrames + (frame * TEST_MAX_ENCODED_BYTES), encodedFrameBytes[frame],
+                          decoded, TEST_FRAME_SAMPLES);
+        }
+        decodeUsecs += usecTimestampNow() - startTime;
+    }
+
+    int numFrames = TEST_NUM_FRAMES * NUM_BENCHMARK_PASSES;
+    std::cout << "    " << name << ": " << encodedFrameBytes[0] << " bytes per frame, "
+        << (float) encodeUsecs / numFrames << " usecs to encode, "
+        << (float) decodeUsecs / numFrames << " usecs to decode" << std::endl;
+
+    delete[] encodedFrames;
+    delete[] samples;
+}
+
+void AudioCodecTests::benchmarkCodecs() {
+    std::cout << "coding " << TEST_FRAME_SAMPLES << " sample stereo frames" << std::endl;
+
+    PCMAudioCodec pcmCodec;
+    benchmarkCodec(&pcmCodec, "PCM");
+
+    IMAADPCMAudioCodec adpcmCodec;
+    benchmarkCodec(&adpcmCodec, "IMA ADPCM");
+}
+
+void AudioCodecTests::runAllTests() {
+    roundTripsPCM();
+    roundTripsADPCM();
+    rejectsMalformedFrames();
+    benchmarkCodecs();
+}
@@ -0,0 +1,29 @@
+//
+//  AudioCodecTests.h
+//  audio-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__AudioCodecTests__
+#define __tests__AudioCodecTests__
+
+namespace AudioCodecTests {
+
+    /// checks that PCM frames come back exactly as they went in
+    void roundTripsPCM();
+
+    /// checks that ADPCM frames decode close to the original and that each frame decodes on its own
+    void roundTripsADPCM();
+
+    /// checks that a truncated or malformed frame decodes to nothing instead of reading past its end
+    void rejectsMalformedFrames();
+
+    /// prints the time taken to encode and decode a frame and the bytes each codec puts on the wire
+    void benchmarkCodecs();
+
+    void runAllTests();
+}
+
+#endif // __tests__AudioCodecTests__
@@ -0,0 +1,280 @@
+//
+//  AudioMixKernelTests.cpp
+//  audio-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <mmintrin.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+
+#include <AudioMixKernel.h>
+#include <AudioRingBuffer.h>
+#include <SharedUtil.h>
+
+#include "AudioMixKernelTests.h"
+
+const int TEST_SAMPLE_PHASE_DELAY_AT_90 = 20;
+const int TEST_RING_BUFFER_SAMPLES = NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL * RING_BUFFER_LENGTH_FRAMES;
+
+struct TestSource {
+    int16_t ringBuffer[TEST_RING_BUFFER_SAMPLES];
+    const int16_t* nextOutput;
+    float attenuation;
+    float weakChannelRatio;
+    int numSamplesDelay;
+    int delayedChannelOffset;
+};
+
+static void randomizeSource(TestSource& source, int maxAmplitude) {
+    for (int i = 0; i < TEST_RING_BUFFER_SAMPLES; i++) {
+        source.ringBuffer[i] = (rand() % (2 * maxAmplitude + 1)) - maxAmplitude;
+    }
+
+    // half of the time sit at the start of the ring buffer so the delay samples have to wrap
+    int frame = (rand() % 2 == 0) ? 0 : rand() % RING_BUFFER_LENGTH_FRAMES;
+    source.nextOutput = source.ringBuffer + (frame * NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL);
+
+    source.attenuation = randFloat();
+    source.numSamplesDelay = rand() % (TEST_SAMPLE_PHASE_DELAY_AT_90 + 1);
+    source.weakChannelRatio = 1.0f - (0.5f * source.numSamplesDelay / TEST_SAMPLE_PHASE_DELAY_AT_90);
+    source.delayedChannelOffset = rand() % 2;
+}
+
+static const int16_t* delaySamplesForSource(const TestSource& source) {
+    const int16_t* delayNextOutputStart = source.nextOutput - source.numSamplesDelay;
+    if (delayNextOutputStart < source.ringBuffer) {
+        delayNextOutputStart = source.ringBuffer + TEST_RING_BUFFER_SAMPLES - source.numSamplesDelay;
+    }
+    return delayNextOutputStart;
+}
+
+// the sample loop from AudioMixer::addBufferToMixForListeningNodeWithBuffer before the kernel replaced it
+static void addSourceWithLegacyMix(int16_t* clientSamples, const TestSource& source) {
+    int delayedChannelOffset = source.delayedChannelOffset;
+    int goodChannelOffset = delayedChannelOffset == 0 ? 1 : 0;
+    float attenuationCoefficient = source.attenuation;
+    float weakChannelAmplitudeRatio = source.weakChannelRatio;
+    int numSamplesDelay = source.numSamplesDelay;
+    const int16_t* nextOutputStart = source.nextOutput;
+
+    int16_t correctBufferSample[2], delayBufferSample[2];
+    int delayedChannelIndex = 0;
+
+    const int SINGLE_STEREO_OFFSET = 2;
+
+    for (int s = 0; s < NETWORK_BUFFER_LENGTH_SAMPLES_STEREO; s += 4) {
+        correctBufferSample[0] = nextOutputStart[s / 2] * attenuationCoefficient;
+        correctBufferSample[1] = nextOutputStart[(s / 2) + 1] * attenuationCoefficient;
+
+        delayedChannelIndex = s + (numSamplesDelay * 2) + delayedChannelOffset;
+
+        delayBufferSample[0] = correctBufferSample[0] * weakChannelAmplitudeRatio;
+        delayBufferSample[1] = correctBufferSample[1] * weakChannelAmplitudeRatio;
+
+        __m64 bufferSamples = _mm_set_pi16(clientSamples[s + goodChannelOffset],
+                                           clientSamples[s + goodChannelOffset + SINGLE_STEREO_OFFSET],
+                                           clientSamples[delayedChannelIndex],
+                                           clientSamples[delayedChannelIndex + SINGLE_STEREO_OFFSET]);
+        __m64 addedSamples = _mm_set_pi16(correctBufferSample[0], correctBufferSample[1],
+                                          delayBufferSample[0], delayBufferSample[1]);
+
+        __m64 mmxResult = _mm_adds_pi16(bufferSamples, addedSamples);
+        int16_t* shortResults = reinterpret_cast<int16_t*>(&mmxResult);
+
+        clientSamples[s + goodChannelOffset] = shortResults[3];
+        clientSamples[s + goodChannelOffset + SINGLE_STEREO_OFFSET] = shortResults[2];
+        clientSamples[delayedChannelIndex] = shortResults[1];
+        clientSamples[delayedChannelIndex + SINGLE_STEREO_OFFSET] = shortResults[0];
+    }
+
+    if (numSamplesDelay > 0) {
+        // the legacy loop handled these in batches of four with _mm_adds_pi16, one at a time gives the same result
+        float attenuationAndWeakChannelRatio = attenuationCoefficient * weakChannelAmplitudeRatio;
+        const int16_t* delayNextOutputStart = delaySamplesForSource(source);
+
+        for (int i = 0; i < numSamplesDelay; i++) {
+            int16_t addSample = delayNextOutputStart[i] * attenuationAndWeakChannelRatio;
+            __m64 mmxResult = _mm_adds_pi16(_mm_set_pi16(clientSamples[(i * 2) + delayedChannelOffset], 0, 0, 0),
+                                            _mm_set_pi16(addSample, 0, 0, 0));
+            clientSamples[(i * 2) + delayedChannelOffset] = reinterpret_cast<int16_t*>(&mmxResult)[3];
+        }
+    }
+
+    _mm_empty();
+}
+
+// the same mix done the way AudioMixerWorker does it now
+static void addSourceWithKernel(int32_t channelAccumulators[2][NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL],
+                                const TestSource& source) {
+    int goodChannelOffset = source.delayedChannelOffset == 0 ? 1 : 0;
+
+    AudioMixKernel::addSpatialized(channelAccumulators[goodChannelOffset], channelAccumulators[source.delayedChannelOffset],
+                                   source.nextOutput, source.attenuation, source.weakChannelRatio,
+                                   source.numSamplesDelay, NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL);
+
+    if (source.numSamplesDelay > 0) {
+        AudioMixKernel::addScaled(channelAccumulators[source.delayedChannelOffset], delaySamplesForSource(source),
+                                  source.attenuation * source.weakChannelRatio, source.numSamplesDelay);
+    }
+}
+
+static void mixWithLegacy(const TestSource* sources, int numSources, int16_t* mix) {
+    int16_t clientSamples[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO + (TEST_SAMPLE_PHASE_DELAY_AT_90 * 2)];
+    memset(clientSamples, 0, sizeof(clientSamples));
+
+    for (int i = 0; i < numSources; i++) {
+        addSourceWithLegacyMix(clientSamples, sources[i]);
+    }
+
+    memcpy(mix, clientSamples, NETWORK_BUFFER_LENGTH_BYTES_STEREO);
+}
+
+static void mixWithKernel(const TestSource* sources, int numSources, int16_t* mix) {
+    int32_t channelAccumulators[2][NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL];
+    memset(channelAccumulators, 0, sizeof(channelAccumulators));
+
+    for (int i = 0; i < numSources; i++) {
+        addSourceWithKernel(channelAccumulators, sources[i]);
+    }
+
+    AudioMixKernel::saturateAndInterleave(channelAccumulators[0], channelAccumulators[1], mix,
+                                          NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL);
+}
+
+void AudioMixKernelTests::matchesLegacyMix() {
+    const int NUM_TRIALS = 200;
+    const int MAX_SOURCES = 16;
+
+    // keep every source quiet enough that no partial sum can clip, so both mixes must agree exactly
+    const int MAX_AMPLITUDE = MAX_SAMPLE_VALUE / (MAX_SOURCES * 2);
+
+    TestSource* sources = new TestSource[MAX_SOURCES];
+    int16_t legacyMix[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+    int16_t kernelMix[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+
+    for (int trial = 0; trial < NUM_TRIALS; trial++) {
+        int numSources = 1 + (rand() % MAX_SOURCES);
+        for (int i = 0; i < numSources; i++) {
+            randomizeSource(sources[i], MAX_AMPLITUDE);
+        }
+
+        mixWithLegacy(sources, numSources, legacyMix);
+        mixWithKernel(sources, numSources, kernelMix);
+
+        for (int s = 0; s < NETWORK_BUFFER_LENGTH_SAMPLES_STEREO; s++) {
+            if (legacyMix[s] != kernelMix[s]) {
+                std::cout << __FILE__ << ":" << __LINE__
+                    << " ERROR: trial " << trial << " sample " << s << " kernel mixed " << kernelMix[s]
+                    << " but the legacy mix was " << legacyMix[s]
+                    << std::endl;
+                break;
+            }
+        }
+    }
+
+    delete[] sources;
+}
+
+void AudioMixKernelTests::saturatesClippedMix() {
+    const int NUM_SOURCES = 8;
+
+    TestSource* sources = new TestSource[NUM_SOURCES];
+    for (int i = 0; i < NUM_SOURCES; i++) {
+        for (int s = 0; s < TEST_RING_BUFFER_SAMPLES; s++) {
+            // every source pushes the same direction on even samples and the other direction on odd ones
+            sources[i].ringBuffer[s] = (s % 2 == 0) ? MAX_SAMPLE_VALUE : MIN_SAMPLE_VALUE;
+        }
+        sources[i].nextOutput = sources[i].ringBuffer;
+        sources[i].attenuation = 1.0f;
+        sources[i].weakChannelRatio = 1.0f;
+        sources[i].numSamplesDelay = 0;
+        sources[i].delayedChannelOffset = i % 2;
+    }
+
+    int16_t kernelMix[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+    mixWithKernel(sources, NUM_SOURCES, kernelMix);
+
+    for (int s = 0; s < NETWORK_BUFFER_LENGTH_SAMPLES_STEREO; s++) {
+        int16_t expectedSample = ((s / 2) % 2 == 0) ? MAX_SAMPLE_VALUE : MIN_SAMPLE_VALUE;
+        if (kernelMix[s] != expectedSample) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: sample " << s << " is " << kernelMix[s]
+                << " but we expected " << expectedSample
+                << std::endl;
+            break;
+        }
+    }
+
+    delete[] sources;
+}
+
+void AudioMixKernelTests::addsAccumulatedMix() {
+    // an odd length so the scalar tail is exercised too
+    const int NUM_SAMPLES = NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL - 3;
+
+    int32_t accumulator[NUM_SAMPLES];
+    int32_t premix[NUM_SAMPLES];
+    int32_t expected[NUM_SAMPLES];
+
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+        accumulator[i] = (rand() % (4 * MAX_SAMPLE_VALUE + 1)) - (2 * MAX_SAMPLE_VALUE);
+        premix[i] = (rand() % (4 * MAX_SAMPLE_VALUE + 1)) - (2 * MAX_SAMPLE_VALUE);
+        expected[i] = accumulator[i] + premix[i];
+    }
+
+    AudioMixKernel::addAccumulated(accumulator, premix, NUM_SAMPLES);
+
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+        if (accumulator[i] != expected[i]) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: sample " << i << " accumulated to " << accumulator[i]
+                << " but we expected " << expected[i]
+                << std::endl;
+            break;
+        }
+    }
+}
+
+void AudioMixKernelTests::benchmarkMix() {
+    const int NUM_SOURCES = 32;
+    const int NUM_FRAMES = 10000;
+
+    TestSource* sources = new TestSource[NUM_SOURCES];
+    for (int i = 0; i < NUM_SOURCES; i++) {
+        randomizeSource(sources[i], MAX_SAMPLE_VALUE / NUM_SOURCES);
+    }
+
+    int16_t mix[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+
+    quint64 startTime = usecTimestampNow();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+        mixWithLegacy(sources, NUM_SOURCES, mix);
+    }
+    quint64 legacyUsecs = usecTimestampNow() - startTime;
+
+    startTime = usecTimestampNow();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+        mixWithKernel(sources, NUM_SOURCES, mix);
+    }
+    quint64 kernelUsecs = usecTimestampNow() - startTime;
+
+    std::cout << "mixing " << NUM_SOURCES << " sources for " << NUM_FRAMES << " frames" << std::endl;
+    std::cout << "    legacy MMX: " << legacyUsecs << " usecs ("
+        << (float) legacyUsecs / NUM_FRAMES << " usecs per frame)" << std::endl;
+    std::cout << "    " << AudioMixKernel::getImplementationName() << " kernel: " << kernelUsecs << " usecs ("
+        << (float) kernelUsecs / NUM_FRAMES << " usecs per frame)" << std::endl;
+
+    delete[] sources;
+}
+
+void AudioMixKernelTests::runAllTests() {
+    matchesLegacyMix();
+    saturatesClippedMix();
+    addsAccumulatedMix();
+    benchmarkMix();
+}
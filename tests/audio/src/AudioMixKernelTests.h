@@ -0,0 +1,29 @@
+//
+//  AudioMixKernelTests.h
+//  audio-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__AudioMixKernelTests__
+#define __tests__AudioMixKernelTests__
+
+namespace AudioMixKernelTests {
+
+    /// compares the kernel against the MMX mixing loop it replaced for mixes that never clip
+    void matchesLegacyMix();
+
+    /// checks that a mix which clips is saturated to the int16 range
+    void saturatesClippedMix();
+
+    /// checks that adding a pre-mix to an accumulator matches adding it one sample at a time
+    void addsAccumulatedMix();
+
+    /// prints the time taken to mix a frame with the legacy loop and with the kernel
+    void benchmarkMix();
+
+    void runAllTests();
+}
+
+#endif // __tests__AudioMixKernelTests__
@@ -0,0 +1,13 @@
+//
+//  main.cpp
+//  audio-tests
+//
+
+#include "AudioCodecTests.h"
+#include "AudioMixKernelTests.h"
+
+int main(int argc, char** argv) {
+    AudioMixKernelTests::runAllTests();
+    AudioCodecTests::runAllTests();
+    return 0;
+}
@@ -0,0 +1,323 @@
+//
+//  AvatarDataTests.cpp
+//  avatars-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <math.h>
+
+#include <iostream>
+
+#include <AvatarData.h>
+#include <AvatarStateDelta.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "AvatarDataTests.h"
+
+const int TEST_NUM_JOINTS = 50;
+const int TEST_NUM_BLENDSHAPES = 46;
+
+// the avatar-mixer re-packs what it gets, so both of the tolerances below are for one trip through the packer
+const float MAX_JOINT_ROTATION_ERROR_DEGREES = 0.02f;
+const float MAX_BLENDSHAPE_ERROR = 1.0f / 255.0f;
+
+// lets the tests turn on faceshift data, which is otherwise only set by the interface's Head
+class TestHeadData : public HeadData {
+public:
+    TestHeadData(AvatarData* owningAvatar) : HeadData(owningAvatar) { }
+
+    void setFaceshiftData(const QVector<float>& blendshapeCoefficients, float pupilDilation) {
+        _isFaceshiftConnected = true;
+        _blendshapeCoefficients = blendshapeCoefficients;
+        _pupilDilation = pupilDilation;
+    }
+};
+
+class TestAvatarData : public AvatarData {
+public:
+    TestAvatarData() {
+        _headData = new TestHeadData(this);
+        _headData->setPupilDilation(0.0f);
+    }
+
+    TestHeadData* getTestHeadData() { return static_cast<TestHeadData*>(_headData); }
+};
+
+static glm::quat randomRotation() {
+    glm::vec3 axis(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f));
+    if (glm::length(axis) < EPSILON) {
+        axis = glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+    return glm::angleAxis(randFloatInRange(-PI, PI), glm::normalize(axis));
+}
+
+// the angle of the rotation between the two, which stays accurate for tiny angles where acos of the dot does not
+static float rotationErrorDegrees(const glm::quat& expected, const glm::quat& actual) {
+    glm::quat difference = glm::inverse(expected) * actual;
+    float sine = glm::length(glm::vec3(difference.x, difference.y, difference.z));
+    return glm::degrees(2.0f * asinf(glm::min(sine, 1.0f)));
+}
+
+static void setupTestAvatar(TestAvatarData& avatar) {
+    avatar.setPosition(glm::vec3(randFloatInRange(-100.0f, 100.0f), 1.0f, randFloatInRange(-100.0f, 100.0f)));
+    avatar.setBodyYaw(randFloatInRange(-180.0f, 180.0f));
+    avatar.setAudioLoudness(randFloatInRange(0.0f, MAX_AUDIO_LOUDNESS));
+
+    for (int i = 0; i < TEST_NUM_JOINTS; i++) {
+        // leave a few joints for the skeleton to animate itself
+        if (i % 7 == 3) {
+            avatar.clearJointData(i);
+        } else {
+            avatar.setJointData(i, randomRotation());
+        }
+    }
+
+    QVector<float> blendshapeCoefficients(TEST_NUM_BLENDSHAPES);
+    for (int i = 0; i < TEST_NUM_BLENDSHAPES; i++) {
+        blendshapeCoefficients[i] = randFloat();
+    }
+    avatar.getTestHeadData()->setFaceshiftData(blendshapeCoefficients, 0.5f);
+}
+
+void AvatarDataTests::roundTripsSmallestThreeQuaternions() {
+    const int NUM_RANDOM_ROTATIONS = 10000;
+
+    QVector<glm::quat> rotations;
+    rotations << glm::quat() << glm::quat(-1.0f, 0.0f, 0.0f, 0.0f)
+        << glm::angleAxis(PI, glm::vec3(1.0f, 0.0f, 0.0f))
+        << glm::angleAxis(PI, glm::vec3(0.0f, 1.0f, 0.0f))
+        << glm::angleAxis(PI, glm::vec3(0.0f, 0.0f, 1.0f))
+        << glm::angleAxis(PI / 2.0f, glm::normalize(glm::vec3(1.0f, 1.0f, 1.0f)));
+    for (int i = 0; i < NUM_RANDOM_ROTATIONS; i++) {
+        rotations << randomRotation();
+    }
+
+    float maxErrorDegrees = 0.0f;
+    foreach (const glm::quat& rotation, rotations) {
+        unsigned char packed[6];
+        int numPackedBytes = packOrientationQuatToSixBytes(packed, rotation);
+
+        glm::quat unpacked;
+        int numUnpackedBytes = unpackOrientationQuatFromSixBytes(packed, unpacked);
+
+        if (numPackedBytes != sizeof(packed) || numUnpackedBytes != sizeof(packed)) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: packed " << numPackedBytes << " bytes and unpacked " << numUnpackedBytes
+                << " bytes but we expected " << sizeof(packed) << std::endl;
+            return;
+        }
+
+        maxErrorDegrees = glm::max(maxErrorDegrees, rotationErrorDegrees(rotation, unpacked));
+    }
+
+    if (maxErrorDegrees > MAX_JOINT_ROTATION_ERROR_DEGREES) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: rotations came back up to " << maxErrorDegrees << " degrees off, we allow "
+            << MAX_JOINT_ROTATION_ERROR_DEGREES << std::endl;
+    }
+}
+
+void AvatarDataTests::roundTripsAvatarData() {
+    TestAvatarData sentAvatar;
+    setupTestAvatar(sentAvatar);
+
+    QByteArray packet = byteArrayWithPopulatedHeader(PacketTypeAvatarData);
+    int numHeaderBytes = packet.size();
+    packet.append(sentAvatar.toByteArray());
+
+    TestAvatarData receivedAvatar;
+    int numParsedBytes = receivedAvatar.parseDataAtOffset(packet, numHeaderBytes);
+
+    if (numParsedBytes != packet.size() - numHeaderBytes) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: parsed " << numParsedBytes << " bytes but we expected " << packet.size() - numHeaderBytes
+            << std::endl;
+    }
+
+    if (receivedAvatar.getPosition() != sentAvatar.getPosition()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: position did not come back exactly" << std::endl;
+    }
+
+    const QVector<JointData>& sentJoints = sentAvatar.getJointData();
+    const QVector<JointData>& receivedJoints = receivedAvatar.getJointData();
+    if (receivedJoints.size() != sentJoints.size()) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: got " << receivedJoints.size() << " joints but we expected " << sentJoints.size() << std::endl;
+        return;
+    }
+
+    for (int i = 0; i < sentJoints.size(); i++) {
+        if (receivedJoints[i].valid != sentJoints[i].valid) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: validity of joint " << i << " did not match" << std::endl;
+        } else if (sentJoints[i].valid) {
+            float errorDegrees = rotationErrorDegrees(sentJoints[i].rotation, receivedJoints[i].rotation);
+            if (errorDegrees > MAX_JOINT_ROTATION_ERROR_DEGREES) {
+                std::cout << __FILE__ << ":" << __LINE__
+                    << " ERROR: joint " << i << " came back " << errorDegrees << " degrees off" << std::endl;
+            }
+        }
+    }
+
+    const QVector<float>& sentBlendshapes = sentAvatar.getHeadData()->getBlendshapeCoefficients();
+    const QVector<float>& receivedBlendshapes = receivedAvatar.getHeadData()->getBlendshapeCoefficients();
+    if (receivedBlendshapes.size() != sentBlendshapes.size()) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: got " << receivedBlendshapes.size() << " blendshapes but we expected "
+            << sentBlendshapes.size() << std::endl;
+        return;
+    }
+
+    for (int i = 0; i < sentBlendshapes.size(); i++) {
+        if (fabsf(receivedBlendshapes[i] - sentBlendshapes[i]) > MAX_BLENDSHAPE_ERROR) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: blendshape " << i << " came back as " << receivedBlendshapes[i]
+                << " but we sent " << sentBlendshapes[i] << std::endl;
+        }
+    }
+}
+
+static void checkStateRoundTrip(const QByteArray& state, const QByteArray* baseState, const char* description) {
+    QByteArray packed(maxPackedAvatarStateBytes(state.size()), 0);
+    int numPackedBytes = packAvatarState(state, baseState, reinterpret_cast<unsigned char*>(packed.data()));
+    const unsigned char* packedData = reinterpret_cast<const unsigned char*>(packed.constData());
+
+    int numMeasuredBytes = numBytesForPackedAvatarState(packedData, numPackedBytes, baseState != NULL);
+    if (numMeasuredBytes != numPackedBytes) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << description << " packed " << numPackedBytes
+            << " bytes but measured as " << numMeasuredBytes << std::endl;
+    }
+
+    QByteArray unpacked;
+    int numUnpackedBytes = unpackAvatarState(packedData, numPackedBytes, baseState, unpacked);
+    if (numUnpackedBytes != numPackedBytes || unpacked != state) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << description << " did not come back exactly" << std::endl;
+    }
+
+    if (numPackedBytes > 0 && unpackAvatarState(packedData, numPackedBytes - 1, baseState, unpacked) != -1) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << description << " unpacked from a truncated buffer"
+            << std::endl;
+    }
+}
+
+void AvatarDataTests::roundTripsStateDeltas() {
+    TestAvatarData avatar;
+    setupTestAvatar(avatar);
+    QByteArray baseState = avatar.toByteArray();
+
+    checkStateRoundTrip(baseState, NULL, "whole state");
+    checkStateRoundTrip(baseState, &baseState, "unchanged state");
+
+    avatar.setAudioLoudness(avatar.getAudioLoudness() + 1.0f);
+    avatar.setJointData(0, randomRotation());
+    avatar.setJointData(TEST_NUM_JOINTS - 1, randomRotation());
+    QByteArray changedState = avatar.toByteArray();
+    checkStateRoundTrip(changedState, &baseState, "state with a few changes");
+
+    // a chat message shifts everything after it
+    avatar.setChatMessage(std::string("hello"));
+    QByteArray longerState = avatar.toByteArray();
+    checkStateRoundTrip(longerState, &baseState, "longer state");
+    checkStateRoundTrip(baseState, &longerState, "shorter state");
+
+    // a delta needs every word it left out to be in the base it is unpacked against
+    QByteArray packed(maxPackedAvatarStateBytes(longerState.size()), 0);
+    int numPackedBytes = packAvatarState(longerState, &longerState, reinterpret_cast<unsigned char*>(packed.data()));
+    QByteArray truncatedBase = longerState.left(longerState.size() / 2);
+    QByteArray unpacked;
+    if (unpackAvatarState(reinterpret_cast<const unsigned char*>(packed.constData()), numPackedBytes,
+                          &truncatedBase, unpacked) != -1) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: unpacked a delta against a base that was too short"
+            << std::endl;
+    }
+
+    // a history only hands back the state it was asked for, and a late state cannot push out a newer one
+    AvatarStateHistory history;
+    *history.getBufferForState(AVATAR_STATE_HISTORY_SIZE + 1) = changedState;
+    if (history.getBufferForState(1)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: an old state replaced a newer one" << std::endl;
+    }
+    if (history.getState(1) || !history.getState(AVATAR_STATE_HISTORY_SIZE + 1)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the history handed back the wrong state" << std::endl;
+    }
+}
+
+static void benchmarkDelta(const QByteArray& state, const QByteArray& baseState, const char* name) {
+    const int NUM_BENCHMARK_PASSES = 10000;
+
+    QByteArray packed(maxPackedAvatarStateBytes(state.size()), 0);
+    unsigned char* packedData = reinterpret_cast<unsigned char*>(packed.data());
+    int numPackedBytes = 0;
+
+    quint64 startTime = usecTimestampNow();
+    for (int pass = 0; pass < NUM_BENCHMARK_PASSES; pass++) {
+        numPackedBytes = packAvatarState(state, &baseState, packedData);
+    }
+    quint64 packUsecs = usecTimestampNow() - startTime;
+
+    const int BULK_AVATAR_PAYLOAD_BYTES = MAX_PACKET_SIZE - MAX_PACKET_HEADER_BYTES - sizeof(quint16);
+    int numEntryBytes = BULK_AVATAR_DATA_ENTRY_HEADER_BYTES + numPackedBytes;
+
+    std::cout << "    " << name << ": " << numEntryBytes << " bytes, "
+        << BULK_AVATAR_PAYLOAD_BYTES / numEntryBytes << " avatars per bulk packet, "
+        << (float) packUsecs / NUM_BENCHMARK_PASSES << " usecs to pack" << std::endl;
+}
+
+void AvatarDataTests::benchmarkBytesPerAvatar() {
+    TestAvatarData avatar;
+    setupTestAvatar(avatar);
+    QByteArray baseState = avatar.toByteArray();
+
+    int numValidJoints = 0;
+    foreach (const JointData& joint, avatar.getJointData()) {
+        numValidJoints += joint.valid ? 1 : 0;
+    }
+
+    // version 3 sent each rotation in eight bytes and each blendshape as a float
+    const int V3_EXTRA_BYTES_PER_JOINT = 2;
+    const int V3_EXTRA_BYTES_PER_BLENDSHAPE = sizeof(float) - 1;
+    int numV3EntryBytes = NUM_BYTES_RFC4122_UUID + baseState.size()
+        + (numValidJoints * V3_EXTRA_BYTES_PER_JOINT) + (TEST_NUM_BLENDSHAPES * V3_EXTRA_BYTES_PER_BLENDSHAPE);
+    int numWholeEntryBytes = BULK_AVATAR_DATA_ENTRY_HEADER_BYTES + sizeof(quint16) + baseState.size();
+
+    std::cout << "bytes per avatar with " << numValidJoints << " joints and " << TEST_NUM_BLENDSHAPES
+        << " blendshapes" << std::endl;
+    std::cout << "    version 3: " << numV3EntryBytes << " bytes" << std::endl;
+    std::cout << "    whole state: " << numWholeEntryBytes << " bytes" << std::endl;
+
+    // standing still and talking, only the loudness and face move
+    avatar.setAudioLoudness(avatar.getAudioLoudness() + 1.0f);
+    QVector<float> blendshapeCoefficients(TEST_NUM_BLENDSHAPES);
+    for (int i = 0; i < TEST_NUM_BLENDSHAPES; i++) {
+        blendshapeCoefficients[i] = randFloat();
+    }
+    avatar.getTestHeadData()->setFaceshiftData(blendshapeCoefficients, 0.5f);
+    benchmarkDelta(avatar.toByteArray(), baseState, "talking");
+
+    // walking, the body and about half of the skeleton move
+    TestAvatarData walkingAvatar;
+    setupTestAvatar(walkingAvatar);
+    QByteArray walkingBaseState = walkingAvatar.toByteArray();
+    walkingAvatar.setPosition(walkingAvatar.getPosition() + glm::vec3(0.02f, 0.0f, 0.01f));
+    walkingAvatar.setBodyYaw(walkingAvatar.getBodyYaw() + 0.5f);
+    for (int i = 0; i < TEST_NUM_JOINTS; i += 2) {
+        walkingAvatar.setJointData(i, randomRotation());
+    }
+    benchmarkDelta(walkingAvatar.toByteArray(), walkingBaseState, "walking");
+
+    // idle, nothing but the loudness changes
+    TestAvatarData idleAvatar;
+    setupTestAvatar(idleAvatar);
+    QByteArray idleBaseState = idleAvatar.toByteArray();
+    idleAvatar.setAudioLoudness(idleAvatar.getAudioLoudness() + 1.0f);
+    benchmarkDelta(idleAvatar.toByteArray(), idleBaseState, "idle");
+}
+
+void AvatarDataTests::runAllTests() {
+    roundTripsSmallestThreeQuaternions();
+    roundTripsAvatarData();
+    roundTripsStateDeltas();
+    benchmarkBytesPerAvatar();
+}
@@ -0,0 +1,29 @@
+//
+//  AvatarDataTests.h
+//  avatars-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__AvatarDataTests__
+#define __tests__AvatarDataTests__
+
+namespace AvatarDataTests {
+
+    /// checks that joint rotations packed as their three smallest components come back within a small angle
+    void roundTripsSmallestThreeQuaternions();
+
+    /// checks that a whole avatar comes back from its packed form, with blendshapes within one step of a byte
+    void roundTripsAvatarData();
+
+    /// checks that states packed against a base rebuild exactly, and that truncated or mismatched ones are rejected
+    void roundTripsStateDeltas();
+
+    /// prints the bytes a whole and a delta packed avatar take up in a bulk avatar packet and how long they take
+    void benchmarkBytesPerAvatar();
+
+    void runAllTests();
+}
+
+#endif // __tests__AvatarDataTests__
@@ -0,0 +1,11 @@
+//
+//  main.cpp
+//  avatars-tests
+//
+
+#include "AvatarDataTests.h"
+
+int main(int argc, char** argv) {
+    AvatarDataTests::runAllTests();
+    return 0;
+}
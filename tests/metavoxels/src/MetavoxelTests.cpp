@@ -127,6 +127,243 @@ static bool testSerialization(Bitstream::MetadataType metadataType) {
     return false;
 }
 
+enum BitstreamFuzzOperation { FUZZ_BOOL, FUZZ_INT, FUZZ_UINT, FUZZ_FLOAT, FUZZ_VEC3, FUZZ_BYTES, FUZZ_BITS, FUZZ_FLUSH,
+    FUZZ_OPERATION_COUNT };
+
+class BitstreamFuzzValue {
+public:
+    int operation;
+    int intValue;
+    glm::vec3 vec3Value;
+    QByteArray bytes;
+    int bits;
+    int offset;
+};
+
+static bool testBitstreamRoundTrip() {
+    const int ROUNDS = 1000;
+    const int MAX_VALUES = 100;
+    for (int round = 0; round < ROUNDS; round++) {
+        QByteArray array;
+        QDataStream outStream(&array, QIODevice::WriteOnly);
+        Bitstream out(outStream);
+        ReferenceBitWriter reference;
+        
+        QVector<BitstreamFuzzValue> values(randIntInRange(1, MAX_VALUES));
+        for (int i = 0; i < values.size(); i++) {
+            BitstreamFuzzValue& value = values[i];
+            value.operation = rand() % FUZZ_OPERATION_COUNT;
+            value.intValue = rand() * (randomBoolean() ? 1 : -1);
+            value.vec3Value = glm::vec3(randFloat(), -randFloat(), randFloat());
+            value.bits = value.offset = 0;
+            switch (value.operation) {
+                case FUZZ_BOOL: {
+                    bool boolValue = value.intValue & 1;
+                    out << boolValue;
+                    reference.write(&boolValue, 1);
+                    break;
+                }
+                case FUZZ_INT:
+                    out << value.intValue;
+                    reference.write(&value.intValue, 32);
+                    break;
+                    
+                case FUZZ_UINT: {
+                    uint uintValue = value.intValue;
+                    out << uintValue;
+                    reference.write(&uintValue, 32);
+                    break;
+                }
+                case FUZZ_FLOAT:
+                    out << value.vec3Value.x;
+                    reference.write(&value.vec3Value.x, 32);
+                    break;
+                    
+                case FUZZ_VEC3:
+                    out << value.vec3Value;
+                    reference.write(&value.vec3Value.x, 32);
+                    reference.write(&value.vec3Value.y, 32);
+                    reference.write(&value.vec3Value.z, 32);
+                    break;
+                    
+                case FUZZ_BYTES: {
+                    // mostly short strings, now and then one long enough to go straight to the underlying stream
+                    const int MAX_SHORT_BYTES = 64;
+                    const int MAX_LONG_BYTES = 4096;
+                    value.bytes = createRandomBytes(0, (rand() % 10 == 0) ? MAX_LONG_BYTES : MAX_SHORT_BYTES);
+                    out << value.bytes;
+                    int size = value.bytes.size();
+                    reference.write(&size, 32);
+                    reference.write(value.bytes.constData(), size * BITS_IN_BYTE);
+                    break;
+                }
+                case FUZZ_BITS: {
+                    const int MAX_BITS = 300;
+                    value.bits = randIntInRange(1, MAX_BITS);
+                    value.offset = rand() % BITS_IN_BYTE;
+                    value.bytes = createRandomBytes((value.offset + value.bits) / BITS_IN_BYTE + 1,
+                        (value.offset + value.bits) / BITS_IN_BYTE + 1);
+                    out.write(value.bytes.constData(), value.bits, value.offset);
+                    reference.write(value.bytes.constData(), value.bits, value.offset);
+                    break;
+                }
+                case FUZZ_FLUSH:
+                    out.flush();
+                    reference.flush();
+                    break;
+            }
+        }
+        out.flush();
+        reference.flush();
+        
+        if (array != reference.getBytes()) {
+            qDebug() << "Bitstream wrote different bytes than the reference writer." << round << array.size() <<
+                reference.getBytes().size();
+            return true;
+        }
+        
+        QDataStream inStream(array);
+        Bitstream in(inStream);
+        for (int i = 0; i < values.size(); i++) {
+            const BitstreamFuzzValue& value = values.at(i);
+            bool matches = true;
+            switch (value.operation) {
+                case FUZZ_BOOL: {
+                    bool boolValue;
+                    in >> boolValue;
+                    matches = (boolValue == (bool)(value.intValue & 1));
+                    break;
+                }
+                case FUZZ_INT: {
+                    int intValue;
+                    in >> intValue;
+                    matches = (intValue == value.intValue);
+                    break;
+                }
+                case FUZZ_UINT: {
+                    uint uintValue;
+                    in >> uintValue;
+                    matches = (uintValue == (uint)value.intValue);
+                    break;
+                }
+                case FUZZ_FLOAT: {
+                    float floatValue;
+                    in >> floatValue;
+                    matches = (floatValue == value.vec3Value.x);
+                    break;
+                }
+                case FUZZ_VEC3: {
+                    glm::vec3 vec3Value;
+                    in >> vec3Value;
+                    matches = (vec3Value == value.vec3Value);
+                    break;
+                }
+                case FUZZ_BYTES: {
+                    QByteArray bytes;
+                    in >> bytes;
+                    matches = (bytes == value.bytes);
+                    break;
+                }
+                case FUZZ_BITS: {
+                    // the bits around the ones read must be left as they were
+                    QByteArray bytes = createRandomBytes(value.bytes.size(), value.bytes.size());
+                    QByteArray expected = bytes;
+                    for (int bit = value.offset; bit < value.offset + value.bits; bit++) {
+                        int mask = 1 << (bit % BITS_IN_BYTE);
+                        char& expectedByte = expected.data()[bit / BITS_IN_BYTE];
+                        expectedByte = (expectedByte & ~mask) | (value.bytes.at(bit / BITS_IN_BYTE) & mask);
+                    }
+                    in.read(bytes.data(), value.bits, value.offset);
+                    matches = (bytes == expected);
+                    break;
+                }
+                case FUZZ_FLUSH:
+                    in.reset();
+                    break;
+            }
+            if (!matches) {
+                qDebug() << "Bitstream read back a different value." << round << i << value.operation;
+                return true;
+            }
+        }
+        if (inStream.status() != QDataStream::Ok || !inStream.atEnd()) {
+            qDebug() << "Bitstream didn't read exactly the bytes written." << round << inStream.status();
+            return true;
+        }
+    }
+    return false;
+}
+
+static void testBitstreamThroughput() {
+    const int BOOLS_PER_VALUE = 3;
+    const int UNALIGNED_BITS = 12;
+    const int VALUES = 1000000;
+    int unalignedValue = 0xABC;
+    QByteArray bytes = createRandomBytes(1024, 1024);
+    
+    QByteArray array;
+    QDataStream outStream(&array, QIODevice::WriteOnly);
+    Bitstream out(outStream);
+    ReferenceBitWriter reference;
+    
+    // a mix of flags, unaligned fields, whole words and now and then a longer string
+    const int BYTES_INTERVAL = 64;
+    quint64 startTime = usecTimestampNow();
+    for (int i = 0; i < VALUES; i++) {
+        for (int j = 0; j < BOOLS_PER_VALUE; j++) {
+            out << (bool)((i >> j) & 1);
+        }
+        out.write(&unalignedValue, UNALIGNED_BITS);
+        out << i;
+        if (i % BYTES_INTERVAL == 0) {
+            out << bytes;
+        }
+    }
+    out.flush();
+    quint64 writeTime = usecTimestampNow() - startTime;
+    
+    startTime = usecTimestampNow();
+    for (int i = 0; i < VALUES; i++) {
+        for (int j = 0; j < BOOLS_PER_VALUE; j++) {
+            bool value = (i >> j) & 1;
+            reference.write(&value, 1);
+        }
+        reference.write(&unalignedValue, UNALIGNED_BITS);
+        reference.write(&i, 32);
+        if (i % BYTES_INTERVAL == 0) {
+            int size = bytes.size();
+            reference.write(&size, 32);
+            reference.write(bytes.constData(), size * BITS_IN_BYTE);
+        }
+    }
+    reference.flush();
+    quint64 referenceWriteTime = usecTimestampNow() - startTime;
+    
+    QDataStream inStream(array);
+    Bitstream in(inStream);
+    startTime = usecTimestampNow();
+    for (int i = 0; i < VALUES; i++) {
+        bool boolValue;
+        for (int j = 0; j < BOOLS_PER_VALUE; j++) {
+            in >> boolValue;
+        }
+        int value = 0;
+        in.read(&value, UNALIGNED_BITS);
+        in >> value;
+        if (i % BYTES_INTERVAL == 0) {
+            in >> bytes;
+        }
+    }
+    quint64 readTime = usecTimestampNow() - startTime;
+    
+    const float BYTES_PER_MEGABYTE = 1024.0f * 1024.0f;
+    const float USECS_PER_SECOND = 1000000.0f;
+    float megabytes = array.size() / BYTES_PER_MEGABYTE;
+    qDebug() << "Wrote" << megabytes << "MB at" << megabytes * USECS_PER_SECOND / qMax(writeTime, (quint64)1) << "MB/s," <<
+        "byte at a time reference at" << megabytes * USECS_PER_SECOND / qMax(referenceWriteTime, (quint64)1) << "MB/s";
+    qDebug() << "Read" << megabytes << "MB at" << megabytes * USECS_PER_SECOND / qMax(readTime, (quint64)1) << "MB/s";
+}
+
 bool MetavoxelTests::run() {
     
     qDebug() << "Running transmission tests...";
@@ -165,6 +402,15 @@ bool MetavoxelTests::run() {
         return true;
     }
     
+    qDebug() << "Running bitstream tests...";
+    qDebug();
+    
+    if (testBitstreamRoundTrip()) {
+        return true;
+    }
+    testBitstreamThroughput();
+    qDebug();
+    
     qDebug() << "All tests passed!";
     
     return false;
@@ -414,3 +660,32 @@ TestSharedObjectB::TestSharedObjectB(float foo, const QByteArray& bar) :
 TestSharedObjectB::~TestSharedObjectB() {
     sharedObjectsDestroyed++;
 }
+
+ReferenceBitWriter::ReferenceBitWriter() :
+        _byte(0),
+        _position(0) {
+}
+
+void ReferenceBitWriter::write(const void* data, int bits, int offset) {
+    const quint8* source = (const quint8*)data;
+    while (bits > 0) {
+        int bitsToWrite = qMin(BITS_IN_BYTE - _position, qMin(BITS_IN_BYTE - offset, bits));
+        _byte |= ((*source >> offset) & ((1 << bitsToWrite) - 1)) << _position;
+        if ((_position += bitsToWrite) == BITS_IN_BYTE) {
+            flush();
+        }
+        if ((offset += bitsToWrite) == BITS_IN_BYTE) {
+            source++;
+            offset = 0;
+        }
+        bits -= bitsToWrite;
+    }
+}
+
+void ReferenceBitWriter::flush() {
+    if (_position != 0) {
+        _bytes.append((char)_byte);
+        _byte = 0;
+        _position = 0;
+    }
+}
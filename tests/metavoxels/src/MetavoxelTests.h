@@ -157,4 +157,23 @@ public:
 
 DECLARE_STREAMABLE_METATYPE(SequencedTestMessage)
 
+/// Writes bits a byte at a time, as Bitstream did before it gathered them into words; used for checking that the bytes
+/// it writes are still the same.
+class ReferenceBitWriter {
+public:
+    
+    ReferenceBitWriter();
+    
+    void write(const void* data, int bits, int offset = 0);
+    void flush();
+    
+    const QByteArray& getBytes() const { return _bytes; }
+    
+private:
+    
+    QByteArray _bytes;
+    quint8 _byte;
+    int _position;
+};
+
 #endif /* defined(__interface__MetavoxelTests__) */
@@ -0,0 +1,27 @@
+//
+//  DatagramBatchTests.h
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__DatagramBatchTests__
+#define __tests__DatagramBatchTests__
+
+namespace DatagramBatchTests {
+
+    /// checks that datagrams sent in batches arrive whole and in order, with the right sender, when read in batches
+    void testBatchesRoundTrip();
+
+    /// checks that the last of the datagrams of a batch too large for a pooled buffer arrives whole, along with the
+    /// ordinary ones around it
+    void testLargeDatagramsInOneBatch();
+
+    /// prints how many datagrams a second make it across loopback one at a time and in batches
+    void benchmarkLoopback();
+
+    void runAllTests();
+}
+
+#endif // __tests__DatagramBatchTests__
@@ -0,0 +1,315 @@
+//
+//  DomainListDeltaTests.cpp
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <stdlib.h>
+
+#include <iostream>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtNetwork/QHostAddress>
+
+#include <DomainListDelta.h>
+#include <HifiSockAddr.h>
+#include <Node.h>
+#include <NodeList.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "DomainListDeltaTests.h"
+
+const int TEST_NODES = 1000;
+const int TEST_LISTENERS = 20;
+const int TEST_ROUNDS = 60;
+const int BENCHMARK_NODES = 2000;
+const int BENCHMARK_LISTENERS = 50;
+const int BENCHMARK_ROUNDS = 20;
+
+// the joins, leaves and moves between check-ins, about what a busy domain sees in a second
+const int CHANGES_PER_ROUND = 10;
+
+// how many check-ins a node that left stays in the lists of the others before they stop hearing from it
+const int SILENT_ROUNDS = 3;
+
+const int PACKET_LOSS_PERCENT = 5;
+
+const NodeSet LISTED_TYPES = NodeSet() << NodeType::Agent << NodeType::AudioMixer << NodeType::AvatarMixer
+    << NodeType::VoxelServer;
+
+class ListedNode {
+public:
+    NodeType_t type;
+    HifiSockAddr publicSocket;
+    HifiSockAddr localSocket;
+};
+
+// the domain-server side, which keeps the nodes and numbers the changes to them
+class SimulatedDomain {
+public:
+    SimulatedDomain(int numNodes);
+    ~SimulatedDomain();
+
+    void changeNodes(int round);
+
+    /// writes the list for a check-in the way DomainServer::sendDomainListToNode() does
+    QList<QByteArray> writeList(const QUuid& listenerUUID, quint32 acknowledgedVersion, bool allowChanges);
+
+    QHash<QUuid, Node*> nodes;
+    QList<QUuid> leavableNodes;
+    QHash<QUuid, int> leftRounds;
+    DomainListChangeLog changes;
+    int listsOfChanges;
+    int wholeLists;
+
+private:
+    void addNode();
+};
+
+// the node side, which keeps the list the way NodeList::processDomainServerList() does
+class SimulatedListener {
+public:
+    void processList(const QByteArray& packet);
+
+    /// forgets the nodes that left long enough ago to have gone silent, as NodeList::removeSilentNodes() would
+    void removeSilentNodes(const SimulatedDomain& domain, int round);
+
+    QUuid uuid;
+    QHash<QUuid, ListedNode> nodes;
+    DomainListVersionTracker versions;
+};
+
+static HifiSockAddr randomSocket() {
+    return HifiSockAddr(QHostAddress((quint32)rand()), 1024 + rand() % 60000);
+}
+
+SimulatedDomain::SimulatedDomain(int numNodes) :
+    listsOfChanges(0),
+    wholeLists(0)
+{
+    for (int i = 0; i < numNodes; i++) {
+        addNode();
+    }
+}
+
+SimulatedDomain::~SimulatedDomain() {
+    qDeleteAll(nodes);
+}
+
+void SimulatedDomain::addNode() {
+    Node* node = new Node(QUuid::createUuid(), LISTED_TYPES.values().at(rand() % LISTED_TYPES.size()), randomSocket(),
+                          randomSocket());
+    nodes.insert(node->getUUID(), node);
+    leavableNodes.append(node->getUUID());
+    changes.nodeUpdated(node->getUUID(), node->getType());
+}
+
+void SimulatedDomain::changeNodes(int round) {
+    for (int i = 0; i < CHANGES_PER_ROUND; i++) {
+        int change = rand() % 3;
+        if (change == 0) {
+            addNode();
+
+        } else if (change == 1) {
+            Node* node = nodes.take(leavableNodes.takeAt(rand() % leavableNodes.size()));
+            leftRounds.insert(node->getUUID(), round);
+            changes.nodeRemoved(node->getUUID(), node->getType());
+            delete node;
+
+        } else {
+            Node* node = nodes.value(leavableNodes.at(rand() % leavableNodes.size()));
+            node->setPublicSocket(randomSocket());
+            changes.nodeUpdated(node->getUUID(), node->getType());
+        }
+    }
+}
+
+QList<QByteArray> SimulatedDomain::writeList(const QUuid& listenerUUID, quint32 acknowledgedVersion, bool allowChanges) {
+    QList<QUuid> updatedNodes;
+    QList<QUuid> removedNodes;
+    bool sendChanges = allowChanges && acknowledgedVersion != NO_DOMAIN_LIST_VERSION
+        && changes.getChangesSince(acknowledgedVersion, LISTED_TYPES, updatedNodes, removedNodes)
+        && updatedNodes.size() + removedNodes.size() < nodes.size();
+
+    DomainListWriter listWriter(listenerUUID, changes.getVersion(),
+                                sendChanges ? acknowledgedVersion : NO_DOMAIN_LIST_VERSION);
+    if (sendChanges) {
+        listsOfChanges++;
+        foreach (const QUuid& nodeUUID, updatedNodes) {
+            Node* node = nodes.value(nodeUUID);
+            if (node && nodeUUID != listenerUUID) {
+                listWriter.appendUpdatedNode(*node, QUuid());
+            }
+        }
+        foreach (const QUuid& nodeUUID, removedNodes) {
+            listWriter.appendRemovedNode(nodeUUID);
+        }
+    } else {
+        wholeLists++;
+        foreach (Node* node, nodes) {
+            if (node->getUUID() != listenerUUID) {
+                listWriter.appendUpdatedNode(*node, QUuid());
+            }
+        }
+    }
+    return listWriter.finish();
+}
+
+void SimulatedListener::processList(const QByteArray& packet) {
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    DomainListHeader listHeader;
+    packetStream >> listHeader;
+    if (listHeader.sessionUUID != uuid) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a list was sent with the session UUID of another node"
+            << std::endl;
+    }
+
+    while (packetStream.device()->pos() < packet.size()) {
+        quint8 entryType;
+        QUuid nodeUUID;
+        packetStream >> entryType;
+
+        if (entryType == DomainListNodeRemoved) {
+            packetStream >> nodeUUID;
+            nodes.remove(nodeUUID);
+            continue;
+        }
+
+        qint8 nodeType;
+        ListedNode listedNode;
+        QUuid connectionSecret;
+        packetStream >> nodeType >> nodeUUID >> listedNode.publicSocket >> listedNode.localSocket >> connectionSecret;
+        listedNode.type = nodeType;
+        nodes.insert(nodeUUID, listedNode);
+    }
+
+    versions.packetReceived(listHeader);
+}
+
+void SimulatedListener::removeSilentNodes(const SimulatedDomain& domain, int round) {
+    bool removedNodes = false;
+    for (QHash<QUuid, ListedNode>::iterator node = nodes.begin(); node != nodes.end(); ) {
+        if (!domain.nodes.contains(node.key()) && domain.leftRounds.value(node.key()) + SILENT_ROUNDS <= round) {
+            node = nodes.erase(node);
+            removedNodes = true;
+        } else {
+            ++node;
+        }
+    }
+    if (removedNodes) {
+        versions.reset();
+    }
+}
+
+// checks every listener in, dropping some of the packets of their lists, and returns the bytes sent
+static quint64 checkIn(SimulatedDomain& domain, QList<SimulatedListener>& listeners, int round, bool allowChanges,
+                       int packetLossPercent) {
+    quint64 bytesSent = 0;
+    for (int i = 0; i < listeners.size(); i++) {
+        SimulatedListener& listener = listeners[i];
+        listener.removeSilentNodes(domain, round);
+
+        foreach (const QByteArray& packet, domain.writeList(listener.uuid, listener.versions.getAcknowledgedVersion(),
+                                                            allowChanges)) {
+            bytesSent += packet.size();
+            if (rand() % 100 >= packetLossPercent) {
+                listener.processList(packet);
+            }
+        }
+    }
+    return bytesSent;
+}
+
+static QList<SimulatedListener> makeListeners(SimulatedDomain& domain, int numListeners) {
+    QList<SimulatedListener> listeners;
+    for (int i = 0; i < numListeners; i++) {
+        SimulatedListener listener;
+        listener.uuid = domain.leavableNodes.takeLast();
+        listeners.append(listener);
+    }
+    return listeners;
+}
+
+void DomainListDeltaTests::testListsConverge() {
+    SimulatedDomain domain(TEST_NODES);
+    QList<SimulatedListener> listeners = makeListeners(domain, TEST_LISTENERS);
+
+    int round = 0;
+    for (; round < TEST_ROUNDS; round++) {
+        domain.changeNodes(round);
+        checkIn(domain, listeners, round, true, PACKET_LOSS_PERCENT);
+    }
+
+    // once the changes stop and the packets get through, everyone should catch up
+    int lastRound = round + SILENT_ROUNDS + 1;
+    for (; round <= lastRound; round++) {
+        checkIn(domain, listeners, round, true, 0);
+    }
+
+    foreach (const SimulatedListener& listener, listeners) {
+        if (listener.nodes.size() != domain.nodes.size() - 1) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a node lists " << listener.nodes.size() <<
+                " nodes but the domain has " << domain.nodes.size() - 1 << " others" << std::endl;
+        }
+        foreach (Node* node, domain.nodes) {
+            if (node->getUUID() == listener.uuid) {
+                continue;
+            }
+            if (!listener.nodes.contains(node->getUUID())) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a node is missing from a list" << std::endl;
+                break;
+            }
+            const ListedNode& listedNode = listener.nodes[node->getUUID()];
+            if (listedNode.type != node->getType() || listedNode.publicSocket != node->getPublicSocket() ||
+                    listedNode.localSocket != node->getLocalSocket()) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a node is listed with an old socket" << std::endl;
+                break;
+            }
+        }
+        if (listener.versions.getAcknowledgedVersion() != domain.changes.getVersion()) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a node acknowledged version " <<
+                listener.versions.getAcknowledgedVersion() << " instead of " << domain.changes.getVersion() << std::endl;
+        }
+    }
+
+    if (domain.listsOfChanges == 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: every list was sent whole" << std::endl;
+    }
+}
+
+static void benchmarkCheckIns(bool allowChanges, const char* mode) {
+    srand(0);
+    SimulatedDomain domain(BENCHMARK_NODES);
+    QList<SimulatedListener> listeners = makeListeners(domain, BENCHMARK_LISTENERS);
+
+    // everyone starts with the whole list
+    checkIn(domain, listeners, 0, allowChanges, 0);
+
+    quint64 bytesSent = 0;
+    quint64 start = usecTimestampNow();
+    for (int round = 1; round <= BENCHMARK_ROUNDS; round++) {
+        domain.changeNodes(round);
+        bytesSent += checkIn(domain, listeners, round, allowChanges, 0);
+    }
+    quint64 elapsed = usecTimestampNow() - start;
+
+    int numCheckIns = BENCHMARK_LISTENERS * BENCHMARK_ROUNDS;
+    std::cout << mode << ": " << BENCHMARK_NODES << " nodes, " <<
+        bytesSent / numCheckIns << " bytes and " << elapsed / numCheckIns << " usecs per check-in" << std::endl;
+}
+
+void DomainListDeltaTests::benchmarkCheckIns() {
+    ::benchmarkCheckIns(false, "whole lists");
+    ::benchmarkCheckIns(true, "changes");
+}
+
+void DomainListDeltaTests::runAllTests() {
+    testListsConverge();
+    benchmarkCheckIns();
+}
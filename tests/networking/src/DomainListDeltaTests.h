@@ -0,0 +1,23 @@
+//
+//  DomainListDeltaTests.h
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__DomainListDeltaTests__
+#define __tests__DomainListDeltaTests__
+
+namespace DomainListDeltaTests {
+
+    /// checks that nodes that lose some of the lists they are sent still end up with the domain-server's list
+    void testListsConverge();
+
+    /// prints the bytes and time it takes to keep the nodes of a busy domain up to date, with and without changes
+    void benchmarkCheckIns();
+
+    void runAllTests();
+}
+
+#endif // __tests__DomainListDeltaTests__
@@ -0,0 +1,293 @@
+//
+//  PacketBufferTests.cpp
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <string.h>
+
+#include <iostream>
+
+#include <QtCore/QList>
+#include <QtCore/QThread>
+
+#include <PacketBuffer.h>
+#include <SharedUtil.h>
+
+#include "PacketBufferTests.h"
+
+const int BENCHMARK_PACKETS = 1000000;
+
+// a mixed audio packet, and the largest packets the octree servers send
+const int BENCHMARK_PACKET_SIZES[] = { 200, MAX_PACKET_SIZE };
+
+static QByteArray testBytes(int size) {
+    QByteArray bytes(size, 0);
+    for (int i = 0; i < size; i++) {
+        bytes[i] = (char)(i * 7);
+    }
+    return bytes;
+}
+
+void PacketBufferTests::testSharing() {
+    QByteArray bytes = testBytes(100);
+    PacketBuffer buffer(bytes);
+    if (buffer.size() != bytes.size() || memcmp(buffer.constData(), bytes.constData(), bytes.size()) != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the buffer doesn't hold the bytes it was made from" <<
+            std::endl;
+    }
+
+    PacketBuffer copy = buffer;
+    if (copy.constData() != buffer.constData()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a copy didn't share the bytes of its buffer" << std::endl;
+    }
+
+    copy.data()[0] = bytes.at(0) ^ 1;
+    if (copy.constData() == buffer.constData() || buffer.constData()[0] != bytes.at(0)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: writing to a copy changed the buffer it shared with" <<
+            std::endl;
+    }
+    if (memcmp(copy.constData() + 1, bytes.constData() + 1, bytes.size() - 1) != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a copy lost its bytes when it was written to" << std::endl;
+    }
+
+    // a buffer nothing else shares is written where it is
+    const char* unsharedData = buffer.constData();
+    if (buffer.data() != unsharedData) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: writing to an unshared buffer copied it" << std::endl;
+    }
+
+    QByteArray view = buffer.asByteArray();
+    if (view.constData() != buffer.constData() || view.size() != buffer.size()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the view of a buffer isn't where the buffer is" << std::endl;
+    }
+
+    PacketBuffer nullBuffer;
+    if (!nullBuffer.isNull() || nullBuffer.size() != 0 || nullBuffer.constData()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a default buffer isn't null" << std::endl;
+    }
+}
+
+void PacketBufferTests::testPrepend() {
+    QByteArray payload = testBytes(200);
+    PacketBuffer packet(payload.constData(), payload.size());
+    const char* payloadData = packet.constData();
+
+    quint64 heapAllocations = PacketBuffer::getTotalHeapAllocations();
+    char* header = packet.prepend(MAX_PACKET_HEADER_BYTES);
+    if (header != payloadData - MAX_PACKET_HEADER_BYTES || PacketBuffer::getTotalHeapAllocations() != heapAllocations) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a header didn't go in front of the packet" << std::endl;
+    }
+    memset(header, 'h', MAX_PACKET_HEADER_BYTES);
+    if (packet.size() != MAX_PACKET_HEADER_BYTES + payload.size() ||
+            memcmp(packet.constData() + MAX_PACKET_HEADER_BYTES, payload.constData(), payload.size()) != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: prepending changed the payload" << std::endl;
+    }
+
+    // with no room left the packet moves, and keeps what it had
+    packet.prepend(1)[0] = 'p';
+    if (packet.size() != 1 + MAX_PACKET_HEADER_BYTES + payload.size() || packet.constData()[0] != 'p' ||
+            packet.constData()[1] != 'h' ||
+            memcmp(packet.constData() + 1 + MAX_PACKET_HEADER_BYTES, payload.constData(), payload.size()) != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a packet lost bytes growing past its headroom" << std::endl;
+    }
+
+    // prepending to a shared buffer leaves the other copy as it was
+    PacketBuffer shared(payload.constData(), payload.size());
+    PacketBuffer copy = shared;
+    copy.prepend(MAX_PACKET_HEADER_BYTES);
+    if (shared.size() != payload.size() || copy.size() != MAX_PACKET_HEADER_BYTES + payload.size() ||
+            memcmp(shared.constData(), payload.constData(), payload.size()) != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: prepending to a copy changed the buffer it shared with" <<
+            std::endl;
+    }
+}
+
+void PacketBufferTests::testResize() {
+    QByteArray bytes = testBytes(PacketBuffer::getMaxPooledSize());
+    PacketBuffer packet(bytes.constData(), 100);
+    const char* data = packet.constData();
+
+    // a pooled packet grows to the end of its block where it is
+    packet.resize(PacketBuffer::getMaxPooledSize());
+    if (packet.constData() != data || packet.capacity() != PacketBuffer::getMaxPooledSize() ||
+            memcmp(packet.constData(), bytes.constData(), 100) != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a packet moved growing inside its block" << std::endl;
+    }
+
+    // and moves to grow past it, keeping what it had
+    packet.resize(2 * PacketBuffer::getMaxPooledSize());
+    if (packet.size() != 2 * PacketBuffer::getMaxPooledSize() || memcmp(packet.constData(), bytes.constData(), 100) != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a packet lost bytes growing past its block" << std::endl;
+    }
+
+    PacketBuffer nullBuffer;
+    nullBuffer.resize(10);
+    if (nullBuffer.isNull() || nullBuffer.size() != 10) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a null buffer didn't grow" << std::endl;
+    }
+
+    // a view that nothing else shares is pointed at the next buffer without allocating
+    QByteArray view;
+    packet.asByteArray(view);
+    const void* viewHeader = view.data_ptr();
+    nullBuffer.asByteArray(view);
+    if (view.constData() != nullBuffer.constData() || view.size() != nullBuffer.size() || view.data_ptr() != viewHeader) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a view wasn't reused for the next buffer" << std::endl;
+    }
+}
+
+void PacketBufferTests::testPoolReuse() {
+    const int PACKETS_IN_FLIGHT = 1000;
+    const int ROUNDS = 100;
+
+    QByteArray bytes = testBytes(MAX_PACKET_SIZE);
+
+    // the first round fills the pool with as many blocks as are ever in use at once
+    QList<PacketBuffer> packets;
+    for (int i = 0; i < PACKETS_IN_FLIGHT; i++) {
+        packets.append(PacketBuffer(bytes));
+    }
+    packets.clear();
+
+    quint64 heapAllocations = PacketBuffer::getTotalHeapAllocations();
+    quint64 pooledBytes = PacketBuffer::getPooledBytes();
+    quint64 pooledBytesInUse = PacketBuffer::getPooledBytesInUse();
+
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < PACKETS_IN_FLIGHT; i++) {
+            packets.append(PacketBuffer(bytes));
+        }
+        if (PacketBuffer::getPooledBytesInUse() < pooledBytesInUse + PACKETS_IN_FLIGHT * MAX_PACKET_SIZE) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the pool doesn't count the blocks in use" << std::endl;
+        }
+        packets.clear();
+    }
+
+    if (PacketBuffer::getTotalHeapAllocations() != heapAllocations) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << PacketBuffer::getTotalHeapAllocations() - heapAllocations <<
+            " heap allocations after the pool had grown" << std::endl;
+    }
+    if (PacketBuffer::getPooledBytes() != pooledBytes || PacketBuffer::getPooledBytesInUse() != pooledBytesInUse) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: blocks weren't returned to the pool" << std::endl;
+    }
+}
+
+// releases the packets it is given on a thread of its own
+class ReleasingThread : public QThread {
+public:
+    ReleasingThread(QList<PacketBuffer>& packets) : _packets(packets) { }
+
+protected:
+    virtual void run() { _packets.clear(); }
+
+private:
+    QList<PacketBuffer>& _packets;
+};
+
+void PacketBufferTests::testThreadCaches() {
+    const int PACKETS_IN_FLIGHT = 1000;
+    const int ROUNDS = 10;
+
+    QByteArray bytes = testBytes(MAX_PACKET_SIZE);
+    quint64 pooledBytesInUse = PacketBuffer::getPooledBytesInUse();
+    quint64 totalBuffers = PacketBuffer::getTotalBuffers();
+
+    // packets made here and released on other threads, like received packets that are processed elsewhere, end up
+    // in those threads' caches and go back to the pool from there
+    quint64 pooledBytes = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        QList<PacketBuffer> packets;
+        for (int i = 0; i < PACKETS_IN_FLIGHT; i++) {
+            packets.append(PacketBuffer(bytes));
+        }
+        ReleasingThread releasingThread(packets);
+        releasingThread.start();
+        releasingThread.wait();
+
+        if (round == 0) {
+            pooledBytes = PacketBuffer::getPooledBytes();
+        }
+    }
+
+    if (PacketBuffer::getPooledBytes() != pooledBytes) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the pool grew as blocks went from thread to thread" <<
+            std::endl;
+    }
+    if (PacketBuffer::getPooledBytesInUse() != pooledBytesInUse) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: blocks released on other threads weren't returned" <<
+            std::endl;
+    }
+    if (PacketBuffer::getTotalBuffers() != totalBuffers + ROUNDS * PACKETS_IN_FLIGHT) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << PacketBuffer::getTotalBuffers() - totalBuffers <<
+            " buffers were counted instead of " << ROUNDS * PACKETS_IN_FLIGHT << std::endl;
+    }
+}
+
+void PacketBufferTests::testOversizedPackets() {
+    const int OVERSIZED_PACKET_BYTES = 16 * 1024;
+
+    QByteArray bytes = testBytes(OVERSIZED_PACKET_BYTES);
+    quint64 heapAllocations = PacketBuffer::getTotalHeapAllocations();
+    quint64 pooledBytesInUse = PacketBuffer::getPooledBytesInUse();
+    {
+        PacketBuffer packet(bytes);
+        if (memcmp(packet.constData(), bytes.constData(), bytes.size()) != 0) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: an oversized packet doesn't hold its bytes" << std::endl;
+        }
+        if (PacketBuffer::getTotalHeapAllocations() != heapAllocations + 1 ||
+                PacketBuffer::getPooledBytesInUse() != pooledBytesInUse) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: an oversized packet didn't get a block of its own" <<
+                std::endl;
+        }
+    }
+    if (PacketBuffer::getPooledBytesInUse() != pooledBytesInUse) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: an oversized packet went back to the pool" << std::endl;
+    }
+}
+
+static void benchmarkSendCopies(int packetSize) {
+    QByteArray bytes = testBytes(packetSize);
+    int checksum = 0;
+
+    // writeDatagram(const char*, ...) made a QByteArray of the data, then a copy of that to write the hash into
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < BENCHMARK_PACKETS; i++) {
+        QByteArray datagram(bytes.constData(), bytes.size());
+        QByteArray datagramCopy = datagram;
+        datagramCopy.data()[i % packetSize] ^= 1;
+        checksum += datagramCopy.at(0);
+    }
+    float byteArraySeconds = (float)(usecTimestampNow() - start) / USECS_PER_SECOND;
+
+    // now the data is copied once into a pooled buffer, and the hash is written there
+    start = usecTimestampNow();
+    for (int i = 0; i < BENCHMARK_PACKETS; i++) {
+        PacketBuffer datagram(bytes.constData(), bytes.size());
+        datagram.data()[i % packetSize] ^= 1;
+        checksum += datagram.constData()[0];
+    }
+    float packetBufferSeconds = (float)(usecTimestampNow() - start) / USECS_PER_SECOND;
+
+    std::cout << packetSize << " byte packets: " << (int)(BENCHMARK_PACKETS / byteArraySeconds) <<
+        " packets per second with QByteArray copies, " << (int)(BENCHMARK_PACKETS / packetBufferSeconds) <<
+        " with PacketBuffer (checksum " << checksum << ")" << std::endl;
+}
+
+void PacketBufferTests::benchmarkSendCopies() {
+    for (int i = 0; i < (int)(sizeof(BENCHMARK_PACKET_SIZES) / sizeof(BENCHMARK_PACKET_SIZES[0])); i++) {
+        ::benchmarkSendCopies(BENCHMARK_PACKET_SIZES[i]);
+    }
+}
+
+void PacketBufferTests::runAllTests() {
+    testSharing();
+    testPrepend();
+    testResize();
+    testPoolReuse();
+    testThreadCaches();
+    testOversizedPackets();
+    benchmarkSendCopies();
+}
@@ -0,0 +1,38 @@
+//
+//  PacketBufferTests.h
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__PacketBufferTests__
+#define __tests__PacketBufferTests__
+
+namespace PacketBufferTests {
+
+    /// checks that copies share their bytes until one of them is written to
+    void testSharing();
+
+    /// checks that headers go into the room in front of a packet, and that packets grow past it
+    void testPrepend();
+
+    /// checks that packets grow inside their blocks, and move to grow past them
+    void testResize();
+
+    /// checks that a steady stream of packets reuses the pooled blocks instead of going to the heap
+    void testPoolReuse();
+
+    /// checks that blocks released on other threads than they were made on go back to the pool
+    void testThreadCaches();
+
+    /// checks that packets too large for a pooled block get one of their own
+    void testOversizedPackets();
+
+    /// prints how many packets a second one core can prepare for sending the way NodeList used to and with PacketBuffer
+    void benchmarkSendCopies();
+
+    void runAllTests();
+}
+
+#endif // __tests__PacketBufferTests__
@@ -0,0 +1,149 @@
+//
+//  PacketHashTests.cpp
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <string.h>
+
+#include <iostream>
+
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+#include <SipHash.h>
+
+#include "PacketHashTests.h"
+
+const int BENCHMARK_PACKETS = 200000;
+
+// a mixed audio packet, and the largest packets the octree servers send
+const int BENCHMARK_PAYLOAD_SIZES[] = { 200, MAX_PACKET_SIZE - MAX_PACKET_HEADER_BYTES };
+
+void PacketHashTests::testSipHashVectors() {
+    // from the reference implementation, keyed with the bytes 0 to 15 and hashing the bytes 0 to size - 1
+    const int VECTOR_SIZES[] = { 0, 15, 63 };
+    const uchar VECTOR_HASHES[][NUM_BYTES_SIPHASH_128] = {
+        { 0xa3, 0x81, 0x7f, 0x04, 0xba, 0x25, 0xa8, 0xe6, 0x6d, 0xf6, 0x72, 0x14, 0xc7, 0x55, 0x02, 0x93 },
+        { 0x54, 0x93, 0xe9, 0x99, 0x33, 0xb0, 0xa8, 0x11, 0x7e, 0x08, 0xec, 0x0f, 0x97, 0xcf, 0xc3, 0xd9 },
+        { 0x51, 0x50, 0xd1, 0x77, 0x2f, 0x50, 0x83, 0x4a, 0x50, 0x3e, 0x06, 0x9a, 0x97, 0x3f, 0xbd, 0x7c }
+    };
+
+    uchar key[NUM_BYTES_SIPHASH_KEY];
+    for (int i = 0; i < NUM_BYTES_SIPHASH_KEY; i++) {
+        key[i] = i;
+    }
+    char data[64];
+    for (int i = 0; i < (int)sizeof(data); i++) {
+        data[i] = i;
+    }
+
+    for (int i = 0; i < (int)(sizeof(VECTOR_SIZES) / sizeof(VECTOR_SIZES[0])); i++) {
+        uchar hash[NUM_BYTES_SIPHASH_128];
+        sipHash128(data, VECTOR_SIZES[i], key, hash);
+        if (memcmp(hash, VECTOR_HASHES[i], NUM_BYTES_SIPHASH_128) != 0) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the hash of " << VECTOR_SIZES[i] <<
+                " bytes doesn't match the reference" << std::endl;
+        }
+    }
+}
+
+static QByteArray testPacket(const QUuid& senderUUID, int payloadSize) {
+    QByteArray packet = byteArrayWithPopulatedHeader(PacketTypeMixedAudio, senderUUID);
+    for (int i = 0; i < payloadSize; i++) {
+        packet.append((char)(i * 7));
+    }
+    return packet;
+}
+
+void PacketHashTests::testPacketHashes() {
+    QUuid senderUUID = QUuid::createUuid();
+    QUuid connectionSecret = QUuid::createUuid();
+
+    QByteArray packet = testPacket(senderUUID, 100);
+    replaceHashInPacketGivenConnectionUUID(packet, connectionSecret);
+
+    if (versionFromPacketHeader(packet) != versionForPacketType(PacketTypeMixedAudio)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the keyed hash changed the version of the packet" <<
+            std::endl;
+    }
+    if (uuidFromPacketHeader(packet) != senderUUID) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the hash overwrote the sender UUID" << std::endl;
+    }
+    if (!packetHashMatchesConnectionUUID(packet, connectionSecret)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a packet didn't verify with its secret" << std::endl;
+    }
+    if (packetHashMatchesConnectionUUID(packet, QUuid::createUuid())) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a packet verified with another secret" << std::endl;
+    }
+
+    QByteArray tamperedPacket = packet;
+    tamperedPacket[tamperedPacket.size() - 1] = tamperedPacket[tamperedPacket.size() - 1] ^ 1;
+    if (packetHashMatchesConnectionUUID(tamperedPacket, connectionSecret)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a changed packet still verified" << std::endl;
+    }
+
+    QByteArray truncatedPacket = packet.left(numBytesForPacketHeader(packet) - 1);
+    if (packetHashMatchesConnectionUUID(truncatedPacket, connectionSecret)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a packet cut short of its header verified" << std::endl;
+    }
+
+    // older nodes put the MD5 in the same place and leave the version alone, which is no longer trusted
+    QByteArray olderPacket = testPacket(senderUUID, 100);
+    olderPacket.replace(numBytesForPacketHeader(olderPacket) - NUM_BYTES_MD5_HASH, NUM_BYTES_MD5_HASH,
+                        hashForPacketAndConnectionUUID(olderPacket, connectionSecret));
+    if (packetHashMatchesConnectionUUID(olderPacket, connectionSecret)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a packet with an unkeyed hash verified" << std::endl;
+    }
+}
+
+static void benchmarkVerification(int payloadSize) {
+    QUuid senderUUID = QUuid::createUuid();
+    QUuid connectionSecret = QUuid::createUuid();
+
+    QByteArray md5Packet = testPacket(senderUUID, payloadSize);
+    md5Packet.replace(numBytesForPacketHeader(md5Packet) - NUM_BYTES_MD5_HASH, NUM_BYTES_MD5_HASH,
+                      hashForPacketAndConnectionUUID(md5Packet, connectionSecret));
+    QByteArray keyedPacket = testPacket(senderUUID, payloadSize);
+    replaceHashInPacketGivenConnectionUUID(keyedPacket, connectionSecret);
+
+    int numVerified = 0;
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < BENCHMARK_PACKETS; i++) {
+        // the way packets were verified before
+        if (hashFromPacketHeader(md5Packet) == hashForPacketAndConnectionUUID(md5Packet, connectionSecret)) {
+            numVerified++;
+        }
+    }
+    float md5Seconds = (float)(usecTimestampNow() - start) / USECS_PER_SECOND;
+
+    start = usecTimestampNow();
+    for (int i = 0; i < BENCHMARK_PACKETS; i++) {
+        if (packetHashMatchesConnectionUUID(keyedPacket, connectionSecret)) {
+            numVerified++;
+        }
+    }
+    float keyedSeconds = (float)(usecTimestampNow() - start) / USECS_PER_SECOND;
+
+    if (numVerified != 2 * BENCHMARK_PACKETS) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: only " << numVerified << " of " << 2 * BENCHMARK_PACKETS <<
+            " packets verified" << std::endl;
+    }
+
+    std::cout << payloadSize << " byte payloads: " << (int)(BENCHMARK_PACKETS / md5Seconds) <<
+        " packets per second verified with MD5, " << (int)(BENCHMARK_PACKETS / keyedSeconds) << " with SipHash" <<
+        std::endl;
+}
+
+void PacketHashTests::benchmarkVerification() {
+    for (int i = 0; i < (int)(sizeof(BENCHMARK_PAYLOAD_SIZES) / sizeof(BENCHMARK_PAYLOAD_SIZES[0])); i++) {
+        ::benchmarkVerification(BENCHMARK_PAYLOAD_SIZES[i]);
+    }
+}
+
+void PacketHashTests::runAllTests() {
+    testSipHashVectors();
+    testPacketHashes();
+    benchmarkVerification();
+}
@@ -0,0 +1,26 @@
+//
+//  PacketHashTests.h
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__PacketHashTests__
+#define __tests__PacketHashTests__
+
+namespace PacketHashTests {
+
+    /// checks SipHash-2-4 against the test vectors of its reference implementation
+    void testSipHashVectors();
+
+    /// checks that hashed packets verify with their secret only, whether they come from new or older nodes
+    void testPacketHashes();
+
+    /// prints how many packets a second one core can verify with MD5 and with the keyed hash
+    void benchmarkVerification();
+
+    void runAllTests();
+}
+
+#endif // __tests__PacketHashTests__
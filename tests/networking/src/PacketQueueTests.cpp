@@ -0,0 +1,342 @@
+//
+//  PacketQueueTests.cpp
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <string.h>
+
+#include <iostream>
+#include <vector>
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+
+#include <Histogram.h>
+#include <PacketQueue.h>
+#include <SharedUtil.h>
+
+#include "PacketQueueTests.h"
+
+const int TEST_CAPACITY = 16;
+
+const int PRODUCERS = 4;
+const int PACKETS_PER_PRODUCER = 100000;
+
+// about the size of an edit packet
+const int BENCHMARK_PACKET_BYTES = 100;
+const int BENCHMARK_BATCH_PACKETS = 64;
+
+// the producers of the benchmark add their packets in bursts, like a burst of edits
+const int BENCHMARK_BURST_PACKETS = 200;
+const int BENCHMARK_BURST_INTERVAL_USECS = 1000;
+
+// a packet is the number of the thread that made it, and its number among that thread's packets
+static NetworkPacket testPacket(int producer, int index) {
+    PacketBuffer buffer(sizeof(producer) + sizeof(index));
+    memcpy(buffer.data(), &producer, sizeof(producer));
+    memcpy(buffer.data() + sizeof(producer), &index, sizeof(index));
+    return NetworkPacket(SharedNodePointer(), buffer);
+}
+
+static int producerOfPacket(const NetworkPacket& packet) {
+    int producer;
+    memcpy(&producer, packet.getBuffer().constData(), sizeof(producer));
+    return producer;
+}
+
+static int indexOfPacket(const NetworkPacket& packet) {
+    int index;
+    memcpy(&index, packet.getBuffer().constData() + sizeof(int), sizeof(index));
+    return index;
+}
+
+void PacketQueueTests::testOrder() {
+    PacketQueue queue(TEST_CAPACITY);
+    QVector<NetworkPacket> packets;
+    int nextIn = 0;
+    int nextOut = 0;
+
+    // a few times around the ring, a few packets at a time
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < TEST_CAPACITY - 3; i++) {
+            queue.enqueue(testPacket(0, nextIn++));
+        }
+        if (queue.size() != nextIn - nextOut) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the queue holds " << queue.size() << " packets, not " <<
+                nextIn - nextOut << std::endl;
+        }
+        while (queue.dequeue(packets, 5) > 0) {
+        }
+        foreach (const NetworkPacket& packet, packets) {
+            if (indexOfPacket(packet) != nextOut++) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR: packet " << indexOfPacket(packet) <<
+                    " came out in place of " << nextOut - 1 << std::endl;
+            }
+        }
+        packets.clear();
+    }
+
+    // more than the ring holds, so the rest overflow, then more go in while the overflow is still being taken from
+    for (int i = 0; i < 3 * TEST_CAPACITY; i++) {
+        queue.enqueue(testPacket(0, nextIn++));
+    }
+    if (queue.getOverflowedPackets() != (quint64)(2 * TEST_CAPACITY)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << queue.getOverflowedPackets() << " packets overflowed, not " <<
+            2 * TEST_CAPACITY << std::endl;
+    }
+    queue.dequeue(packets, 2 * TEST_CAPACITY);
+    for (int i = 0; i < TEST_CAPACITY; i++) {
+        queue.enqueue(testPacket(0, nextIn++));
+    }
+    while (queue.dequeue(packets, 7) > 0) {
+    }
+    foreach (const NetworkPacket& packet, packets) {
+        if (indexOfPacket(packet) != nextOut++) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: packet " << indexOfPacket(packet) <<
+                " came out of the overflow in place of " << nextOut - 1 << std::endl;
+        }
+    }
+    if (nextOut != nextIn || queue.size() != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << nextIn - nextOut << " packets didn't come out" << std::endl;
+    }
+
+    // a wake with nothing waiting lets the next wait return
+    queue.wake();
+    queue.waitForPackets();
+}
+
+class ProducerThread : public QThread {
+public:
+    ProducerThread(PacketQueue& queue, int producer) :
+        _queue(queue),
+        _producer(producer) { }
+
+protected:
+    virtual void run() {
+        for (int i = 0; i < PACKETS_PER_PRODUCER; i++) {
+            _queue.enqueue(testPacket(_producer, i));
+        }
+    }
+
+private:
+    PacketQueue& _queue;
+    int _producer;
+};
+
+void PacketQueueTests::testConcurrentProducers() {
+    // small enough that the producers fill it and overflow now and then
+    PacketQueue queue(256);
+
+    QVector<ProducerThread*> producers;
+    for (int i = 0; i < PRODUCERS; i++) {
+        producers.append(new ProducerThread(queue, i));
+        producers.last()->start();
+    }
+
+    QVector<int> nextIndices(PRODUCERS, 0);
+    QVector<NetworkPacket> packets;
+    int packetsTaken = 0;
+    while (packetsTaken < PRODUCERS * PACKETS_PER_PRODUCER) {
+        queue.waitForPackets();
+        while (queue.dequeue(packets, 64) > 0) {
+            foreach (const NetworkPacket& packet, packets) {
+                int producer = producerOfPacket(packet);
+                if (indexOfPacket(packet) != nextIndices[producer]) {
+                    std::cout << __FILE__ << ":" << __LINE__ << " ERROR: packet " << indexOfPacket(packet) << " of thread " <<
+                        producer << " came out in place of " << nextIndices[producer] << std::endl;
+                }
+                nextIndices[producer] = indexOfPacket(packet) + 1;
+            }
+            packetsTaken += packets.size();
+            packets.resize(0);
+        }
+    }
+
+    foreach (ProducerThread* producer, producers) {
+        producer->wait();
+        delete producer;
+    }
+    if (queue.size() != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << queue.size() << " extra packets in the queue" << std::endl;
+    }
+}
+
+void PacketQueueTests::testHistograms() {
+    Histogram histogram;
+    histogram.add(0);
+    histogram.add(1);
+    histogram.add(5);
+    histogram.add(6);
+    histogram.add(100);
+    if (histogram.getCount() != 5 || histogram.getMax() != 100 || histogram.getBucketCount(3) != 2) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: samples were counted in the wrong buckets: " <<
+            histogram.toString().toLocal8Bit().constData() << std::endl;
+    }
+    if (histogram.getPercentile(0.5f) != 7 || histogram.getPercentile(1.0f) != 100) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: percentiles " << histogram.getPercentile(0.5f) << " and " <<
+            histogram.getPercentile(1.0f) << " should be 7 and 100" << std::endl;
+    }
+
+    // the largest samples, such as a wait time that wrapped around, go in the last bucket
+    Histogram largeSamples;
+    largeSamples.add((quint64)1 << 63);
+    largeSamples.add(~(quint64)0);
+    largeSamples.add(((quint64)1 << 63) - 1);
+    if (largeSamples.getBucketCount(HISTOGRAM_BUCKETS - 1) != 2 || largeSamples.getBucketCount(HISTOGRAM_BUCKETS - 2) != 1) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: large samples were counted in the wrong buckets: " <<
+            largeSamples.toString().toLocal8Bit().constData() << std::endl;
+    }
+
+    PacketQueue queue(TEST_CAPACITY);
+    for (int i = 0; i < 10; i++) {
+        queue.enqueue(testPacket(0, i));
+    }
+    QVector<NetworkPacket> packets;
+    queue.dequeue(packets, 4);
+    queue.dequeue(packets, 4);
+    queue.dequeue(packets, 4);
+    queue.dequeue(packets, 4); // empty, so not counted
+    const Histogram& depths = queue.getDepthHistogram();
+    if (depths.getCount() != 3 || depths.getMax() != 10 || depths.getBucketCount(3) != 1 || depths.getBucketCount(2) != 1) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the queue depths were " <<
+            depths.toString().toLocal8Bit().constData() << std::endl;
+    }
+    if (queue.getWaitTimeHistogram().getCount() != 10) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << queue.getWaitTimeHistogram().getCount() <<
+            " wait times for 10 packets" << std::endl;
+    }
+    queue.resetHistograms();
+    if (queue.getDepthHistogram().getCount() != 3) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the histograms were reset before the queue was taken from" <<
+            std::endl;
+    }
+    queue.dequeue(packets, 4);
+    if (queue.getDepthHistogram().getCount() != 0 || queue.getWaitTimeHistogram().getCount() != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the histograms weren't reset" << std::endl;
+    }
+}
+
+// how the packets were queued before, pushed on and erased off the front of a vector under the thread's lock
+class LockedVectorQueue {
+public:
+    void enqueue(const NetworkPacket& packet) {
+        _mutex.lock();
+        _packets.push_back(packet);
+        _mutex.unlock();
+    }
+
+    int dequeue(QVector<NetworkPacket>& packets, int maxPackets) {
+        int packetsTaken = 0;
+        while (packetsTaken < maxPackets) {
+            _mutex.lock();
+            if (_packets.empty()) {
+                _mutex.unlock();
+                break;
+            }
+            NetworkPacket packet = _packets.front();
+            _packets.erase(_packets.begin());
+            _mutex.unlock();
+            packets.append(packet);
+            packetsTaken++;
+        }
+        return packetsTaken;
+    }
+
+private:
+    QMutex _mutex;
+    std::vector<NetworkPacket> _packets;
+};
+
+// Adds bursts of packets, like an editor or a receive thread does, timing how long it spends adding them.
+template<class T> class BenchmarkProducerThread : public QThread {
+public:
+    BenchmarkProducerThread(T& queue) :
+        _queue(queue),
+        _enqueueUsecs(0) { }
+
+    quint64 getEnqueueUsecs() const { return _enqueueUsecs; }
+
+protected:
+    virtual void run() {
+        // each thread sends its own packet over and over, so that the threads don't contend for its reference count
+        SharedNodePointer destinationNode;
+        PacketBuffer buffer(BENCHMARK_PACKET_BYTES);
+        memset(buffer.data(), 0, BENCHMARK_PACKET_BYTES);
+        NetworkPacket packet(destinationNode, buffer);
+
+        for (int i = 0; i < PACKETS_PER_PRODUCER; i += BENCHMARK_BURST_PACKETS) {
+            quint64 start = usecTimestampNow();
+            for (int j = 0; j < BENCHMARK_BURST_PACKETS; j++) {
+                _queue.enqueue(packet);
+            }
+            _enqueueUsecs += usecTimestampNow() - start;
+            usleep(BENCHMARK_BURST_INTERVAL_USECS);
+        }
+    }
+
+private:
+    T& _queue;
+    quint64 _enqueueUsecs;
+};
+
+// the usecs per thousand packets that the producers spent adding them, and that the consumer spent taking them
+template<class T> static void benchmarkHandoff(T& queue, float& enqueueUsecs, float& dequeueUsecs) {
+    QVector<BenchmarkProducerThread<T>*> producers;
+    for (int i = 0; i < PRODUCERS; i++) {
+        producers.append(new BenchmarkProducerThread<T>(queue));
+        producers.last()->start();
+    }
+
+    QVector<NetworkPacket> packets;
+    int packetsTaken = 0;
+    quint64 totalDequeueUsecs = 0;
+    while (packetsTaken < PRODUCERS * PACKETS_PER_PRODUCER) {
+        quint64 start = usecTimestampNow();
+        int packetsInBatch = queue.dequeue(packets, BENCHMARK_BATCH_PACKETS);
+        if (packetsInBatch == 0) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        totalDequeueUsecs += usecTimestampNow() - start;
+        packetsTaken += packetsInBatch;
+        packets.resize(0);
+    }
+
+    quint64 totalEnqueueUsecs = 0;
+    foreach (BenchmarkProducerThread<T>* producer, producers) {
+        producer->wait();
+        totalEnqueueUsecs += producer->getEnqueueUsecs();
+        delete producer;
+    }
+    enqueueUsecs = (float)totalEnqueueUsecs * 1000 / packetsTaken;
+    dequeueUsecs = (float)totalDequeueUsecs * 1000 / packetsTaken;
+}
+
+void PacketQueueTests::benchmarkHandoff() {
+    float lockedVectorEnqueueUsecs, lockedVectorDequeueUsecs;
+    LockedVectorQueue lockedVectorQueue;
+    ::benchmarkHandoff(lockedVectorQueue, lockedVectorEnqueueUsecs, lockedVectorDequeueUsecs);
+
+    float packetQueueEnqueueUsecs, packetQueueDequeueUsecs;
+    PacketQueue packetQueue;
+    ::benchmarkHandoff(packetQueue, packetQueueEnqueueUsecs, packetQueueDequeueUsecs);
+
+    const Histogram& depths = packetQueue.getDepthHistogram();
+    const Histogram& waitTimes = packetQueue.getWaitTimeHistogram();
+    std::cout << PRODUCERS << " threads to one, usecs per 1000 packets added/taken: " << lockedVectorEnqueueUsecs << "/" <<
+        lockedVectorDequeueUsecs << " with a locked vector, " << packetQueueEnqueueUsecs << "/" << packetQueueDequeueUsecs <<
+        " with PacketQueue (depth 50/99% " << depths.getPercentile(0.5f) << "/" << depths.getPercentile(0.99f) <<
+        ", wait 50/99% " << waitTimes.getPercentile(0.5f) << "/" << waitTimes.getPercentile(0.99f) << " usecs, " <<
+        packetQueue.getOverflowedPackets() << " overflowed)" << std::endl;
+}
+
+void PacketQueueTests::runAllTests() {
+    testOrder();
+    testConcurrentProducers();
+    testHistograms();
+    benchmarkHandoff();
+}
@@ -0,0 +1,30 @@
+//
+//  PacketQueueTests.h
+//  networking-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__PacketQueueTests__
+#define __tests__PacketQueueTests__
+
+namespace PacketQueueTests {
+
+    /// checks that packets come out in the order they went in, in batches, around the ring and through the overflow
+    void testOrder();
+
+    /// checks that packets from many threads at once all come out, each thread's in the order it added them
+    void testConcurrentProducers();
+
+    /// checks the depth and wait time histograms
+    void testHistograms();
+
+    /// prints how long several threads adding bursts of packets, and the one thread taking them, spend in the queue and
+    /// in the locked vector that PacketSender and ReceivedPacketProcessor used before
+    void benchmarkHandoff();
+
+    void runAllTests();
+}
+
+#endif // __tests__PacketQueueTests__
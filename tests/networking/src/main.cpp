@@ -0,0 +1,24 @@
+//
+//  main.cpp
+//  networking-tests
+//
+
+#include <QtCore/QCoreApplication>
+
+#include "DatagramBatchTests.h"
+#include "DomainListDeltaTests.h"
+#include "PacketBufferTests.h"
+#include "PacketHashTests.h"
+#include "PacketQueueTests.h"
+
+int main(int argc, char** argv) {
+    // the sockets want an application to belong to, even without an event loop
+    QCoreApplication application(argc, argv);
+
+    DomainListDeltaTests::runAllTests();
+    DatagramBatchTests::runAllTests();
+    PacketHashTests::runAllTests();
+    PacketBufferTests::runAllTests();
+    PacketQueueTests::runAllTests();
+    return 0;
+}
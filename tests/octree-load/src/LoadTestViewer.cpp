@@ -0,0 +1,219 @@
+//
+//  LoadTestViewer.cpp
+//  octree-load-test
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <QtCore/QTimer>
+
+#include <NodeList.h>
+#include <OctreeConstants.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "LoadTestViewer.h"
+
+const int QUERY_INTERVAL_MSECS = 1000 / 60;
+const int STATS_INTERVAL_MSECS = 1000;
+const int DEFAULT_DURATION_SECONDS = 60;
+
+LoadTestViewer::LoadTestViewer(int& argc, char** argv) :
+    QCoreApplication(argc, argv),
+    _viewerIndex(0),
+    _jurisdictionListener(NULL),
+    _voxelViewer(),
+    _orbitCenter(TREE_SCALE * 0.5f, 0.0f, TREE_SCALE * 0.5f),
+    _orbitRadius(20.0f),
+    _orbitDegreesPerSecond(10.0f),
+    _startTime(usecTimestampNow()),
+    _packetsThisSecond(0),
+    _bytesThisSecond(0),
+    _maxPacketGapThisSecond(0),
+    _lastPacketTime(0),
+    _totalPackets(0),
+    _totalBytes(0),
+    _maxPacketGap(0),
+    _secondsWithoutData(0)
+{
+    NodeList* nodeList = NodeList::createInstance(NodeType::Agent);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    const char** constArgv = const_cast<const char**>(argv);
+
+    const char* viewerIndex = getCmdOption(argc, constArgv, "--viewerIndex");
+    if (viewerIndex) {
+        _viewerIndex = atoi(viewerIndex);
+    }
+
+    if (cmdOptionExists(argc, constArgv, "--local")) {
+        nodeList->getDomainInfo().setIPToLocalhost();
+    }
+
+    const char* domainHostname = getCmdOption(argc, constArgv, "--domain");
+    if (domainHostname) {
+        nodeList->getDomainInfo().setHostname(domainHostname);
+    }
+
+    const char* orbitRadius = getCmdOption(argc, constArgv, "--orbitRadius");
+    if (orbitRadius) {
+        _orbitRadius = atof(orbitRadius);
+    }
+
+    // 0 keeps every viewer still, which only asks the servers to resend the scene when it changes
+    const char* orbitSpeed = getCmdOption(argc, constArgv, "--orbitDegreesPerSecond");
+    if (orbitSpeed) {
+        _orbitDegreesPerSecond = atof(orbitSpeed);
+    }
+
+    const char* maxPPS = getCmdOption(argc, constArgv, "--pps");
+    if (maxPPS) {
+        _voxelViewer.setMaxPacketsPerSecond(atoi(maxPPS));
+    }
+
+    int durationSeconds = DEFAULT_DURATION_SECONDS;
+    const char* duration = getCmdOption(argc, constArgv, "--duration");
+    if (duration) {
+        durationSeconds = atoi(duration);
+    }
+
+    nodeList->addNodeTypeToInterestSet(NodeType::VoxelServer);
+    nodeList->linkedDataCreateCallback = NULL;
+
+    _jurisdictionListener = new JurisdictionListener(NodeType::VoxelServer);
+    _jurisdictionListener->initialize(true);
+
+    _voxelViewer.setJurisdictionListener(_jurisdictionListener);
+    _voxelViewer.init();
+
+    QTimer* domainServerTimer = new QTimer(this);
+    connect(domainServerTimer, SIGNAL(timeout()), nodeList, SLOT(sendDomainServerCheckIn()));
+    domainServerTimer->start(DOMAIN_SERVER_CHECK_IN_USECS / 1000);
+
+    QTimer* silentNodeTimer = new QTimer(this);
+    connect(silentNodeTimer, SIGNAL(timeout()), nodeList, SLOT(removeSilentNodes()));
+    silentNodeTimer->start(NODE_SILENCE_THRESHOLD_USECS / 1000);
+
+    QTimer* queryTimer = new QTimer(this);
+    connect(queryTimer, SIGNAL(timeout()), SLOT(moveAndQuery()));
+    queryTimer->start(QUERY_INTERVAL_MSECS);
+
+    QTimer* statsTimer = new QTimer(this);
+    connect(statsTimer, SIGNAL(timeout()), SLOT(printStats()));
+    statsTimer->start(STATS_INTERVAL_MSECS);
+
+    QTimer::singleShot(durationSeconds * 1000, this, SLOT(printTotalsAndQuit()));
+
+    connect(&nodeList->getNodeSocket(), SIGNAL(readyRead()), SLOT(readPendingDatagrams()));
+}
+
+LoadTestViewer::~LoadTestViewer() {
+    if (_jurisdictionListener) {
+        _jurisdictionListener->terminate();
+        delete _jurisdictionListener;
+    }
+}
+
+void LoadTestViewer::moveAndQuery() {
+    // each viewer starts at a different point of the orbit and looks at its center
+    float secondsElapsed = (usecTimestampNow() - _startTime) / (float) USECS_PER_SECOND;
+    float angle = glm::radians(_viewerIndex * 37.0f + secondsElapsed * _orbitDegreesPerSecond);
+
+    _voxelViewer.setPosition(_orbitCenter + _orbitRadius * glm::vec3(sinf(angle), 0.0f, cosf(angle)));
+    _voxelViewer.setOrientation(glm::angleAxis(angle, IDENTITY_UP));
+    _voxelViewer.queryOctree();
+}
+
+void LoadTestViewer::readPendingDatagrams() {
+    NodeList* nodeList = NodeList::getInstance();
+
+    PacketBuffer receivedDatagram;
+    QByteArray receivedPacket;
+    HifiSockAddr senderSockAddr;
+
+    while (nodeList->readDatagram(receivedDatagram, senderSockAddr)) {
+        receivedDatagram.asByteArray(receivedPacket);
+
+        if (!nodeList->packetVersionAndHashMatch(receivedPacket)) {
+            continue;
+        }
+
+        PacketType packetType = packetTypeForPacket(receivedPacket);
+
+        if (packetType == PacketTypeJurisdiction) {
+            SharedNodePointer matchedNode = nodeList->sendingNodeForPacket(receivedPacket);
+            if (matchedNode) {
+                _jurisdictionListener->queueReceivedPacket(matchedNode, receivedDatagram);
+            }
+        } else if (packetType == PacketTypeVoxelData || packetType == PacketTypeOctreeStats) {
+            SharedNodePointer sourceNode = nodeList->sendingNodeForPacket(receivedPacket);
+            if (!sourceNode) {
+                continue;
+            }
+            sourceNode->setLastHeardMicrostamp(usecTimestampNow());
+
+            receivedVoxelPacket(receivedPacket.size());
+
+            // stats may have the voxel data piggybacked on the end of them
+            QByteArray voxelPacket = receivedPacket;
+            if (packetType == PacketTypeOctreeStats) {
+                int statsMessageLength = OctreeHeadlessViewer::parseOctreeStats(voxelPacket, sourceNode);
+                if (voxelPacket.size() <= statsMessageLength) {
+                    continue;
+                }
+                voxelPacket = voxelPacket.mid(statsMessageLength);
+            }
+
+            _voxelViewer.processDatagram(voxelPacket, sourceNode);
+        } else {
+            nodeList->processNodeData(senderSockAddr, receivedPacket);
+        }
+    }
+}
+
+void LoadTestViewer::receivedVoxelPacket(int packetBytes) {
+    quint64 now = usecTimestampNow();
+    if (_lastPacketTime > 0) {
+        _maxPacketGapThisSecond = std::max(_maxPacketGapThisSecond, now - _lastPacketTime);
+    }
+    _lastPacketTime = now;
+
+    ++_packetsThisSecond;
+    _bytesThisSecond += packetBytes;
+}
+
+void LoadTestViewer::printStats() {
+    printf("viewer %d: %d packets/s %d bytes/s, longest gap between packets %llu msecs, %u elements\n",
+           _viewerIndex, _packetsThisSecond, _bytesThisSecond, _maxPacketGapThisSecond / USECS_PER_MSEC,
+           _voxelViewer.getOctreeElementsCount());
+
+    if (_packetsThisSecond == 0) {
+        ++_secondsWithoutData;
+    }
+
+    _totalPackets += _packetsThisSecond;
+    _totalBytes += _bytesThisSecond;
+    _maxPacketGap = std::max(_maxPacketGap, _maxPacketGapThisSecond);
+
+    _packetsThisSecond = 0;
+    _bytesThisSecond = 0;
+    _maxPacketGapThisSecond = 0;
+}
+
+void LoadTestViewer::printTotalsAndQuit() {
+    // count whatever came in since the last stats
+    printStats();
+    
+    float secondsElapsed = (usecTimestampNow() - _startTime) / (float) USECS_PER_SECOND;
+
+    printf("viewer %d totals: %d packets, %lld bytes, %.1f packets/s, longest gap %llu msecs, %d seconds without data\n",
+           _viewerIndex, _totalPackets, _totalBytes, _totalPackets / secondsElapsed, _maxPacketGap / USECS_PER_MSEC,
+           _secondsWithoutData);
+
+    quit();
+}
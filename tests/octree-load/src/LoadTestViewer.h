@@ -0,0 +1,54 @@
+//
+//  LoadTestViewer.h
+//  octree-load-test
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__LoadTestViewer__
+#define __tests__LoadTestViewer__
+
+#include <QtCore/QCoreApplication>
+
+#include <JurisdictionListener.h>
+#include <VoxelTreeHeadlessViewer.h>
+
+/// A headless agent that checks in with a domain and queries its voxel servers the way the interface does, with a
+/// camera that orbits a point so that the servers keep having to send new scenes, and prints what it receives.
+class LoadTestViewer : public QCoreApplication {
+    Q_OBJECT
+public:
+    LoadTestViewer(int& argc, char** argv);
+    ~LoadTestViewer();
+
+private slots:
+    void readPendingDatagrams();
+    void moveAndQuery();
+    void printStats();
+    void printTotalsAndQuit();
+
+private:
+    void receivedVoxelPacket(int packetBytes);
+
+    int _viewerIndex;
+    JurisdictionListener* _jurisdictionListener;
+    VoxelTreeHeadlessViewer _voxelViewer;
+
+    glm::vec3 _orbitCenter;
+    float _orbitRadius;
+    float _orbitDegreesPerSecond;
+    quint64 _startTime;
+
+    int _packetsThisSecond;
+    int _bytesThisSecond;
+    quint64 _maxPacketGapThisSecond;
+    quint64 _lastPacketTime;
+
+    int _totalPackets;
+    qint64 _totalBytes;
+    quint64 _maxPacketGap;
+    int _secondsWithoutData;
+};
+
+#endif // __tests__LoadTestViewer__
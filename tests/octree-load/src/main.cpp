@@ -0,0 +1,58 @@
+//
+//  main.cpp
+//  octree-load-test
+//
+//  Runs --viewers N headless viewers against the voxel servers of a domain, each in a process of its own since a
+//  process only has the one NodeList. For example:
+//
+//      octree-load-test --local --viewers 200 --duration 120
+//
+
+#include <cstdlib>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QProcess>
+#include <QtCore/QStringList>
+
+#include <SharedUtil.h>
+
+#include "LoadTestViewer.h"
+
+int main(int argc, char** argv) {
+    const char* VIEWERS = "--viewers";
+    const char* numViewersOption = getCmdOption(argc, const_cast<const char**>(argv), VIEWERS);
+
+    if (!numViewersOption) {
+        LoadTestViewer viewer(argc, argv);
+        return viewer.exec();
+    }
+
+    QCoreApplication application(argc, argv);
+
+    // the viewers get all of our arguments except the number of viewers, and an index of their own
+    QStringList viewerArguments = application.arguments().mid(1);
+    int viewersIndex = viewerArguments.indexOf(VIEWERS);
+    viewerArguments.removeAt(viewersIndex + 1);
+    viewerArguments.removeAt(viewersIndex);
+
+    QList<QProcess*> viewers;
+    int numViewers = atoi(numViewersOption);
+    for (int i = 0; i < numViewers; i++) {
+        QProcess* viewer = new QProcess(&application);
+        viewer->setProcessChannelMode(QProcess::ForwardedChannels);
+        viewer->start(application.applicationFilePath(),
+                      QStringList(viewerArguments) << "--viewerIndex" << QString::number(i));
+        viewers.append(viewer);
+    }
+
+    int numFailedViewers = 0;
+    foreach (QProcess* viewer, viewers) {
+        viewer->waitForFinished(-1);
+        if (viewer->exitStatus() != QProcess::NormalExit || viewer->exitCode() != 0) {
+            numFailedViewers++;
+        }
+    }
+
+    printf("%d of %d viewers finished cleanly\n", numViewers - numFailedViewers, numViewers);
+    return numFailedViewers > 0 ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+//
+//  OctreeEditJournalTests.cpp
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <iostream>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+
+#include <OctreeEditJournal.h>
+#include <SharedUtil.h>
+#include <VoxelTree.h>
+
+#include "OctreeEditJournalTests.h"
+#include "VoxelTestUtil.h"
+
+const int INITIAL_VOXELS = 20000;
+const int EDIT_PACKETS = 2000;
+const int EDITS_PER_PACKET = 20;
+
+// journals the packets from first to last, as the server does with each batch, and applies them to the tree
+static void journalEdits(OctreeEditJournal& journal, VoxelTree& tree, const QVector<QByteArray>& edits,
+                         int firstPacket, int lastPacket) {
+    for (int i = firstPacket; i < lastPacket; i++) {
+        journal.beginBatch();
+        journal.append(voxelSetPacket(edits, i * EDITS_PER_PACKET, EDITS_PER_PACKET));
+        journal.flush();
+        applyEdits(&tree, edits, i * EDITS_PER_PACKET, EDITS_PER_PACKET);
+        journal.endBatch();
+    }
+}
+
+void OctreeEditJournalTests::recoversEditsAfterSave() {
+    QString persistFilename = QDir::temp().filePath("octree-edit-journal-test.svo");
+
+    QVector<QByteArray> initialVoxels;
+    for (int i = 0; i < INITIAL_VOXELS; i++) {
+        initialVoxels.append(randomVoxelEdit());
+    }
+    QVector<QByteArray> edits;
+    for (int i = 0; i < EDIT_PACKETS * EDITS_PER_PACKET; i++) {
+        edits.append(randomVoxelEdit());
+    }
+
+    VoxelTree editedTree;
+    applyEdits(&editedTree, initialVoxels, 0, INITIAL_VOXELS);
+    editedTree.writeToSVOFile(persistFilename.toLocal8Bit().constData());
+
+    OctreeEditJournal journal(persistFilename);
+    journal.discard();
+    journal.start();
+
+    // half of the edits go to a journal that is rotated for a save that never happens, the rest to the next one
+    quint64 start = usecTimestampNow();
+    journalEdits(journal, editedTree, edits, 0, EDIT_PACKETS / 2);
+    journal.rotate();
+    journalEdits(journal, editedTree, edits, EDIT_PACKETS / 2, EDIT_PACKETS);
+    quint64 elapsed = usecTimestampNow() - start;
+    std::cout << "journaled and applied " << EDIT_PACKETS << " edit packets: " << elapsed / USECS_PER_MSEC << " msecs, "
+        << (float)elapsed / EDIT_PACKETS << " usecs each, " << (float)journal.getFlushUsecs() / journal.getFlushes()
+        << " usecs per flush" << std::endl;
+
+    // and the server dies in the middle of writing a record
+    QFile currentJournal(persistFilename + ".journal");
+    currentJournal.open(QIODevice::WriteOnly | QIODevice::Append);
+    currentJournal.write(voxelSetPacket(edits, 0, EDITS_PER_PACKET).left(5));
+    currentJournal.close();
+
+    VoxelTree recoveredTree;
+    recoveredTree.readFromSVOFile(persistFilename.toLocal8Bit().constData());
+
+    OctreeEditJournal recoveredJournal(persistFilename);
+    start = usecTimestampNow();
+    int packetsReplayed = recoveredJournal.replay(&recoveredTree);
+    elapsed = usecTimestampNow() - start;
+    std::cout << "replayed " << packetsReplayed << " edit packets: " << elapsed / USECS_PER_MSEC << " msecs, "
+        << (elapsed > 0 ? (float)packetsReplayed * USECS_PER_SECOND / elapsed : 0.0f) << " packets/s" << std::endl;
+
+    if (packetsReplayed != EDIT_PACKETS) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: replayed " << packetsReplayed << " edit packets, expected "
+            << EDIT_PACKETS << std::endl;
+    }
+    if (sumVoxels(&recoveredTree) != sumVoxels(&editedTree)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the recovered tree has different voxels than the edited one"
+            << std::endl;
+    }
+
+    recoveredJournal.discard();
+    QFile::remove(persistFilename);
+}
+
+void OctreeEditJournalTests::runAllTests() {
+    recoversEditsAfterSave();
+}
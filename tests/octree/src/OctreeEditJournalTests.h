@@ -0,0 +1,22 @@
+//
+//  OctreeEditJournalTests.h
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__OctreeEditJournalTests__
+#define __tests__OctreeEditJournalTests__
+
+namespace OctreeEditJournalTests {
+
+    /// journals edit packets after a save, across a rotation and with a record cut short at the end, and checks that
+    /// replaying the journal over the saved file gets back the tree the edits were applied to, printing how fast the
+    /// journal is written and replayed
+    void recoversEditsAfterSave();
+
+    void runAllTests();
+}
+
+#endif // __tests__OctreeEditJournalTests__
@@ -0,0 +1,201 @@
+//
+//  OctreeElementPoolTests.cpp
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <cmath>
+#include <iostream>
+
+#include <QtCore/QVector>
+
+#include <OctalCode.h>
+#include <OctreeElementPool.h>
+#include <SharedUtil.h>
+#include <VoxelTree.h>
+#include <VoxelTreeElement.h>
+
+#include "OctreeElementPoolTests.h"
+
+// enough blocks to take a few slabs
+const int POOL_TEST_BLOCKS = 20000;
+
+const int BOUNDS_TEST_ELEMENTS = 1000;
+const int BOUNDS_TEST_MAX_LEVEL = 16;
+
+void OctreeElementPoolTests::reusesFreedBlocks() {
+    OctreeElementPool blockPool(sizeof(VoxelTreeElement), false);
+    OctreeElementPool groupPool(sizeof(VoxelTreeElement), true);
+
+    QVector<void*> blocks;
+    QVector<void*> groupBlocks;
+    for (int i = 0; i < POOL_TEST_BLOCKS; i++) {
+        blocks.append(blockPool.allocate());
+        groupBlocks.append(groupPool.allocateChild(i % NUMBER_OF_CHILDREN == 0 ? NULL : groupBlocks.last(),
+                                                   (i - 1) % NUMBER_OF_CHILDREN, i % NUMBER_OF_CHILDREN));
+    }
+    quint64 blockPoolReservedBytes = blockPool.getReservedBytes();
+    quint64 groupPoolReservedBytes = groupPool.getReservedBytes();
+
+    foreach (void* block, blocks) {
+        blockPool.release(block);
+    }
+    foreach (void* block, groupBlocks) {
+        groupPool.release(block);
+    }
+    if (blockPool.getBytesInUse() != 0 || groupPool.getBytesInUse() != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: blocks are still in use after all of them were released"
+            << std::endl;
+    }
+
+    // the block freed last is the first handed out again
+    void* reusedBlock = blockPool.allocate();
+    if (reusedBlock != blocks.last()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the block pool didn't hand out the block freed last"
+            << std::endl;
+    }
+    blockPool.release(reusedBlock);
+
+    for (int i = 0; i < POOL_TEST_BLOCKS; i++) {
+        blocks[i] = blockPool.allocate();
+        groupBlocks[i] = groupPool.allocateChild(i % NUMBER_OF_CHILDREN == 0 ? NULL : groupBlocks[i - 1],
+                                                 (i - 1) % NUMBER_OF_CHILDREN, i % NUMBER_OF_CHILDREN);
+    }
+    if (blockPool.getReservedBytes() != blockPoolReservedBytes || groupPool.getReservedBytes() != groupPoolReservedBytes) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the pools reserved more slabs instead of reusing freed blocks"
+            << std::endl;
+    }
+
+    foreach (void* block, blocks) {
+        blockPool.release(block);
+    }
+    foreach (void* block, groupBlocks) {
+        groupPool.release(block);
+    }
+}
+
+void OctreeElementPoolTests::placesSiblingsTogether() {
+    OctreeElementPool pool(sizeof(VoxelTreeElement), true);
+    int blockBytes = pool.getBlockBytes();
+
+    // children added out of order still end up in child order
+    const int FIRST_CHILD_INDEX = 5;
+    char* children[NUMBER_OF_CHILDREN];
+    children[FIRST_CHILD_INDEX] = static_cast<char*>(pool.allocateChild(NULL, 0, FIRST_CHILD_INDEX));
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        if (i != FIRST_CHILD_INDEX) {
+            children[i] = static_cast<char*>(pool.allocateChild(children[FIRST_CHILD_INDEX], FIRST_CHILD_INDEX, i));
+        }
+    }
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        if (children[i] != children[0] + i * blockBytes) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: child " << i << " isn't next to its siblings"
+                << std::endl;
+        }
+    }
+
+    // a child deleted and added again goes back where it was, and nothing else is put there in the meantime
+    pool.release(children[2]);
+    void* looseBlock = pool.allocate();
+    if (looseBlock == children[2]) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the block of a deleted child was given to another element"
+            << std::endl;
+    }
+    if (pool.allocateChild(children[0], 0, 2) != children[2]) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: a child added again wasn't put back next to its siblings"
+            << std::endl;
+    }
+
+    pool.release(looseBlock);
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        pool.release(children[i]);
+    }
+
+    // and the same for the elements of a tree
+    VoxelTree tree;
+    OctreeElement* parent = tree.getRoot()->addChildAtIndex(0);
+    OctreeElement* treeChildren[NUMBER_OF_CHILDREN];
+    for (int i = NUMBER_OF_CHILDREN - 1; i >= 0; i--) {
+        treeChildren[i] = parent->addChildAtIndex(i);
+    }
+    qint64 stride = reinterpret_cast<char*>(treeChildren[1]) - reinterpret_cast<char*>(treeChildren[0]);
+    if (stride < (qint64)sizeof(VoxelTreeElement)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the children of a tree element are " << stride
+            << " bytes apart" << std::endl;
+    }
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        if (reinterpret_cast<char*>(treeChildren[i]) != reinterpret_cast<char*>(treeChildren[0]) + i * stride) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: child " << i << " of a tree element isn't next to its "
+                << "siblings" << std::endl;
+        }
+    }
+}
+
+void OctreeElementPoolTests::poolsExternalChildren() {
+    const quint64 EXTERNAL_CHILDREN_BYTES = NUMBER_OF_CHILDREN * sizeof(OctreeElement*);
+
+    VoxelTree tree;
+    OctreeElement* parent = tree.getRoot()->addChildAtIndex(0);
+    quint64 bytesInUse = OctreeElement::getExternalChildrenPoolMemoryInUse();
+
+    // a single child is kept in the element itself
+    parent->addChildAtIndex(3);
+    if (OctreeElement::getExternalChildrenPoolMemoryInUse() != bytesInUse) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: an element with one child took an array of children"
+            << std::endl;
+    }
+
+    parent->addChildAtIndex(6);
+    if (OctreeElement::getExternalChildrenPoolMemoryInUse() != bytesInUse + EXTERNAL_CHILDREN_BYTES) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: an element with two children didn't take an array of "
+            << "children from the pool" << std::endl;
+    }
+
+    parent->deleteChildAtIndex(6);
+    if (OctreeElement::getExternalChildrenPoolMemoryInUse() != bytesInUse) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: an element back to one child didn't give back its array "
+            << "of children" << std::endl;
+    }
+
+    // deleting an element deletes all of its children along with it
+    parent->addChildAtIndex(1);
+    parent->addChildAtIndex(2);
+    tree.getRoot()->deleteChildAtIndex(0);
+    if (OctreeElement::getExternalChildrenPoolMemoryInUse() != bytesInUse) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: deleting an element with children didn't give back its "
+            << "array of children" << std::endl;
+    }
+}
+
+void OctreeElementPoolTests::computesBoundsFromOctalCodes() {
+    VoxelTree tree;
+
+    for (int i = 0; i < BOUNDS_TEST_ELEMENTS; i++) {
+        OctreeElement* element = tree.getRoot();
+        int level = 1 + randIntInRange(0, BOUNDS_TEST_MAX_LEVEL);
+        for (int j = 0; j < level; j++) {
+            element = element->addChildAtIndex(randIntInRange(0, NUMBER_OF_CHILDREN - 1));
+        }
+
+        // the way elements used to work out the box they stored
+        glm::vec3 corner;
+        copyFirstVertexForCode(element->getOctalCode(), (float*)&corner);
+        float scale = 1 / powf(2, numberOfThreeBitSectionsInCode(element->getOctalCode()));
+
+        AABox box = element->getAABox();
+        if (element->getCorner() != corner || element->getScale() != scale
+                || box.getCorner() != corner || box.getScale() != scale) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the bounds of an element at level "
+                << element->getLevel() << " differ from the stored ones" << std::endl;
+        }
+    }
+}
+
+void OctreeElementPoolTests::runAllTests() {
+    reusesFreedBlocks();
+    placesSiblingsTogether();
+    poolsExternalChildren();
+    computesBoundsFromOctalCodes();
+}
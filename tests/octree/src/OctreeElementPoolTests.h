@@ -0,0 +1,29 @@
+//
+//  OctreeElementPoolTests.h
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__OctreeElementPoolTests__
+#define __tests__OctreeElementPoolTests__
+
+namespace OctreeElementPoolTests {
+
+    /// checks that freed blocks and groups are handed out again before any more slabs are reserved
+    void reusesFreedBlocks();
+
+    /// checks that the children an element adds are placed next to each other in child order, in pools and in a tree
+    void placesSiblingsTogether();
+
+    /// checks that the arrays of external children come from their pool and go back to it as children come and go
+    void poolsExternalChildren();
+
+    /// checks that the bounds computed from the octal codes of elements are the ones they used to store
+    void computesBoundsFromOctalCodes();
+
+    void runAllTests();
+}
+
+#endif // __tests__OctreeElementPoolTests__
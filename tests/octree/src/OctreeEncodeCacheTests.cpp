@@ -0,0 +1,165 @@
+//
+//  OctreeEncodeCacheTests.cpp
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <iostream>
+
+#include <QtCore/QVector>
+
+#include <OctreeElementBag.h>
+#include <OctreeEncodeCache.h>
+#include <OctreePacketData.h>
+#include <OctreeSceneStats.h>
+#include <SharedUtil.h>
+#include <ViewFrustum.h>
+#include <VoxelTree.h>
+
+#include "OctreeEncodeCacheTests.h"
+#include "VoxelTestUtil.h"
+
+const int INITIAL_VOXELS = 20000;
+const int EDITS = 500;
+
+const int VIEWERS = 4;
+const int BENCHMARK_SCENES_PER_VIEWER = 5;
+
+// the viewers stand a few meters apart in the middle of the tree, looking different ways
+static ViewFrustum viewerFrustum(int viewer) {
+    const float VIEWER_SPACING = 4.0f;
+    ViewFrustum viewFrustum;
+    viewFrustum.setPosition(glm::vec3(0.5f, 0.5f, 0.5f) * (float)TREE_SCALE + glm::vec3(viewer * VIEWER_SPACING, 0.0f, 0.0f));
+    viewFrustum.setOrientation(glm::angleAxis(viewer * PI_OVER_TWO, glm::vec3(0.0f, 1.0f, 0.0f)));
+    viewFrustum.setFieldOfView(DEFAULT_FIELD_OF_VIEW_DEGREES);
+    viewFrustum.setAspectRatio(DEFAULT_ASPECT_RATIO);
+    viewFrustum.setNearClip(DEFAULT_NEAR_CLIP);
+    viewFrustum.setFarClip(DEFAULT_FAR_CLIP);
+    viewFrustum.calculate();
+    return viewFrustum;
+}
+
+// encodes a whole scene the way the server sends one, returning the bytes of all of its packets
+static QByteArray encodeScene(VoxelTree* tree, const ViewFrustum& viewFrustum, OctreeSceneStats& stats) {
+    OctreePacketData packetData;
+    OctreeElementBag bag;
+    QByteArray scene;
+
+    stats.sceneStarted(true, false, tree->getRoot(), IGNORE_JURISDICTION_MAP);
+    bag.insert(tree->getRoot());
+    while (!bag.isEmpty()) {
+        OctreeElement* subTree = bag.extract();
+        EncodeBitstreamParams params(INT_MAX, &viewFrustum, WANT_COLOR, WANT_EXISTS_BITS, 0, false, IGNORE_VIEW_FRUSTUM,
+                                     NO_OCCLUSION_CULLING, IGNORE_COVERAGE_MAP, NO_BOUNDARY_ADJUST,
+                                     DEFAULT_OCTREE_SIZE_SCALE, IGNORE_LAST_SENT, true, &stats);
+        int bytesWritten = tree->encodeTreeBitstream(subTree, &packetData, bag, params);
+
+        // a full packet is sent and the element goes back in the bag for the next one
+        if (bytesWritten == 0 && params.stopReason == EncodeBitstreamParams::DIDNT_FIT) {
+            scene.append((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+            packetData.reset();
+            bag.insert(subTree);
+        }
+    }
+    if (packetData.hasContent()) {
+        scene.append((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+    }
+    stats.sceneCompleted();
+    return scene;
+}
+
+static QVector<QByteArray> randomVoxelEdits(int count) {
+    QVector<QByteArray> edits;
+    for (int i = 0; i < count; i++) {
+        edits.append(randomVoxelEdit());
+    }
+    return edits;
+}
+
+// encodes each viewer's scene without the cache, then with it, expecting a hit from the other viewers' subtrees
+static void checkScenesMatch(VoxelTree& tree, const char* when) {
+    OctreeSceneStats stats;
+
+    QVector<QByteArray> uncachedScenes;
+    tree.setWantEncodeCache(false);
+    for (int viewer = 0; viewer < VIEWERS; viewer++) {
+        uncachedScenes.append(encodeScene(&tree, viewerFrustum(viewer), stats));
+    }
+
+    tree.setWantEncodeCache(true);
+    quint64 hits = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int viewer = 0; viewer < VIEWERS; viewer++) {
+            QByteArray cachedScene = encodeScene(&tree, viewerFrustum(viewer), stats);
+            hits += stats.getEncodeCacheHits();
+            if (cachedScene != uncachedScenes.at(viewer)) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR: viewer " << viewer << " was sent " <<
+                    cachedScene.size() << " bytes " << when << " with the cache, but " << uncachedScenes.at(viewer).size() <<
+                    " bytes without it" << std::endl;
+            }
+        }
+    }
+    if (hits == 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: no subtrees were found in the cache " << when << std::endl;
+    }
+}
+
+void OctreeEncodeCacheTests::testCachedScenesMatch() {
+    VoxelTree tree;
+    applyEdits(&tree, randomVoxelEdits(INITIAL_VOXELS), 0, INITIAL_VOXELS);
+    checkScenesMatch(tree, "before edits");
+
+    // edit the tree with the cache still holding the subtrees from before
+    tree.setWantEncodeCache(true);
+    applyEdits(&tree, randomVoxelEdits(EDITS), 0, EDITS);
+    OctreeSceneStats stats;
+    QByteArray editedScene = encodeScene(&tree, viewerFrustum(0), stats);
+
+    tree.setWantEncodeCache(false);
+    if (editedScene != encodeScene(&tree, viewerFrustum(0), stats)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the cache sent subtrees from before the edits" << std::endl;
+    }
+    checkScenesMatch(tree, "after edits");
+}
+
+static void runNearbyViewers(VoxelTree& tree, const char* mode) {
+    OctreeSceneStats stats;
+    quint64 hits = 0;
+    quint64 misses = 0;
+
+    quint64 start = usecTimestampNow();
+    for (int scene = 0; scene < BENCHMARK_SCENES_PER_VIEWER; scene++) {
+        for (int viewer = 0; viewer < VIEWERS; viewer++) {
+            encodeScene(&tree, viewerFrustum(viewer), stats);
+            hits += stats.getEncodeCacheHits();
+            misses += stats.getEncodeCacheMisses();
+        }
+    }
+    float seconds = (float)(usecTimestampNow() - start) / USECS_PER_SECOND;
+
+    std::cout << mode << ": " << VIEWERS << " viewers encoded " << (VIEWERS * BENCHMARK_SCENES_PER_VIEWER) / seconds
+        << " scenes/s, " << hits << " cache hits, " << misses << " misses";
+    if (tree.getEncodeCache()) {
+        std::cout << ", " << tree.getEncodeCache()->getSubtreeCount() << " subtrees in " <<
+            tree.getEncodeCache()->getBytes() << " bytes";
+    }
+    std::cout << std::endl;
+}
+
+void OctreeEncodeCacheTests::benchmarkNearbyViewers() {
+    VoxelTree tree;
+    applyEdits(&tree, randomVoxelEdits(INITIAL_VOXELS), 0, INITIAL_VOXELS);
+
+    tree.setWantEncodeCache(false);
+    runNearbyViewers(tree, "without encode cache");
+
+    tree.setWantEncodeCache(true);
+    runNearbyViewers(tree, "with encode cache");
+}
+
+void OctreeEncodeCacheTests::runAllTests() {
+    testCachedScenesMatch();
+    benchmarkNearbyViewers();
+}
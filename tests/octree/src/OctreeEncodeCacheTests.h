@@ -0,0 +1,25 @@
+//
+//  OctreeEncodeCacheTests.h
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__OctreeEncodeCacheTests__
+#define __tests__OctreeEncodeCacheTests__
+
+namespace OctreeEncodeCacheTests {
+
+    /// checks that viewers are sent the same scenes with the cache as without it, from subtrees another viewer put there
+    /// and after edits to them
+    void testCachedScenesMatch();
+
+    /// has several viewers near each other encode whole scenes, with and without the cache, printing the scenes per second
+    /// and the cache's hit rate
+    void benchmarkNearbyViewers();
+
+    void runAllTests();
+}
+
+#endif // __tests__OctreeEncodeCacheTests__
@@ -0,0 +1,349 @@
+//
+//  OctreeSnapshotTests.cpp
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <algorithm>
+#include <iostream>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+
+#include <OctreeElementBag.h>
+#include <OctreePacketData.h>
+#include <OctreeSnapshots.h>
+#include <SharedUtil.h>
+#include <VoxelTree.h>
+
+#include "OctreeSnapshotTests.h"
+#include "VoxelTestUtil.h"
+
+const int INITIAL_VOXELS = 20000;
+const int EDIT_BATCHES = 200;
+const int EDITS_PER_BATCH = 50;
+const quint64 EDIT_BATCH_INTERVAL_USECS = 1000;
+
+const int VIEWERS = 4;
+
+// like a client of the octree server, a viewer sends this many packets each time it gets to read the tree
+const int PACKETS_PER_VIEWER_INTERVAL = 10;
+
+const quint64 BENCHMARK_USECS = 2 * USECS_PER_SECOND;
+
+// how long the persist thread takes to save the tree in the slow save test
+const quint64 SLOW_SAVE_USECS = USECS_PER_SECOND / 4;
+
+// one tree locked by editor and viewers alike, or a pair of snapshots of it
+struct ContentionRun {
+    ContentionRun(VoxelTree* tree, OctreeSnapshots* snapshots, const QVector<QByteArray>& edits) :
+        tree(tree), snapshots(snapshots), edits(edits), isStopping(0) { }
+
+    VoxelTree* tree;
+    OctreeSnapshots* snapshots;
+    QVector<QByteArray> edits;
+    QAtomicInt isStopping;
+};
+
+// Applies a batch of edits every interval, like the server's one inbound packet processor does with the edits of all of
+// its editors. With snapshots it applies each batch to the unpublished copy, after the batches that copy missed.
+class EditorThread : public QThread {
+public:
+    EditorThread(ContentionRun& run) :
+        _run(run),
+        _batches(0),
+        _sumWaitUsecs(0),
+        _maxWaitUsecs(0) { }
+
+    int getBatches() const { return _batches.load(); }
+    quint64 getSumWaitUsecs() const { return _sumWaitUsecs; }
+    quint64 getMaxWaitUsecs() const { return _maxWaitUsecs; }
+
+protected:
+    virtual void run() {
+        QVector<int> pendingBatches;
+        Octree* lastWrittenTree = NULL;
+        int batch = 0;
+        while (!_run.isStopping.load()) {
+            quint64 waitStart = usecTimestampNow();
+            Octree* tree = _run.tree;
+            if (_run.snapshots) {
+                tree = _run.snapshots->beginWrite();
+            }
+            tree->lockForWrite();
+            quint64 waitUsecs = usecTimestampNow() - waitStart;
+
+            if (_run.snapshots && tree != lastWrittenTree) {
+                foreach (int pendingBatch, pendingBatches) {
+                    applyEdits(tree, _run.edits, pendingBatch * EDITS_PER_BATCH, EDITS_PER_BATCH);
+                }
+                pendingBatches.resize(0);
+                lastWrittenTree = tree;
+            }
+            applyEdits(tree, _run.edits, batch * EDITS_PER_BATCH, EDITS_PER_BATCH);
+
+            tree->unlock();
+            if (_run.snapshots) {
+                _run.snapshots->publish();
+                pendingBatches.append(batch);
+            }
+            batch = (batch + 1) % EDIT_BATCHES;
+
+            _batches.ref();
+            _sumWaitUsecs += waitUsecs;
+            _maxWaitUsecs = std::max(_maxWaitUsecs, waitUsecs);
+
+            usleep(EDIT_BATCH_INTERVAL_USECS);
+        }
+
+        // catch the other copy up, so that both can be checked
+        if (_run.snapshots && !pendingBatches.isEmpty()) {
+            Octree* tree = _run.snapshots->beginWrite();
+            if (tree == lastWrittenTree) {
+                _run.snapshots->publish();
+                tree = _run.snapshots->beginWrite();
+            }
+            foreach (int pendingBatch, pendingBatches) {
+                applyEdits(tree, _run.edits, pendingBatch * EDITS_PER_BATCH, EDITS_PER_BATCH);
+            }
+        }
+    }
+
+private:
+    ContentionRun& _run;
+    QAtomicInt _batches;
+    quint64 _sumWaitUsecs;
+    quint64 _maxWaitUsecs;
+};
+
+// Encodes the whole tree over and over, a few packets at a time. It locks the tree for each few packets, or holds on to a
+// snapshot until it has sent the whole scene, moving over to the published copy whenever there is a newer one.
+class ViewerThread : public QThread {
+public:
+    ViewerThread(ContentionRun& run) :
+        _run(run),
+        _packets(0),
+        _scenes(0),
+        _intervals(0),
+        _sumWaitUsecs(0) { }
+
+    int getPackets() const { return _packets; }
+    int getScenes() const { return _scenes; }
+    int getIntervals() const { return _intervals; }
+    quint64 getSumWaitUsecs() const { return _sumWaitUsecs; }
+
+protected:
+    virtual void run() {
+        OctreePacketData packetData;
+
+        // only the locked tree can have elements deleted from under the bag
+        bool wantDeleteHook = !_run.snapshots;
+        OctreeElementBag bag(wantDeleteHook);
+        int snapshotIndex = -1;
+
+        while (!_run.isStopping.load()) {
+            quint64 waitStart = usecTimestampNow();
+            Octree* tree = _run.tree;
+            if (!_run.snapshots) {
+                tree->lockForRead();
+            } else {
+                if (snapshotIndex < 0) {
+                    snapshotIndex = _run.snapshots->pinPublished();
+                } else if (!_run.snapshots->isPublished(snapshotIndex)) {
+                    snapshotIndex = _run.snapshots->movePinToPublished(snapshotIndex, bag);
+                }
+                tree = _run.snapshots->getTree(snapshotIndex);
+            }
+            _sumWaitUsecs += usecTimestampNow() - waitStart;
+            _intervals++;
+
+            if (bag.isEmpty()) {
+                bag.insert(tree->getRoot());
+            }
+
+            int packetsThisInterval = 0;
+            while (!bag.isEmpty() && packetsThisInterval < PACKETS_PER_VIEWER_INTERVAL) {
+                OctreeElement* subTree = bag.extract();
+                EncodeBitstreamParams params(INT_MAX, IGNORE_VIEW_FRUSTUM, WANT_COLOR, NO_EXISTS_BITS);
+                int bytesWritten = tree->encodeTreeBitstream(subTree, &packetData, bag, params);
+
+                // a full packet is sent and the element goes back in the bag for the next one
+                if (bytesWritten == 0 && params.stopReason == EncodeBitstreamParams::DIDNT_FIT) {
+                    packetsThisInterval++;
+                    packetData.reset();
+                    bag.insert(subTree);
+                }
+            }
+
+            bool completedScene = bag.isEmpty();
+            if (completedScene) {
+                if (packetData.hasContent()) {
+                    packetsThisInterval++;
+                    packetData.reset();
+                }
+                _scenes++;
+            }
+            _packets += packetsThisInterval;
+
+            if (!_run.snapshots) {
+                tree->unlock();
+            } else if (completedScene) {
+                _run.snapshots->unpin(snapshotIndex);
+                snapshotIndex = -1;
+            }
+        }
+
+        if (snapshotIndex >= 0) {
+            _run.snapshots->unpin(snapshotIndex);
+        }
+    }
+
+private:
+    ContentionRun& _run;
+    int _packets;
+    int _scenes;
+    int _intervals;
+    quint64 _sumWaitUsecs;
+};
+
+static void runEditorsAndViewers(ContentionRun& run, const char* mode) {
+    EditorThread editor(run);
+    QVector<ViewerThread*> viewers;
+    for (int i = 0; i < VIEWERS; i++) {
+        viewers.append(new ViewerThread(run));
+    }
+
+    editor.start();
+    foreach (ViewerThread* viewer, viewers) {
+        viewer->start();
+    }
+
+    usleep(BENCHMARK_USECS);
+    run.isStopping.fetchAndStoreOrdered(1);
+
+    editor.wait();
+    int packets = 0;
+    int scenes = 0;
+    int intervals = 0;
+    quint64 viewerWaitUsecs = 0;
+    foreach (ViewerThread* viewer, viewers) {
+        viewer->wait();
+        packets += viewer->getPackets();
+        scenes += viewer->getScenes();
+        intervals += viewer->getIntervals();
+        viewerWaitUsecs += viewer->getSumWaitUsecs();
+        delete viewer;
+    }
+
+    float seconds = (float)BENCHMARK_USECS / USECS_PER_SECOND;
+    std::cout << mode << ": " << editor.getBatches() * EDITS_PER_BATCH / seconds << " edits/s, editor waited "
+        << (editor.getBatches() > 0 ? editor.getSumWaitUsecs() / editor.getBatches() : 0) << " usecs per batch (at most "
+        << editor.getMaxWaitUsecs() << "), " << VIEWERS << " viewers sent " << packets / seconds << " packets/s, "
+        << scenes / seconds << " scenes/s, waited " << (intervals > 0 ? viewerWaitUsecs / intervals : 0)
+        << " usecs per interval" << std::endl;
+}
+
+void OctreeSnapshotTests::benchmarkEditorsAndViewers() {
+    QVector<QByteArray> initialVoxels;
+    for (int i = 0; i < INITIAL_VOXELS; i++) {
+        initialVoxels.append(randomVoxelEdit());
+    }
+    QVector<QByteArray> edits;
+    for (int i = 0; i < EDIT_BATCHES * EDITS_PER_BATCH; i++) {
+        edits.append(randomVoxelEdit());
+    }
+
+    {
+        VoxelTree tree;
+        applyEdits(&tree, initialVoxels, 0, INITIAL_VOXELS);
+
+        ContentionRun run(&tree, NULL, edits);
+        runEditorsAndViewers(run, "locked tree");
+    }
+
+    {
+        VoxelTree first;
+        VoxelTree second;
+        applyEdits(&first, initialVoxels, 0, INITIAL_VOXELS);
+        applyEdits(&second, initialVoxels, 0, INITIAL_VOXELS);
+        OctreeSnapshots snapshots(&first, &second);
+
+        ContentionRun run(&first, &snapshots, edits);
+        runEditorsAndViewers(run, "snapshots");
+
+        if (sumVoxels(&first) != sumVoxels(&second)) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the snapshots hold different voxels after the same edits"
+                << std::endl;
+        }
+    }
+}
+
+void OctreeSnapshotTests::editsFlowDuringSlowSave() {
+    const int SAVE_TEST_INITIAL_VOXELS = 2000;
+
+    QVector<QByteArray> initialVoxels;
+    for (int i = 0; i < SAVE_TEST_INITIAL_VOXELS; i++) {
+        initialVoxels.append(randomVoxelEdit());
+    }
+    QVector<QByteArray> edits;
+    for (int i = 0; i < EDIT_BATCHES * EDITS_PER_BATCH; i++) {
+        edits.append(randomVoxelEdit());
+    }
+
+    VoxelTree first;
+    VoxelTree second;
+    applyEdits(&first, initialVoxels, 0, SAVE_TEST_INITIAL_VOXELS);
+    applyEdits(&second, initialVoxels, 0, SAVE_TEST_INITIAL_VOXELS);
+    OctreeSnapshots snapshots(&first, &second);
+
+    ContentionRun run(&first, &snapshots, edits);
+    EditorThread editor(run);
+    editor.start();
+    usleep(SLOW_SAVE_USECS);
+
+    // hold the published copy like the persist thread does while it saves, reading it as it goes
+    int savedIndex = snapshots.holdPublished();
+    uint savedSumBefore = sumVoxels(snapshots.getTree(savedIndex));
+    int batchesBeforeSave = editor.getBatches();
+
+    usleep(SLOW_SAVE_USECS);
+
+    int batchesDuringSave = editor.getBatches() - batchesBeforeSave;
+    uint savedSumAfter = sumVoxels(snapshots.getTree(savedIndex));
+    bool wasSavedCopyPublished = snapshots.isPublished(savedIndex);
+    snapshots.release(savedIndex);
+
+    usleep(SLOW_SAVE_USECS);
+    run.isStopping.fetchAndStoreOrdered(1);
+    editor.wait();
+
+    // the editor gets to sleep between batches, so it should manage well over a quarter of the batches it would have
+    int minBatchesDuringSave = SLOW_SAVE_USECS / EDIT_BATCH_INTERVAL_USECS / 4;
+    if (batchesDuringSave < minBatchesDuringSave) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the editor applied " << batchesDuringSave
+            << " batches during the save, expected at least " << minBatchesDuringSave << std::endl;
+    }
+    if (editor.getMaxWaitUsecs() >= SLOW_SAVE_USECS / 2) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the editor waited " << editor.getMaxWaitUsecs()
+            << " usecs for the save" << std::endl;
+    }
+    if (!wasSavedCopyPublished || savedSumBefore != savedSumAfter) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the copy being saved was replaced or edited during the save"
+            << std::endl;
+    }
+    if (snapshots.getSumDeferredPublishes() == 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the editor published over the copy being saved" << std::endl;
+    }
+    if (sumVoxels(&first) != sumVoxels(&second)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the snapshots hold different voxels after a slow save"
+            << std::endl;
+    }
+}
+
+void OctreeSnapshotTests::runAllTests() {
+    benchmarkEditorsAndViewers();
+    editsFlowDuringSlowSave();
+}
@@ -0,0 +1,26 @@
+//
+//  OctreeSnapshotTests.h
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__OctreeSnapshotTests__
+#define __tests__OctreeSnapshotTests__
+
+namespace OctreeSnapshotTests {
+
+    /// runs an editor and several viewers against one voxel tree, first locking it and then on a pair of snapshots,
+    /// printing the edits and packets per second and how long each side waited, and checks that both snapshots end
+    /// up holding the same voxels
+    void benchmarkEditorsAndViewers();
+
+    /// holds the published snapshot for as long as a slow save would, checking that the editor goes on applying edits
+    /// in the meantime without waiting, that the held copy isn't touched, and that both copies match afterwards
+    void editsFlowDuringSlowSave();
+
+    void runAllTests();
+}
+
+#endif // __tests__OctreeSnapshotTests__
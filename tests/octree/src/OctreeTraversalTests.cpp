@@ -0,0 +1,123 @@
+//
+//  OctreeTraversalTests.cpp
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <iostream>
+
+#include <OctalCode.h>
+#include <SharedUtil.h>
+#include <VoxelTree.h>
+#include <VoxelTreeElement.h>
+
+#include "OctreeTraversalTests.h"
+#include "VoxelTestUtil.h"
+
+// a solid cube of this many voxels on a side, about two and a half million elements
+const int VOXELS_PER_SIDE = 128;
+
+const int BENCHMARK_TRAVERSALS = 5;
+
+// sums the voxels like sumVoxels(), with a sum for each thread
+class SumVoxelsOperation : public OctreeConcurrentOperation {
+public:
+    SumVoxelsOperation() : _sum(0), _count(0) { }
+
+    virtual bool visit(OctreeElement* element) {
+        VoxelTreeElement* voxel = static_cast<VoxelTreeElement*>(element);
+        const unsigned char* octalCode = voxel->getOctalCode();
+        QByteArray voxelBytes(reinterpret_cast<const char*>(octalCode),
+                              bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(octalCode)));
+        if (voxel->isColored()) {
+            voxelBytes.append(reinterpret_cast<const char*>(voxel->getColor()), BYTES_PER_COLOR);
+        }
+        _sum += qHash(voxelBytes);
+        _count++;
+        return true;
+    }
+    virtual OctreeConcurrentOperation* clone() const { return new SumVoxelsOperation(); }
+    virtual void merge(const OctreeConcurrentOperation* copy) {
+        const SumVoxelsOperation* other = static_cast<const SumVoxelsOperation*>(copy);
+        _sum += other->_sum;
+        _count += other->_count;
+    }
+
+    uint getSum() const { return _sum; }
+    unsigned long getCount() const { return _count; }
+
+private:
+    uint _sum;
+    unsigned long _count;
+};
+
+static bool countElementsOperation(OctreeElement* element, void* extraData) {
+    (*static_cast<unsigned long*>(extraData))++;
+    return true;
+}
+
+void OctreeTraversalTests::benchmarkConcurrentTraversal() {
+    VoxelTree tree;
+    const float VOXEL_SIZE = 1.0f / VOXELS_PER_SIDE;
+    for (int x = 0; x < VOXELS_PER_SIDE; x++) {
+        for (int y = 0; y < VOXELS_PER_SIDE; y++) {
+            for (int z = 0; z < VOXELS_PER_SIDE; z++) {
+                tree.createVoxel(x * VOXEL_SIZE, y * VOXEL_SIZE, z * VOXEL_SIZE, VOXEL_SIZE,
+                                 randIntInRange(0, 255), randIntInRange(0, 255), randIntInRange(0, 255));
+            }
+        }
+    }
+
+    quint64 start = usecTimestampNow();
+    unsigned long count = 0;
+    for (int i = 0; i < BENCHMARK_TRAVERSALS; i++) {
+        count = 0;
+        tree.recurseTreeWithOperation(countElementsOperation, &count);
+    }
+    quint64 countUsecs = (usecTimestampNow() - start) / BENCHMARK_TRAVERSALS;
+
+    start = usecTimestampNow();
+    unsigned long concurrentCount = 0;
+    for (int i = 0; i < BENCHMARK_TRAVERSALS; i++) {
+        concurrentCount = tree.getOctreeElementsCount();
+    }
+    quint64 concurrentCountUsecs = (usecTimestampNow() - start) / BENCHMARK_TRAVERSALS;
+
+    start = usecTimestampNow();
+    uint sum = 0;
+    for (int i = 0; i < BENCHMARK_TRAVERSALS; i++) {
+        sum = sumVoxels(&tree);
+    }
+    quint64 sumUsecs = (usecTimestampNow() - start) / BENCHMARK_TRAVERSALS;
+
+    start = usecTimestampNow();
+    SumVoxelsOperation concurrentSum;
+    for (int i = 0; i < BENCHMARK_TRAVERSALS; i++) {
+        concurrentSum = SumVoxelsOperation();
+        tree.recurseTreeWithConcurrentOperation(concurrentSum);
+    }
+    quint64 concurrentSumUsecs = (usecTimestampNow() - start) / BENCHMARK_TRAVERSALS;
+
+    SumVoxelsOperation postOrderSum;
+    tree.recurseTreeWithConcurrentOperation(postOrderSum, POST_ORDER_OPERATION);
+
+    std::cout << count << " elements, counted in " << countUsecs << " usecs, " << concurrentCountUsecs
+        << " usecs concurrently, summed in " << sumUsecs << " usecs, " << concurrentSumUsecs << " usecs concurrently"
+        << std::endl;
+
+    if (concurrentCount != count || concurrentSum.getCount() != count || postOrderSum.getCount() != count) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << count << " elements were counted on one thread, but "
+            << concurrentCount << ", " << concurrentSum.getCount() << " and " << postOrderSum.getCount()
+            << " concurrently" << std::endl;
+    }
+    if (concurrentSum.getSum() != sum || postOrderSum.getSum() != sum) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the voxels summed differently when visited concurrently"
+            << std::endl;
+    }
+}
+
+void OctreeTraversalTests::runAllTests() {
+    benchmarkConcurrentTraversal();
+}
@@ -0,0 +1,21 @@
+//
+//  OctreeTraversalTests.h
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__OctreeTraversalTests__
+#define __tests__OctreeTraversalTests__
+
+namespace OctreeTraversalTests {
+
+    /// counts and sums the voxels of a tree of a few million elements, on one thread and then concurrently, printing how
+    /// long each took and checking that both visited the same elements, before and after their children
+    void benchmarkConcurrentTraversal();
+
+    void runAllTests();
+}
+
+#endif // __tests__OctreeTraversalTests__
@@ -0,0 +1,71 @@
+//
+//  SVOFileTests.cpp
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <iostream>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include <SharedUtil.h>
+#include <VoxelTree.h>
+
+#include "SVOFileTests.h"
+#include "VoxelTestUtil.h"
+
+const int LARGE_SCENE_VOXELS = 250000;
+
+static void saveAndLoad(VoxelTree& scene, const QString& filename, bool chunked) {
+    const char* mode = chunked ? "chunked SVO" : "plain SVO";
+
+    quint64 start = usecTimestampNow();
+    if (chunked) {
+        scene.writeToChunkedSVOFile(filename.toLocal8Bit().constData());
+    } else {
+        scene.writeToSVOFile(filename.toLocal8Bit().constData());
+    }
+    quint64 saveUsecs = usecTimestampNow() - start;
+
+    VoxelTree loadedScene;
+    start = usecTimestampNow();
+    bool loaded = loadedScene.readFromSVOFile(filename.toLocal8Bit().constData());
+    quint64 loadUsecs = usecTimestampNow() - start;
+
+    qint64 fileBytes = QFileInfo(filename).size();
+    std::cout << mode << ": " << fileBytes / 1024 << " KB, saved in " << saveUsecs / USECS_PER_MSEC << " msecs, loaded in "
+        << loadUsecs / USECS_PER_MSEC << " msecs, "
+        << (loadUsecs > 0 ? (float)fileBytes * USECS_PER_SECOND / loadUsecs / (1024 * 1024) : 0.0f) << " MB/s"
+        << std::endl;
+
+    if (!loaded) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the " << mode << " file didn't load" << std::endl;
+    }
+    if (sumVoxels(&loadedScene) != sumVoxels(&scene)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the " << mode << " file loaded different voxels than were saved"
+            << std::endl;
+    }
+
+    QFile::remove(filename);
+}
+
+void SVOFileTests::benchmarkLoadingLargeScene() {
+    QVector<QByteArray> voxels;
+    for (int i = 0; i < LARGE_SCENE_VOXELS; i++) {
+        voxels.append(randomVoxelEdit());
+    }
+    VoxelTree scene;
+    applyEdits(&scene, voxels, 0, LARGE_SCENE_VOXELS);
+
+    bool chunked = true;
+    saveAndLoad(scene, QDir::temp().filePath("svo-file-test.svo"), !chunked);
+    saveAndLoad(scene, QDir::temp().filePath("svo-file-test-chunked.svo"), chunked);
+}
+
+void SVOFileTests::runAllTests() {
+    benchmarkLoadingLargeScene();
+}
@@ -0,0 +1,21 @@
+//
+//  SVOFileTests.h
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__SVOFileTests__
+#define __tests__SVOFileTests__
+
+namespace SVOFileTests {
+
+    /// saves a large generated scene as a plain and as a chunked SVO file, checks that each loads back to the same
+    /// voxels, and prints how long each took to save and load
+    void benchmarkLoadingLargeScene();
+
+    void runAllTests();
+}
+
+#endif // __tests__SVOFileTests__
@@ -0,0 +1,65 @@
+//
+//  VoxelTestUtil.cpp
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <OctalCode.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+#include <VoxelTree.h>
+#include <VoxelTreeElement.h>
+
+#include "VoxelTestUtil.h"
+
+QByteArray randomVoxelEdit() {
+    unsigned char* codeColor = pointToVoxel(randFloatInRange(0.0f, 1.0f - EDIT_VOXEL_SIZE),
+        randFloatInRange(0.0f, 1.0f - EDIT_VOXEL_SIZE), randFloatInRange(0.0f, 1.0f - EDIT_VOXEL_SIZE), EDIT_VOXEL_SIZE,
+        randIntInRange(0, 255), randIntInRange(0, 255), randIntInRange(0, 255));
+    int length = bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(codeColor)) + BYTES_PER_COLOR;
+    QByteArray edit(reinterpret_cast<const char*>(codeColor), length);
+    delete[] codeColor;
+    return edit;
+}
+
+void applyEdits(Octree* tree, const QVector<QByteArray>& edits, int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        const unsigned char* editData = reinterpret_cast<const unsigned char*>(edits[i].constData());
+        tree->processEditPacketData(PacketTypeVoxelSet, editData, edits[i].size(), editData, edits[i].size(),
+                                    SharedNodePointer());
+    }
+}
+
+QByteArray voxelSetPacket(const QVector<QByteArray>& edits, int first, int count) {
+    QByteArray packet = byteArrayWithPopulatedHeader(PacketTypeVoxelSet);
+
+    unsigned short int sequence = first;
+    quint64 sentAt = usecTimestampNow();
+    packet.append(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+    packet.append(reinterpret_cast<const char*>(&sentAt), sizeof(sentAt));
+
+    for (int i = first; i < first + count; i++) {
+        packet.append(edits[i]);
+    }
+    return packet;
+}
+
+static bool sumVoxelsOperation(OctreeElement* element, void* extraData) {
+    VoxelTreeElement* voxel = static_cast<VoxelTreeElement*>(element);
+    const unsigned char* octalCode = voxel->getOctalCode();
+    QByteArray voxelBytes(reinterpret_cast<const char*>(octalCode),
+                          bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(octalCode)));
+    if (voxel->isColored()) {
+        voxelBytes.append(reinterpret_cast<const char*>(voxel->getColor()), BYTES_PER_COLOR);
+    }
+    *static_cast<uint*>(extraData) += qHash(voxelBytes);
+    return true;
+}
+
+uint sumVoxels(Octree* tree) {
+    uint sum = 0;
+    tree->recurseTreeWithOperation(sumVoxelsOperation, &sum);
+    return sum;
+}
@@ -0,0 +1,31 @@
+//
+//  VoxelTestUtil.h
+//  octree-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__VoxelTestUtil__
+#define __tests__VoxelTestUtil__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+class Octree;
+
+const float EDIT_VOXEL_SIZE = 1.0f / 256.0f;
+
+/// a voxel set record, octal code and color, for a random voxel of EDIT_VOXEL_SIZE
+QByteArray randomVoxelEdit();
+
+/// applies the edits from first on in the way the server does, as the records of a voxel set packet
+void applyEdits(Octree* tree, const QVector<QByteArray>& edits, int first, int count);
+
+/// a voxel set packet, as an editor sends it, of the edits from first on
+QByteArray voxelSetPacket(const QVector<QByteArray>& edits, int first, int count);
+
+/// a sum of the voxels of a tree that doesn't depend on the order they are visited in, which differs between two trees
+uint sumVoxels(Octree* tree);
+
+#endif // __tests__VoxelTestUtil__
@@ -0,0 +1,25 @@
+//
+//  main.cpp
+//  octree-tests
+//
+
+#include <QtCore/QCoreApplication>
+
+#include "OctreeEditJournalTests.h"
+#include "OctreeElementPoolTests.h"
+#include "OctreeEncodeCacheTests.h"
+#include "OctreeSnapshotTests.h"
+#include "OctreeTraversalTests.h"
+#include "SVOFileTests.h"
+
+int main(int argc, char** argv) {
+    QCoreApplication application(argc, argv);
+
+    OctreeEditJournalTests::runAllTests();
+    OctreeSnapshotTests::runAllTests();
+    SVOFileTests::runAllTests();
+    OctreeEncodeCacheTests::runAllTests();
+    OctreeTraversalTests::runAllTests();
+    OctreeElementPoolTests::runAllTests();
+    return 0;
+}
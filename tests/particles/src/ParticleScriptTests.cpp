@@ -0,0 +1,145 @@
+//
+//  ParticleScriptTests.cpp
+//  particles-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <math.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <QtCore/QVector>
+
+#include <Particle.h>
+#include <ParticleScriptContexts.h>
+#include <ScriptEngine.h>
+#include <SharedUtil.h>
+
+#include "ParticleScriptTests.h"
+
+const int BENCHMARK_PARTICLES = 100;
+const int BENCHMARK_FRAMES = 20;
+
+// slows the particle down a little on every update, like the scripts in examples/ do
+const QString UPDATE_SCRIPT = "Particle.update.connect(function() {"
+    "    var velocity = Particle.getVelocity();"
+    "    Particle.setVelocity({ x: velocity.x * 0.5, y: velocity.y * 0.5, z: velocity.z * 0.5 });"
+    "});";
+
+static void initScriptedParticles(QVector<Particle>& particles, const QString& script) {
+    rgbColor color = { 255, 0, 0 };
+    for (int i = 0; i < particles.size(); i++) {
+        particles[i].init(glm::vec3(0.5f, 0.5f, 0.5f), 0.01f, color, glm::vec3(i + 1.0f, 0.0f, 0.0f) / (float)TREE_SCALE,
+            DEFAULT_GRAVITY, DEFAULT_DAMPING, DEFAULT_LIFETIME, NOT_IN_HAND, script);
+    }
+}
+
+void ParticleScriptTests::runsSharedScriptForEachParticle() {
+    const int NUM_PARTICLES = 10;
+    QVector<Particle> particles(NUM_PARTICLES);
+
+    // a script text of its own, so that earlier tests can't have evaluated it already
+    QString script = UPDATE_SCRIPT + "// runsSharedScriptForEachParticle";
+    initScriptedParticles(particles, script);
+
+    int evaluationsBefore = ParticleScriptContexts::getScriptEvaluations();
+    for (int i = 0; i < particles.size(); i++) {
+        particles[i].executeUpdateScripts();
+    }
+
+    int evaluations = ParticleScriptContexts::getScriptEvaluations() - evaluationsBefore;
+    if (evaluations != 1) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: script evaluated " << evaluations
+            << " times for " << NUM_PARTICLES << " particles, expected once" << std::endl;
+    }
+
+    for (int i = 0; i < particles.size(); i++) {
+        float expectedSpeed = (i + 1.0f) * 0.5f;
+        float speed = particles[i].getVelocity().x * (float)TREE_SCALE;
+        if (fabsf(speed - expectedSpeed) > EPSILON) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: particle " << i << " has speed " << speed
+                << ", expected " << expectedSpeed << std::endl;
+        }
+    }
+}
+
+void ParticleScriptTests::runsTopLevelCodeWithParticle() {
+    const int NUM_PARTICLES = 3;
+    const float TOP_LEVEL_DAMPING = 0.25f;
+    const float UPDATED_RADIUS = 1.0f;
+    QVector<Particle> particles(NUM_PARTICLES);
+
+    // the top level code runs once, when the script is first run for a particle, and has that particle to change
+    QString script = QString("Particle.setDamping(%1);"
+        "var firstID = Particle.getID();"
+        "Particle.update.connect(function() { Particle.setRadius(%2); });").arg(TOP_LEVEL_DAMPING).arg(UPDATED_RADIUS);
+    initScriptedParticles(particles, script);
+
+    for (int i = 0; i < particles.size(); i++) {
+        particles[i].executeUpdateScripts();
+    }
+
+    if (fabsf(particles[0].getDamping() - TOP_LEVEL_DAMPING) > EPSILON) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the top level code didn't change the first particle" <<
+            std::endl;
+    }
+    for (int i = 1; i < particles.size(); i++) {
+        if (fabsf(particles[i].getDamping() - DEFAULT_DAMPING) > EPSILON) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the top level code ran again for particle " << i <<
+                std::endl;
+        }
+    }
+    for (int i = 0; i < particles.size(); i++) {
+        if (fabsf(particles[i].getRadius() * (float)TREE_SCALE - UPDATED_RADIUS) > EPSILON) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: particle " << i << " wasn't updated" << std::endl;
+        }
+    }
+
+    // between calls the object has no particle, and does nothing
+    ParticleScriptObject unboundScriptable(NULL);
+    unboundScriptable.setVelocity(glm::vec3(1.0f, 0.0f, 0.0f));
+    if (unboundScriptable.getID() != UNKNOWN_PARTICLE_ID || unboundScriptable.getPosition() != glm::vec3()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: an object with no particle didn't return defaults" <<
+            std::endl;
+    }
+}
+
+void ParticleScriptTests::benchmarkScriptedParticleUpdates() {
+    QVector<Particle> particles(BENCHMARK_PARTICLES);
+    initScriptedParticles(particles, UPDATE_SCRIPT);
+    int numUpdates = BENCHMARK_PARTICLES * BENCHMARK_FRAMES;
+
+    // what every update used to do, a new engine that evaluates the script for one call
+    quint64 start = usecTimestampNow();
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+        for (int i = 0; i < particles.size(); i++) {
+            ScriptEngine engine(particles[i].getScript());
+            ParticleScriptObject particleScriptable(&particles[i]);
+            engine.registerGlobalObject("Particle", &particleScriptable);
+            engine.evaluate();
+            particleScriptable.emitUpdate();
+        }
+    }
+    quint64 newEngineUsecs = usecTimestampNow() - start;
+
+    start = usecTimestampNow();
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+        for (int i = 0; i < particles.size(); i++) {
+            particles[i].executeUpdateScripts();
+        }
+    }
+    quint64 pooledUsecs = usecTimestampNow() - start;
+
+    std::cout << "scripted particle updates per second, new engine per update: "
+        << numUpdates * (float)USECS_PER_SECOND / std::max(newEngineUsecs, (quint64)1)
+        << ", pooled engines: " << numUpdates * (float)USECS_PER_SECOND / std::max(pooledUsecs, (quint64)1) << std::endl;
+}
+
+void ParticleScriptTests::runAllTests() {
+    runsSharedScriptForEachParticle();
+    runsTopLevelCodeWithParticle();
+    benchmarkScriptedParticleUpdates();
+}
@@ -0,0 +1,27 @@
+//
+//  ParticleScriptTests.h
+//  particles-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__ParticleScriptTests__
+#define __tests__ParticleScriptTests__
+
+namespace ParticleScriptTests {
+
+    /// checks that particles sharing a script evaluate it once, and that each call still changes the particle it is for
+    void runsSharedScriptForEachParticle();
+
+    /// checks that a script's top level code runs with the particle it is first run for, once, and that the "Particle"
+    /// object is safe to use when it has no particle
+    void runsTopLevelCodeWithParticle();
+
+    /// prints how many scripted particle updates run per second with a new engine per update and with the pooled ones
+    void benchmarkScriptedParticleUpdates();
+
+    void runAllTests();
+}
+
+#endif // __tests__ParticleScriptTests__
@@ -0,0 +1,115 @@
+//
+//  ParticleTreeTests.cpp
+//  particles-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#include <iostream>
+
+#include <ParticleTree.h>
+#include <SharedUtil.h>
+
+#include "ParticleTreeTests.h"
+
+const int STRESS_PARTICLES = 100000;
+
+// long enough that none of the particles dies of age while the test runs
+const float STRESS_LIFETIME = 1000.0f;
+
+static glm::vec3 randomTreePosition() {
+    // stay away from the edges, a particle that leaves the root's box is deleted on update
+    return glm::vec3(randFloatInRange(0.1f, 0.9f), randFloatInRange(0.1f, 0.9f), randFloatInRange(0.1f, 0.9f));
+}
+
+static void printElapsed(const char* step, quint64 start) {
+    quint64 elapsed = usecTimestampNow() - start;
+    std::cout << step << " " << STRESS_PARTICLES << " particles: " << elapsed / USECS_PER_MSEC << " msecs, "
+        << (float)elapsed / STRESS_PARTICLES << " usecs each" << std::endl;
+}
+
+// returns how many of the particles with an ID from start to end in steps of step the tree can't find
+static int countMissingParticles(ParticleTree& tree, uint32_t start, uint32_t end, uint32_t step) {
+    int missing = 0;
+    for (uint32_t id = start; id < end; id += step) {
+        const Particle* particle = tree.findParticleByID(id, true);
+        if (!particle || particle->getID() != id) {
+            missing++;
+        }
+    }
+    return missing;
+}
+
+void ParticleTreeTests::stressParticleLookupsByID() {
+    ParticleTree tree;
+    tree.lockForWrite();
+
+    rgbColor color = { 0, 255, 0 };
+    quint64 start = usecTimestampNow();
+    for (uint32_t id = 0; id < STRESS_PARTICLES; id++) {
+        Particle particle;
+        particle.init(randomTreePosition(), 0.0001f, color, glm::vec3(0.0f), glm::vec3(0.0f), DEFAULT_DAMPING,
+            STRESS_LIFETIME, IN_HAND, DEFAULT_SCRIPT, id);
+        tree.storeParticle(particle);
+    }
+    printElapsed("stored", start);
+
+    start = usecTimestampNow();
+    int missing = countMissingParticles(tree, 0, STRESS_PARTICLES, 1);
+    printElapsed("found", start);
+    if (missing > 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << missing << " stored particles not found" << std::endl;
+    }
+
+    // send every particle somewhere else, so that the next update moves each one to another element
+    start = usecTimestampNow();
+    for (uint32_t id = 0; id < STRESS_PARTICLES; id++) {
+        ParticleProperties properties;
+        properties.setPosition(randomTreePosition() * (float)TREE_SCALE);
+        tree.updateParticle(ParticleID(id), properties);
+    }
+    printElapsed("edited", start);
+
+    tree.unlock();
+    start = usecTimestampNow();
+    tree.update();
+    printElapsed("moved", start);
+    tree.lockForWrite();
+
+    missing = countMissingParticles(tree, 0, STRESS_PARTICLES, 1);
+    if (missing > 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << missing << " moved particles not found" << std::endl;
+    }
+
+    // delete the even ones, the odd ones have to stay where they are
+    start = usecTimestampNow();
+    for (uint32_t id = 0; id < STRESS_PARTICLES; id += 2) {
+        tree.deleteParticle(ParticleID(id));
+    }
+    printElapsed("deleted half of", start);
+
+    int notDeleted = STRESS_PARTICLES / 2 - countMissingParticles(tree, 0, STRESS_PARTICLES, 2);
+    if (notDeleted > 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << notDeleted << " deleted particles still found" << std::endl;
+    }
+    missing = countMissingParticles(tree, 1, STRESS_PARTICLES, 2);
+    if (missing > 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << missing << " kept particles not found" << std::endl;
+    }
+
+    // a particle that isn't in the tree is stored as a new one, it must not find a stale element in the index
+    Particle particle;
+    particle.init(randomTreePosition(), 0.0001f, color, glm::vec3(0.0f), glm::vec3(0.0f), DEFAULT_DAMPING,
+        STRESS_LIFETIME, IN_HAND, DEFAULT_SCRIPT, 0);
+    tree.storeParticle(particle);
+    if (countMissingParticles(tree, 0, 1, 1) > 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: re-stored particle not found" << std::endl;
+    }
+
+    tree.unlock();
+}
+
+void ParticleTreeTests::runAllTests() {
+    stressParticleLookupsByID();
+}
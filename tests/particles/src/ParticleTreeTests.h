@@ -0,0 +1,21 @@
+//
+//  ParticleTreeTests.h
+//  particles-tests
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 High Fidelity, Inc. All rights reserved.
+//
+
+#ifndef __tests__ParticleTreeTests__
+#define __tests__ParticleTreeTests__
+
+namespace ParticleTreeTests {
+
+    /// stores, finds, edits, moves and deletes 100k particles by ID, checking that the tree's ID index keeps up and
+    /// printing how long each step takes
+    void stressParticleLookupsByID();
+
+    void runAllTests();
+}
+
+#endif // __tests__ParticleTreeTests__
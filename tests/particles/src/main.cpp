@@ -0,0 +1,22 @@
+//
+//  main.cpp
+//  particles-tests
+//
+
+#include <QtCore/QCoreApplication>
+
+#include <NodeList.h>
+
+#include "ParticleScriptTests.h"
+#include "ParticleTreeTests.h"
+
+int main(int argc, char** argv) {
+    QCoreApplication application(argc, argv);
+
+    // the scripting interfaces of a script engine listen for jurisdictions through the node list
+    NodeList::createInstance(NodeType::Agent);
+
+    ParticleScriptTests::runAllTests();
+    ParticleTreeTests::runAllTests();
+    return 0;
+}